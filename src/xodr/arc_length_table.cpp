@@ -0,0 +1,215 @@
+#include "arc_length_table.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace aid { namespace xodr {
+
+namespace {
+
+/**
+ * @brief The number of intervals the parameter range is split into before
+ * refinement, so that curves which happen to be well approximated at the
+ * midpoint of the full range are still refined.
+ */
+constexpr int NUM_INITIAL_INTERVALS = 4;
+
+/**
+ * @brief Bounds the size of the table, for degenerate curves with (nearly)
+ * zero speed somewhere.
+ */
+constexpr int MAX_NUM_NODES = 4096;
+
+class TableBuilder
+{
+  public:
+    TableBuilder(const Poly3& uPoly, const Poly3& vPoly, double endParam)
+        : uPoly_(uPoly), vPoly_(vPoly), endParam_(endParam)
+    {
+        // A rough estimate of the length is enough to scale the tolerance.
+        double estimatedLength = 0;
+        for (int i = 0; i < NUM_INITIAL_INTERVALS; i++)
+        {
+            estimatedLength +=
+                arcLength(endParam * i / NUM_INITIAL_INTERVALS, endParam * (i + 1) / NUM_INITIAL_INTERVALS);
+        }
+        maxError_ = ArcLengthTable::MAX_RELATIVE_ERROR * std::max(estimatedLength, 1.0);
+    }
+
+    double speed(double p) const { return std::hypot(uPoly_.evalDerivative(p), vPoly_.evalDerivative(p)); }
+
+    /**
+     * @brief Computes the arc length over [p0, p1] with 5-point Gauss-Legendre
+     * quadrature.
+     */
+    double arcLength(double p0, double p1) const
+    {
+        constexpr double NODES[] = {0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640,
+                                    0.9061798459386640};
+        constexpr double WEIGHTS[] = {0.5688888888888889, 0.4786286704993665, 0.4786286704993665,
+                                      0.2369268850561891, 0.2369268850561891};
+
+        double halfWidth = .5 * (p1 - p0);
+        double middle = .5 * (p0 + p1);
+
+        double ret = 0;
+        for (int i = 0; i < 5; i++)
+        {
+            ret += WEIGHTS[i] * speed(middle + halfWidth * NODES[i]);
+        }
+        return ret * halfWidth;
+    }
+
+    /**
+     * @brief Appends the nodes of the interval [p0, p1], except for the node
+     * at p0, which has already been appended.
+     */
+    void refine(double p0, double p1)
+    {
+        double s0 = arcLengths_.back();
+        double slope0 = slopes_.back();
+        double slope1 = 1 / std::max(speed(p1), MIN_SPEED);
+
+        double pMid = .5 * (p0 + p1);
+        double lengthA = arcLength(p0, pMid);
+        double lengthB = arcLength(pMid, p1);
+        double s1 = s0 + lengthA + lengthB;
+
+        bool accurate = true;
+        if (static_cast<int>(arcLengths_.size()) + 2 < MAX_NUM_NODES)
+        {
+            // The quadrature over the whole interval should agree with the sum
+            // over the halves, and the interpolant should hit the midpoint.
+            double quadratureError = std::abs(arcLength(p0, p1) - (lengthA + lengthB));
+            double interpolationError =
+                std::abs(hermite(s0, s1, p0, p1, slope0, slope1, s0 + lengthA) - pMid) * speed(pMid);
+
+            accurate = quadratureError <= maxError_ * (p1 - p0) / endParam_ && interpolationError <= maxError_;
+        }
+
+        if (accurate)
+        {
+            arcLengths_.push_back(s1);
+            params_.push_back(p1);
+            slopes_.push_back(slope1);
+        }
+        else
+        {
+            refine(p0, pMid);
+            refine(pMid, p1);
+        }
+    }
+
+    static double hermite(double s0, double s1, double p0, double p1, double slope0, double slope1, double s)
+    {
+        double h = s1 - s0;
+        double t = (s - s0) / h;
+        double t2 = t * t;
+        double t3 = t2 * t;
+        return (2 * t3 - 3 * t2 + 1) * p0 + (t3 - 2 * t2 + t) * h * slope0 + (-2 * t3 + 3 * t2) * p1 +
+               (t3 - t2) * h * slope1;
+    }
+
+    /**
+     * @brief A lower bound on the speed, to keep the slopes finite at cusps.
+     */
+    static constexpr double MIN_SPEED = 1e-12;
+
+    const Poly3& uPoly_;
+    const Poly3& vPoly_;
+    double endParam_;
+    double maxError_;
+
+    std::vector<double> arcLengths_;
+    std::vector<double> params_;
+    std::vector<double> slopes_;
+};
+
+}  // namespace
+
+ArcLengthTable::ArcLengthTable(const Poly3& uPoly, const Poly3& vPoly, double endParam)
+{
+    TableBuilder builder(uPoly, vPoly, endParam);
+    builder.arcLengths_.push_back(0);
+    builder.params_.push_back(0);
+    builder.slopes_.push_back(1 / std::max(builder.speed(0), TableBuilder::MIN_SPEED));
+
+    if (endParam > 0)
+    {
+        for (int i = 0; i < NUM_INITIAL_INTERVALS; i++)
+        {
+            builder.refine(endParam * i / NUM_INITIAL_INTERVALS, endParam * (i + 1) / NUM_INITIAL_INTERVALS);
+        }
+    }
+
+    numNodes_ = static_cast<int>(builder.arcLengths_.size());
+    ownNodes_.reserve(3 * numNodes_);
+    ownNodes_.insert(ownNodes_.end(), builder.arcLengths_.begin(), builder.arcLengths_.end());
+    ownNodes_.insert(ownNodes_.end(), builder.params_.begin(), builder.params_.end());
+    ownNodes_.insert(ownNodes_.end(), builder.slopes_.begin(), builder.slopes_.end());
+
+    arcLengths_ = ownNodes_.data();
+    params_ = arcLengths_ + numNodes_;
+    slopes_ = params_ + numNodes_;
+}
+
+ArcLengthTable::ArcLengthTable(const double* nodes, int numNodes)
+    : arcLengths_(nodes), params_(nodes + numNodes), slopes_(nodes + 2 * numNodes), numNodes_(numNodes)
+{
+    assert(numNodes > 0);
+}
+
+double ArcLengthTable::paramAt(double arcLength) const
+{
+    if (!(arcLength > 0))
+    {
+        return params_[0] + slopes_[0] * arcLength;
+    }
+
+    int last = numNodes_ - 1;
+    if (arcLength >= arcLengths_[last])
+    {
+        return params_[last] + slopes_[last] * (arcLength - arcLengths_[last]);
+    }
+
+    int i = static_cast<int>(std::upper_bound(arcLengths_, arcLengths_ + numNodes_, arcLength) - arcLengths_) - 1;
+    return TableBuilder::hermite(arcLengths_[i], arcLengths_[i + 1], params_[i], params_[i + 1], slopes_[i],
+                                 slopes_[i + 1], arcLength);
+}
+
+LazyArcLengthTable& LazyArcLengthTable::operator=(const LazyArcLengthTable& other)
+{
+    if (this != &other)
+    {
+        reset();
+    }
+    return *this;
+}
+
+void LazyArcLengthTable::reset()
+{
+    const ArcLengthTable* table = table_.exchange(nullptr);
+    if (ownsTable_)
+    {
+        delete table;
+    }
+    ownsTable_ = true;
+}
+
+const ArcLengthTable& LazyArcLengthTable::build(const Poly3& uPoly, const Poly3& vPoly, double endParam) const
+{
+    const ArcLengthTable* table = new ArcLengthTable(uPoly, vPoly, endParam);
+
+    const ArcLengthTable* expected = nullptr;
+    if (!table_.compare_exchange_strong(expected, table, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        // Another thread published its table first.
+        delete table;
+        return *expected;
+    }
+
+    return *table;
+}
+
+}}  // namespace aid::xodr
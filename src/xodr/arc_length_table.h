@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "poly3.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief A lookup table which maps the arc length along a parametric cubic
+ * curve to the curve parameter.
+ *
+ * The curve is (uPoly(p), vPoly(p)) for p in [0, endParam]. The table stores
+ * the parameter, the arc length and the derivative of the parameter with
+ * respect to arc length at a number of nodes, and interpolates between them
+ * with cubic Hermite polynomials. The arc lengths between the nodes are
+ * computed with 5-point Gauss-Legendre quadrature, and intervals are split
+ * until both the quadrature and the interpolation are accurate to
+ * MAX_RELATIVE_ERROR times the length of the curve (or MAX_RELATIVE_ERROR
+ * meters for curves shorter than a meter), so the table is compact for the
+ * gently curving geometries of road networks.
+ */
+class ArcLengthTable
+{
+  public:
+    /**
+     * @brief Builds the table for the given curve.
+     *
+     * @param uPoly         The polynomial for the u-coordinate.
+     * @param vPoly         The polynomial for the v-coordinate.
+     * @param endParam      The end of the parameter range.
+     */
+    ArcLengthTable(const Poly3& uPoly, const Poly3& vPoly, double endParam);
+
+    /**
+     * @brief Creates a table from its nodes, as returned by nodes() for a
+     * table of the same curve.
+     *
+     * The nodes aren't copied, so they must outlive the table. This is used
+     * for tables which are stored in flat map files.
+     *
+     * @param nodes         The nodes.
+     * @param numNodes      The number of nodes.
+     */
+    ArcLengthTable(const double* nodes, int numNodes);
+
+    ArcLengthTable(const ArcLengthTable&) = delete;
+    ArcLengthTable& operator=(const ArcLengthTable&) = delete;
+
+    /**
+     * @returns The arc length of the curve over the full parameter range.
+     */
+    double totalLength() const { return arcLengths_[numNodes_ - 1]; }
+
+    /**
+     * @brief Gets the parameter of the point at the given arc length from the
+     * start of the curve.
+     *
+     * Arc lengths outside [0, totalLength()] are extrapolated linearly.
+     *
+     * @param arcLength     The arc length.
+     * @returns             The parameter.
+     */
+    double paramAt(double arcLength) const;
+
+    /**
+     * @returns The number of nodes of the table.
+     */
+    int numNodes() const { return numNodes_; }
+
+    /**
+     * @returns The 3 * numNodes() values of the nodes: first the arc lengths,
+     * then the parameters, then the slopes.
+     */
+    const double* nodes() const { return arcLengths_; }
+
+    /**
+     * @brief The maximum error of the arc lengths at the nodes, and of the
+     * interpolated parameters, expressed as a distance along the curve and
+     * relative to the length of the curve.
+     */
+    static constexpr double MAX_RELATIVE_ERROR = 1e-11;
+
+  private:
+    /**
+     * @brief The values of the nodes, see nodes(), or empty if they're stored
+     * outside this table.
+     */
+    std::vector<double> ownNodes_;
+
+    const double* arcLengths_;
+    const double* params_;
+
+    /**
+     * @brief The derivatives of the parameter with respect to arc length,
+     * which are the inverses of the speed of the curve.
+     */
+    const double* slopes_;
+
+    int numNodes_;
+};
+
+/**
+ * @brief An ArcLengthTable which is built when it's first used.
+ *
+ * Geometries are often loaded without being evaluated, so they only pay for
+ * the table when they need it. The table may be built from any thread: when
+ * several threads race to build it, one of the tables is published with a
+ * compare-and-swap and the others are discarded. Because the table may be
+ * built on any thread, and arenas aren't thread-safe, it's allocated from the
+ * heap.
+ *
+ * Copies of a LazyArcLengthTable start out empty, and build their own table
+ * when it's first used.
+ */
+class LazyArcLengthTable
+{
+  public:
+    LazyArcLengthTable() = default;
+
+    /**
+     * @brief Creates a LazyArcLengthTable which uses the given table instead
+     * of building one. The table isn't owned, so it must outlive this object.
+     */
+    explicit LazyArcLengthTable(const ArcLengthTable& table) : table_(&table), ownsTable_(false) {}
+
+    LazyArcLengthTable(const LazyArcLengthTable&) {}
+    LazyArcLengthTable(LazyArcLengthTable&& other) noexcept
+        : table_(other.table_.exchange(nullptr)), ownsTable_(other.ownsTable_)
+    {
+        other.ownsTable_ = true;
+    }
+    LazyArcLengthTable& operator=(const LazyArcLengthTable& other);
+    ~LazyArcLengthTable()
+    {
+        if (ownsTable_)
+        {
+            delete table_.load(std::memory_order_acquire);
+        }
+    }
+
+    /**
+     * @brief Gets the table, and builds it first if needed.
+     *
+     * The arguments must be the same for each call, or at least for each call
+     * since the last reset().
+     *
+     * @param uPoly         The polynomial for the u-coordinate.
+     * @param vPoly         The polynomial for the v-coordinate.
+     * @param endParam      The end of the parameter range.
+     * @returns             The table.
+     */
+    const ArcLengthTable& get(const Poly3& uPoly, const Poly3& vPoly, double endParam) const
+    {
+        const ArcLengthTable* table = table_.load(std::memory_order_acquire);
+        return table ? *table : build(uPoly, vPoly, endParam);
+    }
+
+    /**
+     * @brief Discards the table, so it's rebuilt on the next call to get().
+     *
+     * This isn't thread-safe, and is meant for when the curve changes.
+     */
+    void reset();
+
+  private:
+    const ArcLengthTable& build(const Poly3& uPoly, const Poly3& vPoly, double endParam) const;
+
+    mutable std::atomic<const ArcLengthTable*> table_{nullptr};
+
+    /**
+     * @brief Whether table_ was built by this object, rather than passed to
+     * its constructor.
+     */
+    bool ownsTable_ = true;
+};
+
+}}  // namespace aid::xodr
@@ -0,0 +1,11 @@
+#pragma once
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief The path of the directory containing the example maps, relative to
+ * the src/xodr directory from which the benchmarks are run.
+ */
+static const char MAP_DATA_PATH_PREFIX[] = "../../data/opendrive/";
+
+}}  // namespace aid::xodr
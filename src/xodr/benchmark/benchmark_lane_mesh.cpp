@@ -0,0 +1,42 @@
+#include "lane_mesh.h"
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_config.h"
+
+namespace aid { namespace xodr {
+
+static const char* const MAP_NAMES[] = {"Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                        "sample1.1.xodr"};
+
+/**
+ * @brief Builds the lane mesh of a map, reusing the builder and the mesh,
+ * with the tessellation on a single thread.
+ */
+static void BM_BuildLaneMesh(benchmark::State& state)
+{
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)]).extract_value();
+    state.SetLabel(MAP_NAMES[state.range(0)]);
+
+    LaneMeshBuilder::Options options;
+    options.maxError_ = .03;
+    options.numThreads_ = 1;
+
+    LaneMeshBuilder builder(map);
+    LaneMesh mesh;
+    for (auto _ : state)
+    {
+        builder.build(options, mesh);
+        benchmark::DoNotOptimize(mesh.batches_.data());
+    }
+
+    size_t numTriangles = 0;
+    for (const LaneMesh::Batch& batch : mesh.batches_)
+    {
+        numTriangles += batch.indices_.size() / 3;
+    }
+    state.SetItemsProcessed(state.iterations() * numTriangles);
+}
+BENCHMARK(BM_BuildLaneMesh)->DenseRange(0, 3)->Unit(benchmark::kMicrosecond);
+
+}}  // namespace aid::xodr
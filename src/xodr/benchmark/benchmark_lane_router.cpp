@@ -0,0 +1,158 @@
+#include "lane_router.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <random>
+
+#include "benchmark_config.h"
+#include "synthetic_map.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Loads sample1.1, tiled @p numTiles times along both axes (see
+ * tiledMapText()).
+ */
+static XodrMap loadTiledSample(int numTiles)
+{
+    std::string text = readTextFile(std::string(MAP_DATA_PATH_PREFIX) + "sample1.1.xodr");
+    return XodrMap::fromText(tiledMapText(text, numTiles, numTiles, 4000)).extract_value();
+}
+
+/**
+ * @brief Generates queries from random lanes to the lanes where random walks
+ * of up to @p maxSteps edges from them end, so each query has a route. The
+ * copies of the tiled maps aren't connected, so random pairs of lanes would
+ * mostly be in different copies.
+ */
+static std::vector<LaneRouter::Query> randomQueries(const XodrMap& map, const LaneGraph& graph,
+                                                    const LaneRouter& router, int numQueries, int maxSteps)
+{
+    std::vector<LaneKey> laneKeys(map.totalNumLanes());
+    std::vector<int> usableLanes;
+    for (int roadIdx = 0; roadIdx < static_cast<int>(map.roads().size()); roadIdx++)
+    {
+        const ArenaVector<LaneSection>& laneSections = map.roads()[roadIdx].laneSections();
+        for (int i = 0; i < static_cast<int>(laneSections.size()); i++)
+        {
+            const ArenaVector<LaneSection::Lane>& lanes = laneSections[i].lanes();
+            for (int j = 0; j < static_cast<int>(lanes.size()); j++)
+            {
+                laneKeys[lanes[j].globalIndex()] = LaneKey(roadIdx, i, j);
+                if (!std::isinf(router.laneCost(lanes[j].globalIndex())))
+                {
+                    usableLanes.push_back(lanes[j].globalIndex());
+                }
+            }
+        }
+    }
+
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<size_t> laneDist(0, usableLanes.size() - 1);
+    std::vector<LaneRouter::Query> queries;
+    for (int i = 0; i < numQueries; i++)
+    {
+        int from = usableLanes[laneDist(rng)];
+        int to = from;
+        for (int step = 0; step < maxSteps; step++)
+        {
+            std::vector<int> successors;
+            for (int k = 0; k < graph.numSuccessors(to); k++)
+            {
+                if (!std::isinf(router.laneCost(graph.successors(to)[k])))
+                {
+                    successors.push_back(graph.successors(to)[k]);
+                }
+            }
+
+            if (successors.empty())
+            {
+                break;
+            }
+            to = successors[std::uniform_int_distribution<size_t>(0, successors.size() - 1)(rng)];
+        }
+
+        queries.push_back({laneKeys[from], laneKeys[to]});
+    }
+
+    return queries;
+}
+
+static void BM_LaneGraphBuild(benchmark::State& state)
+{
+    XodrMap map = loadTiledSample(static_cast<int>(state.range(0)));
+
+    LaneGraph::Options options;
+    options.numThreads_ = static_cast<int>(state.range(1));
+
+    int numEdges = 0;
+    for (auto _ : state)
+    {
+        LaneGraph graph(map, options);
+        numEdges = graph.numEdges();
+    }
+    state.SetItemsProcessed(state.iterations() * map.totalNumLanes());
+    state.counters["edges"] = numEdges;
+}
+BENCHMARK(BM_LaneGraphBuild)->Args({1, 1})->Args({8, 1})->Args({8, 0})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/**
+ * @brief Finds routes with Dijkstra's algorithm (0) or A* (1), on maps
+ * consisting of 16 and 64 copies of sample1.1, for random walks of up to 20
+ * and 200 edges.
+ */
+static void BM_LaneRouterFindRoute(benchmark::State& state)
+{
+    XodrMap map = loadTiledSample(static_cast<int>(state.range(0)));
+    LaneGraph graph(map, LaneGraph::Options());
+    LaneRouter router(map, graph, LaneRouter::Options());
+    std::vector<LaneRouter::Query> queries = randomQueries(map, graph, router, 1024, static_cast<int>(state.range(2)));
+
+    LaneRouter::Algorithm algorithm =
+        state.range(1) == 0 ? LaneRouter::Algorithm::DIJKSTRA : LaneRouter::Algorithm::A_STAR;
+    LaneRouter::SearchState searchState;
+
+    size_t i = 0;
+    long numSettled = 0;
+    for (auto _ : state)
+    {
+        const LaneRouter::Query& query = queries[i++ % queries.size()];
+        LaneRouter::Route route = router.findRoute(query.from_, query.to_, searchState, algorithm);
+        benchmark::DoNotOptimize(route);
+        numSettled += searchState.numSettled();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["settled"] = benchmark::Counter(numSettled, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_LaneRouterFindRoute)
+    ->Args({4, 0, 20})
+    ->Args({4, 1, 20})
+    ->Args({8, 0, 20})
+    ->Args({8, 1, 20})
+    ->Args({8, 0, 200})
+    ->Args({8, 1, 200})
+    ->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Finds the routes of a batch of 1024 queries with A*.
+ */
+static void BM_LaneRouterFindRoutes(benchmark::State& state)
+{
+    XodrMap map = loadTiledSample(8);
+    LaneGraph graph(map, LaneGraph::Options());
+    LaneRouter router(map, graph, LaneRouter::Options());
+    std::vector<LaneRouter::Query> queries = randomQueries(map, graph, router, 1024, 200);
+
+    std::vector<LaneRouter::Route> routes(queries.size());
+    for (auto _ : state)
+    {
+        router.findRoutes(queries.data(), static_cast<int>(queries.size()), routes.data(),
+                          static_cast<int>(state.range(0)));
+        benchmark::DoNotOptimize(routes.data());
+    }
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+BENCHMARK(BM_LaneRouterFindRoutes)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}}  // namespace aid::xodr
@@ -0,0 +1,107 @@
+#include "lane_spatial_index.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "benchmark_config.h"
+#include "synthetic_map.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Loads sample1.1, tiled @p numTiles times along both axes (see
+ * tiledMapText()).
+ */
+static XodrMap loadTiledSample(int numTiles)
+{
+    std::string text = readTextFile(std::string(MAP_DATA_PATH_PREFIX) + "sample1.1.xodr");
+    return XodrMap::fromText(tiledMapText(text, numTiles, numTiles, 4000)).extract_value();
+}
+
+/**
+ * @brief Generates points near the reference lines of random roads, up to 10
+ * meters to either side, so a good part of them are in lanes.
+ */
+static std::vector<Eigen::Vector2d> queryPoints(const XodrMap& map, int numPoints)
+{
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> roadDist(0, map.roads().size() - 1);
+    std::uniform_real_distribution<double> unitDist(0, 1);
+
+    std::vector<Eigen::Vector2d> points;
+    for (int i = 0; i < numPoints; i++)
+    {
+        const ReferenceLine& refLine = map.roads()[roadDist(rng)].referenceLine();
+        ReferenceLine::PointAndTangentDir pt = refLine.eval(unitDist(rng) * refLine.endS() * .999);
+        Eigen::Vector2d normal(-pt.tangentDir_.y(), pt.tangentDir_.x());
+        points.push_back(pt.point_ + (unitDist(rng) * 20 - 10) * normal);
+    }
+
+    return points;
+}
+
+static void BM_LaneSpatialIndexBuild(benchmark::State& state)
+{
+    XodrMap map = loadTiledSample(static_cast<int>(state.range(0)));
+
+    LaneSpatialIndex::Options options;
+    options.numThreads_ = 1;
+    int numQuads = 0;
+    for (auto _ : state)
+    {
+        LaneSpatialIndex index(map, options);
+        numQuads = index.numQuads();
+    }
+    state.SetItemsProcessed(state.iterations() * numQuads);
+    state.counters["quads"] = numQuads;
+}
+BENCHMARK(BM_LaneSpatialIndexBuild)->Arg(1)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Finds the lanes of single points, on maps consisting of 1, 16 and 64
+ * copies of sample1.1.
+ */
+static void BM_LaneSpatialIndexFindLanes(benchmark::State& state)
+{
+    XodrMap map = loadTiledSample(static_cast<int>(state.range(0)));
+    LaneSpatialIndex index(map, LaneSpatialIndex::Options());
+    std::vector<Eigen::Vector2d> points = queryPoints(map, 4096);
+
+    std::vector<LaneKey> lanes;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        index.findLanes(points[i++ % points.size()], lanes);
+        benchmark::DoNotOptimize(lanes.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["quads"] = index.numQuads();
+}
+BENCHMARK(BM_LaneSpatialIndexFindLanes)->Arg(1)->Arg(4)->Arg(8);
+
+/**
+ * @brief Finds the lanes of a batch of 4096 points.
+ */
+static void BM_LaneSpatialIndexFindLanesBatch(benchmark::State& state)
+{
+    XodrMap map = loadTiledSample(static_cast<int>(state.range(0)));
+    LaneSpatialIndex index(map, LaneSpatialIndex::Options());
+    std::vector<Eigen::Vector2d> points = queryPoints(map, 4096);
+
+    LaneSpatialIndex::BatchResult result;
+    for (auto _ : state)
+    {
+        index.findLanes(points.data(), static_cast<int>(points.size()), result, static_cast<int>(state.range(1)));
+        benchmark::DoNotOptimize(result.lanes_.data());
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_LaneSpatialIndexFindLanesBatch)
+    ->Args({1, 1})
+    ->Args({8, 1})
+    ->Args({8, 0})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+}}  // namespace aid::xodr
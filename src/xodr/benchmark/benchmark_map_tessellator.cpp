@@ -0,0 +1,83 @@
+#include "map_tessellator.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <thread>
+
+#include "benchmark_config.h"
+
+namespace aid { namespace xodr {
+
+static const char* const MAP_NAMES[] = {"Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                        "sample1.1.xodr"};
+
+/**
+ * @brief Tessellates all lane sections of a map with a reused MapTessellator,
+ * at the tolerance of the viewer.
+ */
+static void BM_MapTessellator(benchmark::State& state)
+{
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)]).extract_value();
+    state.SetLabel(MAP_NAMES[state.range(0)]);
+
+    MapTessellator::Options options;
+    options.maxError_ = .03;
+    options.numThreads_ = static_cast<int>(state.range(1));
+
+    MapTessellator tessellator(map);
+    for (auto _ : state)
+    {
+        tessellator.tessellate(options);
+        benchmark::DoNotOptimize(tessellator.boundary(0).vertices_);
+    }
+    state.SetItemsProcessed(state.iterations() * tessellator.numBoundaries());
+}
+
+/**
+ * @brief Adds the argument pairs (map index, number of threads) for all maps,
+ * with the number of threads doubling from 1 up to the number of hardware
+ * threads.
+ */
+static void scalingArguments(benchmark::internal::Benchmark* benchmark)
+{
+    int maxThreads = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+    for (int map = 0; map <= 3; map++)
+    {
+        for (int numThreads = 1; numThreads < maxThreads; numThreads *= 2)
+        {
+            benchmark->Args({map, numThreads});
+        }
+        benchmark->Args({map, maxThreads});
+    }
+}
+BENCHMARK(BM_MapTessellator)->Apply(scalingArguments)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+/**
+ * @brief Tessellates sample1.1 on a single thread into each vertex format, and
+ * reports the memory taken by the vertices.
+ */
+static void BM_MapTessellatorVertexFormat(benchmark::State& state)
+{
+    static const char* const FORMAT_NAMES[] = {"double", "float", "quantized"};
+
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + "sample1.1.xodr").extract_value();
+    state.SetLabel(FORMAT_NAMES[state.range(0)]);
+
+    MapTessellator::Options options;
+    options.maxError_ = .03;
+    options.numThreads_ = 1;
+    options.vertexFormat_ = static_cast<VertexFormat>(state.range(0));
+
+    MapTessellator tessellator(map);
+    for (auto _ : state)
+    {
+        tessellator.tessellate(options);
+        benchmark::DoNotOptimize(tessellator.roadOrigin(0));
+    }
+    state.SetItemsProcessed(state.iterations() * tessellator.numBoundaries());
+    state.counters["vertexBytes"] = static_cast<double>(tessellator.vertexMemoryUsage());
+}
+BENCHMARK(BM_MapTessellatorVertexFormat)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+
+}}  // namespace aid::xodr
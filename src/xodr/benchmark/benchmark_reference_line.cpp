@@ -0,0 +1,414 @@
+#include "xodr_map.h"
+#include "binary/xodr_binary_serializer.h"
+#include "binary/xodr_map_view.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "benchmark_config.h"
+
+extern "C" {
+#include "odrSpiral/odrSpiral.h"
+}
+
+namespace aid { namespace xodr {
+
+static const char* const MAP_NAMES[] = {"Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                        "sample1.1.xodr"};
+
+/**
+ * @brief The s-coordinates at which the reference line of each road of a map
+ * is evaluated: every 10 centimeters, either in order or shuffled.
+ */
+static std::vector<std::vector<double>> sampleSCoords(const XodrMap& map, bool shuffle)
+{
+    std::mt19937 random(42);
+
+    std::vector<std::vector<double>> ret;
+    for (const Road& road : map.roads())
+    {
+        const ReferenceLine& refLine = road.referenceLine();
+
+        std::vector<double> sCoords;
+        for (double s = 0; s < refLine.endS(); s += .1)
+        {
+            sCoords.push_back(s);
+        }
+
+        if (shuffle)
+        {
+            std::shuffle(sCoords.begin(), sCoords.end(), random);
+        }
+
+        ret.push_back(std::move(sCoords));
+    }
+
+    return ret;
+}
+
+static void setLabel(benchmark::State& state)
+{
+    state.SetLabel(std::string(MAP_NAMES[state.range(0)]) + (state.range(1) ? ", shuffled" : ", sorted"));
+}
+
+/**
+ * @brief Evaluates the reference lines of a map one s-coordinate at a time.
+ */
+static void BM_EvalReferenceLine(benchmark::State& state)
+{
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)]).extract_value();
+    std::vector<std::vector<double>> sCoords = sampleSCoords(map, state.range(1));
+    setLabel(state);
+
+    int64_t numEvals = 0;
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < map.roads().size(); i++)
+        {
+            const ReferenceLine& refLine = map.roads()[i].referenceLine();
+            for (double s : sCoords[i])
+            {
+                benchmark::DoNotOptimize(refLine.eval(s));
+            }
+            numEvals += sCoords[i].size();
+        }
+    }
+    state.SetItemsProcessed(numEvals);
+}
+BENCHMARK(BM_EvalReferenceLine)->ArgsProduct({{0, 1, 2, 3}, {0, 1}})->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Evaluates the reference lines of a map like BM_EvalReferenceLine,
+ * through an XodrMapView of the flat map. Each evaluation constructs the
+ * geometry from its flat record, so this measures what that costs.
+ */
+static void BM_EvalReferenceLineView(benchmark::State& state)
+{
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)]).extract_value();
+    std::vector<std::vector<double>> sCoords = sampleSCoords(map, state.range(1));
+    setLabel(state);
+
+    // Copy the data into a buffer of 64 bit integers, to ensure it's aligned.
+    std::vector<char> data = XodrBinarySerializer::serializeFlat(map);
+    std::vector<uint64_t> buffer((data.size() + 7) / 8);
+    std::memcpy(buffer.data(), data.data(), data.size());
+    XodrMapView view = XodrMapView::fromBuffer(reinterpret_cast<const char*>(buffer.data()), data.size());
+
+    int64_t numEvals = 0;
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < view.roads().size(); i++)
+        {
+            ReferenceLineView refLine = view.roads()[i].referenceLine();
+            for (double s : sCoords[i])
+            {
+                benchmark::DoNotOptimize(refLine.eval(s));
+            }
+            numEvals += sCoords[i].size();
+        }
+    }
+    state.SetItemsProcessed(numEvals);
+}
+BENCHMARK(BM_EvalReferenceLineView)->ArgsProduct({{0, 1, 2, 3}, {0, 1}})->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Evaluates the reference lines of a map with one evalMany() call per
+ * road.
+ */
+static void BM_EvalManyReferenceLine(benchmark::State& state)
+{
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)]).extract_value();
+    std::vector<std::vector<double>> sCoords = sampleSCoords(map, state.range(1));
+    setLabel(state);
+
+    size_t maxCount = 0;
+    for (const std::vector<double>& roadSCoords : sCoords)
+    {
+        maxCount = std::max(maxCount, roadSCoords.size());
+    }
+    std::vector<double> x(maxCount), y(maxCount), tangentX(maxCount), tangentY(maxCount);
+
+    int64_t numEvals = 0;
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < map.roads().size(); i++)
+        {
+            const ReferenceLine& refLine = map.roads()[i].referenceLine();
+            int count = static_cast<int>(sCoords[i].size());
+            refLine.evalMany(sCoords[i].data(), count, {x.data(), y.data(), tangentX.data(), tangentY.data()});
+            benchmark::ClobberMemory();
+            numEvals += count;
+        }
+    }
+    state.SetItemsProcessed(numEvals);
+}
+BENCHMARK(BM_EvalManyReferenceLine)->ArgsProduct({{0, 1, 2, 3}, {0, 1}})->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Gets the spirals of the reference lines of a map.
+ */
+static std::vector<const ReferenceLine::Spiral*> spirals(const XodrMap& map)
+{
+    std::vector<const ReferenceLine::Spiral*> ret;
+    for (const Road& road : map.roads())
+    {
+        const ReferenceLine& refLine = road.referenceLine();
+        for (int i = 0; i < refLine.numGeometries(); i++)
+        {
+            if (refLine.geometry(i).geometryType() == ReferenceLine::GeometryType::SPIRAL)
+            {
+                ret.push_back(static_cast<const ReferenceLine::Spiral*>(&refLine.geometry(i)));
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Evaluates the spirals of a map every 10 centimeters with
+ * Spiral::eval().
+ */
+static void BM_EvalSpiral(benchmark::State& state)
+{
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)]).extract_value();
+    std::vector<const ReferenceLine::Spiral*> mapSpirals = spirals(map);
+    state.SetLabel(MAP_NAMES[state.range(0)]);
+
+    int64_t numEvals = 0;
+    for (auto _ : state)
+    {
+        for (const ReferenceLine::Spiral* spiral : mapSpirals)
+        {
+            double startS = spiral->startVertex().sCoord_;
+            for (double u = 0; u < spiral->length(); u += .1)
+            {
+                benchmark::DoNotOptimize(spiral->eval(startS + u));
+                numEvals++;
+            }
+        }
+    }
+    state.SetItemsProcessed(numEvals);
+}
+BENCHMARK(BM_EvalSpiral)->Arg(0)->Arg(2)->Arg(3)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Evaluates the spirals of a map like BM_EvalSpiral, the way
+ * Spiral::eval() did before it used a Clothoid: with two odrSpiral() calls per
+ * evaluation.
+ */
+static void BM_EvalSpiralOdrSpiral(benchmark::State& state)
+{
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)]).extract_value();
+    std::vector<const ReferenceLine::Spiral*> mapSpirals = spirals(map);
+    state.SetLabel(MAP_NAMES[state.range(0)]);
+
+    int64_t numEvals = 0;
+    for (auto _ : state)
+    {
+        for (const ReferenceLine::Spiral* spiral : mapSpirals)
+        {
+            ReferenceLine::Vertex startVert = spiral->startVertex();
+            double curvatureROC = spiral->curvatureRateOfChange();
+            double curveStartParam = spiral->startCurvature() / curvatureROC;
+
+            for (double u = 0; u < spiral->length(); u += .1)
+            {
+                Eigen::Vector2d curveStartPt, curveEvalPt;
+                double curveStartHeading, curveEvalHeading;
+                odrSpiral(curveStartParam, curvatureROC, &curveStartPt.x(), &curveStartPt.y(), &curveStartHeading);
+                odrSpiral(curveStartParam + u, curvatureROC, &curveEvalPt.x(), &curveEvalPt.y(), &curveEvalHeading);
+
+                double heading = startVert.heading_ + (curveEvalHeading - curveStartHeading);
+                ReferenceLine::PointAndTangentDir ret;
+                ret.point_ = startVert.position_ + Eigen::Rotation2Dd(startVert.heading_ - curveStartHeading) *
+                                                       (curveEvalPt - curveStartPt);
+                ret.tangentDir_ = Eigen::Vector2d(std::cos(heading), std::sin(heading));
+                benchmark::DoNotOptimize(ret);
+                numEvals++;
+            }
+        }
+    }
+    state.SetItemsProcessed(numEvals);
+}
+BENCHMARK(BM_EvalSpiralOdrSpiral)->Arg(0)->Arg(2)->Arg(3)->Unit(benchmark::kMicrosecond);
+
+static const char* const PARAM_POLY3_MODES[] = {"", "with table construction", "per eval, with stored table"};
+
+/**
+ * @brief Evaluates a 60 meter paramPoly3, of the kind which connects the lanes
+ * of a junction, every 10 centimeters. With range(0) == 1, each iteration
+ * evaluates a fresh copy of the geometry, so it includes building the arc
+ * length table. With range(0) == 2, each evaluation constructs the geometry
+ * from a stored table, the way GeometryView does.
+ */
+static void BM_EvalParamPoly3(benchmark::State& state)
+{
+    ReferenceLine::ParamPoly3 paramPoly3(ReferenceLine::Vertex{}, 60, Poly3(0, 60, 0, 0), Poly3(0, 0, 3, -1),
+                                         ReferenceLine::PRange::NORMALIZED);
+    int mode = static_cast<int>(state.range(0));
+    state.SetLabel(PARAM_POLY3_MODES[mode]);
+
+    const ArcLengthTable& table = paramPoly3.arcLengthTable();
+    std::vector<double> nodes(table.nodes(), table.nodes() + 3 * table.numNodes());
+
+    int64_t numEvals = 0;
+    for (auto _ : state)
+    {
+        ReferenceLine::ParamPoly3 copy(paramPoly3);
+        const ReferenceLine::ParamPoly3& geom = mode == 1 ? copy : paramPoly3;
+        for (double s = 0; s < geom.length(); s += .1)
+        {
+            if (mode == 2)
+            {
+                ArcLengthTable storedTable(nodes.data(), table.numNodes());
+                ReferenceLine::ParamPoly3 stored(geom.startVertex(), geom.length(), geom.uPoly(), geom.vPoly(),
+                                                 geom.pRange(), storedTable);
+                benchmark::DoNotOptimize(stored.eval(s));
+            }
+            else
+            {
+                benchmark::DoNotOptimize(geom.eval(s));
+            }
+            numEvals++;
+        }
+    }
+    state.SetItemsProcessed(numEvals);
+}
+BENCHMARK(BM_EvalParamPoly3)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Tessellates the reference lines of a map at the fixed rate.
+ */
+static void BM_TessellateReferenceLine(benchmark::State& state)
+{
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)]).extract_value();
+    state.SetLabel(MAP_NAMES[state.range(0)]);
+
+    int64_t numVertices = 0;
+    for (auto _ : state)
+    {
+        for (const Road& road : map.roads())
+        {
+            const ReferenceLine& refLine = road.referenceLine();
+            ReferenceLine::Tessellation tessellation = refLine.tessellate(0, refLine.endS());
+            numVertices += tessellation.size();
+            benchmark::DoNotOptimize(tessellation.data());
+        }
+    }
+    state.SetItemsProcessed(numVertices);
+}
+BENCHMARK(BM_TessellateReferenceLine)->DenseRange(0, 3)->Unit(benchmark::kMicrosecond);
+
+static const char* const LANE_TESSELLATION_MODES[] = {"", " reusing buffers", " with Frenet frames"};
+
+/**
+ * @brief Tessellates the lane boundaries of all lane sections of a map, the
+ * way the viewer does on every repaint. With range(1) == 0, the functions
+ * which return new vectors are used, with range(1) == 1 the ones which reuse
+ * buffers, and with range(1) == 2 the ones which reuse buffers and take a
+ * tessellation with Frenet frames.
+ */
+static void BM_TessellateLaneBoundaryCurves(benchmark::State& state)
+{
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)]).extract_value();
+    int mode = static_cast<int>(state.range(1));
+    state.SetLabel(std::string(MAP_NAMES[state.range(0)]) + LANE_TESSELLATION_MODES[mode]);
+
+    ReferenceLine::Tessellation refLineTessellation;
+    ReferenceLine::FrenetFrames refLineFrames;
+    LaneSection::LaneTessellationBuffer laneTessellation;
+
+    int64_t numLaneSections = 0;
+    for (auto _ : state)
+    {
+        for (const Road& road : map.roads())
+        {
+            for (const LaneSection& laneSection : road.laneSections())
+            {
+                ReferenceLine::TessellationTolerance tolerance = laneSection.boundaryTessellationTolerance(.03);
+                if (mode == 2)
+                {
+                    road.referenceLine().tessellate(refLineFrames, laneSection.startS(), laneSection.endS(),
+                                                    tolerance);
+                    laneSection.tessellateLaneBoundaryCurves(refLineFrames, laneTessellation);
+                    benchmark::DoNotOptimize(laneTessellation.boundaryVertices_.data());
+                }
+                else if (mode == 1)
+                {
+                    road.referenceLine().tessellate(refLineTessellation, laneSection.startS(), laneSection.endS(),
+                                                    tolerance);
+                    laneSection.tessellateLaneBoundaryCurves(refLineTessellation, laneTessellation);
+                    benchmark::DoNotOptimize(laneTessellation.boundaryVertices_.data());
+                }
+                else
+                {
+                    auto tessellation =
+                        road.referenceLine().tessellate(laneSection.startS(), laneSection.endS(), tolerance);
+                    auto boundaries = laneSection.tessellateLaneBoundaryCurves(tessellation);
+                    benchmark::DoNotOptimize(boundaries.data());
+                }
+                numLaneSections++;
+            }
+        }
+    }
+    state.SetItemsProcessed(numLaneSections);
+}
+BENCHMARK(BM_TessellateLaneBoundaryCurves)->ArgsProduct({{0, 1, 2, 3}, {0, 1, 2}})->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Derives the lane boundaries and center lines of all lane sections of
+ * sample1.1 from reference line tessellations which are computed up front, so
+ * only the lane kernels are measured. With range(0) == 0, the kernels take
+ * Vertex tessellations and evaluate the normals from the headings, otherwise
+ * they take the normals from FrenetFrames.
+ */
+static void BM_LaneBoundaryKernels(benchmark::State& state)
+{
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + "sample1.1.xodr").extract_value();
+    bool useFrames = state.range(0) != 0;
+    state.SetLabel(useFrames ? "Frenet frames" : "vertices");
+
+    std::vector<const LaneSection*> laneSections;
+    std::vector<ReferenceLine::Tessellation> tessellations;
+    std::vector<ReferenceLine::FrenetFrames> frames;
+    for (const Road& road : map.roads())
+    {
+        for (const LaneSection& laneSection : road.laneSections())
+        {
+            ReferenceLine::TessellationTolerance tolerance = laneSection.boundaryTessellationTolerance(.03);
+            laneSections.push_back(&laneSection);
+            tessellations.push_back(road.referenceLine().tessellate(laneSection.startS(), laneSection.endS(),
+                                                                    tolerance));
+            frames.emplace_back();
+            road.referenceLine().tessellate(frames.back(), laneSection.startS(), laneSection.endS(), tolerance);
+        }
+    }
+
+    LaneSection::LaneTessellationBuffer laneTessellation;
+    int64_t numVertices = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < static_cast<int>(laneSections.size()); i++)
+        {
+            if (useFrames)
+            {
+                laneSections[i]->tessellateLaneBoundaryCurvesAndCenterLines(frames[i], laneTessellation);
+            }
+            else
+            {
+                laneSections[i]->tessellateLaneBoundaryCurvesAndCenterLines(tessellations[i], laneTessellation);
+            }
+            benchmark::DoNotOptimize(laneTessellation.boundaryVertices_.data());
+            numVertices += laneTessellation.boundaryVertices_.size() + laneTessellation.centerLineVertices_.size();
+        }
+    }
+    state.SetItemsProcessed(numVertices);
+}
+BENCHMARK(BM_LaneBoundaryKernels)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+}}  // namespace aid::xodr
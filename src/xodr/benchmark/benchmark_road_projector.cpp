@@ -0,0 +1,108 @@
+#include "road_projector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "benchmark_config.h"
+#include "synthetic_map.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Loads sample1.1, tiled @p numTiles times along both axes (see
+ * tiledMapText()).
+ */
+static XodrMap loadTiledSample(int numTiles)
+{
+    std::string text = readTextFile(std::string(MAP_DATA_PATH_PREFIX) + "sample1.1.xodr");
+    return XodrMap::fromText(tiledMapText(text, numTiles, numTiles, 4000)).extract_value();
+}
+
+/**
+ * @brief Generates points near the reference lines of random roads, up to 10
+ * meters to either side.
+ */
+static std::vector<Eigen::Vector2d> queryPoints(const XodrMap& map, int numPoints)
+{
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> roadDist(0, map.roads().size() - 1);
+    std::uniform_real_distribution<double> unitDist(0, 1);
+
+    std::vector<Eigen::Vector2d> points;
+    for (int i = 0; i < numPoints; i++)
+    {
+        const ReferenceLine& refLine = map.roads()[roadDist(rng)].referenceLine();
+        ReferenceLine::PointAndTangentDir pt = refLine.eval(unitDist(rng) * refLine.endS() * .999);
+        Eigen::Vector2d normal(-pt.tangentDir_.y(), pt.tangentDir_.x());
+        points.push_back(pt.point_ + (unitDist(rng) * 20 - 10) * normal);
+    }
+
+    return points;
+}
+
+static void BM_RoadProjectorBuild(benchmark::State& state)
+{
+    XodrMap map = loadTiledSample(static_cast<int>(state.range(0)));
+
+    int numSegments = 0;
+    for (auto _ : state)
+    {
+        RoadProjector projector(map, RoadProjector::Options());
+        numSegments = projector.numSegments();
+    }
+    state.SetItemsProcessed(state.iterations() * numSegments);
+    state.counters["segments"] = numSegments;
+}
+BENCHMARK(BM_RoadProjectorBuild)->Arg(1)->Arg(8)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Projects single points, on maps consisting of 1, 16 and 64 copies of
+ * sample1.1, with the default and a coarser segment tolerance (in
+ * centimeters).
+ */
+static void BM_RoadProjectorProject(benchmark::State& state)
+{
+    XodrMap map = loadTiledSample(static_cast<int>(state.range(0)));
+    RoadProjector::Options options;
+    options.maxError_ = state.range(1) * .01;
+    RoadProjector projector(map, options);
+    std::vector<Eigen::Vector2d> points = queryPoints(map, 4096);
+
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        RoadPosition pos = projector.project(points[i++ % points.size()]);
+        benchmark::DoNotOptimize(pos);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["segments"] = projector.numSegments();
+}
+BENCHMARK(BM_RoadProjectorProject)->Args({1, 10})->Args({4, 10})->Args({8, 10})->Args({8, 50});
+
+/**
+ * @brief Projects a batch of 4096 points.
+ */
+static void BM_RoadProjectorProjectBatch(benchmark::State& state)
+{
+    XodrMap map = loadTiledSample(static_cast<int>(state.range(0)));
+    RoadProjector projector(map, RoadProjector::Options());
+    std::vector<Eigen::Vector2d> points = queryPoints(map, 4096);
+
+    std::vector<RoadPosition> positions(points.size());
+    for (auto _ : state)
+    {
+        projector.project(points.data(), static_cast<int>(points.size()), positions.data(),
+                          static_cast<int>(state.range(1)));
+        benchmark::DoNotOptimize(positions.data());
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_RoadProjectorProjectBatch)
+    ->Args({1, 1})
+    ->Args({8, 1})
+    ->Args({8, 0})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+}}  // namespace aid::xodr
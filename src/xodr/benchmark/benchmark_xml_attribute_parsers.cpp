@@ -0,0 +1,308 @@
+#include "xml/xml_attribute_parsers.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+namespace {
+
+/**
+ * @brief The number of calls to the global operator new.
+ */
+std::atomic<size_t> numAllocations(0);
+
+/**
+ * @brief Allocates memory for all forms of the global operator new, and counts
+ * the allocation.
+ *
+ * @returns             The memory, or nullptr if the allocation failed.
+ */
+void* countedAlloc(std::size_t size, std::size_t alignment)
+{
+    numAllocations++;
+    size = std::max<std::size_t>(size, 1);
+    if (alignment <= alignof(std::max_align_t))
+    {
+        return std::malloc(size);
+    }
+
+    // The size passed to aligned_alloc must be a multiple of the alignment.
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void* countedAllocOrThrow(std::size_t size, std::size_t alignment)
+{
+    if (void* ptr = countedAlloc(size, alignment))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+/**
+ * @brief Frees memory allocated by countedAlloc(), for all forms of the global
+ * operator delete.
+ */
+void countedFree(void* ptr)
+{
+    std::free(ptr);
+}
+
+}  // namespace
+
+// All replaceable forms of the global operators are replaced, so every
+// allocation is counted, and all memory is freed by the function which
+// matches the one which allocated it. This replaces them for the whole
+// executable, which is why these benchmarks are built as
+// xodr_allocation_benchmarks rather than as part of xodr_benchmarks.
+
+void* operator new(std::size_t size)
+{
+    return countedAllocOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size)
+{
+    return countedAllocOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept
+{
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    countedFree(ptr);
+}
+
+namespace aid { namespace xodr {
+
+namespace {
+
+struct WidthAttribs
+{
+    double sOffset_;
+    double a_;
+    double b_;
+    double c_;
+    double d_;
+};
+
+/**
+ * @brief Creates a document with the given number of <width> elements, as
+ * found in the <lane> elements of an xodr file.
+ */
+std::string makeWidthDocument(int numElements)
+{
+    std::stringstream ss;
+    ss << "<lane>";
+    for (int i = 0; i < numElements; i++)
+    {
+        ss << "<width sOffset=\"" << i * 2.5
+           << "\" a=\"3.5000000000000000e+00\" b=\"0.0000000000000000e+00\" "
+              "c=\"-1.2500000000000000e-03\" d=\"2.0833333333333334e-05\"/>";
+    }
+    ss << "</lane>";
+    return ss.str();
+}
+
+const int NUM_ELEMENTS = 1000;
+
+}  // namespace
+
+/**
+ * @brief Parses the attributes of <width> elements using an
+ * XmlAttributeParsers, and reports the number of allocations made by the
+ * attribute parsing per element.
+ */
+static void BM_ParseAttributes(benchmark::State& state)
+{
+    std::string text = makeWidthDocument(NUM_ELEMENTS);
+
+    XmlAttributeParsers<XmlParseResult<WidthAttribs>> parsers;
+    parsers.addFieldParser("sOffset", &WidthAttribs::sOffset_);
+    parsers.addFieldParser("a", &WidthAttribs::a_);
+    parsers.addFieldParser("b", &WidthAttribs::b_);
+    parsers.addFieldParser("c", &WidthAttribs::c_);
+    parsers.addFieldParser("d", &WidthAttribs::d_);
+    parsers.finalize();
+
+    size_t parseAllocations = 0;
+    for (auto _ : state)
+    {
+        XmlReader xml = XmlReader::fromText(text);
+        xml.readStartElement("lane");
+        while (!xml.tryReadEndElement())
+        {
+            xml.readStartElement("width");
+
+            size_t before = numAllocations;
+            XmlParseResult<WidthAttribs> result;
+            parsers.parse(xml, result);
+            parseAllocations += numAllocations - before;
+
+            benchmark::DoNotOptimize(result.value().a_);
+            xml.readEndElement();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * NUM_ELEMENTS);
+    state.counters["allocs_per_elem"] =
+        benchmark::Counter(static_cast<double>(parseAllocations) / (state.iterations() * NUM_ELEMENTS));
+}
+BENCHMARK(BM_ParseAttributes)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Repeatedly parses the attributes of a single <width> element, which
+ * measures the attribute dispatch and number parsing without the tokenizer.
+ */
+static void BM_DispatchAttributes(benchmark::State& state)
+{
+    XmlAttributeParsers<XmlParseResult<WidthAttribs>> parsers;
+    parsers.addFieldParser("sOffset", &WidthAttribs::sOffset_);
+    parsers.addFieldParser("a", &WidthAttribs::a_);
+    parsers.addFieldParser("b", &WidthAttribs::b_);
+    parsers.addFieldParser("c", &WidthAttribs::c_);
+    parsers.addFieldParser("d", &WidthAttribs::d_);
+    parsers.finalize();
+
+    XmlReader xml = XmlReader::fromText(makeWidthDocument(1));
+    xml.readStartElement("lane");
+    xml.readStartElement("width");
+
+    for (auto _ : state)
+    {
+        XmlParseResult<WidthAttribs> result;
+        parsers.parse(xml, result);
+        benchmark::DoNotOptimize(result.value().a_);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DispatchAttributes);
+
+/**
+ * @brief Copies the attributes of <width> elements using
+ * XmlReader::getAttributes and parses them with std::stod, which is how the
+ * attributes used to be parsed. This serves as a baseline for
+ * BM_ParseAttributes.
+ */
+static void BM_CopyAttributes(benchmark::State& state)
+{
+    std::string text = makeWidthDocument(NUM_ELEMENTS);
+
+    size_t parseAllocations = 0;
+    for (auto _ : state)
+    {
+        XmlReader xml = XmlReader::fromText(text);
+        xml.readStartElement("lane");
+        while (!xml.tryReadEndElement())
+        {
+            xml.readStartElement("width");
+
+            size_t before = numAllocations;
+            double sum = 0;
+            for (const XmlReader::Attrib& attrib : xml.getAttributes())
+            {
+                sum += std::stod(attrib.value_);
+            }
+            parseAllocations += numAllocations - before;
+
+            benchmark::DoNotOptimize(sum);
+            xml.readEndElement();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * NUM_ELEMENTS);
+    state.counters["allocs_per_elem"] =
+        benchmark::Counter(static_cast<double>(parseAllocations) / (state.iterations() * NUM_ELEMENTS));
+}
+BENCHMARK(BM_CopyAttributes)->Unit(benchmark::kMicrosecond);
+
+}}  // namespace aid::xodr
@@ -0,0 +1,161 @@
+#include "xodr_map.h"
+#include "binary/xodr_map_view.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+#include "benchmark_config.h"
+
+namespace aid { namespace xodr {
+
+static const char* const MAP_NAMES[] = {"Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                        "sample1.1.xodr"};
+
+static void BM_LoadXodr(benchmark::State& state)
+{
+    std::string fileName = std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)];
+    state.SetLabel(MAP_NAMES[state.range(0)]);
+
+    for (auto _ : state)
+    {
+        XodrParseResult<XodrMap> map = XodrMap::fromFile(fileName);
+        benchmark::DoNotOptimize(map.value().totalNumLanes());
+    }
+}
+BENCHMARK(BM_LoadXodr)->DenseRange(0, 3)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Measures the time to the first query of a lazily parsed map: loading
+ * the map and accessing the lanes of a single road.
+ */
+static void BM_LoadXodrLazy(benchmark::State& state)
+{
+    std::string fileName = std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)];
+    state.SetLabel(MAP_NAMES[state.range(0)]);
+
+    XodrMap::ParseOptions options;
+    options.lazy_ = true;
+
+    for (auto _ : state)
+    {
+        XodrParseResult<XodrMap> map = XodrMap::fromFile(fileName, options);
+        const Road& road = map.value().roads()[map.value().roads().size() / 2];
+        benchmark::DoNotOptimize(road.laneSections().front().lanes().size());
+    }
+}
+BENCHMARK(BM_LoadXodrLazy)->DenseRange(0, 3)->Unit(benchmark::kMicrosecond);
+
+static void BM_DestroyXodr(benchmark::State& state)
+{
+    std::string fileName = std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)];
+    state.SetLabel(MAP_NAMES[state.range(0)]);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto map = std::make_unique<XodrMap>(std::move(XodrMap::fromFile(fileName).value()));
+        state.ResumeTiming();
+
+        map.reset();
+    }
+}
+BENCHMARK(BM_DestroyXodr)->DenseRange(0, 3)->Unit(benchmark::kMicrosecond);
+
+static void BM_IterateLanes(benchmark::State& state)
+{
+    std::string fileName = std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)];
+    state.SetLabel(MAP_NAMES[state.range(0)]);
+    XodrMap map = std::move(XodrMap::fromFile(fileName).value());
+
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (const Road& road : map.roads())
+        {
+            for (const LaneSection& laneSection : road.laneSections())
+            {
+                for (const LaneSection::Lane& lane : laneSection.lanes())
+                {
+                    for (const LaneSection::WidthPoly3& width : lane.widthPoly3s())
+                    {
+                        sum += width.poly3().eval(0);
+                    }
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_IterateLanes)->DenseRange(0, 3)->Unit(benchmark::kMicrosecond);
+
+static void BM_LoadXodrParallel(benchmark::State& state)
+{
+    std::string fileName = std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)];
+    state.SetLabel(MAP_NAMES[state.range(0)]);
+
+    XodrMap::ParseOptions options;
+    options.numThreads_ = static_cast<int>(state.range(1));
+
+    for (auto _ : state)
+    {
+        XodrParseResult<XodrMap> map = XodrMap::fromFile(fileName, options);
+        benchmark::DoNotOptimize(map.value().totalNumLanes());
+    }
+}
+
+/**
+ * @brief Adds the argument pairs (map index, number of threads) for all maps,
+ * with the number of threads doubling from 1 up to the number of hardware
+ * threads.
+ */
+static void parallelLoadArguments(benchmark::internal::Benchmark* benchmark)
+{
+    int maxThreads = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+    for (int map = 0; map <= 3; map++)
+    {
+        for (int numThreads = 1; numThreads < maxThreads; numThreads *= 2)
+        {
+            benchmark->Args({map, numThreads});
+        }
+        benchmark->Args({map, maxThreads});
+    }
+}
+BENCHMARK(BM_LoadXodrParallel)->Apply(parallelLoadArguments)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+static void BM_LoadBinary(benchmark::State& state)
+{
+    std::string binFileName = std::string(MAP_NAMES[state.range(0)]) + ".bin";
+    XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)]).value().saveBinary(binFileName);
+    state.SetLabel(MAP_NAMES[state.range(0)]);
+
+    for (auto _ : state)
+    {
+        XodrMap map = XodrMap::fromBinary(binFileName);
+        benchmark::DoNotOptimize(map.totalNumLanes());
+    }
+
+    std::remove(binFileName.c_str());
+}
+BENCHMARK(BM_LoadBinary)->DenseRange(0, 3)->Unit(benchmark::kMicrosecond);
+
+static void BM_OpenFlatView(benchmark::State& state)
+{
+    std::string flatFileName = std::string(MAP_NAMES[state.range(0)]) + ".flat";
+    XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + MAP_NAMES[state.range(0)]).value().saveFlat(flatFileName);
+    state.SetLabel(MAP_NAMES[state.range(0)]);
+
+    for (auto _ : state)
+    {
+        XodrMapView view = XodrMapView::fromFile(flatFileName);
+        benchmark::DoNotOptimize(view.totalNumLanes());
+    }
+
+    std::remove(flatFileName.c_str());
+}
+BENCHMARK(BM_OpenFlatView)->DenseRange(0, 3)->Unit(benchmark::kMicrosecond);
+
+}}  // namespace aid::xodr
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Reads a text file into a string.
+ */
+inline std::string readTextFile(const std::string& fileName)
+{
+    std::ifstream file(fileName);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open file \"" + fileName + "\".");
+    }
+
+    std::ostringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+/**
+ * @brief Creates a larger map by laying out copies of a map in a grid.
+ *
+ * Each copy is translated by a multiple of @p spacing in x and y, and the ids
+ * of its roads and junctions, and all references to them, get a prefix which
+ * is unique to the copy, so the copies are disjoint and can be parsed as a
+ * single map.
+ *
+ * @param text          The text of the map.
+ * @param numTilesX     The number of copies along the x-axis.
+ * @param numTilesY     The number of copies along the y-axis.
+ * @param spacing       The distance between the origins of adjacent copies,
+ *                      which should exceed the extent of the map.
+ * @returns             The text of the tiled map.
+ */
+inline std::string tiledMapText(const std::string& text, int numTilesX, int numTilesY, double spacing)
+{
+    size_t bodyBegin = text.find("</header>");
+    size_t bodyEnd = text.rfind("</OpenDRIVE>");
+    if (bodyBegin == std::string::npos || bodyEnd == std::string::npos)
+    {
+        throw std::runtime_error("Not an OpenDRIVE map.");
+    }
+    bodyBegin += std::string("</header>").size();
+
+    // The attributes which are changed, by element. The coordinates are
+    // translated along their axis, the ids and references get the prefix.
+    struct Rule
+    {
+        const char* element_;
+        const char* attribute_;
+        int axis_;
+    };
+    static const Rule RULES[] = {
+        {"road", "id", -1},
+        {"road", "junction", -1},
+        {"predecessor", "elementId", -1},
+        {"successor", "elementId", -1},
+        {"neighbor", "elementId", -1},
+        {"junction", "id", -1},
+        {"connection", "incomingRoad", -1},
+        {"connection", "connectingRoad", -1},
+        {"geometry", "x", 0},
+        {"geometry", "y", 1},
+    };
+
+    std::string result = text.substr(0, bodyBegin);
+    for (int tileY = 0; tileY < numTilesY; tileY++)
+    {
+        for (int tileX = 0; tileX < numTilesX; tileX++)
+        {
+            std::string prefix = "t" + std::to_string(tileX) + "_" + std::to_string(tileY) + "_";
+
+            size_t pos = bodyBegin;
+            while (pos < bodyEnd)
+            {
+                size_t tagBegin = text.find('<', pos);
+                if (tagBegin >= bodyEnd)
+                {
+                    result.append(text, pos, bodyEnd - pos);
+                    break;
+                }
+
+                size_t tagEnd = text.find('>', tagBegin);
+                result.append(text, pos, tagBegin - pos);
+
+                std::string tag = text.substr(tagBegin, tagEnd + 1 - tagBegin);
+                std::string element = tag.substr(1, tag.find_first_of(" />", 1) - 1);
+                for (const Rule& rule : RULES)
+                {
+                    if (element != rule.element_)
+                    {
+                        continue;
+                    }
+
+                    std::string attribute = std::string(" ") + rule.attribute_ + "=\"";
+                    size_t valueBegin = tag.find(attribute);
+                    if (valueBegin == std::string::npos)
+                    {
+                        continue;
+                    }
+                    valueBegin += attribute.size();
+                    size_t valueEnd = tag.find('"', valueBegin);
+                    std::string value = tag.substr(valueBegin, valueEnd - valueBegin);
+
+                    if (rule.axis_ >= 0)
+                    {
+                        double offset = (rule.axis_ == 0 ? tileX : tileY) * spacing;
+                        char buffer[32];
+                        std::snprintf(buffer, sizeof(buffer), "%.17g", std::strtod(value.c_str(), nullptr) + offset);
+                        value = buffer;
+                    }
+                    else if (value != "-1")
+                    {
+                        value = prefix + value;
+                    }
+                    tag.replace(valueBegin, valueEnd - valueBegin, value);
+                }
+
+                result += tag;
+                pos = tagEnd + 1;
+            }
+        }
+    }
+
+    result.append(text, bodyEnd, std::string::npos);
+    return result;
+}
+
+}}  // namespace aid::xodr
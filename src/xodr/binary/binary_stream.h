@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Appends binary data to a byte buffer.
+ *
+ * Values are written in the native byte order and without any padding.
+ */
+class BinaryWriter
+{
+  public:
+    /**
+     * @brief Writes a trivially copyable value.
+     *
+     * @param value         The value to write.
+     */
+    template <class T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written directly.");
+        writeBytes(&value, sizeof(T));
+    }
+
+    /**
+     * @brief Writes a string, prefixed by its length.
+     *
+     * @param str           The string to write.
+     */
+    void writeString(const std::string& str)
+    {
+        writeSize(str.size());
+        writeBytes(str.data(), str.size());
+    }
+
+    /**
+     * @brief Writes a size or count.
+     *
+     * @param size          The size to write.
+     */
+    void writeSize(size_t size) { write(static_cast<uint64_t>(size)); }
+
+    /**
+     * @brief Writes a vector of trivially copyable values in a single block,
+     * prefixed by its size.
+     *
+     * @param values        The values to write.
+     */
+    template <class T>
+    void writePodVector(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written directly.");
+        writeSize(values.size());
+        writeBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    /**
+     * @brief Writes raw bytes.
+     *
+     * @param data          A pointer to the bytes to write.
+     * @param size          The number of bytes to write.
+     */
+    void writeBytes(const void* data, size_t size)
+    {
+        const char* bytes = static_cast<const char*>(data);
+        buffer_.insert(buffer_.end(), bytes, bytes + size);
+    }
+
+    /**
+     * @returns The data written so far.
+     */
+    const std::vector<char>& buffer() const { return buffer_; }
+
+    /**
+     * @returns The data written so far, moved out of this writer.
+     */
+    std::vector<char> takeBuffer() { return std::move(buffer_); }
+
+  private:
+    std::vector<char> buffer_;
+};
+
+/**
+ * @brief Reads binary data written by a @ref BinaryWriter from a byte buffer.
+ *
+ * All reads are bounds checked, and a std::runtime_error is thrown when
+ * reading past the end of the buffer.
+ */
+class BinaryReader
+{
+  public:
+    /**
+     * @brief Creates a BinaryReader which reads from the given buffer.
+     *
+     * The buffer isn't copied, so it must outlive the reader.
+     *
+     * @param data          A pointer to the start of the buffer.
+     * @param size          The size of the buffer in bytes.
+     */
+    BinaryReader(const char* data, size_t size) : cur_(data), end_(data + size) {}
+
+    /**
+     * @brief Reads a trivially copyable value.
+     *
+     * @returns             The value.
+     */
+    template <class T>
+    T read()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read directly.");
+        T ret;
+        readBytes(&ret, sizeof(T));
+        return ret;
+    }
+
+    /**
+     * @brief Reads an enum value, and checks that it's in range, so corrupt
+     * data can't produce values which are used as out of bounds indices.
+     *
+     * @param lastValue     The last value of the enum. The values of the enum
+     *                      must be consecutive, starting at 0.
+     * @param name          The name of the enum type, for the error message.
+     * @returns             The value.
+     * @throws std::runtime_error if the value isn't in range.
+     */
+    template <class Enum>
+    Enum readEnum(Enum lastValue, const char* name)
+    {
+        static_assert(std::is_enum<Enum>::value, "readEnum() only reads enums.");
+        auto value = read<typename std::underlying_type<Enum>::type>();
+        if (value < 0 || value > static_cast<decltype(value)>(lastValue))
+        {
+            throw std::runtime_error(std::string("Corrupt binary data: invalid ") + name + ".");
+        }
+
+        return static_cast<Enum>(value);
+    }
+
+    /**
+     * @brief Reads a string written by @ref BinaryWriter::writeString.
+     *
+     * @returns             The string.
+     */
+    std::string readString()
+    {
+        size_t size = readSize();
+        checkAvailable(size);
+        std::string ret(cur_, size);
+        cur_ += size;
+        return ret;
+    }
+
+    /**
+     * @brief Reads a size written by @ref BinaryWriter::writeSize.
+     *
+     * @returns             The size.
+     */
+    size_t readSize()
+    {
+        uint64_t size = read<uint64_t>();
+
+        // No valid size can exceed the number of remaining bytes, so this
+        // catches corrupt sizes before they're used for allocations.
+        if (size > static_cast<uint64_t>(end_ - cur_))
+        {
+            throw std::runtime_error("Corrupt binary data: invalid size.");
+        }
+
+        return static_cast<size_t>(size);
+    }
+
+    /**
+     * @brief Reads a vector written by @ref BinaryWriter::writePodVector.
+     *
+     * @returns             The vector.
+     */
+    template <class T>
+    std::vector<T> readPodVector()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read directly.");
+        size_t size = readSize();
+        std::vector<T> ret(size);
+        readBytes(ret.data(), size * sizeof(T));
+        return ret;
+    }
+
+    /**
+     * @brief Reads raw bytes.
+     *
+     * @param data          The destination buffer.
+     * @param size          The number of bytes to read.
+     */
+    void readBytes(void* data, size_t size)
+    {
+        checkAvailable(size);
+        std::memcpy(data, cur_, size);
+        cur_ += size;
+    }
+
+    /**
+     * @returns True if all data has been read, false otherwise.
+     */
+    bool atEnd() const { return cur_ == end_; }
+
+  private:
+    void checkAvailable(size_t size) const
+    {
+        if (size > static_cast<size_t>(end_ - cur_))
+        {
+            throw std::runtime_error("Corrupt binary data: unexpected end of data.");
+        }
+    }
+
+    const char* cur_;
+    const char* end_;
+};
+
+}}  // namespace aid::xodr
@@ -0,0 +1,353 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "lane_id.h"
+#include "poly3.h"
+#include "units.h"
+
+namespace aid { namespace xodr { namespace flat {
+
+/**
+ * @file
+ * @brief The records which make up a flat map file.
+ *
+ * A flat map file contains an XodrMap in a layout which can be used directly
+ * from memory (typically a read-only memory mapping of the file), without any
+ * deserialization. It's pointer-free and relocatable: all references between
+ * records are byte offsets relative to the start of the file. All records are
+ * trivially copyable, and aligned to 8 bytes within the file.
+ *
+ * The file starts with a @ref Header, which contains the root @ref Map record.
+ * Use @ref XodrMapView to access the contents of a flat map file.
+ */
+
+/**
+ * @brief A reference to a string in a flat map file.
+ *
+ * The string isn't null terminated.
+ */
+struct String
+{
+    uint64_t offset_;
+    uint64_t size_;
+};
+
+/**
+ * @brief A reference to an array of records of type T in a flat map file.
+ */
+template <class T>
+struct Array
+{
+    uint64_t offset_;
+    uint64_t size_;
+};
+
+struct ObjectReference
+{
+    String id_;
+
+    /**
+     * @brief The index of the target object, or a negative value if the
+     * reference is null.
+     */
+    int32_t index_;
+    int32_t pad_;
+};
+
+struct Vertex
+{
+    double sCoord_;
+    double x_;
+    double y_;
+    double heading_;
+};
+
+/**
+ * @brief A geometry of a reference line.
+ *
+ * The meaning of params_ depends on the geometry type:
+ *  - LINE: unused.
+ *  - SPIRAL: start curvature, end curvature.
+ *  - ARC: curvature.
+ *  - POLY3: a, b, c, d.
+ *  - PARAM_POLY3: aU, bU, cU, dU, aV, bV, cV, dV.
+ *
+ * precomputed_ holds data which the geometry classes compute when they're
+ * constructed or first evaluated, so views don't have to recompute it for
+ * every evaluation:
+ *  - SPIRAL: the coefficients of the pieces of the clothoid, see
+ *    Clothoid::coeffs().
+ *  - POLY3, PARAM_POLY3: the nodes of the arc length table, see
+ *    ArcLengthTable::nodes().
+ *  - Other types: unused.
+ */
+struct Geometry
+{
+    int32_t type_;
+    int32_t pRange_;
+    Vertex startVertex_;
+    double length_;
+    double params_[8];
+    Array<double> precomputed_;
+};
+
+/**
+ * @brief A polynomial which starts at a given s-coordinate or offset.
+ *
+ * This is used to store both lane width polynomials and elevations.
+ */
+struct SPoly3
+{
+    double s_;
+    Poly3 poly3_;
+
+    double sOffset() const { return s_; }
+    double sCoord() const { return s_; }
+    const Poly3& poly3() const { return poly3_; }
+};
+
+struct LaneMaterial
+{
+    double sOffset_;
+    String surface_;
+    double friction_;
+    double roughness_;
+};
+
+struct LaneVisibility
+{
+    double sOffset_;
+    double forward_;
+    double back_;
+    double left_;
+    double right_;
+
+    double sOffset() const { return sOffset_; }
+    double forward() const { return forward_; }
+    double back() const { return back_; }
+    double left() const { return left_; }
+    double right() const { return right_; }
+};
+
+struct LaneSpeedLimit
+{
+    double sOffset_;
+    double maxSpeed_;
+    int32_t unit_;
+    int32_t pad_;
+
+    double sOffset() const { return sOffset_; }
+    double maxSpeed() const { return maxSpeed_; }
+    SpeedUnit unit() const { return static_cast<SpeedUnit>(unit_); }
+};
+
+/**
+ * @brief A lane attribute which consists of an s-offset and a string.
+ *
+ * This is used to store both lane accesses and lane rules.
+ */
+struct LaneStringAttrib
+{
+    double sOffset_;
+    String value_;
+};
+
+struct LaneHeight
+{
+    double sOffset_;
+    double inner_;
+    double outer_;
+
+    double sOffset() const { return sOffset_; }
+    double inner() const { return inner_; }
+    double outer() const { return outer_; }
+};
+
+struct Lane
+{
+    int32_t id_;
+    int32_t type_;
+    int32_t level_;
+    int32_t globalIndex_;
+    int32_t hasPredecessor_;
+    int32_t predecessor_;
+    int32_t hasSuccessor_;
+    int32_t successor_;
+
+    Array<SPoly3> widthPoly3s_;
+    Array<LaneMaterial> materials_;
+    Array<LaneVisibility> visibilities_;
+    Array<LaneSpeedLimit> speedLimits_;
+    Array<LaneStringAttrib> accesses_;
+    Array<LaneHeight> heights_;
+    Array<LaneStringAttrib> rules_;
+};
+
+struct LaneSection
+{
+    double startS_;
+    double endS_;
+    int32_t singleSided_;
+    int32_t numLeftLanes_;
+    Array<Lane> lanes_;
+};
+
+struct OutlineCorner
+{
+    /**
+     * @brief The index of the corner type in RoadObjectOutline::Corner (0 for
+     * CornerRoad, 1 for CornerLocal).
+     */
+    int32_t type_;
+    int32_t pad_;
+
+    /**
+     * @brief s, t, dz and height for CornerRoad, u, v, z and height for
+     * CornerLocal.
+     */
+    double values_[4];
+};
+
+struct RoadObject
+{
+    int32_t type_;
+    int32_t orientation_;
+    String name_;
+    String id_;
+    double s_;
+    double t_;
+    double zOffset_;
+    double validLength_;
+    double length_;
+    double width_;
+    double radius_;
+    double height_;
+    double heading_;
+    double pitch_;
+    double roll_;
+    int32_t hasOutline_;
+    int32_t pad_;
+    Array<OutlineCorner> outline_;
+};
+
+struct RoadLink
+{
+    int32_t elementType_;
+    int32_t contactPoint_;
+    ObjectReference elementRef_;
+};
+
+struct Road
+{
+    String name_;
+    String id_;
+    ObjectReference junctionRef_;
+    double length_;
+
+    Array<Geometry> geometries_;
+    Vertex endVertex_;
+
+    int32_t hasElevationProfile_;
+    int32_t pad_;
+    Array<SPoly3> elevations_;
+
+    Array<LaneSection> laneSections_;
+    Array<RoadObject> roadObjects_;
+
+    RoadLink predecessor_;
+    RoadLink successor_;
+};
+
+struct LaneLink
+{
+    int32_t from_;
+    int32_t to_;
+
+    LaneID from() const { return LaneID(from_); }
+    LaneID to() const { return LaneID(to_); }
+};
+
+struct Connection
+{
+    String id_;
+    ObjectReference incomingRoad_;
+    ObjectReference connectingRoad_;
+    int32_t contactPoint_;
+    int32_t pad_;
+    Array<LaneLink> laneLinks_;
+};
+
+struct Junction
+{
+    String name_;
+    String id_;
+    Array<Connection> connections_;
+};
+
+/**
+ * @brief An entry of an id to index table.
+ *
+ * The tables are sorted by id, so they can be searched using a binary search.
+ */
+struct IdIndex
+{
+    String id_;
+    int32_t index_;
+    int32_t pad_;
+};
+
+struct Map
+{
+    int32_t hasGeoReference_;
+    int32_t totalNumLanes_;
+    String geoReference_;
+    Array<Road> roads_;
+    Array<Junction> junctions_;
+    Array<IdIndex> roadIds_;
+    Array<IdIndex> junctionIds_;
+};
+
+struct Header
+{
+    char magic_[8];
+    uint32_t formatVersion_;
+    uint32_t byteOrderMark_;
+
+    /**
+     * @brief The size of the whole file, including this header.
+     */
+    uint64_t fileSize_;
+
+    /**
+     * @brief The checksum of all data following this header.
+     */
+    uint64_t checksum_;
+
+    Map map_;
+};
+
+/**
+ * @brief The current version of the flat map format.
+ *
+ * This should be incremented whenever the layout of any record changes.
+ */
+static constexpr uint32_t FORMAT_VERSION = 2;
+
+/**
+ * @brief The magic number at the start of every flat map file.
+ */
+static constexpr char MAGIC[8] = {'X', 'O', 'D', 'R', 'F', 'L', 'A', 'T'};
+
+/**
+ * @brief The value of Header::byteOrderMark_, used to detect files written with
+ * a different byte order.
+ */
+static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+static_assert(std::is_trivially_copyable<Poly3>::value && std::is_standard_layout<Poly3>::value,
+              "Poly3 is stored directly in flat map files.");
+static_assert(sizeof(Header) % 8 == 0, "Flat map records should be 8 byte aligned.");
+
+}}}  // namespace aid::xodr::flat
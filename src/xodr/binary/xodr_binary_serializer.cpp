@@ -0,0 +1,736 @@
+#include "binary/xodr_binary_serializer.h"
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace aid { namespace xodr {
+
+namespace {
+
+const char MAGIC[8] = {'X', 'O', 'D', 'R', 'B', 'I', 'N', '\0'};
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+}  // namespace
+
+constexpr uint32_t XodrBinarySerializer::FORMAT_VERSION;
+
+std::vector<char> XodrBinarySerializer::serialize(const XodrMap& map)
+{
+    BinaryWriter out;
+
+    // Reserve space for the header, which is filled in once the payload size
+    // and checksum are known.
+    Header header = {};
+    out.write(header);
+    write(out, map);
+
+    std::vector<char> ret = out.takeBuffer();
+
+    std::memcpy(header.magic_, MAGIC, sizeof(MAGIC));
+    header.formatVersion_ = FORMAT_VERSION;
+    header.byteOrderMark_ = BYTE_ORDER_MARK;
+    header.payloadSize_ = ret.size() - sizeof(Header);
+    header.payloadChecksum_ = checksum(ret.data() + sizeof(Header), header.payloadSize_);
+    std::memcpy(ret.data(), &header, sizeof(Header));
+
+    return ret;
+}
+
+void XodrBinarySerializer::validateHeader(const Header& header)
+{
+    if (std::memcmp(header.magic_, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        throw std::runtime_error("Not a binary xodr map.");
+    }
+
+    if (header.byteOrderMark_ != BYTE_ORDER_MARK)
+    {
+        throw std::runtime_error("The binary xodr map was written on a machine with a different byte order.");
+    }
+
+    if (header.formatVersion_ != FORMAT_VERSION)
+    {
+        std::stringstream err;
+        err << "Unsupported binary xodr map version " << header.formatVersion_ << " (expected version "
+            << FORMAT_VERSION << ").";
+        throw std::runtime_error(err.str());
+    }
+}
+
+XodrMap XodrBinarySerializer::deserialize(const Header& header, const char* payload)
+{
+    if (checksum(payload, header.payloadSize_) != header.payloadChecksum_)
+    {
+        throw std::runtime_error("Checksum mismatch in binary xodr map.");
+    }
+
+    BinaryReader in(payload, header.payloadSize_);
+
+    std::unique_ptr<XodrArena> arena = std::make_unique<XodrArena>();
+    XodrArena::Scope arenaScope(arena.get());
+
+    XodrMap ret;
+    ret.arenas_.push_back(std::move(arena));
+    read(in, ret);
+
+    if (!in.atEnd())
+    {
+        throw std::runtime_error("Corrupt binary data: trailing data after the map.");
+    }
+
+    return ret;
+}
+
+uint64_t XodrBinarySerializer::checksum(const char* data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+template <class T, class Alloc>
+void XodrBinarySerializer::writeVector(BinaryWriter& out, const std::vector<T, Alloc>& values)
+{
+    out.writeSize(values.size());
+    for (const T& value : values)
+    {
+        write(out, value);
+    }
+}
+
+template <class T, class Alloc>
+void XodrBinarySerializer::readVector(BinaryReader& in, std::vector<T, Alloc>& values)
+{
+    values.resize(in.readSize());
+    for (T& value : values)
+    {
+        read(in, value);
+    }
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const XodrMap& map)
+{
+    out.write(static_cast<bool>(map.geoReference_));
+    if (map.geoReference_)
+    {
+        out.writeString(*map.geoReference_);
+    }
+
+    writeVector(out, map.roads_);
+    writeVector(out, map.junctions_);
+
+    for (const std::map<std::string, int>* idToIndex :
+         {&map.idToIndexMaps_.roadIdToIndex_, &map.idToIndexMaps_.junctionIdToIndex_})
+    {
+        out.writeSize(idToIndex->size());
+        for (const auto& entry : *idToIndex)
+        {
+            out.writeString(entry.first);
+            out.write<int32_t>(entry.second);
+        }
+    }
+
+    out.write<int32_t>(map.totalNumLanes_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, XodrMap& map)
+{
+    if (in.read<bool>())
+    {
+        map.geoReference_ = in.readString();
+    }
+
+    readVector(in, map.roads_);
+    readVector(in, map.junctions_);
+
+    for (std::map<std::string, int>* idToIndex :
+         {&map.idToIndexMaps_.roadIdToIndex_, &map.idToIndexMaps_.junctionIdToIndex_})
+    {
+        size_t size = in.readSize();
+        for (size_t i = 0; i < size; i++)
+        {
+            std::string id = in.readString();
+            idToIndex->emplace_hint(idToIndex->end(), std::move(id), in.read<int32_t>());
+        }
+    }
+
+    map.totalNumLanes_ = in.read<int32_t>();
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const XodrObjectReference& ref)
+{
+    out.writeString(ref.id_);
+    out.write<int32_t>(ref.index_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, XodrObjectReference& ref)
+{
+    ref.id_ = in.readString();
+    ref.index_ = in.read<int32_t>();
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const Poly3& poly)
+{
+    out.write(poly.a_);
+    out.write(poly.b_);
+    out.write(poly.c_);
+    out.write(poly.d_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, Poly3& poly)
+{
+    poly.a_ = in.read<double>();
+    poly.b_ = in.read<double>();
+    poly.c_ = in.read<double>();
+    poly.d_ = in.read<double>();
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const LaneIDOpt& laneId)
+{
+    out.write(static_cast<bool>(laneId));
+    out.write<int32_t>(laneId ? static_cast<int>(*laneId) : 0);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, LaneIDOpt& laneId)
+{
+    bool hasValue = in.read<bool>();
+    int id = in.read<int32_t>();
+    laneId = hasValue ? LaneIDOpt(LaneID(id)) : LaneIDOpt::null();
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const Road& road)
+{
+    road.parseBody();
+
+    out.writeString(road.name_);
+    out.writeString(road.id_);
+    write(out, road.junctionRef_);
+    out.write(road.length_);
+    write(out, road.referenceLine_);
+
+    out.write(static_cast<bool>(road.elevationProfile_));
+    if (road.elevationProfile_)
+    {
+        write(out, *road.elevationProfile_);
+    }
+
+    writeVector(out, road.laneSections_);
+    writeVector(out, road.roadObjects_);
+    write(out, road.links_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, Road& road)
+{
+    road.name_ = in.readString();
+    road.id_ = in.readString();
+    read(in, road.junctionRef_);
+    road.length_ = in.read<double>();
+    read(in, road.referenceLine_);
+
+    if (in.read<bool>())
+    {
+        road.elevationProfile_.emplace();
+        read(in, *road.elevationProfile_);
+    }
+
+    readVector(in, road.laneSections_);
+    readVector(in, road.roadObjects_);
+    read(in, road.links_);
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const ReferenceLine::Vertex& vertex)
+{
+    out.write(vertex.sCoord_);
+    out.write(vertex.position_.x());
+    out.write(vertex.position_.y());
+    out.write(vertex.heading_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, ReferenceLine::Vertex& vertex)
+{
+    vertex.sCoord_ = in.read<double>();
+    vertex.position_.x() = in.read<double>();
+    vertex.position_.y() = in.read<double>();
+    vertex.heading_ = in.read<double>();
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const ReferenceLine& referenceLine)
+{
+    out.writeSize(referenceLine.geometries_.size());
+    for (const auto& geometryUnion : referenceLine.geometries_)
+    {
+        const ReferenceLine::Geometry& geometry = geometryUnion.geometry();
+        ReferenceLine::GeometryType type = geometryUnion.type();
+        out.write(type);
+        write(out, geometry.startVertex());
+        out.write(geometry.length());
+
+        switch (type)
+        {
+            case ReferenceLine::GeometryType::LINE:
+                break;
+            case ReferenceLine::GeometryType::SPIRAL:
+            {
+                const auto& spiral = static_cast<const ReferenceLine::Spiral&>(geometry);
+                out.write(spiral.startCurvature());
+                out.write(spiral.endCurvature());
+                break;
+            }
+            case ReferenceLine::GeometryType::ARC:
+                out.write(static_cast<const ReferenceLine::Arc&>(geometry).curvature());
+                break;
+            case ReferenceLine::GeometryType::POLY3:
+                write(out, static_cast<const ReferenceLine::Poly3Geom&>(geometry).poly());
+                break;
+            case ReferenceLine::GeometryType::PARAM_POLY3:
+            {
+                const auto& paramPoly3 = static_cast<const ReferenceLine::ParamPoly3&>(geometry);
+                write(out, paramPoly3.uPoly());
+                write(out, paramPoly3.vPoly());
+                out.write(paramPoly3.pRange());
+                break;
+            }
+        }
+    }
+
+    write(out, referenceLine.endVertex_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, ReferenceLine& referenceLine)
+{
+    size_t numGeometries = in.readSize();
+    referenceLine.geometries_.clear();
+    referenceLine.geometries_.reserve(numGeometries);
+    referenceLine.geometryStartS_.clear();
+    referenceLine.geometryStartS_.reserve(numGeometries);
+    for (size_t i = 0; i < numGeometries; i++)
+    {
+        auto type = in.readEnum(ReferenceLine::GeometryType::PARAM_POLY3, "geometry type");
+        ReferenceLine::Vertex startVertex;
+        read(in, startVertex);
+        double length = in.read<double>();
+
+        switch (type)
+        {
+            case ReferenceLine::GeometryType::LINE:
+                referenceLine.appendGeometry(ReferenceLine::Line(startVertex, length));
+                break;
+            case ReferenceLine::GeometryType::SPIRAL:
+            {
+                double startCurvature = in.read<double>();
+                double endCurvature = in.read<double>();
+                referenceLine.appendGeometry(ReferenceLine::Spiral(startVertex, length, startCurvature, endCurvature));
+                break;
+            }
+            case ReferenceLine::GeometryType::ARC:
+                referenceLine.appendGeometry(ReferenceLine::Arc(startVertex, length, in.read<double>()));
+                break;
+            case ReferenceLine::GeometryType::POLY3:
+            {
+                Poly3 poly;
+                read(in, poly);
+                referenceLine.appendGeometry(ReferenceLine::Poly3Geom(startVertex, length, poly));
+                break;
+            }
+            case ReferenceLine::GeometryType::PARAM_POLY3:
+            {
+                Poly3 uPoly, vPoly;
+                read(in, uPoly);
+                read(in, vPoly);
+                auto pRange = in.readEnum(ReferenceLine::PRange::NORMALIZED, "parameter range");
+                referenceLine.appendGeometry(ReferenceLine::ParamPoly3(startVertex, length, uPoly, vPoly, pRange));
+                break;
+            }
+            default:
+                throw std::runtime_error("Corrupt binary data: invalid geometry type.");
+        }
+    }
+
+    read(in, referenceLine.endVertex_);
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const ElevationProfile& elevationProfile)
+{
+    out.writeSize(elevationProfile.elevations_.size());
+    for (const ElevationProfile::Elevation& elevation : elevationProfile.elevations_)
+    {
+        out.write(elevation.sCoord());
+        write(out, elevation.poly3());
+    }
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, ElevationProfile& elevationProfile)
+{
+    elevationProfile.elevations_.resize(in.readSize());
+    for (ElevationProfile::Elevation& elevation : elevationProfile.elevations_)
+    {
+        double sCoord = in.read<double>();
+        Poly3 poly3;
+        read(in, poly3);
+        elevation = ElevationProfile::Elevation(sCoord, poly3);
+    }
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const LaneSection& laneSection)
+{
+    out.write(laneSection.startS_);
+    out.write(laneSection.endS_);
+    out.write(laneSection.singleSided_);
+    out.write<int32_t>(laneSection.numLeftLanes_);
+    writeVector(out, laneSection.lanes_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, LaneSection& laneSection)
+{
+    laneSection.startS_ = in.read<double>();
+    laneSection.endS_ = in.read<double>();
+    laneSection.singleSided_ = in.read<bool>();
+    laneSection.numLeftLanes_ = in.read<int32_t>();
+    readVector(in, laneSection.lanes_);
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const LaneSection::Lane& lane)
+{
+    out.write<int32_t>(static_cast<int>(lane.id_));
+    out.write(lane.type_);
+    out.write(lane.level_);
+
+    out.writeSize(lane.widthPoly3s_.size());
+    for (const LaneSection::WidthPoly3& widthPoly3 : lane.widthPoly3s_)
+    {
+        out.write(widthPoly3.sOffset());
+        write(out, widthPoly3.poly3());
+    }
+
+    writeVector(out, lane.materials_);
+    writeVector(out, lane.visibilities_);
+    writeVector(out, lane.speedLimits_);
+    writeVector(out, lane.accesses_);
+    writeVector(out, lane.heights_);
+    writeVector(out, lane.rules_);
+
+    write(out, lane.predecessor_);
+    write(out, lane.successor_);
+
+    out.write<int32_t>(lane.globalIndex_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, LaneSection::Lane& lane)
+{
+    lane.id_ = LaneID(in.read<int32_t>());
+    lane.type_ = in.readEnum(LaneType::HOV, "lane type");
+    lane.level_ = in.read<bool>();
+
+    lane.widthPoly3s_.resize(in.readSize());
+    for (LaneSection::WidthPoly3& widthPoly3 : lane.widthPoly3s_)
+    {
+        double sOffset = in.read<double>();
+        Poly3 poly3;
+        read(in, poly3);
+        widthPoly3 = LaneSection::WidthPoly3(sOffset, poly3);
+    }
+
+    readVector(in, lane.materials_);
+    readVector(in, lane.visibilities_);
+    readVector(in, lane.speedLimits_);
+    readVector(in, lane.accesses_);
+    readVector(in, lane.heights_);
+    readVector(in, lane.rules_);
+
+    read(in, lane.predecessor_);
+    read(in, lane.successor_);
+
+    lane.globalIndex_ = in.read<int32_t>();
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const LaneMaterial& material)
+{
+    out.write(material.sOffset_);
+    out.writeString(material.surface_);
+    out.write(material.friction_);
+    out.write(material.roughness_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, LaneMaterial& material)
+{
+    material.sOffset_ = in.read<double>();
+    material.surface_ = in.readString();
+    material.friction_ = in.read<double>();
+    material.roughness_ = in.read<double>();
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const LaneVisibility& visibility)
+{
+    out.write(visibility.sOffset_);
+    out.write(visibility.forward_);
+    out.write(visibility.back_);
+    out.write(visibility.left_);
+    out.write(visibility.right_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, LaneVisibility& visibility)
+{
+    visibility.sOffset_ = in.read<double>();
+    visibility.forward_ = in.read<double>();
+    visibility.back_ = in.read<double>();
+    visibility.left_ = in.read<double>();
+    visibility.right_ = in.read<double>();
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const LaneSpeedLimit& speedLimit)
+{
+    out.write(speedLimit.sOffset_);
+    out.write(speedLimit.maxSpeed_);
+    out.write(speedLimit.unit_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, LaneSpeedLimit& speedLimit)
+{
+    speedLimit.sOffset_ = in.read<double>();
+    speedLimit.maxSpeed_ = in.read<double>();
+    speedLimit.unit_ = in.readEnum(SpeedUnit::KILOMETERS_PER_HOUR, "speed unit");
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const LaneAccess& access)
+{
+    out.write(access.sOffset_);
+    out.writeString(access.restriction_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, LaneAccess& access)
+{
+    access.sOffset_ = in.read<double>();
+    access.restriction_ = in.readString();
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const LaneHeight& height)
+{
+    out.write(height.sOffset_);
+    out.write(height.inner_);
+    out.write(height.outer_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, LaneHeight& height)
+{
+    height.sOffset_ = in.read<double>();
+    height.inner_ = in.read<double>();
+    height.outer_ = in.read<double>();
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const LaneRule& rule)
+{
+    out.write(rule.sOffset_);
+    out.writeString(rule.value_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, LaneRule& rule)
+{
+    rule.sOffset_ = in.read<double>();
+    rule.value_ = in.readString();
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const RoadObject& roadObject)
+{
+    out.write(roadObject.type_);
+    out.writeString(roadObject.name_);
+    out.writeString(roadObject.id_);
+    out.write(roadObject.s_);
+    out.write(roadObject.t_);
+    out.write(roadObject.zOffset_);
+    out.write(roadObject.validLength_);
+    out.write(roadObject.orientation_);
+    out.write(roadObject.length_);
+    out.write(roadObject.width_);
+    out.write(roadObject.radius_);
+    out.write(roadObject.height_);
+
+    out.write(roadObject.outline_ != nullptr);
+    if (roadObject.outline_)
+    {
+        write(out, *roadObject.outline_);
+    }
+
+    out.write(roadObject.heading_);
+    out.write(roadObject.pitch_);
+    out.write(roadObject.roll_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, RoadObject& roadObject)
+{
+    roadObject.type_ = in.readEnum(RoadObject::Type::PATCH, "road object type");
+    roadObject.name_ = in.readString();
+    roadObject.id_ = in.readString();
+    roadObject.s_ = in.read<double>();
+    roadObject.t_ = in.read<double>();
+    roadObject.zOffset_ = in.read<double>();
+    roadObject.validLength_ = in.read<double>();
+    roadObject.orientation_ = in.readEnum(RoadObject::Orientation::NONE, "road object orientation");
+    roadObject.length_ = in.read<double>();
+    roadObject.width_ = in.read<double>();
+    roadObject.radius_ = in.read<double>();
+    roadObject.height_ = in.read<double>();
+
+    if (in.read<bool>())
+    {
+        roadObject.outline_ = makeArenaPtr<RoadObjectOutline>();
+        read(in, *roadObject.outline_);
+    }
+
+    roadObject.heading_ = in.read<double>();
+    roadObject.pitch_ = in.read<double>();
+    roadObject.roll_ = in.read<double>();
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const RoadObjectOutline& outline)
+{
+    out.writeSize(outline.corners_.size());
+    for (const RoadObjectOutline::Corner& corner : outline.corners_)
+    {
+        out.write<int32_t>(corner.which());
+        if (const auto* cornerRoad = boost::get<RoadObjectOutline::CornerRoad>(&corner))
+        {
+            out.write(cornerRoad->s_);
+            out.write(cornerRoad->t_);
+            out.write(cornerRoad->dz_);
+            out.write(cornerRoad->height_);
+        }
+        else
+        {
+            const auto& cornerLocal = boost::get<RoadObjectOutline::CornerLocal>(corner);
+            out.write(cornerLocal.u_);
+            out.write(cornerLocal.v_);
+            out.write(cornerLocal.z_);
+            out.write(cornerLocal.height_);
+        }
+    }
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, RoadObjectOutline& outline)
+{
+    size_t numCorners = in.readSize();
+    outline.corners_.reserve(numCorners);
+    for (size_t i = 0; i < numCorners; i++)
+    {
+        int which = in.read<int32_t>();
+        if (which == 0)
+        {
+            RoadObjectOutline::CornerRoad cornerRoad;
+            cornerRoad.s_ = in.read<double>();
+            cornerRoad.t_ = in.read<double>();
+            cornerRoad.dz_ = in.read<double>();
+            cornerRoad.height_ = in.read<double>();
+            outline.corners_.emplace_back(cornerRoad);
+        }
+        else if (which == 1)
+        {
+            RoadObjectOutline::CornerLocal cornerLocal;
+            cornerLocal.u_ = in.read<double>();
+            cornerLocal.v_ = in.read<double>();
+            cornerLocal.z_ = in.read<double>();
+            cornerLocal.height_ = in.read<double>();
+            outline.corners_.emplace_back(cornerLocal);
+        }
+        else
+        {
+            throw std::runtime_error("Corrupt binary data: invalid outline corner type.");
+        }
+    }
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const RoadLink& link)
+{
+    out.write(link.elementType_);
+    out.write(link.contactPoint_);
+    write(out, link.elementRef_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, RoadLink& link)
+{
+    link.elementType_ = in.readEnum(RoadLink::ElementType::JUNCTION, "road link element type");
+    link.contactPoint_ = in.readEnum(ContactPoint::END, "contact point");
+    read(in, link.elementRef_);
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const NeighborLink& link)
+{
+    out.write(link.isSpecified_);
+    out.write(link.side_);
+    out.write(link.direction_);
+    write(out, link.elementRef_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, NeighborLink& link)
+{
+    link.isSpecified_ = in.read<bool>();
+    link.side_ = in.readEnum(NeighborLink::Side::RIGHT, "neighbor side");
+    link.direction_ = in.readEnum(NeighborLink::Direction::OPPOSITE, "neighbor direction");
+    read(in, link.elementRef_);
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const RoadLinks& links)
+{
+    write(out, links.predecessor_);
+    write(out, links.successor_);
+    write(out, links.leftNeighbor_);
+    write(out, links.rightNeighbor_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, RoadLinks& links)
+{
+    read(in, links.predecessor_);
+    read(in, links.successor_);
+    read(in, links.leftNeighbor_);
+    read(in, links.rightNeighbor_);
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const Junction& junction)
+{
+    out.writeString(junction.name_);
+    out.writeString(junction.id_);
+    writeVector(out, junction.connections_);
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, Junction& junction)
+{
+    junction.name_ = in.readString();
+    junction.id_ = in.readString();
+    readVector(in, junction.connections_);
+}
+
+void XodrBinarySerializer::write(BinaryWriter& out, const Junction::Connection& connection)
+{
+    out.writeString(connection.id_);
+    write(out, connection.incomingRoad_);
+    write(out, connection.connectingRoad_);
+    out.write(connection.contactPoint_);
+
+    out.writeSize(connection.laneLinks_.size());
+    for (const Junction::LaneLink& laneLink : connection.laneLinks_)
+    {
+        out.write<int32_t>(static_cast<int>(laneLink.from()));
+        out.write<int32_t>(static_cast<int>(laneLink.to()));
+    }
+}
+
+void XodrBinarySerializer::read(BinaryReader& in, Junction::Connection& connection)
+{
+    connection.id_ = in.readString();
+    read(in, connection.incomingRoad_);
+    read(in, connection.connectingRoad_);
+    connection.contactPoint_ = in.readEnum(ContactPoint::END, "contact point");
+
+    connection.laneLinks_.resize(in.readSize());
+    for (Junction::LaneLink& laneLink : connection.laneLinks_)
+    {
+        LaneID from(in.read<int32_t>());
+        LaneID to(in.read<int32_t>());
+        laneLink = Junction::LaneLink(from, to);
+    }
+}
+
+}}  // namespace aid::xodr
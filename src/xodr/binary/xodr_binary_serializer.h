@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "binary/binary_stream.h"
+#include "xodr_map.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Converts a fully parsed and resolved XodrMap to and from a compact
+ * binary representation.
+ *
+ * The binary data starts with a fixed-size header which holds a magic number,
+ * the format version, the byte order, the size of the payload and a checksum of
+ * the payload. The payload contains the map data in the order in which it's
+ * stored in the XodrMap, so loading it only requires a single pass over the
+ * data, without any parsing of numbers or resolving of references.
+ *
+ * The format uses the native byte order and floating point representation, so
+ * it's meant as a cache of parsed xodr files rather than as an interchange
+ * format. Binary data written by a machine with a different byte order is
+ * rejected.
+ *
+ * This class is a friend of all classes which make up an XodrMap. It's used to
+ * implement @ref XodrMap::saveBinary and @ref XodrMap::fromBinary.
+ *
+ * It also implements the flat map format (see @ref flat_map_format.h) which is
+ * written by @ref XodrMap::saveFlat and accessed through @ref XodrMapView.
+ */
+class XodrBinarySerializer
+{
+  public:
+    /**
+     * @brief The current version of the binary format.
+     *
+     * This should be incremented whenever the layout of the payload changes.
+     */
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * @brief The header which precedes the payload.
+     */
+    struct Header
+    {
+        char magic_[8];
+        uint32_t formatVersion_;
+        uint32_t byteOrderMark_;
+        uint64_t payloadSize_;
+        uint64_t payloadChecksum_;
+    };
+
+    /**
+     * @brief Serializes the given map.
+     *
+     * @param map           The map to serialize.
+     * @returns             The binary data, including the header.
+     */
+    static std::vector<char> serialize(const XodrMap& map);
+
+    /**
+     * @brief Validates the given header.
+     *
+     * An exception is thrown if the header doesn't belong to binary map data
+     * with the current format version and byte order.
+     *
+     * @param header        The header to validate.
+     */
+    static void validateHeader(const Header& header);
+
+    /**
+     * @brief Deserializes a map from the given payload.
+     *
+     * The header belonging to the payload should already have been validated
+     * using @ref validateHeader. This function verifies the checksum, and
+     * throws an exception if it doesn't match or if the payload is corrupt.
+     *
+     * @param header        The header belonging to the payload.
+     * @param payload       A pointer to the payload.
+     * @returns             The deserialized map.
+     */
+    static XodrMap deserialize(const Header& header, const char* payload);
+
+    /**
+     * @brief Computes the checksum of the given data.
+     *
+     * This is the 64 bit FNV-1a hash of the data.
+     *
+     * @param data          A pointer to the data.
+     * @param size          The size of the data in bytes.
+     * @returns             The checksum.
+     */
+    static uint64_t checksum(const char* data, size_t size);
+
+    /**
+     * @brief Converts the given map to the flat map format.
+     *
+     * @param map           The map to convert.
+     * @returns             The contents of the flat map file.
+     */
+    static std::vector<char> serializeFlat(const XodrMap& map);
+
+  private:
+    class FlatWriter;
+
+    static void write(BinaryWriter& out, const XodrMap& map);
+    static void write(BinaryWriter& out, const XodrObjectReference& ref);
+    static void write(BinaryWriter& out, const Poly3& poly);
+    static void write(BinaryWriter& out, const LaneIDOpt& laneId);
+    static void write(BinaryWriter& out, const Road& road);
+    static void write(BinaryWriter& out, const ReferenceLine::Vertex& vertex);
+    static void write(BinaryWriter& out, const ReferenceLine& referenceLine);
+    static void write(BinaryWriter& out, const ElevationProfile& elevationProfile);
+    static void write(BinaryWriter& out, const LaneSection& laneSection);
+    static void write(BinaryWriter& out, const LaneSection::Lane& lane);
+    static void write(BinaryWriter& out, const LaneMaterial& material);
+    static void write(BinaryWriter& out, const LaneVisibility& visibility);
+    static void write(BinaryWriter& out, const LaneSpeedLimit& speedLimit);
+    static void write(BinaryWriter& out, const LaneAccess& access);
+    static void write(BinaryWriter& out, const LaneHeight& height);
+    static void write(BinaryWriter& out, const LaneRule& rule);
+    static void write(BinaryWriter& out, const RoadObject& roadObject);
+    static void write(BinaryWriter& out, const RoadObjectOutline& outline);
+    static void write(BinaryWriter& out, const RoadLink& link);
+    static void write(BinaryWriter& out, const NeighborLink& link);
+    static void write(BinaryWriter& out, const RoadLinks& links);
+    static void write(BinaryWriter& out, const Junction& junction);
+    static void write(BinaryWriter& out, const Junction::Connection& connection);
+
+    template <class T, class Alloc>
+    static void writeVector(BinaryWriter& out, const std::vector<T, Alloc>& values);
+
+    static void read(BinaryReader& in, XodrMap& map);
+    static void read(BinaryReader& in, XodrObjectReference& ref);
+    static void read(BinaryReader& in, Poly3& poly);
+    static void read(BinaryReader& in, LaneIDOpt& laneId);
+    static void read(BinaryReader& in, Road& road);
+    static void read(BinaryReader& in, ReferenceLine::Vertex& vertex);
+    static void read(BinaryReader& in, ReferenceLine& referenceLine);
+    static void read(BinaryReader& in, ElevationProfile& elevationProfile);
+    static void read(BinaryReader& in, LaneSection& laneSection);
+    static void read(BinaryReader& in, LaneSection::Lane& lane);
+    static void read(BinaryReader& in, LaneMaterial& material);
+    static void read(BinaryReader& in, LaneVisibility& visibility);
+    static void read(BinaryReader& in, LaneSpeedLimit& speedLimit);
+    static void read(BinaryReader& in, LaneAccess& access);
+    static void read(BinaryReader& in, LaneHeight& height);
+    static void read(BinaryReader& in, LaneRule& rule);
+    static void read(BinaryReader& in, RoadObject& roadObject);
+    static void read(BinaryReader& in, RoadObjectOutline& outline);
+    static void read(BinaryReader& in, RoadLink& link);
+    static void read(BinaryReader& in, NeighborLink& link);
+    static void read(BinaryReader& in, RoadLinks& links);
+    static void read(BinaryReader& in, Junction& junction);
+    static void read(BinaryReader& in, Junction::Connection& connection);
+
+    template <class T, class Alloc>
+    static void readVector(BinaryReader& in, std::vector<T, Alloc>& values);
+};
+
+}}  // namespace aid::xodr
@@ -0,0 +1,360 @@
+#include "binary/xodr_binary_serializer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "binary/flat_map_format.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Builds the contents of a flat map file.
+ *
+ * Records are appended to a single buffer. Arrays are reserved before their
+ * elements are converted, and each element is copied into its slot once all
+ * the records it refers to have been appended, so no record ever needs to be
+ * patched afterwards.
+ */
+class XodrBinarySerializer::FlatWriter
+{
+  public:
+    std::vector<char> write(const XodrMap& map)
+    {
+        allocate(sizeof(flat::Header));
+
+        flat::Header header = {};
+        std::memcpy(header.magic_, flat::MAGIC, sizeof(flat::MAGIC));
+        header.formatVersion_ = flat::FORMAT_VERSION;
+        header.byteOrderMark_ = flat::BYTE_ORDER_MARK;
+        header.map_ = convert(map);
+        header.fileSize_ = buffer_.size();
+        header.checksum_ = checksum(buffer_.data() + sizeof(flat::Header), buffer_.size() - sizeof(flat::Header));
+        std::memcpy(buffer_.data(), &header, sizeof(header));
+
+        return std::move(buffer_);
+    }
+
+  private:
+    /**
+     * @brief Appends the given number of zeroed bytes, padded to a multiple of
+     * 8 bytes, and returns the offset of the first byte.
+     */
+    uint64_t allocate(size_t size)
+    {
+        uint64_t offset = buffer_.size();
+        buffer_.resize(offset + ((size + 7) & ~size_t(7)));
+        return offset;
+    }
+
+    flat::String string(const std::string& str)
+    {
+        flat::String ret;
+        ret.offset_ = allocate(str.size());
+        ret.size_ = str.size();
+        std::memcpy(buffer_.data() + ret.offset_, str.data(), str.size());
+        return ret;
+    }
+
+    /**
+     * @brief Appends an array with an element for each source value, where
+     * each element is computed by calling convertFunc on the source value.
+     */
+    template <class Flat, class Src, class Alloc, class ConvertFunc>
+    flat::Array<Flat> array(const std::vector<Src, Alloc>& src, ConvertFunc&& convertFunc)
+    {
+        flat::Array<Flat> ret;
+        ret.offset_ = allocate(src.size() * sizeof(Flat));
+        ret.size_ = src.size();
+        for (size_t i = 0; i < src.size(); i++)
+        {
+            Flat elem = convertFunc(src[i]);
+            std::memcpy(buffer_.data() + ret.offset_ + i * sizeof(Flat), &elem, sizeof(Flat));
+        }
+        return ret;
+    }
+
+    template <class Flat, class Src, class Alloc>
+    flat::Array<Flat> array(const std::vector<Src, Alloc>& src)
+    {
+        return array<Flat>(src, [this](const Src& value) { return convert(value); });
+    }
+
+    flat::Array<double> array(const double* values, size_t size)
+    {
+        flat::Array<double> ret;
+        ret.offset_ = allocate(size * sizeof(double));
+        ret.size_ = size;
+        std::memcpy(buffer_.data() + ret.offset_, values, size * sizeof(double));
+        return ret;
+    }
+
+    flat::Map convert(const XodrMap& map)
+    {
+        flat::Map ret = {};
+        ret.hasGeoReference_ = static_cast<bool>(map.geoReference_);
+        if (map.geoReference_)
+        {
+            ret.geoReference_ = string(*map.geoReference_);
+        }
+
+        ret.totalNumLanes_ = map.totalNumLanes_;
+        ret.roads_ = array<flat::Road>(map.roads_);
+        ret.junctions_ = array<flat::Junction>(map.junctions_);
+        ret.roadIds_ = idTable(map.idToIndexMaps_.roadIdToIndex_);
+        ret.junctionIds_ = idTable(map.idToIndexMaps_.junctionIdToIndex_);
+        return ret;
+    }
+
+    flat::Array<flat::IdIndex> idTable(const std::map<std::string, int>& idToIndex)
+    {
+        // std::map is ordered by id, so the resulting table is sorted as well.
+        std::vector<std::pair<std::string, int>> entries(idToIndex.begin(), idToIndex.end());
+        return array<flat::IdIndex>(entries, [this](const std::pair<std::string, int>& entry) {
+            flat::IdIndex ret = {};
+            ret.id_ = string(entry.first);
+            ret.index_ = entry.second;
+            return ret;
+        });
+    }
+
+    flat::ObjectReference convert(const XodrObjectReference& ref)
+    {
+        flat::ObjectReference ret = {};
+        ret.id_ = string(ref.id_);
+        ret.index_ = ref.index_;
+        return ret;
+    }
+
+    static flat::Vertex convert(const ReferenceLine::Vertex& vertex)
+    {
+        return {vertex.sCoord_, vertex.position_.x(), vertex.position_.y(), vertex.heading_};
+    }
+
+    flat::Geometry convert(const ReferenceLine::Geometry& geometry)
+    {
+        flat::Geometry ret = {};
+        ret.type_ = static_cast<int32_t>(geometry.geometryType());
+        ret.startVertex_ = convert(geometry.startVertex());
+        ret.length_ = geometry.length();
+
+        switch (geometry.geometryType())
+        {
+            case ReferenceLine::GeometryType::LINE:
+                break;
+            case ReferenceLine::GeometryType::SPIRAL:
+            {
+                const auto& spiral = static_cast<const ReferenceLine::Spiral&>(geometry);
+                ret.params_[0] = spiral.startCurvature();
+                ret.params_[1] = spiral.endCurvature();
+
+                const Clothoid& clothoid = spiral.clothoid();
+                ret.precomputed_ = array(clothoid.coeffs(), clothoid.numPieces() * Clothoid::PIECE_STRIDE);
+                break;
+            }
+            case ReferenceLine::GeometryType::ARC:
+                ret.params_[0] = static_cast<const ReferenceLine::Arc&>(geometry).curvature();
+                break;
+            case ReferenceLine::GeometryType::POLY3:
+            {
+                const auto& poly3 = static_cast<const ReferenceLine::Poly3Geom&>(geometry);
+                storePoly3(poly3.poly(), ret.params_);
+                ret.precomputed_ = arcLengthTable(poly3.arcLengthTable());
+                break;
+            }
+            case ReferenceLine::GeometryType::PARAM_POLY3:
+            {
+                const auto& paramPoly3 = static_cast<const ReferenceLine::ParamPoly3&>(geometry);
+                storePoly3(paramPoly3.uPoly(), ret.params_);
+                storePoly3(paramPoly3.vPoly(), ret.params_ + 4);
+                ret.pRange_ = static_cast<int32_t>(paramPoly3.pRange());
+                ret.precomputed_ = arcLengthTable(paramPoly3.arcLengthTable());
+                break;
+            }
+        }
+
+        return ret;
+    }
+
+    flat::Array<double> arcLengthTable(const ArcLengthTable& table)
+    {
+        return array(table.nodes(), 3 * table.numNodes());
+    }
+
+    static void storePoly3(const Poly3& poly, double* dst)
+    {
+        dst[0] = poly.a_;
+        dst[1] = poly.b_;
+        dst[2] = poly.c_;
+        dst[3] = poly.d_;
+    }
+
+    flat::RoadLink convert(const RoadLink& link)
+    {
+        flat::RoadLink ret = {};
+        ret.elementType_ = static_cast<int32_t>(link.elementType_);
+        ret.contactPoint_ = static_cast<int32_t>(link.contactPoint_);
+        ret.elementRef_ = convert(link.elementRef_);
+        return ret;
+    }
+
+    flat::Road convert(const Road& road)
+    {
+        road.parseBody();
+
+        flat::Road ret = {};
+        ret.name_ = string(road.name_);
+        ret.id_ = string(road.id_);
+        ret.junctionRef_ = convert(road.junctionRef_);
+        ret.length_ = road.length_;
+
+        ret.geometries_ = array<flat::Geometry>(road.referenceLine_.geometries_,
+                                                [this](const ReferenceLine::GeometryUnion& geometry) {
+                                                    return convert(geometry.geometry());
+                                                });
+        ret.endVertex_ = convert(road.referenceLine_.endVertex_);
+
+        ret.hasElevationProfile_ = static_cast<bool>(road.elevationProfile_);
+        if (road.elevationProfile_)
+        {
+            ret.elevations_ = array<flat::SPoly3>(road.elevationProfile_->elevations_,
+                                                  [](const ElevationProfile::Elevation& elevation) {
+                                                      return flat::SPoly3{elevation.sCoord(), elevation.poly3()};
+                                                  });
+        }
+
+        ret.laneSections_ = array<flat::LaneSection>(road.laneSections_);
+        ret.roadObjects_ = array<flat::RoadObject>(road.roadObjects_);
+        ret.predecessor_ = convert(road.links_.predecessor_);
+        ret.successor_ = convert(road.links_.successor_);
+        return ret;
+    }
+
+    flat::LaneSection convert(const LaneSection& laneSection)
+    {
+        flat::LaneSection ret = {};
+        ret.startS_ = laneSection.startS_;
+        ret.endS_ = laneSection.endS_;
+        ret.singleSided_ = laneSection.singleSided_;
+        ret.numLeftLanes_ = laneSection.numLeftLanes_;
+        ret.lanes_ = array<flat::Lane>(laneSection.lanes_);
+        return ret;
+    }
+
+    flat::Lane convert(const LaneSection::Lane& lane)
+    {
+        flat::Lane ret = {};
+        ret.id_ = static_cast<int>(lane.id_);
+        ret.type_ = static_cast<int32_t>(lane.type_);
+        ret.level_ = lane.level_;
+        ret.globalIndex_ = lane.globalIndex_;
+        ret.hasPredecessor_ = lane.hasPredecessor();
+        ret.predecessor_ = lane.hasPredecessor() ? static_cast<int>(lane.predecessor()) : 0;
+        ret.hasSuccessor_ = lane.hasSuccessor();
+        ret.successor_ = lane.hasSuccessor() ? static_cast<int>(lane.successor()) : 0;
+
+        ret.widthPoly3s_ = array<flat::SPoly3>(lane.widthPoly3s_, [](const LaneSection::WidthPoly3& widthPoly3) {
+            return flat::SPoly3{widthPoly3.sOffset(), widthPoly3.poly3()};
+        });
+        ret.materials_ = array<flat::LaneMaterial>(lane.materials_, [this](const LaneMaterial& material) {
+            return flat::LaneMaterial{material.sOffset_, string(material.surface_), material.friction_,
+                                      material.roughness_};
+        });
+        ret.visibilities_ = array<flat::LaneVisibility>(lane.visibilities_, [](const LaneVisibility& visibility) {
+            return flat::LaneVisibility{visibility.sOffset_, visibility.forward_, visibility.back_, visibility.left_,
+                                        visibility.right_};
+        });
+        ret.speedLimits_ = array<flat::LaneSpeedLimit>(lane.speedLimits_, [](const LaneSpeedLimit& speedLimit) {
+            return flat::LaneSpeedLimit{speedLimit.sOffset_, speedLimit.maxSpeed_,
+                                        static_cast<int32_t>(speedLimit.unit_), 0};
+        });
+        ret.accesses_ = array<flat::LaneStringAttrib>(lane.accesses_, [this](const LaneAccess& access) {
+            return flat::LaneStringAttrib{access.sOffset_, string(access.restriction_)};
+        });
+        ret.heights_ = array<flat::LaneHeight>(lane.heights_, [](const LaneHeight& height) {
+            return flat::LaneHeight{height.sOffset_, height.inner_, height.outer_};
+        });
+        ret.rules_ = array<flat::LaneStringAttrib>(lane.rules_, [this](const LaneRule& rule) {
+            return flat::LaneStringAttrib{rule.sOffset_, string(rule.value_)};
+        });
+        return ret;
+    }
+
+    flat::RoadObject convert(const RoadObject& roadObject)
+    {
+        flat::RoadObject ret = {};
+        ret.type_ = static_cast<int32_t>(roadObject.type_);
+        ret.orientation_ = static_cast<int32_t>(roadObject.orientation_);
+        ret.name_ = string(roadObject.name_);
+        ret.id_ = string(roadObject.id_);
+        ret.s_ = roadObject.s_;
+        ret.t_ = roadObject.t_;
+        ret.zOffset_ = roadObject.zOffset_;
+        ret.validLength_ = roadObject.validLength_;
+        ret.length_ = roadObject.length_;
+        ret.width_ = roadObject.width_;
+        ret.radius_ = roadObject.radius_;
+        ret.height_ = roadObject.height_;
+        ret.heading_ = roadObject.heading_;
+        ret.pitch_ = roadObject.pitch_;
+        ret.roll_ = roadObject.roll_;
+
+        ret.hasOutline_ = roadObject.outline_ != nullptr;
+        if (roadObject.outline_)
+        {
+            ret.outline_ = array<flat::OutlineCorner>(
+                roadObject.outline_->corners_, [](const RoadObjectOutline::Corner& corner) {
+                    flat::OutlineCorner ret = {};
+                    ret.type_ = corner.which();
+                    if (const auto* cornerRoad = boost::get<RoadObjectOutline::CornerRoad>(&corner))
+                    {
+                        ret.values_[0] = cornerRoad->s_;
+                        ret.values_[1] = cornerRoad->t_;
+                        ret.values_[2] = cornerRoad->dz_;
+                        ret.values_[3] = cornerRoad->height_;
+                    }
+                    else
+                    {
+                        const auto& cornerLocal = boost::get<RoadObjectOutline::CornerLocal>(corner);
+                        ret.values_[0] = cornerLocal.u_;
+                        ret.values_[1] = cornerLocal.v_;
+                        ret.values_[2] = cornerLocal.z_;
+                        ret.values_[3] = cornerLocal.height_;
+                    }
+                    return ret;
+                });
+        }
+
+        return ret;
+    }
+
+    flat::Junction convert(const Junction& junction)
+    {
+        flat::Junction ret = {};
+        ret.name_ = string(junction.name_);
+        ret.id_ = string(junction.id_);
+        ret.connections_ = array<flat::Connection>(junction.connections_);
+        return ret;
+    }
+
+    flat::Connection convert(const Junction::Connection& connection)
+    {
+        flat::Connection ret = {};
+        ret.id_ = string(connection.id_);
+        ret.incomingRoad_ = convert(connection.incomingRoad_);
+        ret.connectingRoad_ = convert(connection.connectingRoad_);
+        ret.contactPoint_ = static_cast<int32_t>(connection.contactPoint_);
+        ret.laneLinks_ = array<flat::LaneLink>(connection.laneLinks_, [](const Junction::LaneLink& laneLink) {
+            return flat::LaneLink{static_cast<int>(laneLink.from()), static_cast<int>(laneLink.to())};
+        });
+        return ret;
+    }
+
+    std::vector<char> buffer_;
+};
+
+std::vector<char> XodrBinarySerializer::serializeFlat(const XodrMap& map)
+{
+    return FlatWriter().write(map);
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,341 @@
+#include "binary/xodr_map_view.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define XODR_MAP_VIEW_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "binary/xodr_binary_serializer.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief A read-only mapping of a file into memory.
+ *
+ * On platforms without mmap(), the file is read into an 8-byte aligned buffer
+ * instead.
+ */
+class XodrMapView::MappedFile
+{
+  public:
+    explicit MappedFile(const std::string& fileName)
+    {
+#ifdef XODR_MAP_VIEW_USE_MMAP
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Failed to open flat map file \"" + fileName + "\".");
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Failed to stat flat map file \"" + fileName + "\".");
+        }
+
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ != 0)
+        {
+            void* data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error("Failed to map flat map file \"" + fileName + "\".");
+            }
+            data_ = static_cast<const char*>(data);
+        }
+
+        // The mapping stays valid after the file descriptor is closed.
+        ::close(fd);
+#else
+        std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open flat map file \"" + fileName + "\".");
+        }
+
+        size_ = static_cast<size_t>(file.tellg());
+        file.seekg(0);
+
+        buffer_.resize((size_ + 7) / 8);
+        if (!file.read(reinterpret_cast<char*>(buffer_.data()), size_))
+        {
+            throw std::runtime_error("Failed to read flat map file \"" + fileName + "\".");
+        }
+        data_ = reinterpret_cast<const char*>(buffer_.data());
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef XODR_MAP_VIEW_USE_MMAP
+        if (data_)
+        {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+  private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+
+#ifndef XODR_MAP_VIEW_USE_MMAP
+    std::vector<uint64_t> buffer_;
+#endif
+};
+
+ReferenceLine::Vertex GeometryView::startVertex() const
+{
+    const flat::Vertex& v = record_->startVertex_;
+    return ReferenceLine::Vertex{v.sCoord_, Eigen::Vector2d(v.x_, v.y_), v.heading_};
+}
+
+ReferenceLine::PointAndTangentDir GeometryView::eval(double s) const
+{
+    return visit([s](const ReferenceLine::Geometry& geom) { return geom.eval(s); });
+}
+
+double GeometryView::evalCurvature(double s) const
+{
+    return visit([s](const ReferenceLine::Geometry& geom) { return geom.evalCurvature(s); });
+}
+
+ReferenceLine::Vertex ReferenceLineView::endVertex() const
+{
+    const flat::Vertex& v = road_->endVertex_;
+    return ReferenceLine::Vertex{v.sCoord_, Eigen::Vector2d(v.x_, v.y_), v.heading_};
+}
+
+GeometryView ReferenceLineView::geometryContaining(double s) const
+{
+    assert(s >= -.00001 && s <= endS() + .00001);
+
+    const auto* geoms = reinterpret_cast<const flat::Geometry*>(base_ + road_->geometries_.offset_);
+
+    int geomsMin = 0;
+    int geomsMax = numGeometries();
+
+    while (geomsMin != geomsMax - 1)
+    {
+        int mid = (geomsMin + geomsMax) / 2;
+        if (s < geoms[mid].startVertex_.sCoord_)
+        {
+            geomsMax = mid;
+        }
+        else
+        {
+            geomsMin = mid;
+        }
+    }
+    return GeometryView(base_, geoms + geomsMin);
+}
+
+ReferenceLine::PointAndTangentDir ReferenceLineView::eval(double s) const
+{
+    return geometryContaining(s).eval(s);
+}
+
+double ReferenceLineView::evalCurvature(double s) const
+{
+    return geometryContaining(s).evalCurvature(s);
+}
+
+bool LaneView::hasLink(RoadLinkType roadLinkType) const
+{
+    return roadLinkType == RoadLinkType::PREDECESSOR ? hasPredecessor() : hasSuccessor();
+}
+
+LaneID LaneView::link(RoadLinkType roadLinkType) const
+{
+    return roadLinkType == RoadLinkType::PREDECESSOR ? predecessor() : successor();
+}
+
+double LaneView::widthAtSCoord(double s) const
+{
+    FlatSpan<flat::SPoly3> polys = widthPoly3s();
+
+    size_t polyIdx;
+    for (polyIdx = 1; polyIdx < polys.size(); polyIdx++)
+    {
+        if (s < polys[polyIdx].sOffset())
+        {
+            break;
+        }
+    }
+
+    // last poly where sOffset >= poly.sOffset()
+    const flat::SPoly3& poly = polys[polyIdx - 1];
+    return poly.poly3().eval(s - poly.sOffset());
+}
+
+LaneID LaneSectionView::laneIndexToId(int idx) const
+{
+    assert(idx >= 0 && idx < static_cast<int>(record_->lanes_.size_));
+
+    // See LaneSection::laneIndexToId.
+    int id = numLeftLanes() - idx;
+    if (id <= 0)
+    {
+        id--;
+    }
+
+    return LaneID(id);
+}
+
+int LaneSectionView::laneIdToIndex(LaneID id) const
+{
+    int idInt = static_cast<int>(id);
+
+    assert(idInt != 0);
+    assert(idInt <= numLeftLanes());
+    assert(idInt >= -numRightLanes());
+
+    // See LaneSection::laneIdToIndex.
+    int idx = numLeftLanes() - idInt;
+    if (idx >= numLeftLanes())
+    {
+        idx--;
+    }
+
+    return idx;
+}
+
+XodrMapView XodrMapView::fromFile(const std::string& fileName)
+{
+    auto file = std::make_unique<MappedFile>(fileName);
+    const char* data = file->data();
+    size_t size = file->size();
+    return XodrMapView(std::move(file), data, size);
+}
+
+XodrMapView XodrMapView::fromBuffer(const char* data, size_t size)
+{
+    return XodrMapView(nullptr, data, size);
+}
+
+XodrMapView::XodrMapView(std::unique_ptr<MappedFile> file, const char* data, size_t size)
+    : file_(std::move(file)), data_(data), size_(size)
+{
+    if (size_ < sizeof(flat::Header))
+    {
+        throw std::runtime_error("Not a flat xodr map.");
+    }
+
+    if (reinterpret_cast<uintptr_t>(data_) % 8 != 0)
+    {
+        throw std::runtime_error("Flat xodr map data should be aligned to 8 bytes.");
+    }
+
+    const flat::Header& header = *reinterpret_cast<const flat::Header*>(data_);
+    if (std::memcmp(header.magic_, flat::MAGIC, sizeof(flat::MAGIC)) != 0)
+    {
+        throw std::runtime_error("Not a flat xodr map.");
+    }
+
+    if (header.byteOrderMark_ != flat::BYTE_ORDER_MARK)
+    {
+        throw std::runtime_error("The flat xodr map was written on a machine with a different byte order.");
+    }
+
+    if (header.formatVersion_ != flat::FORMAT_VERSION)
+    {
+        std::stringstream err;
+        err << "Unsupported flat xodr map version " << header.formatVersion_ << " (expected version "
+            << flat::FORMAT_VERSION << ").";
+        throw std::runtime_error(err.str());
+    }
+
+    if (header.fileSize_ != size_)
+    {
+        throw std::runtime_error("Size mismatch in flat xodr map.");
+    }
+}
+
+XodrMapView::XodrMapView(XodrMapView&&) noexcept = default;
+XodrMapView& XodrMapView::operator=(XodrMapView&&) noexcept = default;
+XodrMapView::~XodrMapView() = default;
+
+bool XodrMapView::verifyChecksum() const
+{
+    const flat::Header& header = *reinterpret_cast<const flat::Header*>(data_);
+    return XodrBinarySerializer::checksum(data_ + sizeof(flat::Header), size_ - sizeof(flat::Header)) ==
+           header.checksum_;
+}
+
+std::string_view XodrMapView::geoReference() const
+{
+    assert(hasGeoReference());
+    return std::string_view(data_ + map().geoReference_.offset_, map().geoReference_.size_);
+}
+
+int XodrMapView::indexById(const flat::Array<flat::IdIndex>& ids, std::string_view id) const
+{
+    const auto* begin = reinterpret_cast<const flat::IdIndex*>(data_ + ids.offset_);
+    const auto* end = begin + ids.size_;
+
+    auto idOf = [this](const flat::IdIndex& entry) {
+        return std::string_view(data_ + entry.id_.offset_, entry.id_.size_);
+    };
+
+    const auto* it = std::lower_bound(begin, end, id, [&](const flat::IdIndex& entry, std::string_view id) {
+        return idOf(entry) < id;
+    });
+    if (it == end || idOf(*it) != id)
+    {
+        return -1;
+    }
+
+    return it->index_;
+}
+
+boost::optional<RoadView> XodrMapView::roadById(std::string_view id) const
+{
+    int index = roadIndexById(id);
+    if (index < 0)
+    {
+        return boost::none;
+    }
+
+    return roads()[index];
+}
+
+int XodrMapView::roadIndexById(std::string_view id) const
+{
+    return indexById(map().roadIds_, id);
+}
+
+boost::optional<JunctionView> XodrMapView::junctionById(std::string_view id) const
+{
+    int index = junctionIndexById(id);
+    if (index < 0)
+    {
+        return boost::none;
+    }
+
+    return junctions()[index];
+}
+
+int XodrMapView::junctionIndexById(std::string_view id) const
+{
+    return indexById(map().junctionIds_, id);
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,631 @@
+#pragma once
+
+#include <boost/optional.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "binary/flat_map_format.h"
+#include "lane_section.h"
+#include "reference_line.h"
+#include "road_link.h"
+#include "road_object.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief A read-only view of an array of plain records in a flat map file.
+ */
+template <class T>
+class FlatSpan
+{
+  public:
+    FlatSpan() = default;
+    FlatSpan(const T* data, size_t size) : data_(data), size_(size) {}
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const T& operator[](size_t i) const
+    {
+        assert(i < size_);
+        return data_[i];
+    }
+
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+
+  private:
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief A read-only view of an array of records in a flat map file, whose
+ * elements are accessed through view objects of type View.
+ *
+ * View should be constructible from the base address of the flat map data and
+ * a pointer to a record.
+ */
+template <class View, class Record>
+class FlatRange
+{
+  public:
+    class Iterator
+    {
+      public:
+        Iterator(const char* base, const Record* record) : base_(base), record_(record) {}
+
+        View operator*() const { return View(base_, record_); }
+
+        Iterator& operator++()
+        {
+            record_++;
+            return *this;
+        }
+
+        bool operator==(const Iterator& b) const { return record_ == b.record_; }
+        bool operator!=(const Iterator& b) const { return record_ != b.record_; }
+
+      private:
+        const char* base_;
+        const Record* record_;
+    };
+
+    FlatRange(const char* base, const flat::Array<Record>& array)
+        : base_(base), records_(reinterpret_cast<const Record*>(base + array.offset_)), size_(array.size_)
+    {
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    View operator[](size_t i) const
+    {
+        assert(i < size_);
+        return View(base_, records_ + i);
+    }
+
+    Iterator begin() const { return Iterator(base_, records_); }
+    Iterator end() const { return Iterator(base_, records_ + size_); }
+
+  private:
+    const char* base_;
+    const Record* records_;
+    size_t size_;
+};
+
+/**
+ * @brief The base class of all views of records in a flat map file.
+ *
+ * Views are lightweight handles which consist of the base address of the flat
+ * map data and a pointer to the record. They are only valid as long as the
+ * XodrMapView they were obtained from is alive.
+ */
+template <class Record>
+class FlatRecordView
+{
+  public:
+    FlatRecordView(const char* base, const Record* record) : base_(base), record_(record) {}
+
+    /**
+     * @brief Gets the underlying record.
+     */
+    const Record& record() const { return *record_; }
+
+  protected:
+    std::string_view string(const flat::String& str) const { return std::string_view(base_ + str.offset_, str.size_); }
+
+    template <class T>
+    FlatSpan<T> span(const flat::Array<T>& array) const
+    {
+        return FlatSpan<T>(reinterpret_cast<const T*>(base_ + array.offset_), array.size_);
+    }
+
+    template <class View, class T>
+    FlatRange<View, T> range(const flat::Array<T>& array) const
+    {
+        return FlatRange<View, T>(base_, array);
+    }
+
+    const char* base_;
+    const Record* record_;
+};
+
+/**
+ * @brief A view of an XodrObjectReference in a flat map file.
+ */
+class ObjectReferenceView : public FlatRecordView<flat::ObjectReference>
+{
+  public:
+    using FlatRecordView::FlatRecordView;
+
+    std::string_view id() const { return string(record_->id_); }
+
+    /**
+     * @brief Gets whether this reference is null.
+     */
+    bool isNull() const { return record_->index_ < 0; }
+
+    /**
+     * @brief Gets the index of the referenced object. This function should
+     * only be called if isNull() returns false.
+     */
+    int index() const
+    {
+        assert(!isNull());
+        return record_->index_;
+    }
+};
+
+/**
+ * @brief A view of a RoadLink in a flat map file.
+ */
+class RoadLinkView : public FlatRecordView<flat::RoadLink>
+{
+  public:
+    using FlatRecordView::FlatRecordView;
+
+    RoadLink::ElementType elementType() const { return static_cast<RoadLink::ElementType>(record_->elementType_); }
+    ContactPoint contactPoint() const { return static_cast<ContactPoint>(record_->contactPoint_); }
+    ObjectReferenceView elementRef() const { return ObjectReferenceView(base_, &record_->elementRef_); }
+};
+
+/**
+ * @brief A view of a reference line geometry in a flat map file.
+ */
+class GeometryView : public FlatRecordView<flat::Geometry>
+{
+  public:
+    using FlatRecordView::FlatRecordView;
+
+    ReferenceLine::GeometryType geometryType() const
+    {
+        return static_cast<ReferenceLine::GeometryType>(record_->type_);
+    }
+
+    ReferenceLine::Vertex startVertex() const;
+    double length() const { return record_->length_; }
+
+    /**
+     * @brief Calls func with a (stack allocated) ReferenceLine geometry object
+     * which is equivalent to this geometry, and returns its result.
+     *
+     * This allows all the evaluation functions of the geometry classes to be
+     * used without any heap allocations. The data which the geometry classes
+     * precompute is taken from the record (see flat::Geometry), so it isn't
+     * recomputed for every call.
+     *
+     * @param func          The function to call. It's called with a const
+     *                      reference to a ReferenceLine::Line, Spiral, Arc,
+     *                      Poly3Geom or ParamPoly3.
+     * @returns             The value returned by func.
+     */
+    template <class Func>
+    auto visit(Func&& func) const;
+
+    ReferenceLine::PointAndTangentDir eval(double s) const;
+    double evalCurvature(double s) const;
+};
+
+/**
+ * @brief A view of a ReferenceLine in a flat map file.
+ */
+class ReferenceLineView
+{
+  public:
+    ReferenceLineView(const char* base, const flat::Road* road) : base_(base), road_(road) {}
+
+    int numGeometries() const { return static_cast<int>(road_->geometries_.size_); }
+    GeometryView geometry(int i) const { return geometries()[i]; }
+    FlatRange<GeometryView, flat::Geometry> geometries() const
+    {
+        return FlatRange<GeometryView, flat::Geometry>(base_, road_->geometries_);
+    }
+
+    double endS() const { return road_->endVertex_.sCoord_; }
+    ReferenceLine::Vertex endVertex() const;
+
+    /**
+     * @brief Gets the geometry which contains the given s-coordinate. See
+     * @ref ReferenceLine::geometryContaining.
+     */
+    GeometryView geometryContaining(double s) const;
+
+    /**
+     * @brief Evaluates the reference line at the given s-coordinate. See
+     * @ref ReferenceLine::eval.
+     */
+    ReferenceLine::PointAndTangentDir eval(double s) const;
+
+    /**
+     * @brief Evaluates the curvature of the reference line at the given
+     * s-coordinate. See @ref ReferenceLine::evalCurvature.
+     */
+    double evalCurvature(double s) const;
+
+  private:
+    const char* base_;
+    const flat::Road* road_;
+};
+
+/**
+ * @brief A view of a LaneMaterial in a flat map file.
+ */
+class LaneMaterialView : public FlatRecordView<flat::LaneMaterial>
+{
+  public:
+    using FlatRecordView::FlatRecordView;
+
+    double sOffset() const { return record_->sOffset_; }
+    std::string_view surface() const { return string(record_->surface_); }
+    double friction() const { return record_->friction_; }
+    double roughness() const { return record_->roughness_; }
+};
+
+/**
+ * @brief A view of a LaneAccess or LaneRule in a flat map file.
+ *
+ * For lane accesses, value() is the restriction.
+ */
+class LaneStringAttribView : public FlatRecordView<flat::LaneStringAttrib>
+{
+  public:
+    using FlatRecordView::FlatRecordView;
+
+    double sOffset() const { return record_->sOffset_; }
+    std::string_view value() const { return string(record_->value_); }
+};
+
+/**
+ * @brief A view of a LaneSection::Lane in a flat map file.
+ */
+class LaneView : public FlatRecordView<flat::Lane>
+{
+  public:
+    using FlatRecordView::FlatRecordView;
+
+    LaneID id() const { return LaneID(record_->id_); }
+    LaneType type() const { return static_cast<LaneType>(record_->type_); }
+    bool level() const { return record_->level_ != 0; }
+
+    bool hasPredecessor() const { return record_->hasPredecessor_ != 0; }
+    LaneID predecessor() const
+    {
+        assert(hasPredecessor());
+        return LaneID(record_->predecessor_);
+    }
+
+    bool hasSuccessor() const { return record_->hasSuccessor_ != 0; }
+    LaneID successor() const
+    {
+        assert(hasSuccessor());
+        return LaneID(record_->successor_);
+    }
+
+    bool hasLink(RoadLinkType roadLinkType) const;
+    LaneID link(RoadLinkType roadLinkType) const;
+
+    FlatSpan<flat::SPoly3> widthPoly3s() const { return span(record_->widthPoly3s_); }
+    FlatRange<LaneMaterialView, flat::LaneMaterial> materials() const
+    {
+        return range<LaneMaterialView>(record_->materials_);
+    }
+    FlatSpan<flat::LaneVisibility> visibilities() const { return span(record_->visibilities_); }
+    FlatSpan<flat::LaneSpeedLimit> speedLimits() const { return span(record_->speedLimits_); }
+    FlatRange<LaneStringAttribView, flat::LaneStringAttrib> accesses() const
+    {
+        return range<LaneStringAttribView>(record_->accesses_);
+    }
+    FlatSpan<flat::LaneHeight> heights() const { return span(record_->heights_); }
+    FlatRange<LaneStringAttribView, flat::LaneStringAttrib> rules() const
+    {
+        return range<LaneStringAttribView>(record_->rules_);
+    }
+
+    int globalIndex() const { return record_->globalIndex_; }
+
+    /**
+     * @brief Evaluates the width of this lane. See
+     * @ref LaneSection::Lane::widthAtSCoord.
+     */
+    double widthAtSCoord(double s) const;
+};
+
+/**
+ * @brief A view of a LaneSection in a flat map file.
+ */
+class LaneSectionView : public FlatRecordView<flat::LaneSection>
+{
+  public:
+    using FlatRecordView::FlatRecordView;
+
+    double startS() const { return record_->startS_; }
+    double endS() const { return record_->endS_; }
+    bool singleSided() const { return record_->singleSided_ != 0; }
+    int numLeftLanes() const { return record_->numLeftLanes_; }
+    int numRightLanes() const { return static_cast<int>(record_->lanes_.size_) - record_->numLeftLanes_; }
+
+    FlatRange<LaneView, flat::Lane> lanes() const { return range<LaneView>(record_->lanes_); }
+
+    /**
+     * @brief See @ref LaneSection::laneIndexToId.
+     */
+    LaneID laneIndexToId(int idx) const;
+
+    /**
+     * @brief See @ref LaneSection::laneIdToIndex.
+     */
+    int laneIdToIndex(LaneID id) const;
+
+    LaneView laneById(LaneID id) const { return lanes()[laneIdToIndex(id)]; }
+};
+
+/**
+ * @brief A view of a RoadObject in a flat map file.
+ */
+class RoadObjectView : public FlatRecordView<flat::RoadObject>
+{
+  public:
+    using FlatRecordView::FlatRecordView;
+
+    RoadObject::Type type() const { return static_cast<RoadObject::Type>(record_->type_); }
+    std::string_view name() const { return string(record_->name_); }
+    std::string_view id() const { return string(record_->id_); }
+    double s() const { return record_->s_; }
+    double t() const { return record_->t_; }
+    double zOffset() const { return record_->zOffset_; }
+    double validLength() const { return record_->validLength_; }
+    RoadObject::Orientation orientation() const { return static_cast<RoadObject::Orientation>(record_->orientation_); }
+
+    /**
+     * @brief The dimensions of the object. These are NaN if they aren't
+     * specified, see @ref RoadObject.
+     */
+    double length() const { return record_->length_; }
+    double width() const { return record_->width_; }
+    double radius() const { return record_->radius_; }
+    double height() const { return record_->height_; }
+
+    double heading() const { return record_->heading_; }
+    double pitch() const { return record_->pitch_; }
+    double roll() const { return record_->roll_; }
+
+    bool hasOutlineGeometry() const { return record_->hasOutline_ != 0; }
+    FlatSpan<flat::OutlineCorner> outlineCorners() const { return span(record_->outline_); }
+};
+
+/**
+ * @brief A view of an ElevationProfile in a flat map file.
+ */
+class ElevationProfileView
+{
+  public:
+    explicit ElevationProfileView(FlatSpan<flat::SPoly3> elevations) : elevations_(elevations) {}
+
+    FlatSpan<flat::SPoly3> elevations() const { return elevations_; }
+
+  private:
+    FlatSpan<flat::SPoly3> elevations_;
+};
+
+/**
+ * @brief A view of a Road in a flat map file.
+ */
+class RoadView : public FlatRecordView<flat::Road>
+{
+  public:
+    using FlatRecordView::FlatRecordView;
+
+    std::string_view name() const { return string(record_->name_); }
+    std::string_view id() const { return string(record_->id_); }
+    ObjectReferenceView junctionRef() const { return ObjectReferenceView(base_, &record_->junctionRef_); }
+    double length() const { return record_->length_; }
+
+    ReferenceLineView referenceLine() const { return ReferenceLineView(base_, record_); }
+
+    bool hasElevationProfile() const { return record_->hasElevationProfile_ != 0; }
+    ElevationProfileView elevationProfile() const
+    {
+        assert(hasElevationProfile());
+        return ElevationProfileView(span(record_->elevations_));
+    }
+
+    FlatRange<LaneSectionView, flat::LaneSection> laneSections() const
+    {
+        return range<LaneSectionView>(record_->laneSections_);
+    }
+    FlatRange<RoadObjectView, flat::RoadObject> roadObjects() const
+    {
+        return range<RoadObjectView>(record_->roadObjects_);
+    }
+
+    RoadLinkView predecessor() const { return RoadLinkView(base_, &record_->predecessor_); }
+    RoadLinkView successor() const { return RoadLinkView(base_, &record_->successor_); }
+    RoadLinkView roadLink(RoadLinkType type) const
+    {
+        return type == RoadLinkType::PREDECESSOR ? predecessor() : successor();
+    }
+};
+
+/**
+ * @brief A view of a Junction::Connection in a flat map file.
+ */
+class ConnectionView : public FlatRecordView<flat::Connection>
+{
+  public:
+    using FlatRecordView::FlatRecordView;
+
+    std::string_view id() const { return string(record_->id_); }
+    ObjectReferenceView incomingRoad() const { return ObjectReferenceView(base_, &record_->incomingRoad_); }
+    ObjectReferenceView connectingRoad() const { return ObjectReferenceView(base_, &record_->connectingRoad_); }
+    ContactPoint contactPoint() const { return static_cast<ContactPoint>(record_->contactPoint_); }
+    FlatSpan<flat::LaneLink> laneLinks() const { return span(record_->laneLinks_); }
+};
+
+/**
+ * @brief A view of a Junction in a flat map file.
+ */
+class JunctionView : public FlatRecordView<flat::Junction>
+{
+  public:
+    using FlatRecordView::FlatRecordView;
+
+    std::string_view name() const { return string(record_->name_); }
+    std::string_view id() const { return string(record_->id_); }
+    FlatRange<ConnectionView, flat::Connection> connections() const
+    {
+        return range<ConnectionView>(record_->connections_);
+    }
+};
+
+/**
+ * @brief A read-only view of a map stored in a flat map file (see
+ * @ref flat_map_format.h), which is written by @ref XodrMap::saveFlat.
+ *
+ * Opening a flat map file memory maps it, and only validates its header, so it
+ * takes constant time regardless of the size of the map. The map data is used
+ * directly from the mapping, without any deserialization, and since the
+ * mapping is read-only and shared, multiple processes which open the same file
+ * share the same physical memory.
+ *
+ * The view classes returned by an XodrMapView mirror the accessors of the
+ * corresponding XodrMap classes, except that strings are returned as
+ * std::string_view. They're only valid as long as the XodrMapView is alive.
+ */
+class XodrMapView
+{
+  public:
+    /**
+     * @brief Opens the given flat map file.
+     *
+     * An exception is thrown if the file can't be opened, or if its header is
+     * invalid. The contents of the file aren't verified, use
+     * @ref verifyChecksum to do so.
+     *
+     * @param fileName      The name of the flat map file.
+     * @returns             The XodrMapView.
+     */
+    static XodrMapView fromFile(const std::string& fileName);
+
+    /**
+     * @brief Creates a view of flat map data which is already in memory.
+     *
+     * The data isn't copied, so it should outlive the returned view. It should
+     * be aligned to 8 bytes.
+     *
+     * An exception is thrown if the header of the data is invalid.
+     *
+     * @param data          A pointer to the flat map data.
+     * @param size          The size of the data in bytes.
+     * @returns             The XodrMapView.
+     */
+    static XodrMapView fromBuffer(const char* data, size_t size);
+
+    XodrMapView(XodrMapView&&) noexcept;
+    XodrMapView& operator=(XodrMapView&&) noexcept;
+    ~XodrMapView();
+
+    /**
+     * @brief Verifies the checksum of the map data.
+     *
+     * This requires reading the whole file.
+     *
+     * @returns             True if the checksum matches, false otherwise.
+     */
+    bool verifyChecksum() const;
+
+    bool hasGeoReference() const { return map().hasGeoReference_ != 0; }
+    std::string_view geoReference() const;
+
+    FlatRange<RoadView, flat::Road> roads() const { return FlatRange<RoadView, flat::Road>(data_, map().roads_); }
+
+    /**
+     * @brief Gets the road with the given id, or none if no road with that id
+     * exists.
+     */
+    boost::optional<RoadView> roadById(std::string_view id) const;
+
+    /**
+     * @brief Gets the index of the road with the given id, or -1 if no road
+     * with that id exists.
+     */
+    int roadIndexById(std::string_view id) const;
+
+    FlatRange<JunctionView, flat::Junction> junctions() const
+    {
+        return FlatRange<JunctionView, flat::Junction>(data_, map().junctions_);
+    }
+
+    /**
+     * @brief Gets the junction with the given id, or none if no junction with
+     * that id exists.
+     */
+    boost::optional<JunctionView> junctionById(std::string_view id) const;
+
+    /**
+     * @brief Gets the index of the junction with the given id, or -1 if no
+     * junction with that id exists.
+     */
+    int junctionIndexById(std::string_view id) const;
+
+    int totalNumLanes() const { return map().totalNumLanes_; }
+
+    /**
+     * @brief Gets the size of the flat map data in bytes.
+     */
+    size_t dataSize() const { return size_; }
+
+  private:
+    class MappedFile;
+
+    XodrMapView(std::unique_ptr<MappedFile> file, const char* data, size_t size);
+
+    const flat::Map& map() const { return reinterpret_cast<const flat::Header*>(data_)->map_; }
+
+    int indexById(const flat::Array<flat::IdIndex>& ids, std::string_view id) const;
+
+    std::unique_ptr<MappedFile> file_;
+    const char* data_;
+    size_t size_;
+};
+
+template <class Func>
+auto GeometryView::visit(Func&& func) const
+{
+    ReferenceLine::Vertex vertex = startVertex();
+    const double* params = record_->params_;
+    switch (geometryType())
+    {
+        case ReferenceLine::GeometryType::SPIRAL:
+        {
+            FlatSpan<double> coeffs = span(record_->precomputed_);
+            return func(ReferenceLine::Spiral(vertex, length(), params[0], params[1], coeffs.begin(),
+                                              static_cast<int>(coeffs.size() / Clothoid::PIECE_STRIDE)));
+        }
+        case ReferenceLine::GeometryType::ARC:
+            return func(ReferenceLine::Arc(vertex, length(), params[0]));
+        case ReferenceLine::GeometryType::POLY3:
+        {
+            FlatSpan<double> nodes = span(record_->precomputed_);
+            ArcLengthTable table(nodes.begin(), static_cast<int>(nodes.size() / 3));
+            return func(ReferenceLine::Poly3Geom(vertex, length(), Poly3(params[0], params[1], params[2], params[3]),
+                                                 table));
+        }
+        case ReferenceLine::GeometryType::PARAM_POLY3:
+        {
+            FlatSpan<double> nodes = span(record_->precomputed_);
+            ArcLengthTable table(nodes.begin(), static_cast<int>(nodes.size() / 3));
+            return func(ReferenceLine::ParamPoly3(vertex, length(), Poly3(params[0], params[1], params[2], params[3]),
+                                                  Poly3(params[4], params[5], params[6], params[7]),
+                                                  static_cast<ReferenceLine::PRange>(record_->pRange_), table));
+        }
+        case ReferenceLine::GeometryType::LINE:
+        default:
+            return func(ReferenceLine::Line(vertex, length()));
+    }
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,57 @@
+#include "box_tree.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace aid { namespace xodr {
+
+void BoxTree::build(const std::vector<Eigen::AlignedBox2d>& boxes, std::vector<int>& order)
+{
+    order.resize(boxes.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    nodes_.clear();
+    if (boxes.empty())
+    {
+        return;
+    }
+
+    nodes_.reserve(2 * (boxes.size() / MAX_LEAF_SIZE + 1));
+    nodes_.emplace_back();
+    buildNode(0, boxes, order, 0, static_cast<int>(boxes.size()));
+}
+
+void BoxTree::buildNode(int nodeIdx, const std::vector<Eigen::AlignedBox2d>& boxes, std::vector<int>& order,
+                        int begin, int end)
+{
+    Eigen::AlignedBox2d box;
+    Eigen::AlignedBox2d centers;
+    for (int i = begin; i < end; i++)
+    {
+        box.extend(boxes[order[i]]);
+        centers.extend(boxes[order[i]].center());
+    }
+    nodes_[nodeIdx].box_ = box;
+
+    if (end - begin <= MAX_LEAF_SIZE)
+    {
+        nodes_[nodeIdx].first_ = begin;
+        nodes_[nodeIdx].count_ = end - begin;
+        return;
+    }
+
+    int axis = centers.sizes().x() >= centers.sizes().y() ? 0 : 1;
+    int mid = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                     [&](int a, int b) { return boxes[a].center()[axis] < boxes[b].center()[axis]; });
+
+    int firstChild = static_cast<int>(nodes_.size());
+    nodes_.resize(nodes_.size() + 2);
+    nodes_[nodeIdx].first_ = firstChild;
+    nodes_[nodeIdx].count_ = 0;
+
+    buildNode(firstChild, boxes, order, begin, mid);
+    buildNode(firstChild + 1, boxes, order, mid, end);
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+#include <Eigen/Geometry>
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief A bounding volume hierarchy of 2D axis aligned boxes.
+ *
+ * The tree is bulk-loaded top-down, by splitting the boxes at the median of
+ * their centers along the longest axis of the bounds of the centers, so it's
+ * balanced. The leaves refer to ranges of the boxes in the order in which the
+ * tree was built (see build()), so the users of the tree store their
+ * primitives in that order, and a leaf maps to a contiguous range of them.
+ */
+class BoxTree
+{
+  public:
+    /**
+     * @brief Builds the tree over a set of boxes, replacing its contents.
+     *
+     * @param boxes         The boxes.
+     * @param order         Receives the indices of the boxes in the order of
+     *                      the leaves.
+     */
+    void build(const std::vector<Eigen::AlignedBox2d>& boxes, std::vector<int>& order);
+
+    /**
+     * @brief Calls @p fn(first, count) for each leaf whose box contains a
+     * point, where the leaf has the boxes with indices [first, first + count)
+     * in the order of build().
+     *
+     * @param point         The point.
+     * @param fn            The function.
+     */
+    template <typename Fn>
+    void forEachLeafContaining(const Eigen::Vector2d& point, Fn&& fn) const;
+
+    /**
+     * @brief Calls @p fn(first, count) for each leaf whose box is within a
+     * distance of a point, nearer leaves first.
+     *
+     * The distance is given by @p maxDistance(), which is called before each
+     * node is visited, so it can shrink as @p fn finds nearer primitives, like
+     * in a nearest neighbor search.
+     *
+     * @param point         The point.
+     * @param maxDistance   The function which gives the distance.
+     * @param fn            The function.
+     */
+    template <typename MaxDistanceFn, typename Fn>
+    void forEachLeafNear(const Eigen::Vector2d& point, MaxDistanceFn&& maxDistance, Fn&& fn) const;
+
+  private:
+    /**
+     * @brief A node of the tree.
+     *
+     * A leaf has count_ > 0 boxes, starting at first_. An inner node has
+     * count_ == 0, and its children are nodes_[first_] and nodes_[first_ + 1].
+     */
+    struct Node
+    {
+        Eigen::AlignedBox2d box_;
+        int first_;
+        int count_;
+    };
+
+    static constexpr int MAX_LEAF_SIZE = 4;
+
+    /**
+     * @brief The size of the traversal stacks, which is far above the depth of
+     * a balanced tree.
+     */
+    static constexpr int MAX_DEPTH = 64;
+
+    void buildNode(int nodeIdx, const std::vector<Eigen::AlignedBox2d>& boxes, std::vector<int>& order, int begin,
+                   int end);
+
+    std::vector<Node> nodes_;
+};
+
+template <typename Fn>
+void BoxTree::forEachLeafContaining(const Eigen::Vector2d& point, Fn&& fn) const
+{
+    if (nodes_.empty())
+    {
+        return;
+    }
+
+    int stack[MAX_DEPTH];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0)
+    {
+        const Node& node = nodes_[stack[--stackSize]];
+        if (!node.box_.contains(point))
+        {
+            continue;
+        }
+
+        if (node.count_ == 0)
+        {
+            stack[stackSize++] = node.first_;
+            stack[stackSize++] = node.first_ + 1;
+        }
+        else
+        {
+            fn(node.first_, node.count_);
+        }
+    }
+}
+
+template <typename MaxDistanceFn, typename Fn>
+void BoxTree::forEachLeafNear(const Eigen::Vector2d& point, MaxDistanceFn&& maxDistance, Fn&& fn) const
+{
+    if (nodes_.empty())
+    {
+        return;
+    }
+
+    // The nodes on the stack are paired with the distance from the point to
+    // their box.
+    std::pair<int, double> stack[MAX_DEPTH];
+    int stackSize = 0;
+    stack[stackSize++] = {0, nodes_[0].box_.exteriorDistance(point)};
+    while (stackSize > 0)
+    {
+        std::pair<int, double> entry = stack[--stackSize];
+        if (entry.second > maxDistance())
+        {
+            continue;
+        }
+
+        const Node& node = nodes_[entry.first];
+        if (node.count_ > 0)
+        {
+            fn(node.first_, node.count_);
+            continue;
+        }
+
+        // Push the farther child first, so the nearer one is visited first.
+        double distance0 = nodes_[node.first_].box_.exteriorDistance(point);
+        double distance1 = nodes_[node.first_ + 1].box_.exteriorDistance(point);
+        if (distance0 <= distance1)
+        {
+            stack[stackSize++] = {node.first_ + 1, distance1};
+            stack[stackSize++] = {node.first_, distance0};
+        }
+        else
+        {
+            stack[stackSize++] = {node.first_, distance0};
+            stack[stackSize++] = {node.first_ + 1, distance1};
+        }
+    }
+}
+
+}}  // namespace aid::xodr
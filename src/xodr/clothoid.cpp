@@ -0,0 +1,139 @@
+#include "clothoid.h"
+
+#include <cassert>
+#include <cmath>
+#include <complex>
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief An upper bound on the number of pieces, so invalid curvatures can't
+ * cause huge allocations.
+ */
+static constexpr int MAX_NUM_PIECES = 4096;
+
+/**
+ * @brief Bounds the truncation error of the series of a piece, relative to its
+ * length.
+ *
+ * Relative to the middle of a piece, the heading changes by
+ * curvature * t + curvatureRateOfChange * t^2 / 2. The Taylor coefficients of
+ * exp(i heading) are bounded by those of exp(a z + b z^2), with a and b the
+ * absolute values of these terms at the ends of the piece, so the truncated
+ * terms of that series bound the error.
+ */
+static double truncationErrorBound(double maxCurvature, double curvatureRateOfChange, double pieceLength)
+{
+    constexpr int NUM_TERMS = Clothoid::NUM_COEFFS - 1;
+
+    double halfLength = .5 * pieceLength;
+    double a = maxCurvature * halfLength;
+    double b = .5 * std::abs(curvatureRateOfChange) * halfLength * halfLength;
+
+    // (n + 1) m_(n+1) = a m_n + 2 b m_(n-1)
+    double prevCoeff = 0;
+    double coeff = 1;
+    double ret = 0;
+    for (int n = 0; n < 2 * NUM_TERMS; n++)
+    {
+        if (n >= NUM_TERMS)
+        {
+            ret += coeff;
+        }
+
+        double nextCoeff = (a * coeff + 2 * b * prevCoeff) / (n + 1);
+        prevCoeff = coeff;
+        coeff = nextCoeff;
+    }
+
+    return ret;
+}
+
+Clothoid::Clothoid(const Eigen::Vector2d& startPoint, double startHeading, double startCurvature,
+                   double curvatureRateOfChange, double length)
+    : startHeading_(startHeading), startCurvature_(startCurvature), curvatureRateOfChange_(curvatureRateOfChange)
+{
+    // The largest curvature is at one of the ends.
+    double maxCurvature = std::max(std::abs(startCurvature), std::abs(startCurvature + curvatureRateOfChange * length));
+
+    int numPieces = 1;
+    if (length > 0)
+    {
+        while (numPieces < MAX_NUM_PIECES &&
+               !(truncationErrorBound(maxCurvature, curvatureRateOfChange, length / numPieces) <=
+                 MAX_RELATIVE_TRUNCATION_ERROR))
+        {
+            numPieces += (numPieces + 3) / 4;
+        }
+        numPieces = std::min(numPieces, MAX_NUM_PIECES);
+    }
+
+    pieceLength_ = length > 0 ? length / numPieces : 0;
+    invPieceLength_ = length > 0 ? 1 / pieceLength_ : 0;
+    maxPieceIndex_ = numPieces - 1;
+    coeffs_.resize(numPieces * PIECE_STRIDE);
+
+    std::complex<double> pieceStart(startPoint.x(), startPoint.y());
+    for (int piece = 0; piece < numPieces; piece++)
+    {
+        double middleU = (piece + .5) * pieceLength_;
+        double curvature = startCurvature + curvatureRateOfChange * middleU;
+        std::complex<double> middleDir = std::polar(1.0, evalHeading(middleU));
+
+        // The tangent direction at offset t from the middle of the piece is
+        //   middleDir * exp(i (curvature t + curvatureRateOfChange t^2 / 2)).
+        // The coefficients c_n of the Taylor series of the exponential follow
+        // from differentiating it: (n + 1) c_(n+1) = i (curvature c_n +
+        // curvatureRateOfChange c_(n-1)). Integrating the series term by term
+        // gives the series of the offset from the middle of the piece.
+        double* xCoeffs = coeffs_.data() + piece * PIECE_STRIDE;
+        double* yCoeffs = xCoeffs + NUM_COEFFS;
+
+        const std::complex<double> i(0, 1);
+        std::complex<double> prevCoeff = 0;
+        std::complex<double> coeff = 1;
+        for (int n = 0; n + 1 < NUM_COEFFS; n++)
+        {
+            std::complex<double> offsetCoeff = middleDir * coeff / double(n + 1);
+            xCoeffs[n + 1] = offsetCoeff.real();
+            yCoeffs[n + 1] = offsetCoeff.imag();
+
+            std::complex<double> nextCoeff =
+                i * (curvature * coeff + curvatureRateOfChange * prevCoeff) / double(n + 1);
+            prevCoeff = coeff;
+            coeff = nextCoeff;
+        }
+
+        auto evalOffset = [&](double t) {
+            std::complex<double> ret = 0;
+            for (int n = NUM_COEFFS - 1; n >= 1; n--)
+            {
+                ret = (ret + std::complex<double>(xCoeffs[n], yCoeffs[n])) * t;
+            }
+            return ret;
+        };
+
+        // The piece starts where the previous one ends.
+        std::complex<double> middle = pieceStart - evalOffset(-.5 * pieceLength_);
+        xCoeffs[0] = middle.real();
+        yCoeffs[0] = middle.imag();
+
+        pieceStart = middle + evalOffset(.5 * pieceLength_);
+    }
+}
+
+Clothoid::Clothoid(double startHeading, double startCurvature, double curvatureRateOfChange, double length,
+                   const double* coeffs, int numPieces)
+    : startHeading_(startHeading), startCurvature_(startCurvature), curvatureRateOfChange_(curvatureRateOfChange)
+{
+    assert(numPieces > 0);
+
+    // These match the values computed by the other constructor exactly, so
+    // the same pieces are used for the same arc lengths.
+    pieceLength_ = length > 0 ? length / numPieces : 0;
+    invPieceLength_ = length > 0 ? 1 / pieceLength_ : 0;
+    maxPieceIndex_ = numPieces - 1;
+    externalCoeffs_ = coeffs;
+}
+
+}}  // namespace aid::xodr
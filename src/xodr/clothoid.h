@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <Eigen/Dense>
+
+#include "xodr_arena.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief A fast evaluator for a clothoid (Euler spiral), the curve whose
+ * curvature changes linearly with its arc length.
+ *
+ * The position on a clothoid is given by Fresnel integrals, which odrSpiral()
+ * evaluates relative to the point of zero curvature, with rational
+ * approximations and trigonometric functions. Instead, a Clothoid splits the
+ * curve into pieces of equal length, and represents each piece by the Taylor
+ * series of its position around the middle of the piece, which is computed
+ * once. Evaluating a point then amounts to two polynomial evaluations, without
+ * branches, so it can be done in vectorized loops.
+ *
+ * The pieces are made short enough for the truncated terms of the series to
+ * stay below MAX_RELATIVE_TRUNCATION_ERROR times the length of a piece. In
+ * practice, for spirals of up to 300 meters, the positions agree with a
+ * high-precision numerical integration to within 1e-11 meters, and with
+ * odrSpiral() to within 1e-9 meters (see test_clothoid.cpp). The latter is
+ * mostly the error of odrSpiral() itself, which grows as the rate of change of
+ * the curvature approaches zero, because the spiral is then evaluated far from
+ * its point of zero curvature.
+ */
+class Clothoid
+{
+  public:
+    /**
+     * @brief Creates an empty clothoid, which can't be evaluated.
+     */
+    Clothoid() = default;
+
+    /**
+     * @brief Creates a clothoid and computes the series of its pieces.
+     *
+     * @param startPoint            The position at the start of the clothoid.
+     * @param startHeading          The heading at the start of the clothoid.
+     * @param startCurvature        The curvature at the start of the clothoid.
+     * @param curvatureRateOfChange The rate of change of the curvature per unit
+     *                              of arc length.
+     * @param length                The length of the clothoid.
+     */
+    Clothoid(const Eigen::Vector2d& startPoint, double startHeading, double startCurvature,
+             double curvatureRateOfChange, double length);
+
+    /**
+     * @brief Creates a clothoid from the coefficients of its pieces, as
+     * returned by coeffs() for a clothoid with the same parameters.
+     *
+     * The coefficients aren't copied, so they must outlive the clothoid and
+     * its copies. This is used for clothoids which are stored in flat map
+     * files.
+     *
+     * @param startHeading          The heading at the start of the clothoid.
+     * @param startCurvature        The curvature at the start of the clothoid.
+     * @param curvatureRateOfChange The rate of change of the curvature per unit
+     *                              of arc length.
+     * @param length                The length of the clothoid.
+     * @param coeffs                The coefficients of the pieces.
+     * @param numPieces             The number of pieces.
+     */
+    Clothoid(double startHeading, double startCurvature, double curvatureRateOfChange, double length,
+             const double* coeffs, int numPieces);
+
+    /**
+     * @brief Evaluates the position at the given arc length.
+     *
+     * @param u     The arc length from the start of the clothoid. This should
+     *              lie in [0, length], though points slightly outside this
+     *              range are extrapolated from the first or last piece.
+     * @param x     Receives the x-coordinate of the position.
+     * @param y     Receives the y-coordinate of the position.
+     */
+    void evalPoint(double u, double& x, double& y) const
+    {
+        int piece = static_cast<int>(std::min(std::max(u * invPieceLength_, 0.0), maxPieceIndex_));
+        double t = u - (piece + .5) * pieceLength_;
+
+        const double* xCoeffs = coeffs() + piece * PIECE_STRIDE;
+        const double* yCoeffs = xCoeffs + NUM_COEFFS;
+
+        x = xCoeffs[NUM_COEFFS - 1];
+        y = yCoeffs[NUM_COEFFS - 1];
+        for (int i = NUM_COEFFS - 2; i >= 0; i--)
+        {
+            x = x * t + xCoeffs[i];
+            y = y * t + yCoeffs[i];
+        }
+    }
+
+    /**
+     * @brief Evaluates the position at the given arc length.
+     *
+     * See evalPoint(double, double&, double&) for more details.
+     */
+    Eigen::Vector2d evalPoint(double u) const
+    {
+        Eigen::Vector2d ret;
+        evalPoint(u, ret.x(), ret.y());
+        return ret;
+    }
+
+    /**
+     * @brief Evaluates the heading at the given arc length.
+     *
+     * @param u     The arc length from the start of the clothoid.
+     * @returns     The heading, which is continuous along the clothoid.
+     */
+    double evalHeading(double u) const
+    {
+        return startHeading_ + u * (startCurvature_ + .5 * curvatureRateOfChange_ * u);
+    }
+
+    /**
+     * @returns The number of pieces the clothoid is split into.
+     */
+    int numPieces() const { return static_cast<int>(maxPieceIndex_) + 1; }
+
+    /**
+     * @returns The coefficients of the pieces: PIECE_STRIDE coefficients per
+     * piece, see coeffs_.
+     */
+    const double* coeffs() const { return externalCoeffs_ ? externalCoeffs_ : coeffs_.data(); }
+
+    /**
+     * @brief The bound on the truncation error of the series of a piece,
+     * relative to the length of the piece.
+     */
+    static constexpr double MAX_RELATIVE_TRUNCATION_ERROR = 1e-15;
+
+    /**
+     * @brief The number of coefficients of the polynomials which represent the
+     * x- and y-coordinates of a piece.
+     */
+    static constexpr int NUM_COEFFS = 16;
+
+    /**
+     * @brief The number of coefficients per piece.
+     */
+    static constexpr int PIECE_STRIDE = 2 * NUM_COEFFS;
+
+  private:
+
+    double startHeading_ = 0;
+    double startCurvature_ = 0;
+    double curvatureRateOfChange_ = 0;
+
+    double pieceLength_ = 0;
+    double invPieceLength_ = 0;
+
+    /**
+     * @brief The index of the last piece, as a double so it can be used to
+     * clamp the piece index in vectorized code.
+     */
+    double maxPieceIndex_ = 0;
+
+    /**
+     * @brief The coefficients of each piece: first the NUM_COEFFS coefficients
+     * of the polynomial for x, then those for y, in order of increasing degree.
+     * The polynomials are in terms of the arc length from the middle of the
+     * piece.
+     */
+    ArenaVector<double> coeffs_;
+
+    /**
+     * @brief The coefficients, if they're stored outside this clothoid, in
+     * which case coeffs_ is empty.
+     */
+    const double* externalCoeffs_ = nullptr;
+};
+
+}}  // namespace aid::xodr
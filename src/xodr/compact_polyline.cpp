@@ -0,0 +1,88 @@
+#include "compact_polyline.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace aid { namespace xodr {
+
+void FloatPolyline::encode(const Eigen::Vector2d* vertices, int size, const Eigen::Vector2d& origin,
+                           Eigen::Vector2f* out)
+{
+    for (int i = 0; i < size; i++)
+    {
+        out[i] = (vertices[i] - origin).cast<float>();
+    }
+}
+
+static int64_t gridCoord(double coord, double origin, double invStep)
+{
+    // The range is checked before the conversion, which also rejects NaNs.
+    double gridCoord = std::nearbyint((coord - origin) * invStep);
+    if (!(std::abs(gridCoord) <= QuantizedPolyline::MAX_GRID_COORD))
+    {
+        throw std::out_of_range("Vertex too far from the origin of the quantization grid.");
+    }
+
+    return static_cast<int64_t>(gridCoord);
+}
+
+static void encodeDelta(int32_t delta, std::vector<int16_t>& words)
+{
+    if (delta >= -32767 && delta <= 32767)
+    {
+        words.push_back(static_cast<int16_t>(delta));
+    }
+    else
+    {
+        uint32_t bits = static_cast<uint32_t>(delta);
+        words.push_back(QuantizedPolyline::ESCAPE);
+        words.push_back(static_cast<int16_t>(static_cast<uint16_t>(bits & 0xffff)));
+        words.push_back(static_cast<int16_t>(static_cast<uint16_t>(bits >> 16)));
+    }
+}
+
+static int32_t decodeDelta(const int16_t*& words)
+{
+    int16_t word = *words++;
+    if (word != QuantizedPolyline::ESCAPE)
+    {
+        return word;
+    }
+
+    uint32_t low = static_cast<uint16_t>(words[0]);
+    uint32_t high = static_cast<uint16_t>(words[1]);
+    words += 2;
+    return static_cast<int32_t>(low | (high << 16));
+}
+
+void QuantizedPolyline::decode(Eigen::Vector2d* out) const
+{
+    const int16_t* words = words_;
+    int32_t x = 0;
+    int32_t y = 0;
+    for (int i = 0; i < size_; i++)
+    {
+        x += decodeDelta(words);
+        y += decodeDelta(words);
+        out[i] = origin_ + step_ * Eigen::Vector2d(x, y);
+    }
+}
+
+void QuantizedPolyline::encode(const Eigen::Vector2d* vertices, int size, const Eigen::Vector2d& origin, double step,
+                               std::vector<int16_t>& words)
+{
+    double invStep = 1 / step;
+    int64_t prevX = 0;
+    int64_t prevY = 0;
+    for (int i = 0; i < size; i++)
+    {
+        int64_t x = gridCoord(vertices[i].x(), origin.x(), invStep);
+        int64_t y = gridCoord(vertices[i].y(), origin.y(), invStep);
+        encodeDelta(static_cast<int32_t>(x - prevX), words);
+        encodeDelta(static_cast<int32_t>(y - prevY), words);
+        prevX = x;
+        prevY = y;
+    }
+}
+
+}}  // namespace aid::xodr
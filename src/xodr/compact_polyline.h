@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <Eigen/Dense>
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief The formats in which the vertices of tessellated polylines can be
+ * stored.
+ */
+enum class VertexFormat
+{
+    /**
+     * @brief Double precision coordinates.
+     */
+    DOUBLE,
+
+    /**
+     * @brief Single precision coordinates relative to an origin, see
+     * FloatPolyline.
+     */
+    FLOAT,
+
+    /**
+     * @brief Quantized, delta-encoded coordinates relative to an origin, see
+     * QuantizedPolyline.
+     */
+    QUANTIZED,
+};
+
+/**
+ * @brief A polyline with single precision vertices, relative to a double
+ * precision origin.
+ *
+ * Each coordinate is the nearest float to the difference between the original
+ * coordinate and the one of the origin, so it's within |difference| * 2^-24 of
+ * that difference. With the origin near the polyline, for example at the start
+ * of its road, that's well below a millimeter for roads up to several
+ * kilometers long.
+ */
+struct FloatPolyline
+{
+    Eigen::Vector2d origin_;
+    const Eigen::Vector2f* vertices_;
+    int size_;
+
+    /**
+     * @brief Gets a vertex in the coordinate system of the map.
+     *
+     * @param i             The index of the vertex.
+     * @returns             The vertex.
+     */
+    Eigen::Vector2d vertex(int i) const { return origin_ + vertices_[i].cast<double>(); }
+
+    /**
+     * @brief Converts vertices to the FloatPolyline format.
+     *
+     * @param vertices      The vertices.
+     * @param size          The number of vertices.
+     * @param origin        The origin to which the vertices are made relative.
+     * @param out           Receives the @p size converted vertices.
+     */
+    static void encode(const Eigen::Vector2d* vertices, int size, const Eigen::Vector2d& origin, Eigen::Vector2f* out);
+};
+
+/**
+ * @brief A polyline whose vertices are quantized to a grid and delta-encoded.
+ *
+ * Each vertex is rounded to the nearest point of a grid with spacing step_
+ * around origin_, so its x and y coordinates are both within step_ / 2 of the
+ * original ones. The grid coordinates of each vertex are encoded as the
+ * difference to those of the previous vertex (or to (0, 0) for the first
+ * vertex), x before y. A difference in [-32767, 32767] is a single int16 word,
+ * any other difference is the word ESCAPE followed by the low and the high 16
+ * bits of an int32. Since the differences are taken between rounded
+ * coordinates, the rounding errors don't accumulate along the polyline.
+ *
+ * With a step of a millimeter, consecutive vertices less than 32 meters apart
+ * take 4 bytes, compared to the 16 bytes of an Eigen::Vector2d.
+ */
+struct QuantizedPolyline
+{
+    static constexpr int16_t ESCAPE = std::numeric_limits<int16_t>::min();
+
+    /**
+     * @brief The maximum absolute grid coordinate of a vertex, which keeps the
+     * differences within the range of an int32.
+     */
+    static constexpr int64_t MAX_GRID_COORD = int64_t(1) << 30;
+
+    Eigen::Vector2d origin_;
+    double step_;
+    const int16_t* words_;
+    int numWords_;
+    int size_;
+
+    /**
+     * @brief Decodes the vertices.
+     *
+     * @param out           Receives the size_ vertices, in the coordinate
+     *                      system of the map.
+     */
+    void decode(Eigen::Vector2d* out) const;
+
+    /**
+     * @brief Encodes vertices in the QuantizedPolyline format.
+     *
+     * An std::out_of_range exception is thrown if a vertex is more than
+     * MAX_GRID_COORD steps from the origin.
+     *
+     * @param vertices      The vertices.
+     * @param size          The number of vertices.
+     * @param origin        The origin of the grid.
+     * @param step          The spacing of the grid.
+     * @param words         The words are appended to this.
+     */
+    static void encode(const Eigen::Vector2d* vertices, int size, const Eigen::Vector2d& origin, double step,
+                       std::vector<int16_t>& words);
+};
+
+}}  // namespace aid::xodr
@@ -1,4 +1,8 @@
 #include "elevation.h"
+
+#include <algorithm>
+#include <cassert>
+
 #include "xml/xml_attribute_parsers.h"
 #include "xml/xml_child_element_parsers.h"
 
@@ -19,7 +23,7 @@ XodrParseResult<ElevationProfile> ElevationProfile::parseXml(XodrReader& xml)
 {
     XodrParseResult<ElevationProfile> ret;
 
-    static ChildElemParsers childElemParsers;
+    static const ChildElemParsers childElemParsers;
     childElemParsers.parse(xml, ret);
 
     return ret;
@@ -47,7 +51,7 @@ XodrParseResult<ElevationProfile::Elevation> ElevationProfile::Elevation::parseX
 {
     XodrParseResult<ElevationProfile::Elevation> ret;
 
-    static AttribParsers attribParsers;
+    static const AttribParsers attribParsers;
     attribParsers.parse(xml, ret);
 
     xml.skipToEndElement();
@@ -55,4 +59,50 @@ XodrParseResult<ElevationProfile::Elevation> ElevationProfile::Elevation::parseX
     return ret;
 }
 
+ElevationProfile::Cursor::Cursor(const ElevationProfile& profile)
+    : begin_(profile.elevations_.data()), end_(profile.elevations_.data() + profile.elevations_.size())
+{
+    assert(begin_ != end_);
+
+    segment_ = begin_;
+    segmentBeginS_ = -std::numeric_limits<double>::infinity();
+    segmentEndS_ = segment_ + 1 != end_ ? segment_[1].sCoord() : std::numeric_limits<double>::infinity();
+}
+
+const ElevationProfile::Elevation& ElevationProfile::Cursor::seekSlow(double sCoord)
+{
+    // When the s-coordinates are those of a tessellation, whose vertices are
+    // much denser than the segments, the next s-coordinate lies in the next
+    // segment. Otherwise, search for its segment, which precedes the first
+    // segment with a greater s-coordinate.
+    if (sCoord >= segmentEndS_ && (segment_ + 2 == end_ || sCoord < segment_[2].sCoord()))
+    {
+        segment_++;
+    }
+    else
+    {
+        segment_ = std::upper_bound(begin_ + 1, end_, sCoord,
+                                    [](double s, const Elevation& elevation) { return s < elevation.sCoord(); }) -
+                   1;
+    }
+
+    segmentBeginS_ = segment_ == begin_ ? -std::numeric_limits<double>::infinity() : segment_->sCoord();
+    segmentEndS_ = segment_ + 1 != end_ ? segment_[1].sCoord() : std::numeric_limits<double>::infinity();
+    return *segment_;
+}
+
+double ElevationProfile::elevation(double sCoord) const
+{
+    return Cursor(*this).elevation(sCoord);
+}
+
+void ElevationProfile::evalElevations(const double* sCoords, int numPoints, double* out) const
+{
+    Cursor cursor(*this);
+    for (int i = 0; i < numPoints; i++)
+    {
+        out[i] = cursor.elevation(sCoords[i]);
+    }
+}
+
 }}  // namespace aid::xodr
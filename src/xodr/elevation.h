@@ -4,7 +4,9 @@
 
 #include "xml/xml_parse_result.h"
 #include "xodr_reader.h"
+#include "xodr_arena.h"
 
+#include <limits>
 #include <vector>
 
 namespace aid { namespace xodr {
@@ -16,6 +18,8 @@ namespace aid { namespace xodr {
  */
 class ElevationProfile
 {
+    friend class XodrBinarySerializer;
+
   public:
     /**
      * @brief Constructs an uninitialized ElevationProfile.
@@ -102,12 +106,113 @@ class ElevationProfile
      *
      * @return The elevation segments.
      */
-    const std::vector<Elevation>& elevations() const { return elevations_; }
+    const ArenaVector<Elevation>& elevations() const { return elevations_; }
+
+    /**
+     * @brief Evaluates the elevation profile at a sequence of s-coordinates.
+     *
+     * A Cursor remembers the segment of the last s-coordinate it evaluated,
+     * so evaluating a non-decreasing sequence of s-coordinates which are
+     * denser than the segments, such as those of a tessellation, takes
+     * constant time per s-coordinate. Any other sequence is supported too, but
+     * when an s-coordinate lies before the current segment or beyond the next
+     * one, its segment is found with a binary search.
+     *
+     * The first segment also applies before its s-coordinate, so each
+     * s-coordinate lies in exactly one segment.
+     */
+    class Cursor
+    {
+      public:
+        /**
+         * @brief Creates a Cursor at the start of the given elevation profile,
+         * which must outlive it.
+         *
+         * @param profile   The elevation profile.
+         */
+        explicit Cursor(const ElevationProfile& profile);
+
+        /**
+         * @brief Evaluates the elevation at the given s-coordinate.
+         *
+         * @param sCoord    The s-coordinate.
+         * @returns         The elevation.
+         */
+        double elevation(double sCoord)
+        {
+            const Elevation& segment = seek(sCoord);
+            return segment.poly3().eval(sCoord - segment.sCoord());
+        }
+
+        /**
+         * @brief Evaluates the slope (the derivative of the elevation with
+         * respect to s) at the given s-coordinate.
+         *
+         * @param sCoord    The s-coordinate.
+         * @returns         The slope.
+         */
+        double slope(double sCoord)
+        {
+            const Elevation& segment = seek(sCoord);
+            return segment.poly3().evalDerivative(sCoord - segment.sCoord());
+        }
+
+      private:
+        /**
+         * @brief Moves the cursor to the segment which contains the given
+         * s-coordinate, and returns it.
+         */
+        const Elevation& seek(double sCoord)
+        {
+            // The common case: the s-coordinate lies in the current segment.
+            if (sCoord >= segmentBeginS_ && sCoord < segmentEndS_)
+            {
+                return *segment_;
+            }
+            return seekSlow(sCoord);
+        }
+
+        const Elevation& seekSlow(double sCoord);
+
+        const Elevation* begin_;
+        const Elevation* end_;
+        const Elevation* segment_;
+
+        /**
+         * @brief The range of s-coordinates in which segment_ applies.
+         */
+        double segmentBeginS_;
+        double segmentEndS_;
+    };
+
+    /**
+     * @brief Evaluates the elevation at the given s-coordinate.
+     *
+     * To evaluate many s-coordinates in order, use a Cursor or
+     * evalElevations() instead.
+     *
+     * @param sCoord    The s-coordinate.
+     * @returns         The elevation.
+     */
+    double elevation(double sCoord) const;
+
+    /**
+     * @brief Evaluates the elevations at the given s-coordinates, which are
+     * typically those of the vertices of a tessellation.
+     *
+     * This takes constant time per s-coordinate if the s-coordinates are
+     * non-decreasing, see Cursor.
+     *
+     * @param sCoords       The s-coordinates.
+     * @param numPoints     The number of s-coordinates.
+     * @param out           Receives the @p numPoints elevations.
+     */
+    void evalElevations(const double* sCoords, int numPoints, double* out) const;
 
   private:
     class ChildElemParsers;
 
-    std::vector<Elevation> elevations_;
+    ArenaVector<Elevation> elevations_;
 };
 
 }}  // namespace aid::xodr
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "xodr_reader.h"
+#include "xodr_arena.h"
 #include "xodr_object_reference.h"
 #include "road_link.h"
 #include "lane_id.h"
@@ -13,6 +14,8 @@ namespace aid { namespace xodr {
  */
 class Junction
 {
+    friend class XodrBinarySerializer;
+
   public:
     class Connection;
     class LaneLink;
@@ -37,6 +40,8 @@ class Junction
      */
     class Connection
     {
+        friend class XodrBinarySerializer;
+
       public:
         /**
          * @brief Parses a Connection using the given XodrReader.
@@ -71,7 +76,7 @@ class Junction
         /**
          * @brief Gets the lane specific linking information.
          */
-        const std::vector<LaneLink>& laneLinks() const { return laneLinks_; }
+        const ArenaVector<LaneLink>& laneLinks() const { return laneLinks_; }
 
         /**
          * @brief Searches this connection for a lane link whose 'from' lane
@@ -117,8 +122,8 @@ class Junction
         std::string id_;
         XodrObjectReference incomingRoad_;
         XodrObjectReference connectingRoad_;
-        ContactPoint contactPoint_;
-        std::vector<LaneLink> laneLinks_;
+        ContactPoint contactPoint_ = ContactPoint::NOT_SPECIFIED;
+        ArenaVector<LaneLink> laneLinks_;
     };
 
     /**
@@ -177,7 +182,7 @@ class Junction
     /**
      * @brief Gets the connections of this junction.
      */
-    const std::vector<Connection>& connections() const { return connections_; }
+    const ArenaVector<Connection>& connections() const { return connections_; }
 
     /**
      * @brief Resolves the XodrObjectReference references in this junction.
@@ -232,7 +237,7 @@ class Junction
 
     std::string name_;
     std::string id_;
-    std::vector<Connection> connections_;
+    ArenaVector<Connection> connections_;
 };
 
 }}  // namespace aid::xodr
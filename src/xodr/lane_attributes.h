@@ -12,6 +12,8 @@ namespace aid { namespace xodr {
  */
 class LaneMaterial
 {
+    friend class XodrBinarySerializer;
+
   public:
     /**
      * @brief Creates an uninitialized LaneMaterial.
@@ -63,6 +65,8 @@ class LaneMaterial
  */
 class LaneVisibility
 {
+    friend class XodrBinarySerializer;
+
   public:
     /**
      * @brief Creates an uninitialized LaneVisibility.
@@ -132,6 +136,8 @@ class LaneVisibility
  */
 class LaneSpeedLimit
 {
+    friend class XodrBinarySerializer;
+
   public:
     /**
      * @brief Creates an uninitialized LaneSpeedLimit.
@@ -182,6 +188,8 @@ class LaneSpeedLimit
  */
 class LaneAccess
 {
+    friend class XodrBinarySerializer;
+
   public:
     /**
      * @brief Creates an uninitialized LaneAccess.
@@ -221,6 +229,8 @@ class LaneAccess
  */
 class LaneHeight
 {
+    friend class XodrBinarySerializer;
+
   public:
     /**
      * @brief Creates an uninitialized LaneHeight.
@@ -266,6 +276,8 @@ class LaneHeight
  */
 class LaneRule
 {
+    friend class XodrBinarySerializer;
+
   public:
     /**
      * @brief Creates an uninitialized LaneRule.
@@ -0,0 +1,362 @@
+#include "lane_graph.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "binary/xodr_binary_serializer.h"
+#include "map_tessellator.h"
+#include "parallel_for.h"
+
+namespace aid { namespace xodr {
+
+namespace {
+
+const char MAGIC[8] = {'X', 'O', 'D', 'R', 'L', 'G', 'R', '\0'};
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+using Edge = std::pair<int, int>;
+
+/**
+ * @brief Gets the global index of the lane with the given id in a lane
+ * section, or -1 if there's no such lane.
+ */
+int globalLaneIndex(const LaneSection& laneSection, LaneID id)
+{
+    int intId = static_cast<int>(id);
+    if (intId == 0 || intId > laneSection.numLeftLanes() || intId < -laneSection.numRightLanes())
+    {
+        return -1;
+    }
+
+    return laneSection.lanes()[laneSection.laneIdToIndex(id)].globalIndex();
+}
+
+/**
+ * @brief Gets the contact point of its lane section at which a lane is left,
+ * see LaneGraph.
+ */
+ContactPoint exitContactPoint(LaneID id)
+{
+    return static_cast<int>(id) < 0 ? ContactPoint::END : ContactPoint::START;
+}
+
+/**
+ * @brief Gets the global index of the lane which a lane is linked to at one of
+ * the contact points of its lane section, through the predecessor or successor
+ * link of the lane itself.
+ *
+ * @returns             The global index, or -1 if the lane has no such link,
+ *                      or if it's to a junction or to a lane which doesn't
+ *                      exist.
+ */
+int linkedLane(const XodrMap& map, const Road& road, int laneSectionIdx, const LaneSection::Lane& lane,
+               ContactPoint contactPoint)
+{
+    RoadLinkType linkType = linkTypeForContactPoint(contactPoint);
+    if (!lane.hasLink(linkType))
+    {
+        return -1;
+    }
+
+    const ArenaVector<LaneSection>& laneSections = road.laneSections();
+    const LaneSection* linkedLaneSection;
+    if (contactPoint == ContactPoint::END && laneSectionIdx + 1 < static_cast<int>(laneSections.size()))
+    {
+        linkedLaneSection = &laneSections[laneSectionIdx + 1];
+    }
+    else if (contactPoint == ContactPoint::START && laneSectionIdx > 0)
+    {
+        linkedLaneSection = &laneSections[laneSectionIdx - 1];
+    }
+    else
+    {
+        const RoadLink& roadLink = road.roadLink(linkType);
+        if (roadLink.elementType() != RoadLink::ElementType::ROAD)
+        {
+            return -1;
+        }
+
+        const Road& linkedRoad = map.roads()[roadLink.elementRef().index()];
+        linkedLaneSection = &linkedRoad.laneSectionForContactPoint(roadLink.contactPoint());
+    }
+
+    return globalLaneIndex(*linkedLaneSection, lane.link(linkType));
+}
+
+/**
+ * @brief Adds the edges into and out of the lanes of a road which follow from
+ * the lane links of those lanes.
+ */
+void addRoadEdges(const XodrMap& map, const Road& road, std::vector<Edge>& edges)
+{
+    const ArenaVector<LaneSection>& laneSections = road.laneSections();
+    for (int i = 0; i < static_cast<int>(laneSections.size()); i++)
+    {
+        const LaneSection& laneSection = laneSections[i];
+        const ArenaVector<LaneSection::Lane>& lanes = laneSection.lanes();
+        for (int j = 0; j < static_cast<int>(lanes.size()); j++)
+        {
+            const LaneSection::Lane& lane = lanes[j];
+            ContactPoint exit = exitContactPoint(laneSection.laneIndexToId(j));
+
+            int successor = linkedLane(map, road, i, lane, exit);
+            if (successor >= 0)
+            {
+                edges.emplace_back(lane.globalIndex(), successor);
+            }
+
+            int predecessor = linkedLane(map, road, i, lane, oppositeContactPoint(exit));
+            if (predecessor >= 0)
+            {
+                edges.emplace_back(predecessor, lane.globalIndex());
+            }
+        }
+    }
+}
+
+/**
+ * @brief Finds the contact point of the incoming road of a junction connection
+ * at which it's connected to the connecting road.
+ *
+ * @returns             True if the contact point was found.
+ */
+bool findIncomingContactPoint(const XodrMap& map, int junctionIdx, const Junction::Connection& connection,
+                              ContactPoint& contactPoint)
+{
+    int incomingRoadIdx = connection.incomingRoad().index();
+
+    // The connecting road links to the incoming road directly, which is
+    // unambiguous even if both ends of the incoming road are in the junction.
+    const Road& connectingRoad = map.roads()[connection.connectingRoad().index()];
+    const RoadLink& backLink = connectingRoad.roadLink(linkTypeForContactPoint(connection.contactPoint()));
+    if (backLink.elementType() == RoadLink::ElementType::ROAD && backLink.elementRef().index() == incomingRoadIdx)
+    {
+        contactPoint = backLink.contactPoint();
+        return true;
+    }
+
+    const Road& incomingRoad = map.roads()[incomingRoadIdx];
+    for (RoadLinkType linkType : {RoadLinkType::PREDECESSOR, RoadLinkType::SUCCESSOR})
+    {
+        const RoadLink& roadLink = incomingRoad.roadLink(linkType);
+        if (roadLink.elementType() == RoadLink::ElementType::JUNCTION &&
+            roadLink.elementRef().index() == junctionIdx)
+        {
+            contactPoint = contactPointForLinkType(linkType);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Adds the edges which follow from the lane links of the connections of
+ * a junction.
+ */
+void addJunctionEdges(const XodrMap& map, int junctionIdx, std::vector<Edge>& edges)
+{
+    for (const Junction::Connection& connection : map.junctions()[junctionIdx].connections())
+    {
+        ContactPoint incomingContactPoint;
+        if (!findIncomingContactPoint(map, junctionIdx, connection, incomingContactPoint))
+        {
+            continue;
+        }
+
+        const LaneSection& incomingLaneSection =
+            map.roads()[connection.incomingRoad().index()].laneSectionForContactPoint(incomingContactPoint);
+        const LaneSection& connectingLaneSection =
+            map.roads()[connection.connectingRoad().index()].laneSectionForContactPoint(connection.contactPoint());
+
+        for (const Junction::LaneLink& laneLink : connection.laneLinks())
+        {
+            int from = globalLaneIndex(incomingLaneSection, laneLink.from());
+            int to = globalLaneIndex(connectingLaneSection, laneLink.to());
+            if (from < 0 || to < 0)
+            {
+                continue;
+            }
+
+            if (exitContactPoint(laneLink.from()) == incomingContactPoint)
+            {
+                edges.emplace_back(from, to);
+            }
+            else
+            {
+                edges.emplace_back(to, from);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+constexpr uint32_t LaneGraph::FORMAT_VERSION;
+
+LaneGraph::LaneGraph() : offsets_(1, 0) {}
+
+LaneGraph::LaneGraph(const XodrMap& map, const Options& options)
+{
+    MapTessellator tessellator(map);
+    MapTessellator::Options tessellatorOptions;
+    tessellatorOptions.maxError_ = options.maxError_;
+    tessellatorOptions.numThreads_ = options.numThreads_;
+    tessellator.tessellate(tessellatorOptions);
+
+    laneLengths_.resize(map.totalNumLanes());
+    for (int i = 0; i < map.totalNumLanes(); i++)
+    {
+        MapTessellator::Polyline centerLine = tessellator.centerLine(i);
+        double length = 0;
+        for (int j = 0; j + 1 < centerLine.size_; j++)
+        {
+            length += (centerLine.vertices_[j + 1] - centerLine.vertices_[j]).norm();
+        }
+        laneLengths_[i] = length;
+    }
+
+    // Each road and junction gets its own edge list, so they can be filled in
+    // parallel. Most edges are found from both of their lanes, and the links
+    // between connecting roads and incoming roads also through the junction,
+    // so the duplicates are removed below.
+    int numRoads = static_cast<int>(map.roads().size());
+    int numJunctions = static_cast<int>(map.junctions().size());
+    std::vector<std::vector<Edge>> elementEdges(numRoads + numJunctions);
+    parallelFor(resolveNumThreads(options.numThreads_), elementEdges.size(), [&](size_t i, int) {
+        int elementIdx = static_cast<int>(i);
+        if (elementIdx < numRoads)
+        {
+            addRoadEdges(map, map.roads()[elementIdx], elementEdges[i]);
+        }
+        else
+        {
+            addJunctionEdges(map, elementIdx - numRoads, elementEdges[i]);
+        }
+    });
+
+    std::vector<Edge> edges;
+    for (const std::vector<Edge>& e : elementEdges)
+    {
+        edges.insert(edges.end(), e.begin(), e.end());
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    offsets_.assign(map.totalNumLanes() + 1, 0);
+    targets_.resize(edges.size());
+    edgeLengths_.resize(edges.size());
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        offsets_[edges[i].first + 1]++;
+        targets_[i] = edges[i].second;
+        edgeLengths_[i] = laneLengths_[edges[i].first];
+    }
+    for (int i = 0; i < map.totalNumLanes(); i++)
+    {
+        offsets_[i + 1] += offsets_[i];
+    }
+}
+
+bool LaneGraph::hasEdge(int from, int to) const
+{
+    const int* first = successors(from);
+    const int* last = first + numSuccessors(from);
+    return std::binary_search(first, last, to);
+}
+
+std::vector<char> LaneGraph::serialize() const
+{
+    BinaryWriter out;
+
+    // Reserve space for the header, which is filled in once the payload size
+    // and checksum are known.
+    XodrBinarySerializer::Header header = {};
+    out.write(header);
+    out.writePodVector(offsets_);
+    out.writePodVector(targets_);
+    out.writePodVector(edgeLengths_);
+    out.writePodVector(laneLengths_);
+
+    std::vector<char> ret = out.takeBuffer();
+
+    std::memcpy(header.magic_, MAGIC, sizeof(MAGIC));
+    header.formatVersion_ = FORMAT_VERSION;
+    header.byteOrderMark_ = BYTE_ORDER_MARK;
+    header.payloadSize_ = ret.size() - sizeof(header);
+    header.payloadChecksum_ = XodrBinarySerializer::checksum(ret.data() + sizeof(header), header.payloadSize_);
+    std::memcpy(ret.data(), &header, sizeof(header));
+
+    return ret;
+}
+
+LaneGraph LaneGraph::deserialize(const char* data, size_t size)
+{
+    XodrBinarySerializer::Header header;
+    if (size < sizeof(header))
+    {
+        throw std::runtime_error("Not a binary lane graph.");
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic_, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        throw std::runtime_error("Not a binary lane graph.");
+    }
+
+    if (header.byteOrderMark_ != BYTE_ORDER_MARK)
+    {
+        throw std::runtime_error("The binary lane graph was written on a machine with a different byte order.");
+    }
+
+    if (header.formatVersion_ != FORMAT_VERSION)
+    {
+        std::stringstream err;
+        err << "Unsupported binary lane graph version " << header.formatVersion_ << " (expected version "
+            << FORMAT_VERSION << ").";
+        throw std::runtime_error(err.str());
+    }
+
+    const char* payload = data + sizeof(header);
+    if (header.payloadSize_ != size - sizeof(header) ||
+        XodrBinarySerializer::checksum(payload, header.payloadSize_) != header.payloadChecksum_)
+    {
+        throw std::runtime_error("Checksum mismatch in binary lane graph.");
+    }
+
+    BinaryReader in(payload, header.payloadSize_);
+
+    LaneGraph ret;
+    ret.offsets_ = in.readPodVector<int>();
+    ret.targets_ = in.readPodVector<int>();
+    ret.edgeLengths_ = in.readPodVector<double>();
+    ret.laneLengths_ = in.readPodVector<double>();
+
+    if (!in.atEnd())
+    {
+        throw std::runtime_error("Corrupt binary data: trailing data after the lane graph.");
+    }
+
+    // Make sure the graph can be traversed without going out of bounds.
+    int numLanes = ret.numLanes();
+    if (ret.offsets_.size() != static_cast<size_t>(numLanes) + 1 || ret.offsets_.front() != 0 ||
+        ret.offsets_.back() != ret.numEdges() || ret.edgeLengths_.size() != ret.targets_.size() ||
+        !std::is_sorted(ret.offsets_.begin(), ret.offsets_.end()) ||
+        std::any_of(ret.targets_.begin(), ret.targets_.end(), [&](int t) { return t < 0 || t >= numLanes; }))
+    {
+        throw std::runtime_error("Corrupt binary data: inconsistent lane graph.");
+    }
+
+    return ret;
+}
+
+bool LaneGraph::operator==(const LaneGraph& other) const
+{
+    return offsets_ == other.offsets_ && targets_ == other.targets_ && edgeLengths_ == other.edgeLengths_ &&
+           laneLengths_ == other.laneLengths_;
+}
+
+}}  // namespace aid::xodr
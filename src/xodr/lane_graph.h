@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "xodr_map.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief The graph of the lanes of an XodrMap, with an edge from each lane to
+ * each lane which can be entered at its end.
+ *
+ * The nodes are the lanes, identified by their global index (see
+ * LaneSection::Lane::globalIndex()). The edges come from the lane links
+ * between consecutive lane sections of a road, the lane links between roads
+ * which are linked directly, and the lane links of the junction connections.
+ * Lane changes aren't edges.
+ *
+ * A lane is traversed in the direction of the reference line if it's a right
+ * lane, and against it if it's a left lane. The driving direction of the road
+ * (right or left hand traffic) isn't taken into account, and neither are lane
+ * types, so the graph also has edges between sidewalks, shoulders, etc.
+ *
+ * The edges are stored in compressed sparse row form: the successors of a lane
+ * are consecutive in a single array, so that iterating over them touches a
+ * single contiguous range of memory. Each edge has a length, which is the
+ * length of the center line of its source lane, so the length of a path is the
+ * sum of the lengths of its lanes, minus that of the last one.
+ */
+class LaneGraph
+{
+  public:
+    /**
+     * @brief Options which control how a LaneGraph is built.
+     */
+    struct Options
+    {
+        /**
+         * @brief The maximum distance between the tessellated lane center
+         * lines, whose lengths are the edge lengths, and the exact ones.
+         */
+        double maxError_ = .01;
+
+        /**
+         * @brief The number of threads over which the roads are distributed,
+         * or 0 for one per hardware thread.
+         */
+        int numThreads_ = 0;
+    };
+
+    /**
+     * @brief The current version of the binary format written by serialize().
+     *
+     * This should be incremented whenever the layout of the data changes.
+     */
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * @brief Constructs an empty graph, without any lanes.
+     */
+    LaneGraph();
+
+    /**
+     * @brief Builds the graph of the lanes of a map.
+     *
+     * @param map           The map. The graph doesn't refer to it after it's
+     *                      built.
+     * @param options       The options.
+     */
+    LaneGraph(const XodrMap& map, const Options& options);
+
+    /**
+     * @returns The number of lanes, which is XodrMap::totalNumLanes() of the
+     * map the graph was built from.
+     */
+    int numLanes() const { return static_cast<int>(laneLengths_.size()); }
+
+    /**
+     * @returns The number of edges.
+     */
+    int numEdges() const { return static_cast<int>(targets_.size()); }
+
+    /**
+     * @brief Gets the length of the center line of a lane.
+     *
+     * @param lane          The global index of the lane.
+     * @returns             The length.
+     */
+    double laneLength(int lane) const { return laneLengths_[lane]; }
+
+    /**
+     * @brief The edges from the lane with global index i are the edges with
+     * indices offsets()[i] up to but not including offsets()[i + 1].
+     *
+     * @returns The numLanes() + 1 offsets.
+     */
+    const std::vector<int>& offsets() const { return offsets_; }
+
+    /**
+     * @returns The global index of the target lane of each edge. The targets
+     * of the edges of a lane are in increasing order, without duplicates.
+     */
+    const std::vector<int>& targets() const { return targets_; }
+
+    /**
+     * @returns The length of each edge.
+     */
+    const std::vector<double>& edgeLengths() const { return edgeLengths_; }
+
+    /**
+     * @brief Gets the number of successors of a lane.
+     *
+     * @param lane          The global index of the lane.
+     * @returns             The number of successors.
+     */
+    int numSuccessors(int lane) const { return offsets_[lane + 1] - offsets_[lane]; }
+
+    /**
+     * @brief Gets the successors of a lane.
+     *
+     * @param lane          The global index of the lane.
+     * @returns             A pointer to the numSuccessors(@p lane) global
+     *                      indices of the successors.
+     */
+    const int* successors(int lane) const { return targets_.data() + offsets_[lane]; }
+
+    /**
+     * @brief Checks whether there's an edge between two lanes.
+     *
+     * @param from          The global index of the source lane.
+     * @param to            The global index of the target lane.
+     * @returns             True if @p to is a successor of @p from.
+     */
+    bool hasEdge(int from, int to) const;
+
+    /**
+     * @brief Serializes this graph to a binary representation.
+     *
+     * Like the binary maps of XodrBinarySerializer, the data starts with a
+     * header with a magic number, the format version, the byte order, the
+     * size of the payload and a checksum of the payload, and uses the native
+     * byte order.
+     *
+     * @returns             The binary data.
+     */
+    std::vector<char> serialize() const;
+
+    /**
+     * @brief Deserializes a graph written by serialize().
+     *
+     * An std::runtime_error is thrown if the data isn't a serialized graph of
+     * the current format version and byte order, or if it's corrupt.
+     *
+     * @param data          A pointer to the binary data.
+     * @param size          The size of the binary data in bytes.
+     * @returns             The graph.
+     */
+    static LaneGraph deserialize(const char* data, size_t size);
+
+    bool operator==(const LaneGraph& other) const;
+    bool operator!=(const LaneGraph& other) const { return !(*this == other); }
+
+  private:
+    std::vector<int> offsets_;
+    std::vector<int> targets_;
+    std::vector<double> edgeLengths_;
+    std::vector<double> laneLengths_;
+};
+
+}}  // namespace aid::xodr
@@ -81,11 +81,11 @@ class LaneID
     /**
      * @brief Parses a LaneID from the given string.
      */
-    static XodrParseResult<LaneID> parse(const std::string& s)
+    static XodrParseResult<LaneID> parse(std::string_view s)
     {
         LaneID ret;
 
-        ret.id_ = std::stoi(s);
+        ret.id_ = xml_parsers::parseXmlAttrib<int>(s);
         if (ret.id_ >= INVALID_TAG)
         {
             throw std::out_of_range("Lane identifier out of range");
@@ -224,7 +224,7 @@ class LaneIDOpt
     /**
      * @brief Parses a LaneIDOpt from the given string.
      */
-    static XodrParseResult<LaneIDOpt> parse(const std::string& s)
+    static XodrParseResult<LaneIDOpt> parse(std::string_view s)
     {
         return XodrParseResult<LaneIDOpt>(LaneID::parse(s).value());
     }
@@ -0,0 +1,224 @@
+#include "lane_mesh.h"
+
+#include <algorithm>
+
+namespace aid { namespace xodr {
+
+LaneMeshBuilder::LaneMeshBuilder(const XodrMap& map) : map_(map), tessellator_(map)
+{
+}
+
+void LaneMeshBuilder::build(const Options& options, LaneMesh& mesh)
+{
+    MapTessellator::Options tessellatorOptions;
+    tessellatorOptions.maxError_ = options.maxError_;
+    tessellatorOptions.numThreads_ = options.numThreads_;
+    tessellator_.tessellate(tessellatorOptions);
+
+    mesh.batches_.resize(NUM_LANE_TYPES);
+    for (LaneMesh::Batch& batch : mesh.batches_)
+    {
+        batch.vertices_.clear();
+        batch.indices_.clear();
+        batch.lanes_.clear();
+    }
+    mesh.laneRanges_.resize(map_.totalNumLanes());
+
+    endPoints_.resize(NUM_LANE_TYPES);
+    for (std::vector<uint32_t>& endPoints : endPoints_)
+    {
+        endPoints.clear();
+    }
+
+    const ArenaVector<Road>& roads = map_.roads();
+    for (int roadIdx = 0; roadIdx < static_cast<int>(roads.size()); roadIdx++)
+    {
+        for (int i = 0; i < static_cast<int>(roads[roadIdx].laneSections().size()); i++)
+        {
+            addLaneSection(LaneSectionKey(roadIdx, i), mesh);
+        }
+    }
+
+    for (int i = 0; i < NUM_LANE_TYPES; i++)
+    {
+        weld(options.weldTolerance_, mesh, mesh.batches_[i], endPoints_[i]);
+    }
+}
+
+void LaneMeshBuilder::addLaneSection(LaneSectionKey laneSectionKey, LaneMesh& mesh)
+{
+    const LaneSection& laneSection = laneSectionByKey(map_, laneSectionKey);
+    const ArenaVector<LaneSection::Lane>& lanes = laneSection.lanes();
+    int firstBoundary = tessellator_.boundaryIndex(laneSectionKey, 0);
+
+    // All boundaries of a lane section have a vertex at each vertex of the
+    // reference line.
+    const ReferenceLine::FrenetFrames& refLineFrames = tessellator_.refLineFrames(laneSectionKey);
+    int numPoints = refLineFrames.size();
+    uint32_t numQuads = static_cast<uint32_t>(numPoints - 1);
+
+    laneHeights_.resize(2 * numPoints);
+    prevRightHeights_.resize(numPoints);
+    double* inner = laneHeights_.data();
+    double* outer = inner + numPoints;
+
+    uint32_t prevRightBase = 0;
+    for (int j = 0; j < static_cast<int>(lanes.size()); j++)
+    {
+        const LaneSection::Lane& lane = lanes[j];
+        int typeIdx = static_cast<int>(lane.type());
+        LaneMesh::Batch& batch = mesh.batches_[typeIdx];
+
+        laneSection.evalLaneHeights(j, refLineFrames.sCoords_.data(), numPoints, inner, outer);
+        bool isLeftLane = j < laneSection.numLeftLanes();
+        const double* leftHeights = isLeftLane ? outer : inner;
+        const double* rightHeights = isLeftLane ? inner : outer;
+
+        // Share the edge with the lane to the left if it's in the same batch,
+        // and at the same height.
+        uint32_t leftBase;
+        if (j > 0 && lanes[j - 1].type() == lane.type() &&
+            std::equal(leftHeights, leftHeights + numPoints, prevRightHeights_.begin()))
+        {
+            leftBase = prevRightBase;
+        }
+        else
+        {
+            leftBase = addEdge(firstBoundary + j, refLineFrames.elevations_.data(), leftHeights, batch,
+                               endPoints_[typeIdx]);
+        }
+        uint32_t rightBase = addEdge(firstBoundary + j + 1, refLineFrames.elevations_.data(), rightHeights, batch,
+                                     endPoints_[typeIdx]);
+        prevRightBase = rightBase;
+        std::copy(rightHeights, rightHeights + numPoints, prevRightHeights_.begin());
+
+        LaneMesh::LaneRange& range = mesh.laneRanges_[lane.globalIndex()];
+        range.laneType_ = lane.type();
+        range.firstIndex_ = static_cast<int>(batch.indices_.size());
+        range.numIndices_ = static_cast<int>(numQuads * 6);
+
+        size_t indexIt = batch.indices_.size();
+        batch.indices_.resize(indexIt + numQuads * 6);
+        uint32_t* indices = batch.indices_.data() + indexIt;
+        for (uint32_t k = 0; k < numQuads; k++)
+        {
+            uint32_t l0 = leftBase + k;
+            uint32_t r0 = rightBase + k;
+
+            // The left edge is on the positive t side, so this is
+            // counter-clockwise in the x/y-plane.
+            indices[0] = l0;
+            indices[1] = r0;
+            indices[2] = r0 + 1;
+            indices[3] = l0;
+            indices[4] = r0 + 1;
+            indices[5] = l0 + 1;
+            indices += 6;
+        }
+
+        batch.lanes_.push_back(lane.globalIndex());
+    }
+}
+
+uint32_t LaneMeshBuilder::addEdge(int boundaryIndex, const double* elevations, const double* heights,
+                                  LaneMesh::Batch& batch, std::vector<uint32_t>& endPoints)
+{
+    MapTessellator::Polyline boundary = tessellator_.boundary(boundaryIndex);
+
+    uint32_t base = static_cast<uint32_t>(batch.vertices_.size());
+    batch.vertices_.resize(base + boundary.size_);
+    Eigen::Vector3d* vertices = batch.vertices_.data() + base;
+    for (int i = 0; i < boundary.size_; i++)
+    {
+        vertices[i] = Eigen::Vector3d(boundary.vertices_[i].x(), boundary.vertices_[i].y(), elevations[i] + heights[i]);
+    }
+
+    endPoints.push_back(base);
+    endPoints.push_back(base + boundary.size_ - 1);
+    return base;
+}
+
+void LaneMeshBuilder::weld(double tolerance, LaneMesh& mesh, LaneMesh::Batch& batch, std::vector<uint32_t>& endPoints)
+{
+    if (batch.empty())
+    {
+        return;
+    }
+
+    std::vector<Eigen::Vector3d>& vertices = batch.vertices_;
+
+    // Sweep over the end points in the order of their x-coordinates, and
+    // map each one to the first end point within the tolerance of it.
+    std::sort(endPoints.begin(), endPoints.end(), [&vertices](uint32_t a, uint32_t b) {
+        return vertices[a].x() < vertices[b].x() || (vertices[a].x() == vertices[b].x() && a < b);
+    });
+
+    vertexRemap_.resize(vertices.size());
+    for (uint32_t i = 0; i < vertexRemap_.size(); i++)
+    {
+        vertexRemap_[i] = i;
+    }
+
+    double toleranceSq = tolerance * tolerance;
+    for (size_t a = 0; a < endPoints.size(); a++)
+    {
+        uint32_t i = endPoints[a];
+        for (size_t b = a + 1; b < endPoints.size() && vertices[endPoints[b]].x() - vertices[i].x() <= tolerance;
+             b++)
+        {
+            uint32_t j = endPoints[b];
+            if (vertexRemap_[j] == j && (vertices[j] - vertices[i]).squaredNorm() <= toleranceSq)
+            {
+                vertexRemap_[j] = vertexRemap_[i];
+            }
+        }
+    }
+
+    // Remove the welded vertices, and find the new index of each vertex.
+    newVertexIndices_.resize(vertices.size());
+    uint32_t numVertices = 0;
+    for (uint32_t i = 0; i < vertexRemap_.size(); i++)
+    {
+        if (vertexRemap_[i] == i)
+        {
+            vertices[numVertices] = vertices[i];
+            newVertexIndices_[i] = numVertices++;
+        }
+    }
+    vertices.resize(numVertices);
+
+    for (uint32_t i = 0; i < vertexRemap_.size(); i++)
+    {
+        vertexRemap_[i] = newVertexIndices_[vertexRemap_[i]];
+    }
+
+    // Remap the indices, and remove the triangles which became degenerate,
+    // such as those at the start or end of a lane with a width of 0 there.
+    std::vector<uint32_t>& indices = batch.indices_;
+    size_t numIndices = 0;
+    for (int globalLaneIdx : batch.lanes_)
+    {
+        LaneMesh::LaneRange& range = mesh.laneRanges_[globalLaneIdx];
+        size_t begin = range.firstIndex_;
+        size_t end = begin + range.numIndices_;
+
+        range.firstIndex_ = static_cast<int>(numIndices);
+        for (size_t i = begin; i < end; i += 3)
+        {
+            uint32_t a = vertexRemap_[indices[i]];
+            uint32_t b = vertexRemap_[indices[i + 1]];
+            uint32_t c = vertexRemap_[indices[i + 2]];
+            if (a != b && b != c && c != a)
+            {
+                indices[numIndices] = a;
+                indices[numIndices + 1] = b;
+                indices[numIndices + 2] = c;
+                numIndices += 3;
+            }
+        }
+        range.numIndices_ = static_cast<int>(numIndices) - range.firstIndex_;
+    }
+    indices.resize(numIndices);
+}
+
+}}  // namespace aid::xodr
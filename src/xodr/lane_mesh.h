@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <Eigen/Dense>
+
+#include "map_tessellator.h"
+#include "xodr_map.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief A 3D triangle mesh of the lanes of an XodrMap, batched by lane type.
+ *
+ * Each lane is a strip of quads between its left and right edges (see
+ * LaneSection::tessellateLaneBoundaryCurves3D()), split into two triangles
+ * each, which are wound counter-clockwise when seen from above (the positive
+ * z-axis). All lanes of the same type are in the same batch, which has a
+ * single vertex buffer and a single index buffer. Within a batch, adjacent
+ * lanes share the vertices of the boundary between them where their heights
+ * agree, and the end points of the edges are welded at lane section seams and
+ * road links, see LaneMeshBuilder::Options::weldTolerance_.
+ */
+struct LaneMesh
+{
+    /**
+     * @brief The vertices and triangles of all lanes of one type.
+     */
+    struct Batch
+    {
+        std::vector<Eigen::Vector3d> vertices_;
+
+        /**
+         * @brief The vertex indices of the triangles, three per triangle.
+         */
+        std::vector<uint32_t> indices_;
+
+        /**
+         * @brief The global indices of the lanes in the batch, in the order in
+         * which their triangles appear in indices_.
+         */
+        std::vector<int> lanes_;
+
+        bool empty() const { return indices_.empty(); }
+    };
+
+    /**
+     * @brief The range of indices of a lane within its batch.
+     */
+    struct LaneRange
+    {
+        LaneType laneType_;
+        int firstIndex_;
+        int numIndices_;
+    };
+
+    /**
+     * @brief Gets the batch of the lanes of a type, which is empty if there
+     * are no such lanes.
+     *
+     * @param laneType      The lane type.
+     * @returns             The batch.
+     */
+    const Batch& batch(LaneType laneType) const { return batches_[static_cast<int>(laneType)]; }
+
+    /**
+     * @brief The batches, by lane type.
+     */
+    std::vector<Batch> batches_;
+
+    /**
+     * @brief The range of indices of each lane within the batch of its type,
+     * by the global index of the lane (see LaneSection::Lane::globalIndex()).
+     */
+    std::vector<LaneRange> laneRanges_;
+};
+
+/**
+ * @brief Builds a LaneMesh from the lane boundaries of an XodrMap.
+ *
+ * The boundaries are tessellated with a MapTessellator, after which the
+ * batches are assembled in the order of the roads, lane sections and lanes, so
+ * the resulting mesh doesn't depend on the number of threads.
+ */
+class LaneMeshBuilder
+{
+  public:
+    /**
+     * @brief Options which control how a LaneMesh is built.
+     */
+    struct Options
+    {
+        /**
+         * @brief The maximum distance between the tessellated lane boundaries
+         * and the exact ones.
+         */
+        double maxError_ = .01;
+
+        /**
+         * @brief The distance within which the end points of lane edges are
+         * welded into a single vertex.
+         *
+         * The edges of consecutive lane sections and linked roads meet
+         * at their end points, but as they're evaluated separately, the end
+         * points generally differ by a rounding error, or by up to a few
+         * millimeters where the map data has small gaps. Welding these makes
+         * the mesh free of cracks.
+         */
+        double weldTolerance_ = .01;
+
+        /**
+         * @brief The number of threads used to tessellate the boundaries, see
+         * MapTessellator::Options::numThreads_.
+         */
+        int numThreads_ = 0;
+    };
+
+    /**
+     * @brief Creates a LaneMeshBuilder for the given map, which must outlive
+     * it.
+     *
+     * @param map           The map.
+     */
+    explicit LaneMeshBuilder(const XodrMap& map);
+
+    /**
+     * @brief Builds the mesh of all lanes of the map, reusing the buffers of
+     * @p mesh.
+     *
+     * @param options       The options.
+     * @param mesh          Receives the mesh.
+     */
+    void build(const Options& options, LaneMesh& mesh);
+
+  private:
+    void addLaneSection(LaneSectionKey laneSectionKey, LaneMesh& mesh);
+    uint32_t addEdge(int boundaryIndex, const double* elevations, const double* heights, LaneMesh::Batch& batch,
+                     std::vector<uint32_t>& endPoints);
+    void weld(double tolerance, LaneMesh& mesh, LaneMesh::Batch& batch, std::vector<uint32_t>& endPoints);
+
+    const XodrMap& map_;
+    MapTessellator tessellator_;
+
+    /**
+     * @brief The indices of the vertices at the end points of the boundaries,
+     * by lane type.
+     */
+    std::vector<std::vector<uint32_t>> endPoints_;
+
+    /**
+     * @brief Buffers for the height offsets of the lanes, see
+     * LaneSection::evalLaneHeights().
+     */
+    std::vector<double> laneHeights_;
+    std::vector<double> prevRightHeights_;
+
+    /**
+     * @brief Buffers for weld().
+     */
+    std::vector<uint32_t> vertexRemap_;
+    std::vector<uint32_t> newVertexIndices_;
+};
+
+}}  // namespace aid::xodr
@@ -0,0 +1,262 @@
+#include "lane_router.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "parallel_for.h"
+
+namespace aid { namespace xodr {
+
+namespace {
+
+/**
+ * @brief Converts a speed limit to meters per second.
+ */
+double metersPerSecond(const LaneSpeedLimit& speedLimit)
+{
+    switch (speedLimit.unit())
+    {
+        case SpeedUnit::MILES_PER_HOUR:
+            return speedLimit.maxSpeed() * .44704;
+
+        case SpeedUnit::KILOMETERS_PER_HOUR:
+            return speedLimit.maxSpeed() / 3.6;
+
+        default:
+            return speedLimit.maxSpeed();
+    }
+}
+
+/**
+ * @brief Gets the mean of the reciprocal of the speed along a lane, weighted by
+ * the length along the reference line over which each speed limit applies.
+ *
+ * @param lane          The lane.
+ * @param length        The length of the lane section.
+ * @param defaultSpeed  The speed where there's no (positive) speed limit.
+ */
+double meanInverseSpeed(const LaneSection::Lane& lane, double length, double defaultSpeed)
+{
+    const ArenaVector<LaneSpeedLimit>& speedLimits = lane.speedLimits();
+    if (speedLimits.empty() || length <= 0)
+    {
+        return 1 / defaultSpeed;
+    }
+
+    double sum = 0;
+    double prevS = 0;
+    double prevInverseSpeed = 1 / defaultSpeed;
+    for (const LaneSpeedLimit& speedLimit : speedLimits)
+    {
+        double s = std::min(std::max(speedLimit.sOffset(), prevS), length);
+        sum += (s - prevS) * prevInverseSpeed;
+        prevS = s;
+
+        double speed = metersPerSecond(speedLimit);
+        prevInverseSpeed = 1 / (speed > 0 ? speed : defaultSpeed);
+    }
+    sum += (length - prevS) * prevInverseSpeed;
+
+    return sum / length;
+}
+
+}  // namespace
+
+LaneRouter::Options::Options()
+{
+    laneTypeCostFactors_.fill(std::numeric_limits<double>::infinity());
+    for (LaneType type : {LaneType::DRIVING, LaneType::BIDIRECTIONAL, LaneType::ENTRY, LaneType::EXIT,
+                          LaneType::OFF_RAMP, LaneType::ON_RAMP, LaneType::CONNECTING_RAMP})
+    {
+        laneTypeCostFactors_[static_cast<int>(type)] = 1;
+    }
+}
+
+LaneRouter::LaneRouter(const XodrMap& map, const LaneGraph& graph, const Options& options)
+    : map_(map), graph_(graph)
+{
+    laneCosts_.resize(map.totalNumLanes());
+    startPoints_.resize(map.totalNumLanes());
+    laneKeys_.resize(map.totalNumLanes());
+
+    std::vector<double> offsets;
+    for (int roadIdx = 0; roadIdx < static_cast<int>(map.roads().size()); roadIdx++)
+    {
+        const Road& road = map.roads()[roadIdx];
+        double roadEndS = road.referenceLine().endS();
+
+        const ArenaVector<LaneSection>& laneSections = road.laneSections();
+        for (int i = 0; i < static_cast<int>(laneSections.size()); i++)
+        {
+            const LaneSection& laneSection = laneSections[i];
+            double startS = std::min(laneSection.startS(), roadEndS);
+            double endS = std::min(laneSection.endS(), roadEndS);
+
+            const ArenaVector<LaneSection::Lane>& lanes = laneSection.lanes();
+            for (int j = 0; j < static_cast<int>(lanes.size()); j++)
+            {
+                const LaneSection::Lane& lane = lanes[j];
+                int globalLaneIdx = lane.globalIndex();
+                laneKeys_[globalLaneIdx] = LaneKey(roadIdx, i, j);
+
+                double factor = options.laneTypeCostFactors_[static_cast<int>(lane.type())];
+                laneCosts_[globalLaneIdx] =
+                    std::isinf(factor) ? factor
+                                       : graph.laneLength(globalLaneIdx) *
+                                             meanInverseSpeed(lane, endS - startS, options.defaultSpeed_) * factor;
+
+                // Right lanes start at the start of the lane section, left
+                // lanes at its end, see LaneGraph.
+                double s = j < laneSection.numLeftLanes() ? endS : startS;
+                offsets.resize(lanes.size() + 1);
+                laneSection.evalBoundaryOffsets(s, offsets.data());
+                startPoints_[globalLaneIdx] = road.pose(s, (offsets[j] + offsets[j + 1]) / 2).position_.head<2>();
+            }
+        }
+    }
+
+    double maxDistancePerCost = 0;
+    for (int from = 0; from < graph.numLanes(); from++)
+    {
+        if (std::isinf(laneCosts_[from]))
+        {
+            continue;
+        }
+
+        for (int i = 0; i < graph.numSuccessors(from); i++)
+        {
+            int to = graph.successors(from)[i];
+            if (std::isinf(laneCosts_[to]))
+            {
+                continue;
+            }
+
+            double distance = (startPoints_[to] - startPoints_[from]).norm();
+            if (distance > 0)
+            {
+                maxDistancePerCost = std::max(maxDistancePerCost, distance / laneCosts_[from]);
+            }
+        }
+    }
+
+    costPerDistance_ = maxDistancePerCost > 0 ? 1 / maxDistancePerCost : 0;
+}
+
+LaneRouter::Route LaneRouter::findRoute(const LaneKey& from, const LaneKey& to, SearchState& state,
+                                        Algorithm algorithm) const
+{
+    int source = globalLaneIndex(from);
+    int target = globalLaneIndex(to);
+
+    Route ret;
+    state.numSettled_ = 0;
+    if (std::isinf(laneCosts_[source]) || std::isinf(laneCosts_[target]))
+    {
+        return ret;
+    }
+
+    if (state.costs_.size() != laneCosts_.size())
+    {
+        state.costs_.resize(laneCosts_.size());
+        state.parents_.resize(laneCosts_.size());
+        state.stamps_.assign(laneCosts_.size(), 0);
+    }
+
+    if (++state.stamp_ == 0)
+    {
+        std::fill(state.stamps_.begin(), state.stamps_.end(), 0);
+        state.stamp_ = 1;
+    }
+
+    // The standard heap functions keep the greatest element at the front, so
+    // this orders the entries by decreasing priority.
+    auto heapCompare = [](const SearchState::HeapEntry& a, const SearchState::HeapEntry& b) {
+        return a.priority_ > b.priority_ || (a.priority_ == b.priority_ && a.lane_ > b.lane_);
+    };
+
+    double costPerDistance = algorithm == Algorithm::A_STAR ? costPerDistance_ : 0;
+    const Eigen::Vector2d& targetPoint = startPoints_[target];
+
+    state.heap_.clear();
+    state.costs_[source] = 0;
+    state.parents_[source] = -1;
+    state.stamps_[source] = state.stamp_;
+    state.heap_.push_back({(startPoints_[source] - targetPoint).norm() * costPerDistance, 0, source});
+
+    bool found = false;
+    while (!state.heap_.empty())
+    {
+        std::pop_heap(state.heap_.begin(), state.heap_.end(), heapCompare);
+        SearchState::HeapEntry entry = state.heap_.back();
+        state.heap_.pop_back();
+
+        // Lanes are pushed again when their cost decreases, rather than
+        // updated in place, so skip the outdated entries.
+        if (entry.cost_ > state.costs_[entry.lane_])
+        {
+            continue;
+        }
+
+        state.numSettled_++;
+        if (entry.lane_ == target)
+        {
+            found = true;
+            break;
+        }
+
+        double laneCost = laneCosts_[entry.lane_];
+        const int* successors = graph_.successors(entry.lane_);
+        for (int i = 0; i < graph_.numSuccessors(entry.lane_); i++)
+        {
+            int successor = successors[i];
+            if (std::isinf(laneCosts_[successor]))
+            {
+                continue;
+            }
+
+            double cost = entry.cost_ + laneCost;
+            if (state.stamps_[successor] != state.stamp_ || cost < state.costs_[successor])
+            {
+                state.costs_[successor] = cost;
+                state.parents_[successor] = entry.lane_;
+                state.stamps_[successor] = state.stamp_;
+
+                double priority = cost + (startPoints_[successor] - targetPoint).norm() * costPerDistance;
+                state.heap_.push_back({priority, cost, successor});
+                std::push_heap(state.heap_.begin(), state.heap_.end(), heapCompare);
+            }
+        }
+    }
+
+    if (!found)
+    {
+        return ret;
+    }
+
+    ret.cost_ = state.costs_[target];
+    for (int lane = target; lane >= 0; lane = state.parents_[lane])
+    {
+        ret.lanes_.push_back(laneKeys_[lane]);
+    }
+    std::reverse(ret.lanes_.begin(), ret.lanes_.end());
+
+    return ret;
+}
+
+void LaneRouter::findRoutes(const Query* queries, int numQueries, Route* out, int numThreads) const
+{
+    numThreads = resolveNumThreads(numThreads);
+    std::vector<SearchState> states(numThreads);
+
+    parallelFor(numThreads, numQueries, [&](size_t i, int threadIdx) {
+        out[i] = findRoute(queries[i].from_, queries[i].to_, states[threadIdx]);
+    });
+}
+
+int LaneRouter::globalLaneIndex(const LaneKey& key) const
+{
+    const LaneSection& laneSection = map_.roads().at(key.roadIdx_).laneSections().at(key.laneSectionIdx_);
+    return laneSection.lanes().at(key.laneIdx_).globalIndex();
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <Eigen/Dense>
+
+#include "lane_graph.h"
+#include "lane_section.h"
+#include "xodr_map.h"
+#include "xodr_map_keys.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Finds shortest routes between lanes, over the edges of a LaneGraph.
+ *
+ * The cost of a lane is the time it takes to traverse it: its length (see
+ * LaneGraph::laneLength()) divided by its speed limit, or by
+ * Options::defaultSpeed_ where it has none, multiplied by the cost factor of
+ * its lane type. Lanes whose type has an infinite cost factor aren't used. The
+ * cost of a route is the sum of the costs of its lanes, except the last one,
+ * so it's the time from the start of the first lane to the start of the last
+ * one.
+ *
+ * Routes are found with A*, or with Dijkstra's algorithm, which is the same
+ * search without a heuristic. The heuristic is the Euclidean distance from
+ * the start of a lane to the start of the target lane, divided by the largest
+ * ratio of the distance between the start points of the lanes of an edge and
+ * the cost of the edge. So it's consistent, and both algorithms find routes
+ * with the same (minimal) cost. The start points are evaluated on the
+ * reference lines, at the lateral offset of the center of the lane.
+ *
+ * A search uses a SearchState, which holds the per-lane data and the binary
+ * heap of the search, so they're only allocated by the first search which uses
+ * it. A router can be used from multiple threads concurrently, as long as each
+ * thread uses its own SearchState.
+ */
+class LaneRouter
+{
+  public:
+    /**
+     * @brief Options which control the costs of the lanes.
+     */
+    struct Options
+    {
+        /**
+         * @brief Creates the default options, with a cost factor of 1 for the
+         * lane types which are meant for cars, and an infinite cost factor for
+         * the other types.
+         */
+        Options();
+
+        /**
+         * @brief The speed in meters per second of the parts of lanes which
+         * have no speed limit.
+         */
+        double defaultSpeed_ = 50 / 3.6;
+
+        /**
+         * @brief The cost factor of each lane type, indexed by the LaneType.
+         *
+         * The factors must be positive. Lanes with an infinite factor are
+         * never entered.
+         */
+        std::array<double, NUM_LANE_TYPES> laneTypeCostFactors_;
+    };
+
+    /**
+     * @brief The search algorithm used by findRoute().
+     */
+    enum class Algorithm
+    {
+        DIJKSTRA,
+        A_STAR
+    };
+
+    /**
+     * @brief A route between two lanes.
+     */
+    struct Route
+    {
+        /**
+         * @brief The cost of the route, or infinity if there's no route.
+         */
+        double cost_ = std::numeric_limits<double>::infinity();
+
+        /**
+         * @brief The lanes of the route, from the start lane to the target
+         * lane, or empty if there's no route.
+         */
+        std::vector<LaneKey> lanes_;
+    };
+
+    /**
+     * @brief A query for a route, see findRoutes().
+     */
+    struct Query
+    {
+        LaneKey from_;
+        LaneKey to_;
+    };
+
+    /**
+     * @brief The state of a search, which is reused by subsequent searches to
+     * avoid allocations.
+     */
+    class SearchState
+    {
+      public:
+        /**
+         * @returns The number of lanes which were settled (whose cost was
+         * final) by the last search.
+         */
+        int numSettled() const { return numSettled_; }
+
+      private:
+        friend class LaneRouter;
+
+        struct HeapEntry
+        {
+            double priority_;
+            double cost_;
+            int lane_;
+        };
+
+        /**
+         * @brief The costs and parents of the lanes are only valid if their
+         * stamp equals stamp_, so they don't need to be reset between
+         * searches.
+         */
+        std::vector<double> costs_;
+        std::vector<int> parents_;
+        std::vector<uint32_t> stamps_;
+        uint32_t stamp_ = 0;
+
+        std::vector<HeapEntry> heap_;
+        int numSettled_ = 0;
+    };
+
+    /**
+     * @brief Creates a router.
+     *
+     * @param map           The map, which must outlive the router.
+     * @param graph         The graph of the lanes of @p map, which must
+     *                      outlive the router.
+     * @param options       The options.
+     */
+    LaneRouter(const XodrMap& map, const LaneGraph& graph, const Options& options);
+
+    /**
+     * @brief Gets the cost of a lane.
+     *
+     * @param lane          The global index of the lane.
+     * @returns             The cost, which is infinite if the lane can't be
+     *                      used.
+     */
+    double laneCost(int lane) const { return laneCosts_[lane]; }
+
+    /**
+     * @brief Finds the route with the lowest cost between two lanes.
+     *
+     * @param from          The start lane.
+     * @param to            The target lane.
+     * @param state         The search state.
+     * @param algorithm     The search algorithm.
+     * @returns             The route, which has an infinite cost and no
+     *                      lanes if there's no route, or if one of the lanes
+     *                      can't be used.
+     * @throws std::out_of_range if one of the lane keys is invalid.
+     */
+    Route findRoute(const LaneKey& from, const LaneKey& to, SearchState& state,
+                    Algorithm algorithm = Algorithm::A_STAR) const;
+
+    /**
+     * @brief Finds the routes of a batch of queries with A*.
+     *
+     * @param queries       The queries.
+     * @param numQueries    The number of queries.
+     * @param out           Receives the @p numQueries routes.
+     * @param numThreads    The number of threads over which the queries are
+     *                      distributed, or 0 for one per hardware thread.
+     */
+    void findRoutes(const Query* queries, int numQueries, Route* out, int numThreads = 0) const;
+
+  private:
+    /**
+     * @brief Gets the global index of the lane with the given key.
+     */
+    int globalLaneIndex(const LaneKey& key) const;
+
+    const XodrMap& map_;
+    const LaneGraph& graph_;
+
+    std::vector<double> laneCosts_;
+
+    /**
+     * @brief The start point of each lane, see LaneRouter.
+     */
+    std::vector<Eigen::Vector2d> startPoints_;
+
+    /**
+     * @brief The reciprocal of the largest ratio of the distance between the
+     * start points of the lanes of an edge and its cost, which converts
+     * distances to lower bounds of costs. It's 0 if there are edges without
+     * cost between distinct points.
+     */
+    double costPerDistance_;
+
+    /**
+     * @brief The key of each lane, by its global index.
+     */
+    std::vector<LaneKey> laneKeys_;
+};
+
+}}  // namespace aid::xodr
@@ -1,43 +1,137 @@
 #include "lane_section.h"
 
+#include <algorithm>
 #include <cmath>
 #include <climits>
 
+#include "simd_math.h"
+
 namespace aid { namespace xodr {
 
 LaneSection::Lane::Lane() : predecessor_(LaneIDOpt::null()), successor_(LaneIDOpt::null()) {}
 
+ReferenceLine::TessellationTolerance LaneSection::boundaryTessellationTolerance(double maxError) const
+{
+    // The lateral offset of a boundary is the sum of the widths of the lanes
+    // between it and the reference line, so the extremes of the widths bound
+    // the offsets of the outermost boundary on each side.
+    double maxOffsets[2] = {0, 0};
+    double maxSecondDerivatives[2] = {0, 0};
+
+    double length = endS_ - startS_;
+    for (int i = 0; i < static_cast<int>(lanes_.size()); i++)
+    {
+        const ArenaVector<WidthPoly3>& widths = lanes_[i].widthPoly3s_;
+
+        double maxWidth = 0;
+        double maxWidthSecondDerivative = 0;
+        for (int j = 0; j < static_cast<int>(widths.size()); j++)
+        {
+            // The first polynomial also applies before its sOffset(), see
+            // tessellateLaneBoundariesSide().
+            double begin = (j == 0 ? 0 : widths[j].sOffset()) - widths[j].sOffset();
+            double end = (j + 1 < static_cast<int>(widths.size()) ? widths[j + 1].sOffset() : length) -
+                         widths[j].sOffset();
+            if (end <= begin)
+            {
+                continue;
+            }
+
+            const Poly3& poly = widths[j].poly3();
+            maxWidth = std::max({maxWidth, std::abs(poly.maxValueInInterval(begin, end)),
+                                 std::abs(poly.minValueInInterval(begin, end))});
+
+            // The second derivative is linear.
+            maxWidthSecondDerivative = std::max({maxWidthSecondDerivative, std::abs(poly.eval2ndDerivative(begin)),
+                                                 std::abs(poly.eval2ndDerivative(end))});
+        }
+
+        int side = i < numLeftLanes_ ? 0 : 1;
+        maxOffsets[side] += maxWidth;
+        maxSecondDerivatives[side] += maxWidthSecondDerivative;
+    }
+
+    ReferenceLine::TessellationTolerance ret;
+    ret.maxError_ = maxError;
+    ret.maxLateralOffset_ = std::max(maxOffsets[0], maxOffsets[1]);
+    ret.maxLateralSecondDerivative_ = std::max(maxSecondDerivatives[0], maxSecondDerivatives[1]);
+    return ret;
+}
+
 std::vector<LaneSection::BoundaryTessellation> LaneSection::tessellateLaneBoundaries(
     const ReferenceLine::Tessellation& refLineTessellation) const
+{
+    LaneTessellationBuffer buffer;
+    tessellateLaneBoundaries(refLineTessellation, buffer);
+
+    std::vector<BoundaryTessellation> ret;
+    ret.resize(buffer.numBoundaries());
+    for (int i = 0; i < buffer.numBoundaries(); i++)
+    {
+        auto begin = buffer.lateralPositions_.begin();
+        ret[i].lateralPositions_.assign(begin + buffer.boundaryOffsets_[i], begin + buffer.boundaryOffsets_[i + 1]);
+    }
+
+    return ret;
+}
+
+void LaneSection::tessellateLaneBoundaries(const ReferenceLine::Tessellation& refLineTessellation,
+                                           LaneTessellationBuffer& out) const
 {
     assert(!refLineTessellation.empty());
+
+    tessellateLaneBoundaries([&](int i) { return refLineTessellation[i].sCoord_; },
+                             static_cast<int>(refLineTessellation.size()), out);
+}
+
+void LaneSection::tessellateLaneBoundaries(const ReferenceLine::FrenetFrames& refLineFrames,
+                                           LaneTessellationBuffer& out) const
+{
+    assert(refLineFrames.size() > 0);
+
+    const double* sCoords = refLineFrames.sCoords_.data();
+    tessellateLaneBoundaries([sCoords](int i) { return sCoords[i]; }, refLineFrames.size(), out);
+}
+
+template <typename SCoordFn>
+void LaneSection::tessellateLaneBoundaries(SCoordFn sCoordAt, int numPoints, LaneTessellationBuffer& out) const
+{
     assert(numLeftLanes_ <= static_cast<int>(lanes_.size()));
 
-    std::vector<BoundaryTessellation> ret;
-    ret.resize(lanes_.size() + 1);
+    int numBoundaries = static_cast<int>(lanes_.size()) + 1;
 
-    std::vector<double>& centerOut = ret[numLeftLanes_].lateralPositions_;
-    centerOut.resize(refLineTessellation.size());
-    std::fill(centerOut.begin(), centerOut.end(), 0);
+    out.lateralPositions_.resize(numBoundaries * numPoints);
+    out.boundaryOffsets_.resize(numBoundaries + 1);
+    for (int i = 0; i <= numBoundaries; i++)
+    {
+        out.boundaryOffsets_[i] = i * numPoints;
+    }
+
+    out.boundaryVertices_.clear();
+    out.centerLineVertices_.clear();
+    out.variances_.clear();
+    out.centerLineOffsets_.clear();
+    out.laneEdgeVertices_.clear();
+
+    double* centerOut = out.lateralPositions_.data() + numLeftLanes_ * numPoints;
+    std::fill(centerOut, centerOut + numPoints, 0);
 
     // Tessellate the left lanes.
     if (numLeftLanes_)
     {
-        tessellateLaneBoundariesSide(refLineTessellation, ret.data() + numLeftLanes_, numLeftLanes_ - 1, -1, -1);
+        tessellateLaneBoundariesSide(sCoordAt, numPoints, centerOut, numLeftLanes_ - 1, -1, -1);
     }
 
     // Tessellate the right lanes.
     if (numLeftLanes_ < static_cast<int>(lanes_.size()))
     {
-        tessellateLaneBoundariesSide(refLineTessellation, ret.data() + numLeftLanes_, numLeftLanes_, lanes_.size(), 1);
+        tessellateLaneBoundariesSide(sCoordAt, numPoints, centerOut, numLeftLanes_, lanes_.size(), 1);
     }
-
-    return ret;
 }
 
-void LaneSection::tessellateLaneBoundariesSide(const ReferenceLine::Tessellation& refLineTessellation,
-                                               BoundaryTessellation* boundaryIt, int lanesBegin, int lanesEnd,
-                                               int stepDir) const
+template <typename SCoordFn>
+void LaneSection::tessellateLaneBoundariesSide(SCoordFn sCoordAt, int numPoints, double* boundaryIt, int lanesBegin,
+                                               int lanesEnd, int stepDir) const
 {
     assert(stepDir == -1 || stepDir == 1);
 
@@ -47,25 +141,23 @@ void LaneSection::tessellateLaneBoundariesSide(const ReferenceLine::Tessellation
     // lanesEnd > lanesBegin implies stepDir must be 1.
     assert(!(lanesEnd > lanesBegin) || stepDir == 1);
 
-    BoundaryTessellation* prevBoundaryIt = boundaryIt;
-    boundaryIt += stepDir;
+    int boundaryStride = numPoints * stepDir;
+
+    const double* prevBoundaryIt = boundaryIt;
+    boundaryIt += boundaryStride;
 
     for (int i = lanesBegin; i != lanesEnd; i += stepDir)
     {
-        auto refLineIt = refLineTessellation.begin();
-
-        auto innerBoundaryIt = prevBoundaryIt->lateralPositions_.begin();
-
-        boundaryIt->lateralPositions_.resize(refLineTessellation.size());
-        auto outerBoundaryIt = boundaryIt->lateralPositions_.begin();
+        const double* innerBoundaryIt = prevBoundaryIt;
+        double* outerBoundaryIt = boundaryIt;
 
         auto curPolyIt = lanes_[i].widthPoly3s_.begin();
         auto endPolyIt = lanes_[i].widthPoly3s_.end();
         auto nextPolyIt = curPolyIt + 1;
 
-        while (refLineIt != refLineTessellation.end())
+        for (int j = 0; j < numPoints; j++)
         {
-            double param = refLineIt->sCoord_ - startS_;
+            double param = sCoordAt(j) - startS_;
 
             // If we're past the sOffset_ of the next polynomial (if one exists),
             // then keep advancing until we found the polynomial our current param lies in.
@@ -78,33 +170,42 @@ void LaneSection::tessellateLaneBoundariesSide(const ReferenceLine::Tessellation
             double ds = param - curPolyIt->sOffset();
             *outerBoundaryIt = *innerBoundaryIt + curPolyIt->poly3().eval(ds) * -stepDir;
 
-            refLineIt++;
             innerBoundaryIt++;
             outerBoundaryIt++;
         }
 
         prevBoundaryIt = boundaryIt;
-        boundaryIt += stepDir;
+        boundaryIt += boundaryStride;
     }
 }
 
 std::vector<LaneSection::BoundaryCurveTessellation> LaneSection::tessellateLaneBoundaryCurves(
     const ReferenceLine::Tessellation& refLineTessellation) const
 {
-    assert(!refLineTessellation.empty());
-
-    auto boundaries = tessellateLaneBoundaries(refLineTessellation);
-
-    int numPoints = static_cast<int>(refLineTessellation.size());
-    int numBoundaries = static_cast<int>(boundaries.size());
+    LaneTessellationBuffer buffer;
+    tessellateLaneBoundaryCurves(refLineTessellation, buffer);
 
     std::vector<BoundaryCurveTessellation> ret;
-    ret.resize(numBoundaries);
-    for (int i = 0; i < numBoundaries; i++)
+    ret.resize(buffer.numBoundaries());
+    for (int i = 0; i < buffer.numBoundaries(); i++)
     {
-        ret[i].vertices_.resize(numPoints);
+        ret[i].vertices_.assign(buffer.boundaryVertices(i), buffer.boundaryVertices(i) + buffer.boundarySize(i));
     }
 
+    return ret;
+}
+
+/**
+ * @brief Computes the positions of the vertices of the boundaries from their
+ * lateral positions.
+ */
+static void computeBoundaryVertices(const ReferenceLine::Tessellation& refLineTessellation,
+                                    LaneSection::LaneTessellationBuffer& out)
+{
+    int numPoints = static_cast<int>(refLineTessellation.size());
+    int numBoundaries = out.numBoundaries();
+
+    out.boundaryVertices_.resize(out.lateralPositions_.size());
     for (int i = 0; i < numPoints; i++)
     {
         Eigen::Vector2d pt = refLineTessellation[i].position_;
@@ -114,30 +215,28 @@ std::vector<LaneSection::BoundaryCurveTessellation> LaneSection::tessellateLaneB
 
         for (int j = 0; j < numBoundaries; j++)
         {
-            double lateral = boundaries[j].lateralPositions_[i];
-            ret[j].vertices_[i] = pt + perp * lateral;
+            double lateral = out.lateralPositions_[j * numPoints + i];
+            out.boundaryVertices_[j * numPoints + i] = pt + perp * lateral;
         }
     }
-
-    return ret;
 }
 
-std::vector<LaneSection::CenterLineTessellation> LaneSection::tessellateLaneCenterLines(
-    const ReferenceLine::Tessellation& refLineTessellation) const
+/**
+ * @brief Computes the center lines and variances of the lanes from the lateral
+ * positions of their boundaries.
+ */
+static void computeCenterLines(const ReferenceLine::Tessellation& refLineTessellation,
+                               LaneSection::LaneTessellationBuffer& out)
 {
-    assert(!refLineTessellation.empty());
-
-    std::vector<LaneSection::CenterLineTessellation> ret;
-
-    auto boundaries = tessellateLaneBoundaries(refLineTessellation);
+    int numPoints = static_cast<int>(refLineTessellation.size());
+    int numLanes = out.numBoundaries() - 1;
 
-    int numPoints = refLineTessellation.size();
-    int numLanes = boundaries.size() - 1;
-    ret.resize(numLanes);
-    for (int i = 0; i < numLanes; i++)
+    out.centerLineVertices_.resize(numLanes * numPoints);
+    out.variances_.resize(numLanes * numPoints);
+    out.centerLineOffsets_.resize(numLanes + 1);
+    for (int i = 0; i <= numLanes; i++)
     {
-        ret[i].vertices_.resize(numPoints);
-        ret[i].variances_.resize(numPoints);
+        out.centerLineOffsets_[i] = i * numPoints;
     }
 
     for (int i = 0; i < numPoints; i++)
@@ -149,67 +248,319 @@ std::vector<LaneSection::CenterLineTessellation> LaneSection::tessellateLaneCent
 
         for (int j = 0; j < numLanes; j++)
         {
-            double variance = .5f * (boundaries[j + 1].lateralPositions_[i] - boundaries[j].lateralPositions_[i]);
+            double innerLateral = out.lateralPositions_[j * numPoints + i];
+            double outerLateral = out.lateralPositions_[(j + 1) * numPoints + i];
+            double variance = .5f * (outerLateral - innerLateral);
 
-            double centerLineLateral = boundaries[j].lateralPositions_[i] + variance;
-            ret[j].vertices_[i] = pt + perp * centerLineLateral;
-            ret[j].variances_[i] = variance;
+            double centerLineLateral = innerLateral + variance;
+            out.centerLineVertices_[j * numPoints + i] = pt + perp * centerLineLateral;
+            out.variances_[j * numPoints + i] = variance;
         }
     }
+}
+
+void LaneSection::tessellateLaneBoundaryCurves(const ReferenceLine::Tessellation& refLineTessellation,
+                                               LaneTessellationBuffer& out) const
+{
+    tessellateLaneBoundaries(refLineTessellation, out);
+    computeBoundaryVertices(refLineTessellation, out);
+}
+
+/**
+ * @brief Copies the center lines of a LaneTessellationBuffer into separate
+ * CenterLineTessellation's.
+ */
+static std::vector<LaneSection::CenterLineTessellation> centerLineTessellations(
+    const LaneSection::LaneTessellationBuffer& buffer)
+{
+    std::vector<LaneSection::CenterLineTessellation> ret;
+    ret.resize(buffer.numCenterLines());
+    for (int i = 0; i < buffer.numCenterLines(); i++)
+    {
+        int begin = buffer.centerLineOffsets_[i];
+        int end = buffer.centerLineOffsets_[i + 1];
+        ret[i].vertices_.assign(buffer.centerLineVertices_.begin() + begin, buffer.centerLineVertices_.begin() + end);
+        ret[i].variances_.assign(buffer.variances_.begin() + begin, buffer.variances_.begin() + end);
+    }
 
     return ret;
 }
 
+std::vector<LaneSection::CenterLineTessellation> LaneSection::tessellateLaneCenterLines(
+    const ReferenceLine::Tessellation& refLineTessellation) const
+{
+    LaneTessellationBuffer buffer;
+    tessellateLaneCenterLines(refLineTessellation, buffer);
+    return centerLineTessellations(buffer);
+}
+
+void LaneSection::tessellateLaneCenterLines(const ReferenceLine::Tessellation& refLineTessellation,
+                                            LaneTessellationBuffer& out) const
+{
+    tessellateLaneBoundaries(refLineTessellation, out);
+    computeCenterLines(refLineTessellation, out);
+}
+
 LaneSection::BoundaryCurveAndCenterLineTessellations LaneSection::tessellateLaneBoundaryCurvesAndCenterLines(
     const ReferenceLine::Tessellation& refLineTessellation) const
 {
-    assert(!refLineTessellation.empty());
+    LaneTessellationBuffer buffer;
+    tessellateLaneBoundaryCurvesAndCenterLines(refLineTessellation, buffer);
 
     BoundaryCurveAndCenterLineTessellations ret;
+    ret.boundaryCurveTessellations_.resize(buffer.numBoundaries());
+    for (int i = 0; i < buffer.numBoundaries(); i++)
+    {
+        ret.boundaryCurveTessellations_[i].vertices_.assign(buffer.boundaryVertices(i),
+                                                            buffer.boundaryVertices(i) + buffer.boundarySize(i));
+    }
+    ret.centerLineTessellations_ = centerLineTessellations(buffer);
 
-    auto boundaries = tessellateLaneBoundaries(refLineTessellation);
+    return ret;
+}
 
-    int numPoints = refLineTessellation.size();
-    int numBoundaries = static_cast<int>(boundaries.size());
-    int numLanes = numBoundaries - 1;
+void LaneSection::tessellateLaneBoundaryCurvesAndCenterLines(const ReferenceLine::Tessellation& refLineTessellation,
+                                                             LaneTessellationBuffer& out) const
+{
+    tessellateLaneBoundaries(refLineTessellation, out);
+    computeBoundaryVertices(refLineTessellation, out);
+    computeCenterLines(refLineTessellation, out);
+}
+
+/**
+ * @brief Computes the positions of the vertices of the boundaries from their
+ * lateral positions, by offsetting the reference line vertices along their
+ * normals.
+ */
+static void computeBoundaryVertices(const ReferenceLine::FrenetFrames& refLineFrames,
+                                    LaneSection::LaneTessellationBuffer& out)
+{
+    int numPoints = refLineFrames.size();
+    const double* x = refLineFrames.x_.data();
+    const double* y = refLineFrames.y_.data();
+    const double* tangentX = refLineFrames.tangentX_.data();
+    const double* tangentY = refLineFrames.tangentY_.data();
+
+    out.boundaryVertices_.resize(out.lateralPositions_.size());
+    for (int j = 0; j < out.numBoundaries(); j++)
+    {
+        const double* lateral = out.lateralPositions_.data() + j * numPoints;
+        double* vertices = out.boundaryVertices_[j * numPoints].data();
+
+        XODR_SIMD_LOOP
+        for (int i = 0; i < numPoints; i++)
+        {
+            vertices[2 * i] = x[i] - tangentY[i] * lateral[i];
+            vertices[2 * i + 1] = y[i] + tangentX[i] * lateral[i];
+        }
+    }
+}
 
-    ret.boundaryCurveTessellations_.resize(numBoundaries);
-    for (int i = 0; i < numBoundaries; i++)
+/**
+ * @brief Computes the center lines and variances of the lanes from the lateral
+ * positions of their boundaries, by offsetting the reference line vertices
+ * along their normals.
+ */
+static void computeCenterLines(const ReferenceLine::FrenetFrames& refLineFrames,
+                               LaneSection::LaneTessellationBuffer& out)
+{
+    int numPoints = refLineFrames.size();
+    int numLanes = out.numBoundaries() - 1;
+    const double* x = refLineFrames.x_.data();
+    const double* y = refLineFrames.y_.data();
+    const double* tangentX = refLineFrames.tangentX_.data();
+    const double* tangentY = refLineFrames.tangentY_.data();
+
+    out.centerLineVertices_.resize(numLanes * numPoints);
+    out.variances_.resize(numLanes * numPoints);
+    out.centerLineOffsets_.resize(numLanes + 1);
+    for (int j = 0; j <= numLanes; j++)
     {
-        ret.boundaryCurveTessellations_[i].vertices_.resize(numPoints);
+        out.centerLineOffsets_[j] = j * numPoints;
     }
 
-    ret.centerLineTessellations_.resize(numLanes);
-    for (int i = 0; i < numLanes; i++)
+    for (int j = 0; j < numLanes; j++)
     {
-        ret.centerLineTessellations_[i].vertices_.resize(numPoints);
-        ret.centerLineTessellations_[i].variances_.resize(numPoints);
+        const double* innerLateral = out.lateralPositions_.data() + j * numPoints;
+        const double* outerLateral = innerLateral + numPoints;
+        double* vertices = out.centerLineVertices_[j * numPoints].data();
+        double* variances = out.variances_.data() + j * numPoints;
+
+        XODR_SIMD_LOOP
+        for (int i = 0; i < numPoints; i++)
+        {
+            double variance = .5 * (outerLateral[i] - innerLateral[i]);
+            double centerLineLateral = innerLateral[i] + variance;
+            vertices[2 * i] = x[i] - tangentY[i] * centerLineLateral;
+            vertices[2 * i + 1] = y[i] + tangentX[i] * centerLineLateral;
+            variances[i] = variance;
+        }
     }
+}
+
+void LaneSection::tessellateLaneBoundaryCurves(const ReferenceLine::FrenetFrames& refLineFrames,
+                                               LaneTessellationBuffer& out) const
+{
+    tessellateLaneBoundaries(refLineFrames, out);
+    computeBoundaryVertices(refLineFrames, out);
+}
 
+void LaneSection::tessellateLaneCenterLines(const ReferenceLine::FrenetFrames& refLineFrames,
+                                            LaneTessellationBuffer& out) const
+{
+    tessellateLaneBoundaries(refLineFrames, out);
+    computeCenterLines(refLineFrames, out);
+}
+
+void LaneSection::tessellateLaneBoundaryCurvesAndCenterLines(const ReferenceLine::FrenetFrames& refLineFrames,
+                                                             LaneTessellationBuffer& out) const
+{
+    tessellateLaneBoundaries(refLineFrames, out);
+    computeBoundaryVertices(refLineFrames, out);
+    computeCenterLines(refLineFrames, out);
+}
+
+template <typename Fn>
+void LaneSection::forEachLaneHeight(int laneIdx, const double* sCoords, int numPoints, Fn fn) const
+{
+    assert(laneIdx >= 0 && laneIdx < static_cast<int>(lanes_.size()));
+
+    const ArenaVector<LaneHeight>& heights = lanes_[laneIdx].heights();
+    auto nextHeightIt = heights.begin();
+    double inner = 0;
+    double outer = 0;
     for (int i = 0; i < numPoints; i++)
     {
-        Eigen::Vector2d pt = refLineTessellation[i].position_;
-        double heading = refLineTessellation[i].heading_;
+        // Each LaneHeight applies from its s-offset up to that of the next.
+        double param = sCoords[i] - startS_;
+        while (nextHeightIt != heights.end() && param >= nextHeightIt->sOffset())
+        {
+            inner = nextHeightIt->inner();
+            outer = nextHeightIt->outer();
+            nextHeightIt++;
+        }
 
-        Eigen::Vector2d perp(-std::sin(heading), std::cos(heading));
+        fn(i, inner, outer);
+    }
+}
 
-        for (int j = 0; j < numBoundaries; j++)
+void LaneSection::evalLaneHeights(int laneIdx, const double* sCoords, int numPoints, double* innerOut,
+                                  double* outerOut) const
+{
+    forEachLaneHeight(laneIdx, sCoords, numPoints, [=](int i, double inner, double outer) {
+        innerOut[i] = inner;
+        outerOut[i] = outer;
+    });
+}
+
+LaneSection::BoundaryCursor::BoundaryCursor(const LaneSection& laneSection)
+    : laneSection_(laneSection), polyIndices_(laneSection.lanes_.size(), 0)
+{
+}
+
+const LaneSection::WidthPoly3& LaneSection::BoundaryCursor::seek(int laneIdx, double localS)
+{
+    const ArenaVector<WidthPoly3>& polys = laneSection_.lanes_[laneIdx].widthPoly3s_;
+    int numPolys = static_cast<int>(polys.size());
+    int& polyIdx = polyIndices_[laneIdx];
+
+    // The first polynomial also applies before its sOffset(), like in
+    // tessellateLaneBoundariesSide().
+    bool afterBegin = polyIdx == 0 || localS >= polys[polyIdx].sOffset();
+    bool beforeEnd = polyIdx + 1 == numPolys || localS < polys[polyIdx + 1].sOffset();
+    if (afterBegin && beforeEnd)
+    {
+        return polys[polyIdx];
+    }
+
+    if (afterBegin && (polyIdx + 2 == numPolys || localS < polys[polyIdx + 2].sOffset()))
+    {
+        polyIdx++;
+    }
+    else
+    {
+        auto it = std::upper_bound(polys.begin() + 1, polys.end(), localS,
+                                   [](double s, const WidthPoly3& poly) { return s < poly.sOffset(); });
+        polyIdx = static_cast<int>(it - polys.begin()) - 1;
+    }
+
+    return polys[polyIdx];
+}
+
+void LaneSection::BoundaryCursor::boundaryOffsets(double s, double* offsets, double* derivatives)
+{
+    int numLanes = static_cast<int>(laneSection_.lanes_.size());
+    int centerIdx = laneSection_.numLeftLanes_;
+    double localS = s - laneSection_.startS_;
+
+    // The width of each lane is added to the offset of its inner boundary,
+    // walking outward from the reference line on both sides.
+    offsets[centerIdx] = 0;
+    double derivative = 0;
+    for (int i = centerIdx - 1; i >= 0; i--)
+    {
+        const WidthPoly3& poly = seek(i, localS);
+        offsets[i] = offsets[i + 1] + poly.poly3().eval(localS - poly.sOffset());
+        if (derivatives)
         {
-            double lateral = boundaries[j].lateralPositions_[i];
-            ret.boundaryCurveTessellations_[j].vertices_[i] = pt + perp * lateral;
+            derivative += poly.poly3().evalDerivative(localS - poly.sOffset());
+            derivatives[i] = derivative;
         }
+    }
 
-        for (int j = 0; j < numLanes; j++)
+    derivative = 0;
+    for (int i = centerIdx; i < numLanes; i++)
+    {
+        const WidthPoly3& poly = seek(i, localS);
+        offsets[i + 1] = offsets[i] - poly.poly3().eval(localS - poly.sOffset());
+        if (derivatives)
         {
-            double variance = .5f * (boundaries[j + 1].lateralPositions_[i] - boundaries[j].lateralPositions_[i]);
-
-            double centerLineLateral = boundaries[j].lateralPositions_[i] + variance;
-            ret.centerLineTessellations_[j].vertices_[i] = pt + perp * centerLineLateral;
-            ret.centerLineTessellations_[j].variances_[i] = variance;
+            derivative -= poly.poly3().evalDerivative(localS - poly.sOffset());
+            derivatives[i + 1] = derivative;
         }
     }
 
-    return ret;
+    if (derivatives)
+    {
+        derivatives[centerIdx] = 0;
+    }
+}
+
+void LaneSection::evalBoundaryOffsets(double s, double* offsets) const
+{
+    BoundaryCursor(*this).boundaryOffsets(s, offsets);
+}
+
+void LaneSection::tessellateLaneBoundaryCurves3D(const ReferenceLine::FrenetFrames& refLineFrames,
+                                                 LaneTessellationBuffer& out) const
+{
+    assert(refLineFrames.hasElevations());
+
+    tessellateLaneBoundaries(refLineFrames, out);
+    computeBoundaryVertices(refLineFrames, out);
+
+    int numPoints = refLineFrames.size();
+    int numLanes = static_cast<int>(lanes_.size());
+    const double* elevations = refLineFrames.elevations_.data();
+
+    out.laneEdgeVertices_.resize(2 * numLanes * numPoints);
+    for (int i = 0; i < numLanes; i++)
+    {
+        const Eigen::Vector2d* leftBoundary = out.boundaryVertices(i);
+        const Eigen::Vector2d* rightBoundary = out.boundaryVertices(i + 1);
+        Eigen::Vector3d* leftEdge = out.laneEdgeVertices_.data() + 2 * i * numPoints;
+        Eigen::Vector3d* rightEdge = leftEdge + numPoints;
+
+        // The outer edge of a left lane is its left edge, and the inner edge
+        // of a right lane is its left edge.
+        bool isLeftLane = i < numLeftLanes_;
+        forEachLaneHeight(i, refLineFrames.sCoords_.data(), numPoints, [&](int j, double inner, double outer) {
+            double leftZ = elevations[j] + (isLeftLane ? outer : inner);
+            double rightZ = elevations[j] + (isLeftLane ? inner : outer);
+            leftEdge[j] = Eigen::Vector3d(leftBoundary[j].x(), leftBoundary[j].y(), leftZ);
+            rightEdge[j] = Eigen::Vector3d(rightBoundary[j].x(), rightBoundary[j].y(), rightZ);
+        });
+    }
 }
 
 LaneID LaneSection::laneIndexToId(int idx) const
@@ -266,6 +617,46 @@ int LaneSection::laneIdToIndex(LaneID id) const
     return idx;
 }
 
+int LaneSection::laneIndexAt(double s, double t) const
+{
+    double localS = s - startS_;
+    if (t > 0 || (t == 0 && numLeftLanes_ > 0))
+    {
+        // Walk the left lanes outward from the reference line.
+        double outer = 0;
+        for (int i = numLeftLanes_ - 1; i >= 0; i--)
+        {
+            outer += lanes_[i].widthAtSCoord(localS);
+            if (t <= outer)
+            {
+                return i;
+            }
+        }
+    }
+    else
+    {
+        double outer = 0;
+        for (int i = numLeftLanes_; i < static_cast<int>(lanes_.size()); i++)
+        {
+            outer -= lanes_[i].widthAtSCoord(localS);
+            if (t >= outer)
+            {
+                return i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+void LaneSection::offsetGlobalLaneIndices(int offset)
+{
+    for (Lane& lane : lanes_)
+    {
+        lane.globalIndex_ += offset;
+    }
+}
+
 void LaneSection::validate() const
 {
     double maxSOffset = endS_ - startS_;
@@ -326,7 +717,7 @@ LaneID LaneSection::Lane::link(RoadLinkType roadLinkType) const
 }
 
 template <class T>
-static void validateAttribSCoords(const std::string& attribsName, double maxSOffset, const std::vector<T>& attribs)
+static void validateAttribSCoords(const std::string& attribsName, double maxSOffset, const ArenaVector<T>& attribs)
 {
     if (attribs.empty())
     {
@@ -364,20 +755,12 @@ void LaneSection::Lane::validate(double maxSOffset) const
 
 double LaneSection::Lane::widthAtSCoord(const double s) const
 {
-    size_t polyIdx;
-    for (polyIdx = 1; polyIdx < widthPoly3s_.size(); polyIdx++)
-    {
-        const auto& poly = widthPoly3s_[polyIdx];
-        if (s < poly.sOffset())
-        {
-            break;
-        }
-    }
-
-    // last poly where sOffset >= poly.sOffset()
-    const auto& poly = widthPoly3s_[polyIdx - 1];
-    auto param = s - poly.sOffset();
-    return poly.poly3().eval(param);
+    // The last polynomial with an sOffset() at or before s, or the first one
+    // if there's none.
+    auto it = std::upper_bound(widthPoly3s_.begin() + 1, widthPoly3s_.end(), s,
+                               [](double sCoord, const WidthPoly3& poly) { return sCoord < poly.sOffset(); });
+    const WidthPoly3& poly = *(it - 1);
+    return poly.poly3().eval(s - poly.sOffset());
 }
 
 }}  // namespace aid::xodr
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <vector>
 #include <Eigen/Dense>
 
 #include "xodr_reader.h"
+#include "xodr_arena.h"
 #include "poly3.h"
 #include "reference_line.h"
 #include "road_link.h"
@@ -20,6 +23,8 @@ enum class LaneType : int;
  */
 class LaneSection
 {
+    friend class XodrBinarySerializer;
+
   public:
     friend class Road;
 
@@ -46,6 +51,7 @@ class LaneSection
     class Lane
     {
         friend class LaneSection;
+        friend class XodrBinarySerializer;
 
       public:
         /**
@@ -142,7 +148,7 @@ class LaneSection
          *
          * @returns         A vector with this lane's width polynomials.
          */
-        const std::vector<WidthPoly3>& widthPoly3s() const { return widthPoly3s_; }
+        const ArenaVector<WidthPoly3>& widthPoly3s() const { return widthPoly3s_; }
 
         /**
          * @name Lane attributes
@@ -161,32 +167,32 @@ class LaneSection
         /**
          * @returns The LaneMaterial attributes associated with this lane.
          */
-        const std::vector<LaneMaterial>& materials() const { return materials_; }
+        const ArenaVector<LaneMaterial>& materials() const { return materials_; }
 
         /**
          * @returns The LaneVisibility attributes associated with this lane.
          */
-        const std::vector<LaneVisibility>& visibilities() const { return visibilities_; }
+        const ArenaVector<LaneVisibility>& visibilities() const { return visibilities_; }
 
         /**
          * @returns The LaneSpeedLimit attributes associated with this lane.
          */
-        const std::vector<LaneSpeedLimit>& speedLimits() const { return speedLimits_; };
+        const ArenaVector<LaneSpeedLimit>& speedLimits() const { return speedLimits_; };
 
         /**
          * @returns The LaneAccess attributes associated with this lane.
          */
-        const std::vector<LaneAccess>& accesses() const { return accesses_; };
+        const ArenaVector<LaneAccess>& accesses() const { return accesses_; };
 
         /**
          * @returns The LaneHeight attributes associated with this lane.
          */
-        const std::vector<LaneHeight>& heights() const { return heights_; }
+        const ArenaVector<LaneHeight>& heights() const { return heights_; }
 
         /**
          * @returns The LaneRule attributes associated with this lane.
          */
-        const std::vector<LaneRule>& rules() const { return rules_; }
+        const ArenaVector<LaneRule>& rules() const { return rules_; }
 
         /** @} */
 
@@ -253,14 +259,14 @@ class LaneSection
         LaneType type_;
         bool level_;
 
-        std::vector<WidthPoly3> widthPoly3s_;
+        ArenaVector<WidthPoly3> widthPoly3s_;
 
-        std::vector<LaneMaterial> materials_;
-        std::vector<LaneVisibility> visibilities_;
-        std::vector<LaneSpeedLimit> speedLimits_;
-        std::vector<LaneAccess> accesses_;
-        std::vector<LaneHeight> heights_;
-        std::vector<LaneRule> rules_;
+        ArenaVector<LaneMaterial> materials_;
+        ArenaVector<LaneVisibility> visibilities_;
+        ArenaVector<LaneSpeedLimit> speedLimits_;
+        ArenaVector<LaneAccess> accesses_;
+        ArenaVector<LaneHeight> heights_;
+        ArenaVector<LaneRule> rules_;
 
         LaneIDOpt predecessor_;
         LaneIDOpt successor_;
@@ -370,6 +376,20 @@ class LaneSection
         std::vector<double> variances_;
     };
 
+    /**
+     * @brief Gets the tolerance for an adaptive tessellation of the reference
+     * line, which bounds the error of the lane boundaries of this lane section
+     * derived from it.
+     *
+     * Passing the result to ReferenceLine::tessellate() gives a reference line
+     * tessellation from which tessellateLaneBoundaryCurves() creates boundaries
+     * that deviate at most @p maxError from the exact lane boundaries.
+     *
+     * @param maxError      The maximum error of the lane boundaries.
+     * @returns             The tessellation tolerance.
+     */
+    ReferenceLine::TessellationTolerance boundaryTessellationTolerance(double maxError) const;
+
     /**
      * @brief Tessellates the lane boundaries into polylines with vertices
      * specified in terms of their lateral position (t-coordinates).
@@ -455,6 +475,315 @@ class LaneSection
     BoundaryCurveAndCenterLineTessellations tessellateLaneBoundaryCurvesAndCenterLines(
         const ReferenceLine::Tessellation& refLineTessellation) const;
 
+    /**
+     * @brief The lane boundary and center line tessellations of a lane
+     * section, stored in flat arrays which can be reused from call to call.
+     *
+     * The functions which take a LaneTessellationBuffer overwrite the parts of
+     * it they compute and clear the others, but keep the capacity of all
+     * arrays. Once a buffer has grown large enough for the largest lane
+     * section, tessellating into it doesn't allocate.
+     *
+     * The data of boundary i (with boundaries ordered as in the result of
+     * tessellateLaneBoundaries()) lies in the range
+     * [boundaryOffsets_[i], boundaryOffsets_[i + 1]) of lateralPositions_ and
+     * boundaryVertices_, and that of the center line of lane i lies in the
+     * range [centerLineOffsets_[i], centerLineOffsets_[i + 1]) of
+     * centerLineVertices_ and variances_.
+     */
+    struct LaneTessellationBuffer
+    {
+        /**
+         * @brief The lateral positions of the points on the boundaries, see
+         * BoundaryTessellation.
+         */
+        std::vector<double> lateralPositions_;
+
+        /**
+         * @brief The positions of the points on the boundaries, see
+         * BoundaryCurveTessellation.
+         */
+        std::vector<Eigen::Vector2d> boundaryVertices_;
+
+        /**
+         * @brief The offsets of the boundaries, followed by the total number
+         * of boundary points.
+         */
+        std::vector<int> boundaryOffsets_;
+
+        /**
+         * @brief The vertices of the center lines, see CenterLineTessellation.
+         */
+        std::vector<Eigen::Vector2d> centerLineVertices_;
+
+        /**
+         * @brief The variances of the vertices of the center lines, see
+         * CenterLineTessellation.
+         */
+        std::vector<double> variances_;
+
+        /**
+         * @brief The offsets of the center lines, followed by the total number
+         * of center line points.
+         */
+        std::vector<int> centerLineOffsets_;
+
+        /**
+         * @brief The 3D vertices of the left and right edges of the lanes, see
+         * tessellateLaneBoundaryCurves3D().
+         *
+         * With n vertices per boundary, the left edge of lane i lies in the
+         * range [2 * i * n, (2 * i + 1) * n), followed by its right edge.
+         */
+        std::vector<Eigen::Vector3d> laneEdgeVertices_;
+
+        /**
+         * @returns The number of boundaries in the buffer.
+         */
+        int numBoundaries() const { return std::max(static_cast<int>(boundaryOffsets_.size()) - 1, 0); }
+
+        /**
+         * @returns The number of center lines in the buffer.
+         */
+        int numCenterLines() const { return std::max(static_cast<int>(centerLineOffsets_.size()) - 1, 0); }
+
+        /**
+         * @returns The number of points on boundary @p i.
+         */
+        int boundarySize(int i) const { return boundaryOffsets_[i + 1] - boundaryOffsets_[i]; }
+
+        /**
+         * @returns The vertices of boundary @p i, of which there are
+         * boundarySize(i).
+         */
+        const Eigen::Vector2d* boundaryVertices(int i) const { return boundaryVertices_.data() + boundaryOffsets_[i]; }
+
+        /**
+         * @returns The 3D vertices of the left edge of lane @p i, of which
+         * there are boundarySize(i).
+         */
+        const Eigen::Vector3d* leftEdgeVertices(int i) const
+        {
+            return laneEdgeVertices_.data() + 2 * i * boundarySize(i);
+        }
+
+        /**
+         * @returns The 3D vertices of the right edge of lane @p i, of which
+         * there are boundarySize(i).
+         */
+        const Eigen::Vector3d* rightEdgeVertices(int i) const
+        {
+            return laneEdgeVertices_.data() + (2 * i + 1) * boundarySize(i);
+        }
+    };
+
+    /**
+     * @brief Tessellates the lane boundaries into lateral positions, like
+     * tessellateLaneBoundaries(const ReferenceLine::Tessellation&), but into
+     * a reusable buffer.
+     *
+     * Fills the lateralPositions_ and boundaryOffsets_ of @p out.
+     *
+     * @param refLineTessellation   The tessellation of the reference line.
+     * @param out           The buffer which receives the tessellation.
+     */
+    void tessellateLaneBoundaries(const ReferenceLine::Tessellation& refLineTessellation,
+                                  LaneTessellationBuffer& out) const;
+
+    /**
+     * @brief Tessellates the lane boundaries into polylines, like
+     * tessellateLaneBoundaryCurves(const ReferenceLine::Tessellation&), but
+     * into a reusable buffer.
+     *
+     * Fills the lateralPositions_, boundaryVertices_ and boundaryOffsets_ of
+     * @p out.
+     *
+     * @param refLineTessellation   The tessellation of the reference line.
+     * @param out           The buffer which receives the tessellation.
+     */
+    void tessellateLaneBoundaryCurves(const ReferenceLine::Tessellation& refLineTessellation,
+                                      LaneTessellationBuffer& out) const;
+
+    /**
+     * @brief Tessellates the lanes into the center line plus variance form,
+     * like tessellateLaneCenterLines(const ReferenceLine::Tessellation&), but
+     * into a reusable buffer.
+     *
+     * Fills the lateralPositions_, boundaryOffsets_, centerLineVertices_,
+     * variances_ and centerLineOffsets_ of @p out. The lateral positions are
+     * computed along the way.
+     *
+     * @param refLineTessellation   The tessellation of the reference line.
+     * @param out           The buffer which receives the tessellation.
+     */
+    void tessellateLaneCenterLines(const ReferenceLine::Tessellation& refLineTessellation,
+                                   LaneTessellationBuffer& out) const;
+
+    /**
+     * @brief Simultaneously computes the boundary curve tessellation and
+     * center line tessellation, like
+     * tessellateLaneBoundaryCurvesAndCenterLines(const ReferenceLine::Tessellation&),
+     * but into a reusable buffer.
+     *
+     * Fills all parts of @p out.
+     *
+     * @param refLineTessellation   The tessellation of the reference line.
+     * @param out           The buffer which receives the tessellation.
+     */
+    void tessellateLaneBoundaryCurvesAndCenterLines(const ReferenceLine::Tessellation& refLineTessellation,
+                                                    LaneTessellationBuffer& out) const;
+
+    /**
+     * @brief Tessellates the lane boundaries into lateral positions, with the
+     * s-coordinates taken from a reference line tessellation with Frenet
+     * frames.
+     *
+     * See tessellateLaneBoundaries(const ReferenceLine::Tessellation&, LaneTessellationBuffer&).
+     *
+     * @param refLineFrames The tessellation of the reference line.
+     * @param out           The buffer which receives the tessellation.
+     */
+    void tessellateLaneBoundaries(const ReferenceLine::FrenetFrames& refLineFrames,
+                                  LaneTessellationBuffer& out) const;
+
+    /**
+     * @brief Tessellates the lane boundaries into polylines, by offsetting the
+     * vertices of a reference line tessellation along their normals.
+     *
+     * This gives the same result as
+     * tessellateLaneBoundaryCurves(const ReferenceLine::Tessellation&, LaneTessellationBuffer&)
+     * up to rounding, but uses the normals of @p refLineFrames instead of
+     * evaluating them from the headings, in loops which can be vectorized.
+     *
+     * @param refLineFrames The tessellation of the reference line.
+     * @param out           The buffer which receives the tessellation.
+     */
+    void tessellateLaneBoundaryCurves(const ReferenceLine::FrenetFrames& refLineFrames,
+                                      LaneTessellationBuffer& out) const;
+
+    /**
+     * @brief Tessellates the lanes into the center line plus variance form,
+     * from a reference line tessellation with Frenet frames.
+     *
+     * See tessellateLaneBoundaryCurves(const ReferenceLine::FrenetFrames&, LaneTessellationBuffer&).
+     *
+     * @param refLineFrames The tessellation of the reference line.
+     * @param out           The buffer which receives the tessellation.
+     */
+    void tessellateLaneCenterLines(const ReferenceLine::FrenetFrames& refLineFrames,
+                                   LaneTessellationBuffer& out) const;
+
+    /**
+     * @brief Simultaneously computes the boundary curve tessellation and
+     * center line tessellation, from a reference line tessellation with
+     * Frenet frames.
+     *
+     * See tessellateLaneBoundaryCurves(const ReferenceLine::FrenetFrames&, LaneTessellationBuffer&).
+     *
+     * @param refLineFrames The tessellation of the reference line.
+     * @param out           The buffer which receives the tessellation.
+     */
+    void tessellateLaneBoundaryCurvesAndCenterLines(const ReferenceLine::FrenetFrames& refLineFrames,
+                                                    LaneTessellationBuffer& out) const;
+
+    /**
+     * @brief Tessellates the boundary curves like
+     * tessellateLaneBoundaryCurves(const ReferenceLine::FrenetFrames&, LaneTessellationBuffer&),
+     * and additionally computes the 3D edges of each lane.
+     *
+     * The elevation of a lane edge is that of the reference line, offset by
+     * the inner or outer height of the lane (see Lane::heights()) on its inner
+     * or outer edge. Since adjacent lanes can have different heights, for
+     * example where a sidewalk is raised above the road, each lane has its own
+     * left and right edge rather than sharing a boundary with its neighbors.
+     * Superelevation and crossfall aren't taken into account.
+     *
+     * @param refLineFrames The tessellation of the reference line, which must
+     *                      have elevations (see Road::tessellateReferenceLine()).
+     * @param out           The buffer which receives the tessellation.
+     */
+    void tessellateLaneBoundaryCurves3D(const ReferenceLine::FrenetFrames& refLineFrames,
+                                        LaneTessellationBuffer& out) const;
+
+    /**
+     * @brief Evaluates the height offsets of a lane (see Lane::heights()) at
+     * the given s-coordinates, which must be non-decreasing.
+     *
+     * Before the s-offset of the first LaneHeight, and for lanes without
+     * heights, the offsets are 0.
+     *
+     * @param laneIdx       The index of the lane in lanes().
+     * @param sCoords       The s-coordinates.
+     * @param numPoints     The number of s-coordinates.
+     * @param innerOut      Receives the @p numPoints inner offsets.
+     * @param outerOut      Receives the @p numPoints outer offsets.
+     */
+    void evalLaneHeights(int laneIdx, const double* sCoords, int numPoints, double* innerOut, double* outerOut) const;
+
+    /**
+     * @brief Evaluates the lateral offsets of the lane boundaries at a
+     * sequence of s-coordinates.
+     *
+     * The offsets are the cumulative widths of the lanes between the reference
+     * line and each boundary, in one pass over the lanes. Like
+     * ElevationProfile::Cursor, a BoundaryCursor remembers the width
+     * polynomial of each lane which applied to the last s-coordinate, so a
+     * non-decreasing sequence of s-coordinates, such as those of a trajectory,
+     * takes constant time per lane and s-coordinate. Other sequences fall back
+     * to a binary search.
+     */
+    class BoundaryCursor
+    {
+      public:
+        /**
+         * @brief Creates a BoundaryCursor at the start of a lane section,
+         * which must outlive it.
+         *
+         * @param laneSection   The lane section.
+         */
+        explicit BoundaryCursor(const LaneSection& laneSection);
+
+        /**
+         * @brief Evaluates the lateral offsets of all boundaries of the lane
+         * section at the given s-coordinate.
+         *
+         * The boundaries are ordered like in tessellateLaneBoundaries(), from
+         * the outer boundary of the leftmost lane to that of the rightmost
+         * one, so boundary numLeftLanes() is the reference line.
+         *
+         * @param s             The s-coordinate, relative to the start of the
+         *                      road.
+         * @param offsets       Receives the lanes().size() + 1 offsets,
+         *                      positive to the left.
+         * @param derivatives   If not null, receives the derivatives of the
+         *                      offsets with respect to s.
+         */
+        void boundaryOffsets(double s, double* offsets, double* derivatives = nullptr);
+
+      private:
+        /**
+         * @brief Moves the cursor of a lane to the width polynomial which
+         * applies at the given s-coordinate (relative to the start of the lane
+         * section), and returns it.
+         */
+        const WidthPoly3& seek(int laneIdx, double localS);
+
+        const LaneSection& laneSection_;
+        std::vector<int> polyIndices_;
+    };
+
+    /**
+     * @brief Evaluates the lateral offsets of the lane boundaries at the given
+     * s-coordinate.
+     *
+     * To evaluate many s-coordinates in order, use a BoundaryCursor instead.
+     *
+     * @param s             The s-coordinate, relative to the start of the road.
+     * @param offsets       Receives the lanes().size() + 1 offsets, see
+     *                      BoundaryCursor::boundaryOffsets().
+     */
+    void evalBoundaryOffsets(double s, double* offsets) const;
+
     /**
      * @brief The beginning of the s-range of this lane section.
      *
@@ -510,7 +839,7 @@ class LaneSection
      *
      * @returns A vector with the lanes.
      */
-    const std::vector<Lane>& lanes() const { return lanes_; }
+    const ArenaVector<Lane>& lanes() const { return lanes_; }
 
     /**
      * @brief Converts from a lane index to a lane identifier.
@@ -532,6 +861,23 @@ class LaneSection
      */
     int laneIdToIndex(LaneID id) const;
 
+    /**
+     * @brief Finds the lane which contains a point, given in the road
+     * coordinates of the road this lane section is a part of.
+     *
+     * The lateral extents of the lanes are given by their width polynomials,
+     * measured from the reference line. A point on the boundary between two
+     * lanes is in the inner one.
+     *
+     * @param s             The s-coordinate, which should lie in the s-range
+     *                      of this lane section.
+     * @param t             The lateral offset from the reference line,
+     *                      positive to the left.
+     * @returns             The index of the lane, or -1 if the point lies
+     *                      beyond the outermost lane on its side.
+     */
+    int laneIndexAt(double s, double t) const;
+
     /**
      * @brief Gets the lane of this lane section with the given lane identifier.
      *
@@ -581,6 +927,12 @@ class LaneSection
     class AttribParsers;
     class ChildElemParsers;
 
+    /**
+     * @brief Adds the given offset to the global lane indices of all lanes in
+     * this lane section. See Road::offsetGlobalLaneIndices.
+     */
+    void offsetGlobalLaneIndices(int offset);
+
     static void parseLeftLanes(XodrReader& xml, XodrParseResult<LaneSection>& laneSection);
     static void parseRightLanes(XodrReader& xml, XodrParseResult<LaneSection>& laneSection);
 
@@ -596,11 +948,15 @@ class LaneSection
      * either because it was the far boundary of the loop's previous iteration,
      * or because it was provided by the caller.
      *
-     * @param refLineTessellation   The tessellation of the reference line.
-     * @param boundaryIt    An iterator, which initially points to the boundary
-     *                      which corresponds to the reference line, and will
-     *                      be advanced in the direction of 'stepDir' to go to
-     *                      the next boundary in the direction of the current side.
+     * @param sCoordAt      A function which returns the s-coordinate of the
+     *                      reference line vertex with the given index.
+     * @param numPoints     The number of reference line vertices.
+     * @param boundaryIt    A pointer to the lateral positions of the boundary
+     *                      which corresponds to the reference line, in a flat
+     *                      array which stores the boundaries one after another,
+     *                      each with @p numPoints lateral positions. It will be
+     *                      advanced in the direction of 'stepDir' to go to the
+     *                      next boundary in the direction of the current side.
      * @param lanesBegin    The first lane on the current side.
      * @param lanesEnd      The end of the range of lanes which should be
      *                      handled by this function. The range does not
@@ -610,16 +966,34 @@ class LaneSection
      *                      the lanes on the left side of the reference line and
      *                      1 for the lanes on the right side.
      */
-    void tessellateLaneBoundariesSide(const ReferenceLine::Tessellation& refLineTessellation,
-                                      BoundaryTessellation* boundaryIt, int lanesBegin, int lanesEnd,
-                                      int stepDir) const;
+    template <typename SCoordFn>
+    void tessellateLaneBoundariesSide(SCoordFn sCoordAt, int numPoints, double* boundaryIt, int lanesBegin,
+                                      int lanesEnd, int stepDir) const;
+
+    /**
+     * @brief The implementation of the tessellateLaneBoundaries() overloads.
+     *
+     * @param sCoordAt      A function which returns the s-coordinate of the
+     *                      reference line vertex with the given index.
+     * @param numPoints     The number of reference line vertices.
+     * @param out           The buffer which receives the tessellation.
+     */
+    template <typename SCoordFn>
+    void tessellateLaneBoundaries(SCoordFn sCoordAt, int numPoints, LaneTessellationBuffer& out) const;
+
+    /**
+     * @brief Calls @p fn(i, inner, outer) with the height offsets of a lane at
+     * each of the given non-decreasing s-coordinates, see evalLaneHeights().
+     */
+    template <typename Fn>
+    void forEachLaneHeight(int laneIdx, const double* sCoords, int numPoints, Fn fn) const;
 
     double startS_;
     double endS_;
     bool singleSided_;
 
     int numLeftLanes_;
-    std::vector<Lane> lanes_;
+    ArenaVector<Lane> lanes_;
 };
 
 enum class LaneType : int
@@ -651,4 +1025,9 @@ enum class LaneType : int
     HOV
 };
 
+/**
+ * @brief The number of values of LaneType.
+ */
+constexpr int NUM_LANE_TYPES = static_cast<int>(LaneType::HOV) + 1;
+
 }}  // namespace aid::xodr
@@ -7,7 +7,7 @@ namespace aid { namespace xodr {
 namespace xml_parsers {
 
 template <>
-LaneType parseXmlAttrib(const std::string& value)
+LaneType parseXmlAttrib(std::string_view value)
 {
     if (value == "none")
     {
@@ -0,0 +1,150 @@
+#include "lane_spatial_index.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "map_tessellator.h"
+#include "parallel_for.h"
+
+namespace aid { namespace xodr {
+
+LaneSpatialIndex::LaneSpatialIndex(const XodrMap& map, const Options& options)
+{
+    MapTessellator tessellator(map);
+    MapTessellator::Options tessellatorOptions;
+    tessellatorOptions.maxError_ = options.maxError_;
+    tessellatorOptions.numThreads_ = options.numThreads_;
+    tessellator.tessellate(tessellatorOptions);
+
+    laneKeys_.resize(map.totalNumLanes());
+    for (int roadIdx = 0; roadIdx < static_cast<int>(map.roads().size()); roadIdx++)
+    {
+        const ArenaVector<LaneSection>& laneSections = map.roads()[roadIdx].laneSections();
+        for (int i = 0; i < static_cast<int>(laneSections.size()); i++)
+        {
+            LaneSectionKey laneSectionKey(roadIdx, i);
+            const ArenaVector<LaneSection::Lane>& lanes = laneSections[i].lanes();
+            for (int j = 0; j < static_cast<int>(lanes.size()); j++)
+            {
+                int globalLaneIdx = lanes[j].globalIndex();
+                laneKeys_[globalLaneIdx] = LaneKey(laneSectionKey, j);
+
+                MapTessellator::Polyline left = tessellator.boundary(tessellator.boundaryIndex(laneSectionKey, j));
+                MapTessellator::Polyline right = tessellator.boundary(tessellator.boundaryIndex(laneSectionKey, j + 1));
+                for (int k = 0; k + 1 < left.size_; k++)
+                {
+                    quads_.push_back({{left.vertices_[k], left.vertices_[k + 1], right.vertices_[k + 1],
+                                       right.vertices_[k]},
+                                      globalLaneIdx});
+                }
+            }
+        }
+    }
+
+    std::vector<Eigen::AlignedBox2d> quadBoxes(quads_.size());
+    for (size_t i = 0; i < quads_.size(); i++)
+    {
+        for (const Eigen::Vector2d& corner : quads_[i].corners_)
+        {
+            quadBoxes[i].extend(corner);
+        }
+    }
+
+    std::vector<int> order;
+    tree_.build(quadBoxes, order);
+
+    std::vector<Quad> sortedQuads(quads_.size());
+    for (size_t i = 0; i < quads_.size(); i++)
+    {
+        sortedQuads[i] = quads_[order[i]];
+    }
+    quads_.swap(sortedQuads);
+}
+
+bool LaneSpatialIndex::Quad::contains(const Eigen::Vector2d& point) const
+{
+    // Count the crossings of the edges with a ray from the point in the
+    // positive x direction. The test is half-open in y, so a ray through a
+    // corner crosses exactly one of its edges.
+    bool inside = false;
+    for (int i = 0, j = 3; i < 4; j = i++)
+    {
+        const Eigen::Vector2d& a = corners_[i];
+        const Eigen::Vector2d& b = corners_[j];
+        if ((a.y() > point.y()) != (b.y() > point.y()) &&
+            point.x() < a.x() + (b.x() - a.x()) * (point.y() - a.y()) / (b.y() - a.y()))
+        {
+            inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
+void LaneSpatialIndex::findLaneIndices(const Eigen::Vector2d& point, std::vector<int>& laneIndices) const
+{
+    laneIndices.clear();
+    tree_.forEachLeafContaining(point, [&](int first, int count) {
+        for (int i = first; i < first + count; i++)
+        {
+            const Quad& quad = quads_[i];
+            if (quad.contains(point) &&
+                std::find(laneIndices.begin(), laneIndices.end(), quad.globalLaneIdx_) == laneIndices.end())
+            {
+                laneIndices.push_back(quad.globalLaneIdx_);
+            }
+        }
+    });
+
+    std::sort(laneIndices.begin(), laneIndices.end());
+}
+
+void LaneSpatialIndex::findLanes(const Eigen::Vector2d& point, std::vector<LaneKey>& lanes) const
+{
+    std::vector<int> laneIndices;
+    findLaneIndices(point, laneIndices);
+
+    lanes.clear();
+    for (int laneIdx : laneIndices)
+    {
+        lanes.push_back(laneKeys_[laneIdx]);
+    }
+}
+
+void LaneSpatialIndex::findLanes(const Eigen::Vector2d* points, int numPoints, BatchResult& result,
+                                 int numThreads) const
+{
+    // The points are split into chunks, each of which collects the lanes of
+    // its points, so the result doesn't depend on the number of threads.
+    constexpr int CHUNK_SIZE = 256;
+    int numChunks = (numPoints + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    result.offsets_.assign(numPoints + 1, 0);
+    std::vector<std::vector<int>> chunkLaneIndices(numChunks);
+    parallelFor(numThreads, numChunks, [&](size_t chunkIdx, int) {
+        std::vector<int>& chunkLanes = chunkLaneIndices[chunkIdx];
+        std::vector<int> laneIndices;
+
+        int end = std::min(static_cast<int>(chunkIdx + 1) * CHUNK_SIZE, numPoints);
+        for (int i = static_cast<int>(chunkIdx) * CHUNK_SIZE; i < end; i++)
+        {
+            findLaneIndices(points[i], laneIndices);
+            result.offsets_[i + 1] = static_cast<int>(laneIndices.size());
+            chunkLanes.insert(chunkLanes.end(), laneIndices.begin(), laneIndices.end());
+        }
+    });
+
+    std::partial_sum(result.offsets_.begin(), result.offsets_.end(), result.offsets_.begin());
+
+    result.lanes_.clear();
+    result.lanes_.reserve(result.offsets_.back());
+    for (const std::vector<int>& chunkLanes : chunkLaneIndices)
+    {
+        for (int laneIdx : chunkLanes)
+        {
+            result.lanes_.push_back(laneKeys_[laneIdx]);
+        }
+    }
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <vector>
+#include <Eigen/Dense>
+
+#include "box_tree.h"
+#include "xodr_map.h"
+#include "xodr_map_keys.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief A spatial index over the lanes of an XodrMap, which finds the lanes
+ * that contain a point.
+ *
+ * The lane boundaries are tessellated with a MapTessellator, and each lane is
+ * split into quads, one for each pair of consecutive vertices of its left and
+ * right boundaries. The bounding boxes of the quads are bulk-loaded into a
+ * BoxTree, which is balanced, so a query visits O(log n) nodes for a point
+ * which is in few quads.
+ *
+ * Since the lanes are represented by their tessellation, a point which is less
+ * than Options::maxError_ from a lane boundary may be attributed to the lane
+ * on the other side. Points on the boundary between two lanes are generally
+ * in one of them, and points where lanes overlap (for example in junctions)
+ * are in all of them.
+ */
+class LaneSpatialIndex
+{
+  public:
+    /**
+     * @brief Options which control how a LaneSpatialIndex is built.
+     */
+    struct Options
+    {
+        /**
+         * @brief The maximum distance between the tessellated lane boundaries
+         * and the exact ones.
+         */
+        double maxError_ = .01;
+
+        /**
+         * @brief The number of threads used to tessellate the boundaries, see
+         * MapTessellator::Options::numThreads_.
+         */
+        int numThreads_ = 0;
+    };
+
+    /**
+     * @brief The lanes which contain each of a batch of points, see
+     * findLanes(const Eigen::Vector2d*, int, BatchResult&, int) const.
+     */
+    struct BatchResult
+    {
+        /**
+         * @brief The lanes of the i'th point are lanes_[offsets_[i]] up to but
+         * not including lanes_[offsets_[i + 1]].
+         */
+        std::vector<int> offsets_;
+        std::vector<LaneKey> lanes_;
+    };
+
+    /**
+     * @brief Builds the index of the lanes of a map.
+     *
+     * @param map           The map. The index doesn't refer to it after it's
+     *                      built.
+     * @param options       The options.
+     */
+    LaneSpatialIndex(const XodrMap& map, const Options& options);
+
+    /**
+     * @returns The number of quads in the index.
+     */
+    int numQuads() const { return static_cast<int>(quads_.size()); }
+
+    /**
+     * @brief Finds the lanes which contain a point.
+     *
+     * @param point         The point.
+     * @param lanes         Receives the lanes, in the order of their global
+     *                      indices, each of them once.
+     */
+    void findLanes(const Eigen::Vector2d& point, std::vector<LaneKey>& lanes) const;
+
+    /**
+     * @brief Finds the lanes which contain each of a batch of points.
+     *
+     * @param points        The points.
+     * @param numPoints     The number of points.
+     * @param result        Receives the lanes of each point, in the order of
+     *                      findLanes(const Eigen::Vector2d&,
+     *                      std::vector<LaneKey>&) const.
+     * @param numThreads    The number of threads over which the points are
+     *                      distributed, or 0 for one per hardware thread.
+     */
+    void findLanes(const Eigen::Vector2d* points, int numPoints, BatchResult& result, int numThreads = 0) const;
+
+  private:
+    /**
+     * @brief The quad between two consecutive vertices of the boundaries of a
+     * lane, with its corners in order around it.
+     */
+    struct Quad
+    {
+        Eigen::Vector2d corners_[4];
+        int globalLaneIdx_;
+
+        bool contains(const Eigen::Vector2d& point) const;
+    };
+
+    /**
+     * @brief Finds the global indices of the lanes which contain a point.
+     */
+    void findLaneIndices(const Eigen::Vector2d& point, std::vector<int>& laneIndices) const;
+
+    /**
+     * @brief The quads, in the order of the leaves of tree_.
+     */
+    std::vector<Quad> quads_;
+    BoxTree tree_;
+
+    /**
+     * @brief The key of each lane, by its global index.
+     */
+    std::vector<LaneKey> laneKeys_;
+};
+
+}}  // namespace aid::xodr
@@ -0,0 +1,263 @@
+#include "map_tessellator.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "parallel_for.h"
+
+namespace aid { namespace xodr {
+
+MapTessellator::MapTessellator(const XodrMap& map) : map_(map)
+{
+    const ArenaVector<Road>& roads = map.roads();
+    int numRoads = static_cast<int>(roads.size());
+
+    laneSectionsBegin_.resize(numRoads + 1);
+    laneSectionsBegin_[0] = 0;
+    for (int i = 0; i < numRoads; i++)
+    {
+        laneSectionsBegin_[i + 1] = laneSectionsBegin_[i] + static_cast<int>(roads[i].laneSections().size());
+    }
+
+    int numLaneSections = laneSectionsBegin_[numRoads];
+    laneSectionBoundariesBegin_.resize(numLaneSections);
+    refLineFrames_.resize(numLaneSections);
+    roadOrigins_.resize(numRoads, Eigen::Vector2d::Zero());
+
+    roadOrder_.resize(numRoads);
+    for (int i = 0; i < numRoads; i++)
+    {
+        roadOrder_[i] = i;
+    }
+    std::stable_sort(roadOrder_.begin(), roadOrder_.end(), [&roads](int a, int b) {
+        return roads[a].referenceLine().endS() > roads[b].referenceLine().endS();
+    });
+}
+
+void MapTessellator::tessellate(const Options& options)
+{
+    int numThreads = resolveNumThreads(options.numThreads_);
+
+    // Pass 1: tessellate the reference lines, which gives the number of
+    // vertices of each polyline.
+    forEachRoad(numThreads, [&](int roadIdx, int) { tessellateReferenceLines(roadIdx, options); });
+
+    // Compute the offsets of the polylines, in the order of the lane sections
+    // for the boundaries, and in the order of the global lane indices for the
+    // center lines.
+    const ArenaVector<Road>& roads = map_.roads();
+    int numBoundaries = 0;
+    int numBoundaryVertices = 0;
+    boundaries_.offsets_.clear();
+    boundaries_.roads_.clear();
+    centerLines_.offsets_.assign(map_.totalNumLanes() + 1, 0);
+    centerLines_.roads_.resize(map_.totalNumLanes());
+    for (int roadIdx = 0; roadIdx < static_cast<int>(roads.size()); roadIdx++)
+    {
+        const ArenaVector<LaneSection>& laneSections = roads[roadIdx].laneSections();
+        for (int i = 0; i < static_cast<int>(laneSections.size()); i++)
+        {
+            int laneSectionIdx = laneSectionsBegin_[roadIdx] + i;
+            const ReferenceLine::FrenetFrames& frames = refLineFrames_[laneSectionIdx];
+            int numPoints = frames.size();
+            const ArenaVector<LaneSection::Lane>& lanes = laneSections[i].lanes();
+
+            if (i == 0 && numPoints > 0)
+            {
+                roadOrigins_[roadIdx] = Eigen::Vector2d(frames.x_[0], frames.y_[0]);
+            }
+
+            laneSectionBoundariesBegin_[laneSectionIdx] = numBoundaries;
+            for (int j = 0; j <= static_cast<int>(lanes.size()); j++)
+            {
+                boundaries_.offsets_.push_back(numBoundaryVertices);
+                boundaries_.roads_.push_back(roadIdx);
+                numBoundaryVertices += numPoints;
+            }
+            numBoundaries += static_cast<int>(lanes.size()) + 1;
+
+            for (const LaneSection::Lane& lane : lanes)
+            {
+                centerLines_.offsets_[lane.globalIndex() + 1] = numPoints;
+                centerLines_.roads_[lane.globalIndex()] = roadIdx;
+            }
+        }
+    }
+    boundaries_.offsets_.push_back(numBoundaryVertices);
+
+    for (int i = 0; i < map_.totalNumLanes(); i++)
+    {
+        centerLines_.offsets_[i + 1] += centerLines_.offsets_[i];
+    }
+
+    vertexFormat_ = options.vertexFormat_;
+    quantizationStep_ = options.quantizationStep_;
+    resizeVertexArrays(boundaries_);
+    resizeVertexArrays(centerLines_);
+    centerLineVariances_.resize(centerLines_.offsets_.back());
+
+    // Pass 2: derive the lane boundaries and center lines, and store them in
+    // the output.
+    threadBuffers_.resize(std::max(numThreads, static_cast<int>(threadBuffers_.size())));
+    threadWords_.resize(threadBuffers_.size());
+    for (std::vector<int16_t>& words : threadWords_)
+    {
+        words.clear();
+    }
+    forEachRoad(numThreads, [&](int roadIdx, int threadIdx) { tessellateLanes(roadIdx, threadIdx); });
+
+    if (vertexFormat_ == VertexFormat::QUANTIZED)
+    {
+        gatherWords(boundaries_);
+        gatherWords(centerLines_);
+    }
+}
+
+int MapTessellator::boundaryIndex(LaneSectionKey laneSectionKey, int boundaryIdx) const
+{
+    return laneSectionBoundariesBegin_[laneSectionIndex(laneSectionKey)] + boundaryIdx;
+}
+
+const ReferenceLine::FrenetFrames& MapTessellator::refLineFrames(LaneSectionKey laneSectionKey) const
+{
+    return refLineFrames_[laneSectionIndex(laneSectionKey)];
+}
+
+int MapTessellator::laneSectionIndex(LaneSectionKey laneSectionKey) const
+{
+    assert(laneSectionKey.roadIdx_ >= 0 && laneSectionKey.roadIdx_ < static_cast<int>(map_.roads().size()));
+
+    int laneSectionIdx = laneSectionsBegin_[laneSectionKey.roadIdx_] + laneSectionKey.laneSectionIdx_;
+    assert(laneSectionIdx < laneSectionsBegin_[laneSectionKey.roadIdx_ + 1]);
+
+    return laneSectionIdx;
+}
+
+template <typename Fn>
+void MapTessellator::forEachRoad(int numThreads, Fn fn) const
+{
+    parallelFor(numThreads, roadOrder_.size(), [&](size_t i, int threadIdx) { fn(roadOrder_[i], threadIdx); });
+}
+
+void MapTessellator::tessellateReferenceLines(int roadIdx, const Options& options)
+{
+    const Road& road = map_.roads()[roadIdx];
+    const ArenaVector<LaneSection>& laneSections = road.laneSections();
+    for (int i = 0; i < static_cast<int>(laneSections.size()); i++)
+    {
+        const LaneSection& laneSection = laneSections[i];
+        road.tessellateReferenceLine(refLineFrames_[laneSectionsBegin_[roadIdx] + i], laneSection.startS(),
+                                     laneSection.endS(), laneSection.boundaryTessellationTolerance(options.maxError_));
+    }
+}
+
+void MapTessellator::tessellateLanes(int roadIdx, int threadIdx)
+{
+    LaneSection::LaneTessellationBuffer& buffer = threadBuffers_[threadIdx];
+    const ArenaVector<LaneSection>& laneSections = map_.roads()[roadIdx].laneSections();
+    for (int i = 0; i < static_cast<int>(laneSections.size()); i++)
+    {
+        const LaneSection& laneSection = laneSections[i];
+        int laneSectionIdx = laneSectionsBegin_[roadIdx] + i;
+
+        laneSection.tessellateLaneBoundaryCurvesAndCenterLines(refLineFrames_[laneSectionIdx], buffer);
+
+        int firstBoundary = laneSectionBoundariesBegin_[laneSectionIdx];
+        for (int j = 0; j < buffer.numBoundaries(); j++)
+        {
+            storePolyline(boundaries_, firstBoundary + j, buffer.boundaryVertices(j), threadIdx);
+        }
+
+        const ArenaVector<LaneSection::Lane>& lanes = laneSection.lanes();
+        for (int j = 0; j < static_cast<int>(lanes.size()); j++)
+        {
+            int begin = buffer.centerLineOffsets_[j];
+            int end = buffer.centerLineOffsets_[j + 1];
+            int globalIndex = lanes[j].globalIndex();
+            storePolyline(centerLines_, globalIndex, buffer.centerLineVertices_.data() + begin, threadIdx);
+            std::copy(buffer.variances_.begin() + begin, buffer.variances_.begin() + end,
+                      centerLineVariances_.begin() + centerLines_.offsets_[globalIndex]);
+        }
+    }
+}
+
+template <typename T>
+static void resizeOrRelease(std::vector<T>& vec, bool used, size_t size)
+{
+    if (used)
+    {
+        vec.resize(size);
+    }
+    else
+    {
+        std::vector<T>().swap(vec);
+    }
+}
+
+void MapTessellator::resizeVertexArrays(PolylineArrays& arrays) const
+{
+    size_t numPolylines = arrays.offsets_.size() - 1;
+    size_t numVertices = arrays.offsets_.back();
+    bool quantized = vertexFormat_ == VertexFormat::QUANTIZED;
+
+    resizeOrRelease(arrays.vertices_, vertexFormat_ == VertexFormat::DOUBLE, numVertices);
+    resizeOrRelease(arrays.floatVertices_, vertexFormat_ == VertexFormat::FLOAT, numVertices);
+    resizeOrRelease(arrays.wordSources_, quantized, numPolylines);
+    resizeOrRelease(arrays.wordOffsets_, quantized, numPolylines + 1);
+    if (!quantized)
+    {
+        std::vector<int16_t>().swap(arrays.words_);
+    }
+}
+
+void MapTessellator::storePolyline(PolylineArrays& arrays, int idx, const Eigen::Vector2d* vertices, int threadIdx)
+{
+    int begin = arrays.offsets_[idx];
+    int size = arrays.offsets_[idx + 1] - begin;
+    const Eigen::Vector2d& origin = roadOrigins_[arrays.roads_[idx]];
+    switch (vertexFormat_)
+    {
+    case VertexFormat::DOUBLE:
+        std::copy(vertices, vertices + size, arrays.vertices_.begin() + begin);
+        break;
+
+    case VertexFormat::FLOAT:
+        FloatPolyline::encode(vertices, size, origin, arrays.floatVertices_.data() + begin);
+        break;
+
+    case VertexFormat::QUANTIZED:
+    {
+        // The number of words isn't known in advance, so the polyline is
+        // encoded into the buffer of the thread, and gathered by
+        // gatherWords().
+        std::vector<int16_t>& words = threadWords_[threadIdx];
+        int firstWord = static_cast<int>(words.size());
+        QuantizedPolyline::encode(vertices, size, origin, quantizationStep_, words);
+        arrays.wordSources_[idx] = {threadIdx, firstWord};
+        arrays.wordOffsets_[idx + 1] = static_cast<int>(words.size()) - firstWord;
+        break;
+    }
+    }
+}
+
+void MapTessellator::gatherWords(PolylineArrays& arrays) const
+{
+    int numPolylines = static_cast<int>(arrays.wordSources_.size());
+    arrays.wordOffsets_[0] = 0;
+    for (int i = 0; i < numPolylines; i++)
+    {
+        arrays.wordOffsets_[i + 1] += arrays.wordOffsets_[i];
+    }
+
+    arrays.words_.resize(arrays.wordOffsets_.back());
+    for (int i = 0; i < numPolylines; i++)
+    {
+        const std::vector<int16_t>& words = threadWords_[arrays.wordSources_[i].first];
+        int firstWord = arrays.wordSources_[i].second;
+        int numWords = arrays.wordOffsets_[i + 1] - arrays.wordOffsets_[i];
+        std::copy(words.begin() + firstWord, words.begin() + firstWord + numWords,
+                  arrays.words_.begin() + arrays.wordOffsets_[i]);
+    }
+}
+
+}}  // namespace aid::xodr
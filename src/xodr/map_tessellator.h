@@ -0,0 +1,376 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+#include <Eigen/Dense>
+
+#include "compact_polyline.h"
+#include "xodr_map.h"
+#include "xodr_map_keys.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Tessellates the lane boundaries and center lines of all lane sections
+ * of an XodrMap, in parallel.
+ *
+ * The work is split into one task per road. The roads are tessellated in two
+ * passes, each of which distributes the tasks over a number of threads:
+ *
+ *  1. The reference line of each lane section is adaptively tessellated (see
+ *     LaneSection::boundaryTessellationTolerance()) into FrenetFrames with
+ *     elevations, which fixes the number of vertices of its boundaries and
+ *     center lines.
+ *  2. Once the offsets of all polylines have been computed from these counts
+ *     and the output arrays have been sized, the boundaries and center lines
+ *     are derived from the frames and copied into their place.
+ *
+ * Since the offsets are computed in the order of the roads and lane sections,
+ * and each polyline only depends on its own lane section, the output is the
+ * same regardless of the number of threads and the order in which the tasks
+ * are run.
+ *
+ * The center line of a lane is found by its global index (see
+ * LaneSection::Lane::globalIndex()), and the boundaries of a lane section by
+ * its LaneSectionKey. A MapTessellator can tessellate the map repeatedly, for
+ * example with a different tolerance, and reuses its arrays when it does.
+ *
+ * The vertices of the polylines are stored in the format given by
+ * Options::vertexFormat_, and only in that format. The compact formats store
+ * them relative to the origin of their road (see roadOrigin()), and are read
+ * with floatBoundary() and quantizedBoundary() (and the corresponding center
+ * line accessors) instead of boundary().
+ */
+class MapTessellator
+{
+  public:
+    /**
+     * @brief Options which control how a map is tessellated.
+     */
+    struct Options
+    {
+        /**
+         * @brief The maximum distance between the tessellated lane boundaries
+         * and the exact ones.
+         */
+        double maxError_ = .01;
+
+        /**
+         * @brief The number of threads used to tessellate the roads.
+         *
+         * If this is 1, the roads are tessellated on the calling thread. If
+         * it's 0, one thread per hardware thread is used.
+         */
+        int numThreads_ = 0;
+
+        /**
+         * @brief The format in which the vertices of the polylines are stored.
+         */
+        VertexFormat vertexFormat_ = VertexFormat::DOUBLE;
+
+        /**
+         * @brief The spacing of the grid to which the vertices are quantized
+         * if vertexFormat_ is VertexFormat::QUANTIZED.
+         *
+         * This adds up to quantizationStep_ / 2 to the error in x and y of
+         * each vertex, on top of maxError_.
+         */
+        double quantizationStep_ = .001;
+    };
+
+    /**
+     * @brief A polyline in the output of the tessellator.
+     */
+    struct Polyline
+    {
+        const Eigen::Vector2d* vertices_;
+        int size_;
+    };
+
+    /**
+     * @brief Creates a MapTessellator for the given map, which must outlive
+     * it.
+     *
+     * @param map           The map.
+     */
+    explicit MapTessellator(const XodrMap& map);
+
+    /**
+     * @brief Tessellates all lane sections of the map, replacing the results
+     * of any previous call.
+     *
+     * @param options       The options.
+     */
+    void tessellate(const Options& options);
+
+    /**
+     * @returns The format in which the vertices were stored by the last call
+     * to tessellate().
+     */
+    VertexFormat vertexFormat() const { return vertexFormat_; }
+
+    /**
+     * @returns The number of bytes taken by the vertices of the boundaries and
+     * center lines.
+     */
+    size_t vertexMemoryUsage() const { return boundaries_.memoryUsage() + centerLines_.memoryUsage(); }
+
+    /**
+     * @returns The total number of lane boundaries in the map.
+     */
+    int numBoundaries() const { return std::max(static_cast<int>(boundaries_.offsets_.size()) - 1, 0); }
+
+    /**
+     * @brief Gets the index of a lane boundary, which can be passed to
+     * boundary().
+     *
+     * @param laneSectionKey    The lane section of the boundary.
+     * @param boundaryIdx       The index of the boundary within the lane
+     *                          section, in the order of
+     *                          LaneSection::tessellateLaneBoundaries().
+     * @returns                 The index of the boundary.
+     */
+    int boundaryIndex(LaneSectionKey laneSectionKey, int boundaryIdx) const;
+
+    /**
+     * @brief Gets the tessellation of the reference line of a lane section,
+     * from which its boundaries and center lines were derived.
+     *
+     * The tessellation has elevations, see Road::tessellateReferenceLine().
+     *
+     * @param laneSectionKey    The lane section.
+     * @returns                 The tessellation.
+     */
+    const ReferenceLine::FrenetFrames& refLineFrames(LaneSectionKey laneSectionKey) const;
+
+    /**
+     * @brief Gets the origin of the compact vertices of the polylines of a
+     * road, which is the start of its reference line.
+     *
+     * @param roadIdx       The index of the road.
+     * @returns             The origin.
+     */
+    const Eigen::Vector2d& roadOrigin(int roadIdx) const { return roadOrigins_[roadIdx]; }
+
+    /**
+     * @brief Gets the tessellation of a lane boundary, if the vertex format is
+     * VertexFormat::DOUBLE.
+     *
+     * @param boundaryIndex The index of the boundary, see boundaryIndex().
+     * @returns             The polyline.
+     */
+    Polyline boundary(int boundaryIndex) const { return polyline(boundaries_, boundaryIndex); }
+
+    /**
+     * @brief Gets the tessellation of a lane boundary, if the vertex format is
+     * VertexFormat::FLOAT.
+     *
+     * @param boundaryIndex The index of the boundary, see boundaryIndex().
+     * @returns             The polyline.
+     */
+    FloatPolyline floatBoundary(int boundaryIndex) const { return floatPolyline(boundaries_, boundaryIndex); }
+
+    /**
+     * @brief Gets the tessellation of a lane boundary, if the vertex format is
+     * VertexFormat::QUANTIZED.
+     *
+     * @param boundaryIndex The index of the boundary, see boundaryIndex().
+     * @returns             The polyline.
+     */
+    QuantizedPolyline quantizedBoundary(int boundaryIndex) const
+    {
+        return quantizedPolyline(boundaries_, boundaryIndex);
+    }
+
+    /**
+     * @brief Gets the tessellation of the center line of a lane, if the vertex
+     * format is VertexFormat::DOUBLE.
+     *
+     * @param globalLaneIndex   The global index of the lane.
+     * @returns                 The polyline.
+     */
+    Polyline centerLine(int globalLaneIndex) const { return polyline(centerLines_, globalLaneIndex); }
+
+    /**
+     * @brief Gets the tessellation of the center line of a lane, if the vertex
+     * format is VertexFormat::FLOAT.
+     *
+     * @param globalLaneIndex   The global index of the lane.
+     * @returns                 The polyline.
+     */
+    FloatPolyline floatCenterLine(int globalLaneIndex) const { return floatPolyline(centerLines_, globalLaneIndex); }
+
+    /**
+     * @brief Gets the tessellation of the center line of a lane, if the vertex
+     * format is VertexFormat::QUANTIZED.
+     *
+     * @param globalLaneIndex   The global index of the lane.
+     * @returns                 The polyline.
+     */
+    QuantizedPolyline quantizedCenterLine(int globalLaneIndex) const
+    {
+        return quantizedPolyline(centerLines_, globalLaneIndex);
+    }
+
+    /**
+     * @brief Gets the variances of the vertices of the center line of a lane,
+     * see LaneSection::CenterLineTessellation.
+     *
+     * @param globalLaneIndex   The global index of the lane.
+     * @returns                 The variances, one for each vertex of
+     *                          centerLine(globalLaneIndex).
+     */
+    const double* centerLineVariances(int globalLaneIndex) const
+    {
+        return centerLineVariances_.data() + centerLines_.offsets_[globalLaneIndex];
+    }
+
+  private:
+    /**
+     * @brief The vertices of a set of polylines, in the vertex format of the
+     * tessellator.
+     */
+    struct PolylineArrays
+    {
+        /**
+         * @brief The index of the first vertex of each polyline, followed by
+         * the total number of vertices.
+         */
+        std::vector<int> offsets_;
+
+        /**
+         * @brief The index of the road of each polyline.
+         */
+        std::vector<int> roads_;
+
+        std::vector<Eigen::Vector2d> vertices_;
+        std::vector<Eigen::Vector2f> floatVertices_;
+
+        /**
+         * @brief The words of the quantized polylines, and the index of the
+         * first word of each polyline, followed by the total number of words.
+         */
+        std::vector<int16_t> words_;
+        std::vector<int> wordOffsets_;
+
+        /**
+         * @brief The thread buffer into which each quantized polyline was
+         * encoded, and its first word in that buffer.
+         */
+        std::vector<std::pair<int, int>> wordSources_;
+
+        size_t memoryUsage() const
+        {
+            return vertices_.size() * sizeof(Eigen::Vector2d) + floatVertices_.size() * sizeof(Eigen::Vector2f) +
+                   words_.size() * sizeof(int16_t);
+        }
+    };
+
+    Polyline polyline(const PolylineArrays& arrays, int idx) const
+    {
+        assert(vertexFormat_ == VertexFormat::DOUBLE);
+
+        int begin = arrays.offsets_[idx];
+        return {arrays.vertices_.data() + begin, arrays.offsets_[idx + 1] - begin};
+    }
+
+    FloatPolyline floatPolyline(const PolylineArrays& arrays, int idx) const
+    {
+        assert(vertexFormat_ == VertexFormat::FLOAT);
+
+        int begin = arrays.offsets_[idx];
+        return {roadOrigins_[arrays.roads_[idx]], arrays.floatVertices_.data() + begin,
+                arrays.offsets_[idx + 1] - begin};
+    }
+
+    QuantizedPolyline quantizedPolyline(const PolylineArrays& arrays, int idx) const
+    {
+        assert(vertexFormat_ == VertexFormat::QUANTIZED);
+
+        int begin = arrays.wordOffsets_[idx];
+        return {roadOrigins_[arrays.roads_[idx]], quantizationStep_, arrays.words_.data() + begin,
+                arrays.wordOffsets_[idx + 1] - begin, arrays.offsets_[idx + 1] - arrays.offsets_[idx]};
+    }
+
+    /**
+     * @brief Calls @p fn with the index of each road, on @p numThreads
+     * threads, and rethrows the first exception it throws.
+     */
+    template <typename Fn>
+    void forEachRoad(int numThreads, Fn fn) const;
+
+    /**
+     * @brief Gets the index of a lane section among those of all roads.
+     */
+    int laneSectionIndex(LaneSectionKey laneSectionKey) const;
+
+    void tessellateReferenceLines(int roadIdx, const Options& options);
+    void tessellateLanes(int roadIdx, int threadIdx);
+
+    /**
+     * @brief Sizes the arrays of the vertex format, and releases those of the
+     * other formats.
+     */
+    void resizeVertexArrays(PolylineArrays& arrays) const;
+
+    /**
+     * @brief Stores the vertices of a polyline in the vertex format.
+     */
+    void storePolyline(PolylineArrays& arrays, int idx, const Eigen::Vector2d* vertices, int threadIdx);
+
+    /**
+     * @brief Gathers the words of the quantized polylines from the thread
+     * buffers into the words_ array.
+     */
+    void gatherWords(PolylineArrays& arrays) const;
+
+    const XodrMap& map_;
+
+    /**
+     * @brief The index of the first lane section of each road among the lane
+     * sections of all roads, followed by the total number of lane sections.
+     */
+    std::vector<int> laneSectionsBegin_;
+
+    /**
+     * @brief The index of the first boundary of each lane section, by the
+     * index of the lane section among those of all roads.
+     */
+    std::vector<int> laneSectionBoundariesBegin_;
+
+    /**
+     * @brief The roads, in the order in which their tasks are started: the
+     * longest roads first, so the threads run out of work at about the same
+     * time.
+     */
+    std::vector<int> roadOrder_;
+
+    /**
+     * @brief The reference line tessellations of the lane sections, by the
+     * index of the lane section among those of all roads.
+     */
+    std::vector<ReferenceLine::FrenetFrames> refLineFrames_;
+
+    VertexFormat vertexFormat_ = VertexFormat::DOUBLE;
+    double quantizationStep_ = 0;
+    std::vector<Eigen::Vector2d> roadOrigins_;
+
+    /**
+     * @brief The boundaries, by boundary index, and the center lines, by
+     * global lane index.
+     */
+    PolylineArrays boundaries_;
+    PolylineArrays centerLines_;
+    std::vector<double> centerLineVariances_;
+
+    /**
+     * @brief The buffers into which the threads tessellate the lane sections,
+     * and into which they encode quantized polylines.
+     */
+    std::vector<LaneSection::LaneTessellationBuffer> threadBuffers_;
+    std::vector<std::vector<int16_t>> threadWords_;
+};
+
+}}  // namespace aid::xodr
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Resolves a requested number of threads, where 0 means one thread per
+ * hardware thread.
+ *
+ * @param numThreads    The requested number of threads.
+ * @returns             The number of threads to use, at least 1.
+ */
+inline int resolveNumThreads(int numThreads)
+{
+    if (numThreads == 0)
+    {
+        numThreads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    return std::max(numThreads, 1);
+}
+
+/**
+ * @brief Calls @p fn(i, threadIdx) for each i in [0, count), distributed over
+ * @p numThreads threads, one of which is the calling thread.
+ *
+ * The threads take the next index from a shared counter, so the indices are
+ * started in increasing order. If a call throws, no further calls are started
+ * and the first exception is rethrown on the calling thread once all threads
+ * have finished.
+ *
+ * @param numThreads    The number of threads, see resolveNumThreads().
+ * @param count         The number of indices.
+ * @param fn            The function, which is called with the index and the
+ *                      index of the thread in [0, numThreads).
+ */
+template <typename Fn>
+void parallelFor(int numThreads, size_t count, Fn&& fn)
+{
+    // There's no point in starting more threads than there are indices.
+    numThreads = static_cast<int>(
+        std::min(static_cast<size_t>(resolveNumThreads(numThreads)), std::max(count, static_cast<size_t>(1))));
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr exception;
+
+    auto worker = [&](int threadIdx) {
+        try
+        {
+            size_t i;
+            while (!failed && (i = next++) < count)
+            {
+                fn(i, threadIdx);
+            }
+        }
+        catch (...)
+        {
+            // Only the first thread to fail stores its exception.
+            if (!failed.exchange(true))
+            {
+                exception = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < numThreads; i++)
+    {
+        threads.emplace_back(worker, i);
+    }
+
+    // The calling thread does its share of the work as well.
+    worker(0);
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+}}  // namespace aid::xodr
@@ -1,101 +1,649 @@
 #include "reference_line.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
-extern "C" {
-#include "odrSpiral/odrSpiral.h"
-}
+#include "simd_math.h"
 
 namespace aid { namespace xodr {
 
 static const double NUM_VERTICES_PER_METER = 1;
 
-ReferenceLine::ReferenceLine(const ReferenceLine& referenceLine) : endVertex_(referenceLine.endVertex_)
+int ReferenceLine::geometryContaining(double s) const
 {
-    geometries_.reserve(referenceLine.geometries_.size());
-    for (const auto& geometry : referenceLine.geometries_)
-    {
-        geometries_.emplace_back(geometry->clone());
-    }
+    assert(s >= -.00001 && s <= endVertex_.sCoord_ + .00001);
+    assert(!geometryStartS_.empty());
+
+    // The first geometry also covers s-coordinates slightly before its start.
+    auto it = std::upper_bound(geometryStartS_.begin() + 1, geometryStartS_.end(), s);
+    return static_cast<int>(it - geometryStartS_.begin()) - 1;
 }
 
-ReferenceLine& ReferenceLine::operator=(const ReferenceLine& referenceLine)
+ReferenceLine::PointAndTangentDir ReferenceLine::eval(double s) const
 {
-    endVertex_ = referenceLine.endVertex_;
-    geometries_.clear();
-    geometries_.reserve(referenceLine.geometries_.size());
-    for (const auto& geometry : referenceLine.geometries_)
-    {
-        geometries_.emplace_back(geometry->clone());
-    }
-    return *this;
+    return geometries_[geometryContaining(s)].eval(s);
 }
 
-const ReferenceLine::Geometry& ReferenceLine::geometryContaining(double s) const
+double ReferenceLine::evalCurvature(double s) const
 {
-    assert(s >= -.00001 && s <= endVertex_.sCoord_ + .00001);
+    return geometries_[geometryContaining(s)].evalCurvature(s);
+}
 
-    int geomsMin = 0;
-    int geomsMax = static_cast<int>(geometries_.size());
+void ReferenceLine::evalMany(const double* sCoords, int count, const PointsAndTangentDirs& out) const
+{
+    int numGeoms = static_cast<int>(geometries_.size());
+
+    // The s-range of a geometry, where the first and last geometries extend
+    // indefinitely, matching geometryContaining().
+    auto rangeStart = [&](int geom) {
+        return geom == 0 ? -std::numeric_limits<double>::infinity() : geometryStartS_[geom];
+    };
+    auto rangeEnd = [&](int geom) {
+        return geom == numGeoms - 1 ? std::numeric_limits<double>::infinity() : geometryStartS_[geom + 1];
+    };
+
+    int geom = 0;
+    int begin = 0;
+    while (begin < count)
+    {
+        // For sorted input, the cursor is either still at the right geometry
+        // or one before it, so the binary search is rarely needed.
+        double s = sCoords[begin];
+        if (s < rangeStart(geom) || s >= rangeEnd(geom))
+        {
+            if (geom + 1 < numGeoms && s >= rangeStart(geom + 1) && s < rangeEnd(geom + 1))
+            {
+                geom++;
+            }
+            else
+            {
+                geom = geometryContaining(s);
+            }
+        }
+
+        double start = rangeStart(geom);
+        double end = rangeEnd(geom);
+        int runEnd = begin + 1;
+        while (runEnd < count && sCoords[runEnd] >= start && sCoords[runEnd] < end)
+        {
+            runEnd++;
+        }
+
+        geometries_[geom].evalMany(sCoords + begin, runEnd - begin, out.offset(begin));
+        begin = runEnd;
+    }
+}
 
-    while (geomsMin != geomsMax - 1)
+template <typename Fn>
+void ReferenceLine::forEachGeometryInRange(double startS, double endS, Fn&& fn) const
+{
+    int numGeoms = static_cast<int>(geometries_.size());
+    for (int i = geometryContaining(startS); i < numGeoms; i++)
     {
-        int mid = (geomsMin + geomsMax) / 2;
-        if (s < geometries_[mid]->startVertex().sCoord_)
+        double geomStartS = geometryStartS_[i];
+        if (geomStartS > endS)
+        {
+            break;
+        }
+
+        double geomEndS;
+        if (i == numGeoms - 1)
         {
-            geomsMax = mid;
+            geomEndS = geomStartS + geometries_[i].geometry().length();
         }
         else
         {
-            geomsMin = mid;
+            geomEndS = geometryStartS_[i + 1];
+        }
+
+        double clampedStartS = std::max(startS, geomStartS);
+        double clampedEndS = std::min(endS, geomEndS);
+        if (clampedStartS < clampedEndS)
+        {
+            fn(geometries_[i], clampedStartS, clampedEndS);
         }
     }
-    return *geometries_[geomsMin];
 }
 
-ReferenceLine::PointAndTangentDir ReferenceLine::eval(double s) const
+ReferenceLine::Tessellation ReferenceLine::tessellate(double startS, double endS) const
 {
-    return geometryContaining(s).eval(s);
+    Tessellation ret;
+    tessellate(ret, startS, endS);
+    return ret;
 }
 
-double ReferenceLine::evalCurvature(double s) const
+ReferenceLine::Tessellation ReferenceLine::tessellate(double startS, double endS,
+                                                      const TessellationTolerance& tolerance) const
 {
-    return geometryContaining(s).evalCurvature(s);
+    Tessellation ret;
+    tessellate(ret, startS, endS, tolerance);
+    return ret;
 }
 
-ReferenceLine::Tessellation ReferenceLine::tessellate(double startS, double endS) const
+void ReferenceLine::tessellate(Tessellation& tessellation, double startS, double endS) const
 {
     assert(!geometries_.empty());
-    assert(startS >= geometries_[0]->startVertex().sCoord_);
+    assert(startS >= geometryStartS_[0]);
     assert(endS <= endVertex_.sCoord_);
     assert(startS < endS);
 
-    Tessellation ret;
+    tessellation.clear();
+
+    forEachGeometryInRange(startS, endS, [&](const GeometryUnion& geom, double geomStartS, double geomEndS) {
+        geom.tessellate(tessellation, geomStartS, geomEndS, geomEndS == endS);
+    });
+}
+
+void ReferenceLine::tessellate(Tessellation& tessellation, double startS, double endS,
+                               const TessellationTolerance& tolerance) const
+{
+    assert(!geometries_.empty());
+    assert(startS >= geometryStartS_[0]);
+    assert(endS <= endVertex_.sCoord_);
+    assert(startS < endS);
+    assert(tolerance.maxError_ > 0);
+
+    tessellation.clear();
+
+    forEachGeometryInRange(startS, endS, [&](const GeometryUnion& geom, double geomStartS, double geomEndS) {
+        geom.tessellate(tessellation, geomStartS, geomEndS, geomEndS == endS, tolerance);
+    });
+}
+
+void ReferenceLine::tessellate(FrenetFrames& frames, double startS, double endS) const
+{
+    assert(!geometries_.empty());
+    assert(startS >= geometryStartS_[0]);
+    assert(endS <= endVertex_.sCoord_);
+    assert(startS < endS);
+
+    frames.resize(0);
+    frames.elevations_.clear();
+
+    forEachGeometryInRange(startS, endS, [&](const GeometryUnion& geom, double geomStartS, double geomEndS) {
+        geom.tessellate(frames, geomStartS, geomEndS, geomEndS == endS);
+    });
+}
+
+void ReferenceLine::tessellate(FrenetFrames& frames, double startS, double endS,
+                               const TessellationTolerance& tolerance) const
+{
+    assert(!geometries_.empty());
+    assert(startS >= geometryStartS_[0]);
+    assert(endS <= endVertex_.sCoord_);
+    assert(startS < endS);
+    assert(tolerance.maxError_ > 0);
+
+    frames.resize(0);
+    frames.elevations_.clear();
+
+    forEachGeometryInRange(startS, endS, [&](const GeometryUnion& geom, double geomStartS, double geomEndS) {
+        geom.tessellate(frames, geomStartS, geomEndS, geomEndS == endS, tolerance);
+    });
+}
+
+ReferenceLine::GeometryUnion::GeometryUnion(const GeometryUnion& other) : type_(other.type_)
+{
+    switch (type_)
+    {
+        case GeometryType::LINE:
+            new (&line_) Line(other.line_);
+            break;
+        case GeometryType::SPIRAL:
+            new (&spiral_) Spiral(other.spiral_);
+            break;
+        case GeometryType::ARC:
+            new (&arc_) Arc(other.arc_);
+            break;
+        case GeometryType::POLY3:
+            new (&poly3_) Poly3Geom(other.poly3_);
+            break;
+        case GeometryType::PARAM_POLY3:
+            new (&paramPoly3_) ParamPoly3(other.paramPoly3_);
+            break;
+    }
+}
 
-    for (int i = 0; i < static_cast<int>(geometries_.size()); i++)
+// Spirals and the arc length tables of cubic geometries own memory, which is
+// moved rather than copied when the geometries of a reference line are
+// reallocated.
+ReferenceLine::GeometryUnion::GeometryUnion(GeometryUnion&& other) noexcept : type_(other.type_)
+{
+    switch (type_)
     {
-        const Geometry& geom = *geometries_[i];
+        case GeometryType::LINE:
+            new (&line_) Line(other.line_);
+            break;
+        case GeometryType::SPIRAL:
+            new (&spiral_) Spiral(std::move(other.spiral_));
+            break;
+        case GeometryType::ARC:
+            new (&arc_) Arc(other.arc_);
+            break;
+        case GeometryType::POLY3:
+            new (&poly3_) Poly3Geom(std::move(other.poly3_));
+            break;
+        case GeometryType::PARAM_POLY3:
+            new (&paramPoly3_) ParamPoly3(std::move(other.paramPoly3_));
+            break;
+    }
+}
 
-        double geomStartS = geom.startVertex().sCoord_;
-        double geomEndS;
-        if (i == static_cast<int>(geometries_.size()) - 1)
-        {
-            geomEndS = geomStartS + geom.length();
-        }
-        else
+ReferenceLine::GeometryUnion& ReferenceLine::GeometryUnion::operator=(const GeometryUnion& other)
+{
+    if (this != &other)
+    {
+        this->~GeometryUnion();
+        new (this) GeometryUnion(other);
+    }
+    return *this;
+}
+
+const ReferenceLine::Geometry& ReferenceLine::GeometryUnion::geometry() const
+{
+    switch (type_)
+    {
+        case GeometryType::LINE:
+            return line_;
+        case GeometryType::SPIRAL:
+            return spiral_;
+        case GeometryType::ARC:
+            return arc_;
+        case GeometryType::POLY3:
+            return poly3_;
+        case GeometryType::PARAM_POLY3:
+            return paramPoly3_;
+    }
+
+    assert(!"invalid geometry type");
+    return line_;
+}
+
+// The members are named by value, so the calls below are bound statically and
+// can be inlined, rather than going through the vtable.
+
+ReferenceLine::PointAndTangentDir ReferenceLine::GeometryUnion::eval(double s) const
+{
+    switch (type_)
+    {
+        case GeometryType::LINE:
+            return line_.Line::eval(s);
+        case GeometryType::SPIRAL:
+            return spiral_.Spiral::eval(s);
+        case GeometryType::ARC:
+            return arc_.Arc::eval(s);
+        case GeometryType::POLY3:
+            return poly3_.Poly3Geom::eval(s);
+        case GeometryType::PARAM_POLY3:
+            return paramPoly3_.ParamPoly3::eval(s);
+    }
+
+    assert(!"invalid geometry type");
+    return PointAndTangentDir();
+}
+
+// The batch kernels below compute the same values as the eval() functions of
+// the geometries, with everything that only depends on the geometry hoisted
+// out of the loop.
+
+static void evalManyLine(const ReferenceLine::Line& line, const double* sCoords, int count,
+                         const ReferenceLine::PointsAndTangentDirs& out)
+{
+    ReferenceLine::Vertex startVert = line.startVertex();
+    double forwardX = std::cos(startVert.heading_);
+    double forwardY = std::sin(startVert.heading_);
+
+    XODR_SIMD_LOOP
+    for (int i = 0; i < count; i++)
+    {
+        double t = sCoords[i] - startVert.sCoord_;
+        out.x_[i] = startVert.position_.x() + t * forwardX;
+        out.y_[i] = startVert.position_.y() + t * forwardY;
+        out.tangentX_[i] = forwardX;
+        out.tangentY_[i] = forwardY;
+    }
+}
+
+static void evalManySpiral(const ReferenceLine::Spiral& spiral, const double* sCoords, int count,
+                           const ReferenceLine::PointsAndTangentDirs& out)
+{
+    double startS = spiral.startVertex().sCoord_;
+    const Clothoid& clothoid = spiral.clothoid();
+
+    XODR_SIMD_LOOP
+    for (int i = 0; i < count; i++)
+    {
+        double u = sCoords[i] - startS;
+        clothoid.evalPoint(u, out.x_[i], out.y_[i]);
+        simd::sinCos(clothoid.evalHeading(u), out.tangentY_[i], out.tangentX_[i]);
+    }
+}
+
+static void evalManyArc(const ReferenceLine::Arc& arc, const double* sCoords, int count,
+                        const ReferenceLine::PointsAndTangentDirs& out)
+{
+    ReferenceLine::Vertex startVert = arc.startVertex();
+
+    double curvature = arc.curvature();
+    double radius = 1 / curvature;
+    double centerX = startVert.position_.x() - std::sin(startVert.heading_) * radius;
+    double centerY = startVert.position_.y() + std::cos(startVert.heading_) * radius;
+
+    XODR_SIMD_LOOP
+    for (int i = 0; i < count; i++)
+    {
+        double heading = startVert.heading_ + (sCoords[i] - startVert.sCoord_) * curvature;
+
+        double sinHeading, cosHeading;
+        simd::sinCos(heading, sinHeading, cosHeading);
+
+        out.x_[i] = centerX + sinHeading * radius;
+        out.y_[i] = centerY - cosHeading * radius;
+        out.tangentX_[i] = cosHeading;
+        out.tangentY_[i] = sinHeading;
+    }
+}
+
+static void evalManyPoly3(const ReferenceLine::Poly3Geom& poly3, const double* sCoords, int count,
+                          const ReferenceLine::PointsAndTangentDirs& out)
+{
+    ReferenceLine::Vertex startVert = poly3.startVertex();
+    double forwardX = std::cos(startVert.heading_);
+    double forwardY = std::sin(startVert.heading_);
+
+    const Poly3& poly = poly3.poly();
+    double a = poly.a_, b = poly.b_, c = poly.c_, d = poly.d_;
+
+    // The lookups in the arc length table aren't vectorizable, so the
+    // u-coordinates are stored in the output buffer first.
+    for (int i = 0; i < count; i++)
+    {
+        out.x_[i] = poly3.uCoordAt(sCoords[i]);
+    }
+
+    XODR_SIMD_LOOP
+    for (int i = 0; i < count; i++)
+    {
+        double u = out.x_[i];
+        double v = a + u * (b + u * (c + u * d));
+        double dv = b + u * (2 * c + u * 3 * d);
+
+        // side = (-forwardY, forwardX)
+        out.x_[i] = startVert.position_.x() + u * forwardX - v * forwardY;
+        out.y_[i] = startVert.position_.y() + u * forwardY + v * forwardX;
+
+        double tangentX = forwardX - dv * forwardY;
+        double tangentY = forwardY + dv * forwardX;
+        double invLength = 1 / std::sqrt(tangentX * tangentX + tangentY * tangentY);
+        out.tangentX_[i] = tangentX * invLength;
+        out.tangentY_[i] = tangentY * invLength;
+    }
+}
+
+static void evalManyParamPoly3(const ReferenceLine::ParamPoly3& paramPoly3, const double* sCoords, int count,
+                               const ReferenceLine::PointsAndTangentDirs& out)
+{
+    ReferenceLine::Vertex startVert = paramPoly3.startVertex();
+    double forwardX = std::cos(startVert.heading_);
+    double forwardY = std::sin(startVert.heading_);
+
+    const Poly3& uPoly = paramPoly3.uPoly();
+    const Poly3& vPoly = paramPoly3.vPoly();
+    double aU = uPoly.a_, bU = uPoly.b_, cU = uPoly.c_, dU = uPoly.d_;
+    double aV = vPoly.a_, bV = vPoly.b_, cV = vPoly.c_, dV = vPoly.d_;
+
+    // See evalManyPoly3().
+    for (int i = 0; i < count; i++)
+    {
+        out.x_[i] = paramPoly3.paramAt(sCoords[i]);
+    }
+
+    XODR_SIMD_LOOP
+    for (int i = 0; i < count; i++)
+    {
+        double p = out.x_[i];
+        double u = aU + p * (bU + p * (cU + p * dU));
+        double v = aV + p * (bV + p * (cV + p * dV));
+        double du = bU + p * (2 * cU + p * 3 * dU);
+        double dv = bV + p * (2 * cV + p * 3 * dV);
+
+        out.x_[i] = startVert.position_.x() + u * forwardX - v * forwardY;
+        out.y_[i] = startVert.position_.y() + u * forwardY + v * forwardX;
+
+        double tangentX = du * forwardX - dv * forwardY;
+        double tangentY = du * forwardY + dv * forwardX;
+        double invLength = 1 / std::sqrt(tangentX * tangentX + tangentY * tangentY);
+        out.tangentX_[i] = tangentX * invLength;
+        out.tangentY_[i] = tangentY * invLength;
+    }
+}
+
+void ReferenceLine::GeometryUnion::evalMany(const double* sCoords, int count, const PointsAndTangentDirs& out) const
+{
+    switch (type_)
+    {
+        case GeometryType::LINE:
+            evalManyLine(line_, sCoords, count, out);
+            break;
+        case GeometryType::SPIRAL:
+            evalManySpiral(spiral_, sCoords, count, out);
+            break;
+        case GeometryType::ARC:
+            evalManyArc(arc_, sCoords, count, out);
+            break;
+        case GeometryType::POLY3:
+            evalManyPoly3(poly3_, sCoords, count, out);
+            break;
+        case GeometryType::PARAM_POLY3:
+            evalManyParamPoly3(paramPoly3_, sCoords, count, out);
+            break;
+    }
+}
+
+double ReferenceLine::GeometryUnion::evalCurvature(double s) const
+{
+    switch (type_)
+    {
+        case GeometryType::LINE:
+            return line_.Line::evalCurvature(s);
+        case GeometryType::SPIRAL:
+            return spiral_.Spiral::evalCurvature(s);
+        case GeometryType::ARC:
+            return arc_.Arc::evalCurvature(s);
+        case GeometryType::POLY3:
+            return poly3_.Poly3Geom::evalCurvature(s);
+        case GeometryType::PARAM_POLY3:
+            return paramPoly3_.ParamPoly3::evalCurvature(s);
+    }
+
+    assert(!"invalid geometry type");
+    return 0;
+}
+
+void ReferenceLine::GeometryUnion::tessellate(Tessellation& tessellation, double startS, double endS,
+                                              bool includeEndPt) const
+{
+    switch (type_)
+    {
+        case GeometryType::LINE:
+            line_.Line::tessellate(tessellation, startS, endS, includeEndPt);
+            break;
+        case GeometryType::SPIRAL:
+            spiral_.Spiral::tessellate(tessellation, startS, endS, includeEndPt);
+            break;
+        case GeometryType::ARC:
+            arc_.Arc::tessellate(tessellation, startS, endS, includeEndPt);
+            break;
+        case GeometryType::POLY3:
+            poly3_.Poly3Geom::tessellate(tessellation, startS, endS, includeEndPt);
+            break;
+        case GeometryType::PARAM_POLY3:
+            paramPoly3_.ParamPoly3::tessellate(tessellation, startS, endS, includeEndPt);
+            break;
+    }
+}
+
+ReferenceLine::Vertex ReferenceLine::GeometryUnion::evalVertex(double s) const
+{
+    switch (type_)
+    {
+        case GeometryType::LINE:
+            return line_.Line::evalVertex(s);
+        case GeometryType::SPIRAL:
+            return spiral_.Spiral::evalVertex(s);
+        case GeometryType::ARC:
+            return arc_.Arc::evalVertex(s);
+        case GeometryType::POLY3:
+            return poly3_.Poly3Geom::evalVertex(s);
+        case GeometryType::PARAM_POLY3:
+            return paramPoly3_.ParamPoly3::evalVertex(s);
+    }
+
+    assert(!"invalid geometry type");
+    return Vertex();
+}
+
+/**
+ * @brief Computes the length of the longest step along a curve with at most
+ * the given absolute curvature, such that the chord deviates at most
+ * tolerance.maxError_ from the curve and from its lateral offset curves.
+ *
+ * A chord of length L of an arc with curvature k deviates at most k L^2 / 8
+ * from the arc. Offsetting the arc by t scales the deviation by |1 - k t|, and
+ * interpolating the offset linearly adds at most |t''| L^2 / 8.
+ */
+static double maxTessellationStep(double absCurvature, const ReferenceLine::TessellationTolerance& tolerance)
+{
+    // Keep the deviation well within the range where the quadratic estimate
+    // holds, by turning at most 45 degrees per step.
+    constexpr double MAX_HEADING_CHANGE = .25 * M_PI;
+
+    double bend = absCurvature * (1 + absCurvature * tolerance.maxLateralOffset_) +
+                  tolerance.maxLateralSecondDerivative_;
+    double step = bend > 0 ? std::sqrt(8 * tolerance.maxError_ / bend) : std::numeric_limits<double>::infinity();
+    if (absCurvature > 0)
+    {
+        step = std::min(step, MAX_HEADING_CHANGE / absCurvature);
+    }
+    return step;
+}
+
+template <typename EmitFn>
+void ReferenceLine::GeometryUnion::forEachAdaptiveTessellationS(double startS, double endS, bool includeEndPt,
+                                                                const TessellationTolerance& tolerance,
+                                                                EmitFn&& emit) const
+{
+    // Steps shorter than this are never taken, which guarantees progress when
+    // the tolerance is unreasonably small.
+    constexpr double MIN_STEP = 1e-4;
+
+    auto absCurvature = [this](double s) { return type_ == GeometryType::LINE ? 0 : std::abs(evalCurvature(s)); };
+
+    double s = startS;
+    while (true)
+    {
+        emit(s);
+
+        // The step is based on the largest curvature found in it. For lines,
+        // arcs and spirals, the curvature is monotonic, so its maximum lies at
+        // one of the ends of the step. Shrinking the step can only lower the
+        // maximum, so a few iterations settle on a valid step.
+        double startCurvature = absCurvature(s);
+        double step = maxTessellationStep(startCurvature, tolerance);
+        for (int i = 0; i < 4; i++)
         {
-            geomEndS = geometries_[i + 1]->startVertex().sCoord_;
+            double stepEndS = std::min(s + step, endS);
+            double maxCurvature =
+                std::max({startCurvature, absCurvature(stepEndS), absCurvature(.5 * (s + stepEndS))});
+            double maxStep = maxTessellationStep(maxCurvature, tolerance);
+            if (maxStep >= stepEndS - s)
+            {
+                break;
+            }
+            step = maxStep;
         }
 
-        double clampedStartS = std::max(startS, geomStartS);
-        double clampedEndS = std::min(endS, geomEndS);
-        if (clampedStartS < clampedEndS)
+        // Don't leave a sliver of a segment before the end.
+        s += std::max(step, MIN_STEP);
+        if (s >= endS - MIN_STEP)
         {
-            geom.tessellate(ret, clampedStartS, clampedEndS, clampedEndS == endS);
+            break;
         }
     }
 
-    return ret;
+    if (includeEndPt)
+    {
+        emit(endS);
+    }
+}
+
+void ReferenceLine::GeometryUnion::tessellate(Tessellation& tessellation, double startS, double endS,
+                                              bool includeEndPt, const TessellationTolerance& tolerance) const
+{
+    forEachAdaptiveTessellationS(startS, endS, includeEndPt, tolerance,
+                                 [&](double s) { tessellation.push_back(evalVertex(s)); });
+}
+
+void ReferenceLine::GeometryUnion::tessellate(FrenetFrames& frames, double startS, double endS,
+                                              bool includeEndPt) const
+{
+    // The same vertices as the fixed-rate tessellate() of the geometries.
+    int num = static_cast<int>(std::ceil((endS - startS) * NUM_VERTICES_PER_METER));
+    double stepSize = (endS - startS) / num;
+
+    if (includeEndPt)
+    {
+        num++;
+    }
+
+    int begin = frames.size();
+    for (int i = 0; i < num; i++)
+    {
+        frames.sCoords_.push_back(startS + i * stepSize);
+    }
+    evalFrames(frames, begin);
+}
+
+void ReferenceLine::GeometryUnion::tessellate(FrenetFrames& frames, double startS, double endS, bool includeEndPt,
+                                              const TessellationTolerance& tolerance) const
+{
+    int begin = frames.size();
+    forEachAdaptiveTessellationS(startS, endS, includeEndPt, tolerance,
+                                 [&](double s) { frames.sCoords_.push_back(s); });
+    evalFrames(frames, begin);
+}
+
+void ReferenceLine::GeometryUnion::evalFrames(FrenetFrames& frames, int begin) const
+{
+    int end = static_cast<int>(frames.sCoords_.size());
+    frames.resize(end);
+
+    evalMany(frames.sCoords_.data() + begin, end - begin, frames.pointsAndTangentDirs(begin));
+    for (int i = begin; i < end; i++)
+    {
+        frames.curvatures_[i] = evalCurvature(frames.sCoords_[i]);
+    }
+}
+
+ReferenceLine::Vertex ReferenceLine::GeometryUnion::endVertex() const
+{
+    switch (type_)
+    {
+        case GeometryType::LINE:
+            return line_.Line::endVertex();
+        case GeometryType::SPIRAL:
+            return spiral_.Spiral::endVertex();
+        case GeometryType::ARC:
+            return arc_.Arc::endVertex();
+        case GeometryType::POLY3:
+            return poly3_.Poly3Geom::endVertex();
+        case GeometryType::PARAM_POLY3:
+            return paramPoly3_.ParamPoly3::endVertex();
+    }
+
+    assert(!"invalid geometry type");
+    return Vertex();
 }
 
 ReferenceLine::Geometry::Geometry(const Vertex& startVertex, double length) : startVertex_(startVertex), length_(length)
@@ -108,6 +656,38 @@ bool ReferenceLine::Geometry::inSRange(double s) const
     return localS >= -.00001 && localS < length_ + .00001;
 }
 
+double ReferenceLine::Geometry::nearestS(const Eigen::Vector2d& point, double sHint) const
+{
+    constexpr int MAX_ITERATIONS = 32;
+
+    double startS = startVertex_.sCoord_;
+    double endS = startS + length_;
+    double s = std::min(std::max(sHint, startS), endS);
+    for (int i = 0; i < MAX_ITERATIONS; i++)
+    {
+        // f is half the derivative of the squared distance with respect to s,
+        // and df its derivative, for a curve with a unit tangent.
+        PointAndTangentDir pt = eval(s);
+        Eigen::Vector2d toCurve = pt.point_ - point;
+        Eigen::Vector2d normal(-pt.tangentDir_.y(), pt.tangentDir_.x());
+        double f = toCurve.dot(pt.tangentDir_);
+        double df = 1 + evalCurvature(s) * toCurve.dot(normal);
+
+        // Where the point lies beyond the center of curvature, the squared
+        // distance isn't convex, and the Newton step would go the wrong way,
+        // so fall back to a gradient step.
+        double step = df > .1 ? f / df : f;
+        double nextS = std::min(std::max(s - step, startS), endS);
+        if (std::abs(nextS - s) < 1e-12 * std::max(1.0, std::abs(s)))
+        {
+            return nextS;
+        }
+        s = nextS;
+    }
+
+    return s;
+}
+
 ReferenceLine::Line::Line(double startS, const Eigen::Vector2d& from, const Eigen::Vector2d& to)
 {
     assert(!from.isApprox(to));
@@ -148,6 +728,20 @@ double ReferenceLine::Line::evalCurvature(double s) const
     return 0;
 }
 
+ReferenceLine::Vertex ReferenceLine::Line::evalVertex(double s) const
+{
+    assert(inSRange(s));
+
+    const Vertex& startVert = startVertex();
+    Eigen::Vector2d forward(std::cos(startVert.heading_), std::sin(startVert.heading_));
+
+    Vertex ret;
+    ret.sCoord_ = s;
+    ret.position_ = startVert.position_ + (s - startVert.sCoord_) * forward;
+    ret.heading_ = startVert.heading_;
+    return ret;
+}
+
 void ReferenceLine::Line::tessellate(Tessellation& tessellation, double startS, double endS, bool includeEndPt) const
 {
     const Vertex& startVert = startVertex();
@@ -180,6 +774,15 @@ void ReferenceLine::Line::tessellate(Tessellation& tessellation, double startS,
     }
 }
 
+double ReferenceLine::Line::nearestS(const Eigen::Vector2d& point, double) const
+{
+    const Vertex& startVert = startVertex();
+
+    Eigen::Vector2d forward(std::cos(startVert.heading_), std::sin(startVert.heading_));
+    double localS = (point - startVert.position_).dot(forward);
+    return startVert.sCoord_ + std::min(std::max(localS, 0.0), length());
+}
+
 ReferenceLine::Vertex ReferenceLine::Line::endVertex() const
 {
     const Vertex& startVert = startVertex();
@@ -200,41 +803,43 @@ ReferenceLine::Spiral::Spiral(const GeometryAttribs& geomAttribs, double startCu
     setGeometryAttribs(geomAttribs);
     startCurvature_ = startCurvature;
     endCurvature_ = endCurvature;
+    initClothoid();
 }
 
 ReferenceLine::Spiral::Spiral(const Vertex& startVertex, double length, double startCurvature, double endCurvature)
     : Geometry(startVertex, length), startCurvature_(startCurvature), endCurvature_(endCurvature)
 {
+    initClothoid();
 }
 
-ReferenceLine::Spiral* ReferenceLine::Spiral::clone() const
+ReferenceLine::Spiral::Spiral(const Vertex& startVertex, double length, double startCurvature, double endCurvature,
+                              const double* clothoidCoeffs, int numClothoidPieces)
+    : Geometry(startVertex, length), startCurvature_(startCurvature), endCurvature_(endCurvature)
 {
-    return new Spiral(startVertex(), length(), startCurvature_, endCurvature_);
+    clothoid_ = Clothoid(startVertex.heading_, startCurvature_, curvatureRateOfChange(), length, clothoidCoeffs,
+                         numClothoidPieces);
 }
 
-ReferenceLine::PointAndTangentDir ReferenceLine::Spiral::eval(double s) const
+void ReferenceLine::Spiral::initClothoid()
 {
-    assert(inSRange(s));
-
     const Vertex& startVert = startVertex();
+    clothoid_ = Clothoid(startVert.position_, startVert.heading_, startCurvature_, curvatureRateOfChange(), length());
+}
 
-    double curvatureROC = curvatureRateOfChange();
-    double curveStartParam = startCurvature_ / curvatureROC;
-    double curveEvalParam = curveStartParam + (s - startVert.sCoord_);
-
-    Eigen::Vector2d curveStartPt, curveEndPt;
-    double curveStartHeading, curveEvalHeading;
-
-    odrSpiral(curveStartParam, curvatureROC, &curveStartPt.x(), &curveStartPt.y(), &curveStartHeading);
-    odrSpiral(curveEvalParam, curvatureROC, &curveEndPt.x(), &curveEndPt.y(), &curveEvalHeading);
+ReferenceLine::Spiral* ReferenceLine::Spiral::clone() const
+{
+    return new Spiral(*this);
+}
 
-    Eigen::Vector2d offset = curveEndPt - curveStartPt;
-    offset = Eigen::Rotation2Dd(startVert.heading_ - curveStartHeading) * offset;
+ReferenceLine::PointAndTangentDir ReferenceLine::Spiral::eval(double s) const
+{
+    assert(inSRange(s));
 
-    double heading = startVert.heading_ + (curveEvalHeading - curveStartHeading);
+    double u = s - startVertex().sCoord_;
+    double heading = clothoid_.evalHeading(u);
 
     PointAndTangentDir ret;
-    ret.point_ = startVert.position_ + offset;
+    ret.point_ = clothoid_.evalPoint(u);
     ret.tangentDir_ = Eigen::Vector2d(std::cos(heading), std::sin(heading));
     return ret;
 }
@@ -246,19 +851,21 @@ double ReferenceLine::Spiral::evalCurvature(double s) const
     return startCurvature_ + (s - startVertex().sCoord_) * curvatureRateOfChange();
 }
 
-void ReferenceLine::Spiral::tessellate(Tessellation& tessellation, double startS, double endS, bool includeEndPt) const
+ReferenceLine::Vertex ReferenceLine::Spiral::evalVertex(double s) const
 {
-    const Vertex& startVert = startVertex();
-
-    double rateOfChange = (endCurvature_ - startCurvature_) / length();
-    double curveStartParam = startCurvature_ / rateOfChange;
+    assert(inSRange(s));
 
-    Eigen::Vector2d curveStartPt;
-    double curveStartHeading;
-    odrSpiral(curveStartParam, rateOfChange, &curveStartPt.x(), &curveStartPt.y(), &curveStartHeading);
+    double u = s - startVertex().sCoord_;
 
-    Eigen::Matrix2d rotation = Eigen::Rotation2Dd(startVert.heading_ - curveStartHeading).toRotationMatrix();
+    Vertex ret;
+    ret.sCoord_ = s;
+    ret.position_ = clothoid_.evalPoint(u);
+    ret.heading_ = clothoid_.evalHeading(u);
+    return ret;
+}
 
+void ReferenceLine::Spiral::tessellate(Tessellation& tessellation, double startS, double endS, bool includeEndPt) const
+{
     int num = static_cast<int>(std::ceil((endS - startS) * NUM_VERTICES_PER_METER));
     double stepSize = (endS - startS) / num;
 
@@ -267,48 +874,18 @@ void ReferenceLine::Spiral::tessellate(Tessellation& tessellation, double startS
         num++;
     }
 
-    double startParam = curveStartParam + (startS - startVert.sCoord_);
     for (int i = 0; i < num; i++)
     {
-        Vertex vert;
-
-        vert.sCoord_ = startS + i * stepSize;
-
-        double t = startParam + i * stepSize;
-        Eigen::Vector2d curvePt;
-        double curveHeading;
-        odrSpiral(t, rateOfChange, &curvePt.x(), &curvePt.y(), &curveHeading);
-
-        vert.position_ = rotation * (curvePt - curveStartPt) + startVert.position_;
-        vert.heading_ = startVert.heading_ + (curveHeading - curveStartHeading);
-
-        tessellation.push_back(vert);
+        tessellation.push_back(evalVertex(startS + i * stepSize));
     }
 }
 
 ReferenceLine::Vertex ReferenceLine::Spiral::endVertex() const
 {
-    const Vertex& startVert = startVertex();
-
-    double curvatureROC = curvatureRateOfChange();
-    double curveStartParam = startCurvature_ / curvatureROC;
-    double curveEndParam = curveStartParam + length();
-
-    Eigen::Vector2d curveStartPt, curveEndPt;
-    double curveStartHeading, curveEndHeading;
-
-    odrSpiral(curveStartParam, curvatureROC, &curveStartPt.x(), &curveStartPt.y(), &curveStartHeading);
-    odrSpiral(curveEndParam, curvatureROC, &curveEndPt.x(), &curveEndPt.y(), &curveEndHeading);
-
-    Eigen::Vector2d offset = curveEndPt - curveStartPt;
-
-    Eigen::Rotation2Dd rotation(startVert.heading_ - curveStartHeading);
-    offset = rotation * offset;
-
     Vertex ret;
-    ret.sCoord_ = startVert.sCoord_ + length();
-    ret.position_ = startVert.position_ + offset;
-    ret.heading_ = startVert.heading_ + (curveEndHeading - curveStartHeading);
+    ret.sCoord_ = startVertex().sCoord_ + length();
+    ret.position_ = clothoid_.evalPoint(length());
+    ret.heading_ = clothoid_.evalHeading(length());
     return ret;
 }
 
@@ -377,6 +954,25 @@ double ReferenceLine::Arc::evalCurvature(double s) const
     return curvature_;
 }
 
+ReferenceLine::Vertex ReferenceLine::Arc::evalVertex(double s) const
+{
+    assert(inSRange(s));
+
+    const Vertex& startVert = startVertex();
+
+    double radius = 1 / curvature_;
+    Eigen::Vector2d toCenter(-std::sin(startVert.heading_), std::cos(startVert.heading_));
+    Eigen::Vector2d center = startVert.position_ + toCenter * radius;
+
+    Vertex ret;
+    ret.sCoord_ = s;
+    ret.heading_ = startVert.heading_ + (s - startVert.sCoord_) * curvature_;
+
+    Eigen::Vector2d toCircle(std::sin(ret.heading_), -std::cos(ret.heading_));
+    ret.position_ = center + toCircle * radius;
+    return ret;
+}
+
 void ReferenceLine::Arc::tessellate(Tessellation& tessellation, double startS, double endS, bool includeEndPt) const
 {
     const Vertex& startVert = startVertex();
@@ -409,6 +1005,47 @@ void ReferenceLine::Arc::tessellate(Tessellation& tessellation, double startS, d
     }
 }
 
+double ReferenceLine::Arc::nearestS(const Eigen::Vector2d& point, double) const
+{
+    const Vertex& startVert = startVertex();
+
+    double radius = 1 / curvature_;
+    Eigen::Vector2d startNormal(-std::sin(startVert.heading_), std::cos(startVert.heading_));
+    Eigen::Vector2d center = startVert.position_ + startNormal * radius;
+
+    // All points on the circle are equally near to its center.
+    Eigen::Vector2d fromCenter = point - center;
+    if (fromCenter.squaredNorm() < 1e-24)
+    {
+        return startVert.sCoord_;
+    }
+
+    // The point on the circle nearest to the given point has the direction
+    // fromCenter from the center, so its heading is perpendicular to it.
+    // Measure the angle from the start heading in the direction of travel.
+    if (radius < 0)
+    {
+        fromCenter = -fromCenter;
+    }
+    double heading = std::atan2(fromCenter.x(), -fromCenter.y());
+    double angle = std::remainder((heading - startVert.heading_) * (curvature_ > 0 ? 1 : -1), 2 * M_PI);
+    if (angle < 0)
+    {
+        angle += 2 * M_PI;
+    }
+
+    double localS = angle * std::abs(radius);
+    if (localS <= length())
+    {
+        return startVert.sCoord_ + localS;
+    }
+
+    // Otherwise, the nearest point is one of the end points.
+    double startDistance = (point - startVert.position_).squaredNorm();
+    double endDistance = (point - endVertex().position_).squaredNorm();
+    return startVert.sCoord_ + (endDistance < startDistance ? length() : 0);
+}
+
 ReferenceLine::Vertex ReferenceLine::Arc::endVertex() const
 {
     const Vertex& startVert = startVertex();
@@ -438,6 +1075,12 @@ ReferenceLine::Poly3Geom::Poly3Geom(const Vertex& startVertex, double length, co
 {
 }
 
+ReferenceLine::Poly3Geom::Poly3Geom(const Vertex& startVertex, double length, const Poly3& poly,
+                                    const ArcLengthTable& arcLengthTable)
+    : Geometry(startVertex, length), poly_(poly), arcLengthTable_(arcLengthTable)
+{
+}
+
 ReferenceLine::Poly3Geom* ReferenceLine::Poly3Geom::clone() const
 {
     return new Poly3Geom(startVertex(), length(), poly_);
@@ -453,7 +1096,7 @@ ReferenceLine::PointAndTangentDir ReferenceLine::Poly3Geom::eval(double s) const
 
     PointAndTangentDir ret;
 
-    double u = s - startVert.sCoord_;
+    double u = uCoordAt(s);
     double v = poly_.eval(u);
     ret.point_ = startVert.position_ + u * forward + v * side;
 
@@ -468,12 +1111,30 @@ double ReferenceLine::Poly3Geom::evalCurvature(double s) const
 {
     assert(inSRange(s));
 
-    double u = s - startVertex().sCoord_;
+    double u = uCoordAt(s);
     double derivative = poly_.evalDerivative(u);
 
     return poly_.eval2ndDerivative(u) / std::pow(1 + derivative * derivative, 1.5);
 }
 
+ReferenceLine::Vertex ReferenceLine::Poly3Geom::evalVertex(double s) const
+{
+    assert(inSRange(s));
+
+    const Vertex& startVert = startVertex();
+    Eigen::Vector2d forward(std::cos(startVert.heading_), std::sin(startVert.heading_));
+    Eigen::Vector2d side(-forward.y(), forward.x());
+
+    double u = uCoordAt(s);
+    double v = poly_.eval(u);
+
+    Vertex ret;
+    ret.sCoord_ = s;
+    ret.position_ = startVert.position_ + u * forward + v * side;
+    ret.heading_ = startVert.heading_ + std::atan(poly_.evalDerivative(u));
+    return ret;
+}
+
 void ReferenceLine::Poly3Geom::tessellate(Tessellation& tessellation, double startS, double endS,
                                           bool includeEndPt) const
 {
@@ -486,8 +1147,6 @@ void ReferenceLine::Poly3Geom::tessellate(Tessellation& tessellation, double sta
     Eigen::Vector2d forward(std::cos(startVert.heading_), std::sin(startVert.heading_));
     Eigen::Vector2d side(-forward.y(), forward.x());
 
-    double startU = startS - startVert.sCoord_;
-
     int num = static_cast<int>(std::ceil((endS - startS) * NUM_VERTICES_PER_METER));
     double stepSize = (endS - startS) / num;
 
@@ -501,7 +1160,7 @@ void ReferenceLine::Poly3Geom::tessellate(Tessellation& tessellation, double sta
         Vertex vertex;
         vertex.sCoord_ = startS + i * stepSize;
 
-        double u = startU + i * stepSize;
+        double u = uCoordAt(vertex.sCoord_);
         double v = poly_.eval(u);
         vertex.position_ = startVert.position_ + u * forward + v * side;
 
@@ -519,13 +1178,13 @@ ReferenceLine::Vertex ReferenceLine::Poly3Geom::endVertex() const
     Eigen::Vector2d forward(std::cos(startVert.heading_), std::sin(startVert.heading_));
     Eigen::Vector2d side(-forward.y(), forward.x());
 
-    double endU = length();
-    double endV = poly_.eval(length());
+    double endU = uCoordAt(startVert.sCoord_ + length());
+    double endV = poly_.eval(endU);
 
-    double headingDiff = std::atan(poly_.evalDerivative(length()));
+    double headingDiff = std::atan(poly_.evalDerivative(endU));
 
     Vertex ret;
-    ret.sCoord_ = startVert.sCoord_ + endU;
+    ret.sCoord_ = startVert.sCoord_ + length();
     ret.position_ = startVert.position_ + endU * forward + endV * side;
     ret.heading_ = startVert.heading_ + headingDiff;
     return ret;
@@ -533,8 +1192,9 @@ ReferenceLine::Vertex ReferenceLine::Poly3Geom::endVertex() const
 
 double ReferenceLine::Poly3Geom::endCurvature() const
 {
-    double vDeriv = poly_.evalDerivative(length());
-    double v2ndDeriv = poly_.eval2ndDerivative(length());
+    double endU = uCoordAt(startVertex().sCoord_ + length());
+    double vDeriv = poly_.evalDerivative(endU);
+    double v2ndDeriv = poly_.eval2ndDerivative(endU);
 
     double sqrSpeed = 1 + vDeriv * vDeriv;
     double curvature = v2ndDeriv / (std::sqrt(sqrSpeed) * sqrSpeed);
@@ -557,6 +1217,12 @@ ReferenceLine::ParamPoly3::ParamPoly3(const Vertex& startVertex, double length,
 {
 }
 
+ReferenceLine::ParamPoly3::ParamPoly3(const Vertex& startVertex, double length, const Poly3& uPoly, const Poly3& vPoly,
+                                      PRange pRange, const ArcLengthTable& arcLengthTable)
+    : Geometry(startVertex, length), uPoly_(uPoly), vPoly_(vPoly), pRange_(pRange), arcLengthTable_(arcLengthTable)
+{
+}
+
 ReferenceLine::ParamPoly3* ReferenceLine::ParamPoly3::clone() const
 {
     return new ParamPoly3(startVertex(), length(), uPoly_, vPoly_, pRange_);
@@ -572,11 +1238,7 @@ ReferenceLine::PointAndTangentDir ReferenceLine::ParamPoly3::eval(double s) cons
 
     PointAndTangentDir ret;
 
-    double param = s - startVert.sCoord_;
-    if (pRange_ == PRange::NORMALIZED)
-    {
-        param /= length();
-    }
+    double param = paramAt(s);
 
     double u = uPoly_.eval(param);
     double v = vPoly_.eval(param);
@@ -593,11 +1255,7 @@ double ReferenceLine::ParamPoly3::evalCurvature(double s) const
 {
     assert(inSRange(s));
 
-    double param = s - startVertex().sCoord_;
-    if (pRange_ == PRange::NORMALIZED)
-    {
-        param /= length();
-    }
+    double param = paramAt(s);
     double numerator = uPoly_.evalDerivative(param) * vPoly_.eval2ndDerivative(param) -
                        vPoly_.evalDerivative(param) * uPoly_.eval2ndDerivative(param);
     double derivativeU = uPoly_.evalDerivative(param);
@@ -606,6 +1264,26 @@ double ReferenceLine::ParamPoly3::evalCurvature(double s) const
     return numerator / denominator;
 }
 
+ReferenceLine::Vertex ReferenceLine::ParamPoly3::evalVertex(double s) const
+{
+    assert(inSRange(s));
+
+    const Vertex& startVert = startVertex();
+    Eigen::Vector2d forward(std::cos(startVert.heading_), std::sin(startVert.heading_));
+    Eigen::Vector2d side(-forward.y(), forward.x());
+
+    double param = paramAt(s);
+
+    double u = uPoly_.eval(param);
+    double v = vPoly_.eval(param);
+
+    Vertex ret;
+    ret.sCoord_ = s;
+    ret.position_ = startVert.position_ + u * forward + v * side;
+    ret.heading_ = startVert.heading_ + std::atan2(vPoly_.evalDerivative(param), uPoly_.evalDerivative(param));
+    return ret;
+}
+
 void ReferenceLine::ParamPoly3::tessellate(Tessellation& tessellation, double startS, double endS,
                                            bool includeEndPt) const
 {
@@ -618,19 +1296,8 @@ void ReferenceLine::ParamPoly3::tessellate(Tessellation& tessellation, double st
     Eigen::Vector2d forward(std::cos(startVert.heading_), std::sin(startVert.heading_));
     Eigen::Vector2d side(-forward.y(), forward.x());
 
-    double startParam = startS - startVert.sCoord_;
-
     int num = static_cast<int>(std::ceil((endS - startS) * NUM_VERTICES_PER_METER));
-
     double stepSize = (endS - startS) / num;
-    double paramStepSize = stepSize;
-
-    if (pRange_ == PRange::NORMALIZED)
-    {
-        double scale = 1 / length();
-        startParam *= scale;
-        paramStepSize *= scale;
-    }
 
     if (includeEndPt)
     {
@@ -643,7 +1310,7 @@ void ReferenceLine::ParamPoly3::tessellate(Tessellation& tessellation, double st
 
         vert.sCoord_ = startS + i * stepSize;
 
-        double t = startParam + i * paramStepSize;
+        double t = paramAt(vert.sCoord_);
         double u = uPoly_.eval(t);
         double v = vPoly_.eval(t);
         vert.position_ = startVert.position_ + u * forward + v * side;
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cassert>
 #include <memory>
 #include <Eigen/Dense>
 
 #include "xodr_reader.h"
+#include "xodr_arena.h"
+#include "arc_length_table.h"
+#include "clothoid.h"
 #include "poly3.h"
 
 namespace aid { namespace xodr {
@@ -22,6 +26,7 @@ class TestFactory;
 class ReferenceLine
 {
     friend class TestFactory;
+    friend class XodrBinarySerializer;
 
   public:
     struct Vertex
@@ -97,11 +102,133 @@ class ReferenceLine
         Eigen::Vector2d tangentDir_;
     };
 
+    /**
+     * @brief Output buffers for points and tangent directions, in
+     * structure-of-arrays layout.
+     *
+     * Each member points to a caller-provided array with one element for each
+     * evaluated s-coordinate.
+     */
+    struct PointsAndTangentDirs
+    {
+        double* x_;
+        double* y_;
+        double* tangentX_;
+        double* tangentY_;
+
+        /**
+         * @returns Buffers which start @p offset elements further into these ones.
+         */
+        PointsAndTangentDirs offset(int offset) const
+        {
+            return {x_ + offset, y_ + offset, tangentX_ + offset, tangentY_ + offset};
+        }
+    };
+
     /**
      * @brief A Tessellation is a piecewise linear approximation of a reference line.
      */
     using Tessellation = std::vector<Vertex>;
 
+    /**
+     * @brief A tessellation of a reference line which also holds the Frenet
+     * frame and the curvature at each vertex, in structure-of-arrays layout.
+     *
+     * The unit tangent of vertex i is (tangentX_[i], tangentY_[i]), and its
+     * unit normal, which points to the left, is (-tangentY_[i], tangentX_[i]).
+     * Consumers which offset the vertices laterally can use these directly,
+     * rather than evaluating the sine and cosine of the heading.
+     *
+     * All arrays except elevations_ have the same size. Functions which fill a
+     * FrenetFrames overwrite it and keep the capacity of its arrays, so it can
+     * be reused without allocating.
+     */
+    struct FrenetFrames
+    {
+        std::vector<double> sCoords_;
+        std::vector<double> x_;
+        std::vector<double> y_;
+        std::vector<double> tangentX_;
+        std::vector<double> tangentY_;
+
+        /**
+         * @brief The signed curvatures at the vertices, positive when the
+         * reference line turns left.
+         */
+        std::vector<double> curvatures_;
+
+        /**
+         * @brief The elevations (z-coordinates) of the vertices.
+         *
+         * The reference line itself is 2D, so ReferenceLine::tessellate()
+         * leaves this empty. Road::tessellateReferenceLine() fills it from the
+         * road's elevation profile, which gives a 3D tessellation.
+         */
+        std::vector<double> elevations_;
+
+        /**
+         * @returns The number of vertices.
+         */
+        int size() const { return static_cast<int>(sCoords_.size()); }
+
+        /**
+         * @returns Whether elevations_ holds the elevation of each vertex.
+         */
+        bool hasElevations() const { return elevations_.size() == sCoords_.size(); }
+
+        /**
+         * @brief Resizes all arrays except elevations_ to @p size elements.
+         */
+        void resize(int size)
+        {
+            sCoords_.resize(size);
+            x_.resize(size);
+            y_.resize(size);
+            tangentX_.resize(size);
+            tangentY_.resize(size);
+            curvatures_.resize(size);
+        }
+
+        /**
+         * @returns The arrays of the points and tangent directions, starting at
+         * vertex @p offset, in the form accepted by evalMany().
+         */
+        PointsAndTangentDirs pointsAndTangentDirs(int offset)
+        {
+            return {x_.data() + offset, y_.data() + offset, tangentX_.data() + offset, tangentY_.data() + offset};
+        }
+    };
+
+    /**
+     * @brief The maximum error of an adaptive tessellation.
+     *
+     * An adaptive tessellation places its vertices such that the polyline
+     * deviates at most maxError_ from the reference line. When lateral offset
+     * curves (such as lane boundaries) are derived from the tessellation by
+     * offsetting its vertices, the bound can be extended to those curves by
+     * describing their offsets with maxLateralOffset_ and
+     * maxLateralSecondDerivative_.
+     */
+    struct TessellationTolerance
+    {
+        /**
+         * @brief The maximum distance between the polyline and the curve.
+         */
+        double maxError_;
+
+        /**
+         * @brief The maximum absolute lateral offset (t-coordinate) of the
+         * offset curves.
+         */
+        double maxLateralOffset_ = 0;
+
+        /**
+         * @brief The maximum absolute second derivative of the lateral offsets
+         * with respect to s.
+         */
+        double maxLateralSecondDerivative_ = 0;
+    };
+
     /**
      * @brief The type of a @ref Geometry.
      *
@@ -250,6 +377,21 @@ class ReferenceLine
          */
         virtual double evalCurvature(double s) const = 0;
 
+        /**
+         * @brief Evaluates the vertex on this geometry with the given
+         * s-coordinate.
+         *
+         * The heading of the vertex is continuous along the geometry, like the
+         * headings of the vertices created by tessellate().
+         *
+         * The s-coordinate must lie in the s-interval of this geometry (that is,
+         * the interval [startVertex().sCoord_, endVertex().sCoord_]).
+         *
+         * @param s     The s-coordinate.
+         * @return      The vertex.
+         */
+        virtual Vertex evalVertex(double s) const = 0;
+
         /**
          * Tessellates the section of this geometry which falls in the
          * [startS, endS] range. [startS, endS] must be a subset of the full
@@ -264,6 +406,24 @@ class ReferenceLine
          */
         virtual void tessellate(Tessellation& tessellation, double startS, double endS, bool includeEndPt) const = 0;
 
+        /**
+         * @brief Finds the s-coordinate of the point on this geometry which is
+         * nearest to the given point.
+         *
+         * The default implementation refines @p sHint with Newton's method on
+         * the derivative of the squared distance, so it finds the nearest
+         * point if @p sHint is close enough to it, for example if it's the
+         * s-coordinate of the nearest point on a tessellation of the geometry.
+         * Line and Arc have closed form implementations, which ignore
+         * @p sHint.
+         *
+         * @param point     The point.
+         * @param sHint     An estimate of the s-coordinate.
+         * @returns         The s-coordinate, which lies in the s-interval of
+         *                  this geometry (including its end).
+         */
+        virtual double nearestS(const Eigen::Vector2d& point, double sHint) const;
+
         /**
          * @brief Gets the start vertex of this geometry.
          *
@@ -378,6 +538,13 @@ class ReferenceLine
          */
         virtual double evalCurvature(double s) const override;
 
+        /**
+         * @brief The Line implementation of the evalVertex() function.
+         *
+         * See Geometry::evalVertex() for more details.
+         */
+        virtual Vertex evalVertex(double s) const override;
+
         /**
          * @brief The Line implementation of the tessellate function.
          *
@@ -386,6 +553,13 @@ class ReferenceLine
         virtual void tessellate(Tessellation& tessellation, double startS, double endS,
                                 bool includeEndPt) const override;
 
+        /**
+         * @brief The Line implementation of the nearestS() function.
+         *
+         * See Geometry::nearestS() for more details.
+         */
+        virtual double nearestS(const Eigen::Vector2d& point, double sHint) const override;
+
         /**
          * @brief The Line implementation of the endVertex function.
          *
@@ -425,6 +599,25 @@ class ReferenceLine
          */
         Spiral(const Vertex& startVertex, double length, double startCurvature, double endCurvature);
 
+        /**
+         * @brief Constructs a spiral whose evaluator uses precomputed
+         * coefficients, as returned by clothoid().coeffs() for a spiral with
+         * the same parameters.
+         *
+         * The coefficients aren't copied, see the corresponding Clothoid
+         * constructor.
+         *
+         * @param startVertex       The start vertex.
+         * @param length            The length of this part of the line.
+         * @param startCurvature    The start curvature.
+         * @param endCurvature      The end curvature.
+         * @param clothoidCoeffs    The coefficients of the pieces of the
+         *                          clothoid.
+         * @param numClothoidPieces The number of pieces of the clothoid.
+         */
+        Spiral(const Vertex& startVertex, double length, double startCurvature, double endCurvature,
+               const double* clothoidCoeffs, int numClothoidPieces);
+
         /**
          * @brief Parses a Spiral using the given XodrReader.
          *
@@ -461,6 +654,13 @@ class ReferenceLine
          */
         virtual double evalCurvature(double s) const override;
 
+        /**
+         * @brief The Spiral implementation of the evalVertex() function.
+         *
+         * See Geometry::evalVertex() for more details.
+         */
+        virtual Vertex evalVertex(double s) const override;
+
         /**
          * @brief The Spiral implementation of the tessellate function.
          *
@@ -480,11 +680,24 @@ class ReferenceLine
         double endCurvature() const { return endCurvature_; }
         double curvatureRateOfChange() const { return (endCurvature_ - startCurvature_) / length(); }
 
+        /**
+         * @returns The evaluator for this spiral, relative to the start of
+         * the spiral.
+         */
+        const Clothoid& clothoid() const { return clothoid_; }
+
       private:
         class AttribParsers;
 
-        double startCurvature_;
-        double endCurvature_;
+        /**
+         * @brief Computes clothoid_ from the geometry and the curvatures.
+         */
+        void initClothoid();
+
+        double startCurvature_ = 0;
+        double endCurvature_ = 0;
+
+        Clothoid clothoid_;
     };
 
     /**
@@ -561,6 +774,13 @@ class ReferenceLine
          */
         virtual double evalCurvature(double s) const override;
 
+        /**
+         * @brief The Arc implementation of the evalVertex() function.
+         *
+         * See Geometry::evalVertex() for more details.
+         */
+        virtual Vertex evalVertex(double s) const override;
+
         /**
          * @brief The Arc implementation of the tessellate function.
          *
@@ -569,6 +789,13 @@ class ReferenceLine
         virtual void tessellate(Tessellation& tessellation, double startS, double endS,
                                 bool includeEndPt) const override;
 
+        /**
+         * @brief The Arc implementation of the nearestS() function.
+         *
+         * See Geometry::nearestS() for more details.
+         */
+        virtual double nearestS(const Eigen::Vector2d& point, double sHint) const override;
+
         /**
          * @brief The Arc implementation of the endVertex function.
          *
@@ -616,6 +843,19 @@ class ReferenceLine
          */
         Poly3Geom(const Vertex& startVertex, double length, const Poly3& poly);
 
+        /**
+         * @brief Constructs a polynomial which uses the given arc length table
+         * instead of building one.
+         *
+         * @param startVertex       The start vertex.
+         * @param length            The length of this part of the line.
+         * @param poly              The polynomial.
+         * @param arcLengthTable    The table, as returned by arcLengthTable()
+         *                          for a polynomial with the same parameters.
+         *                          It must outlive the polynomial.
+         */
+        Poly3Geom(const Vertex& startVertex, double length, const Poly3& poly, const ArcLengthTable& arcLengthTable);
+
         /**
          * @brief Parses a Poly3Geom using the given XodrReader.
          *
@@ -652,6 +892,13 @@ class ReferenceLine
          */
         virtual double evalCurvature(double s) const override;
 
+        /**
+         * @brief The Poly3Geom implementation of the evalVertex() function.
+         *
+         * See Geometry::evalVertex() for more details.
+         */
+        virtual Vertex evalVertex(double s) const override;
+
         /**
          * @brief The Poly3Geom implementation of the tessellate function.
          *
@@ -671,6 +918,28 @@ class ReferenceLine
 
         const Poly3& poly() const { return poly_; }
 
+        /**
+         * @brief Gets the local u-coordinate of the point with the given
+         * s-coordinate.
+         *
+         * The u-coordinate is found in the arc length table of this geometry,
+         * which is built on first use, so that the distance along the curve
+         * from the start vertex equals s - startVertex().sCoord_.
+         *
+         * @param s     The s-coordinate.
+         * @returns     The u-coordinate.
+         */
+        double uCoordAt(double s) const { return arcLengthTable().paramAt(s - startVertex().sCoord_); }
+
+        /**
+         * @returns The arc length table of this geometry, which is built if
+         * needed.
+         */
+        const ArcLengthTable& arcLengthTable() const
+        {
+            return arcLengthTable_.get(Poly3(0, 1, 0, 0), poly_, length());
+        }
+
       private:
         class AttribParsers;
 
@@ -680,6 +949,13 @@ class ReferenceLine
         void setD(double d) { poly_.d_ = d; }
 
         Poly3 poly_;
+
+        /**
+         * @brief The arc length table of the curve (u, poly_(u)) for u in
+         * [0, length()]. Since the curve is at least as long as its extent in
+         * u, this covers the full s-range.
+         */
+        LazyArcLengthTable arcLengthTable_;
     };
 
     /**
@@ -739,6 +1015,22 @@ class ReferenceLine
          */
         ParamPoly3(const Vertex& startVertex, double length, const Poly3& uPoly, const Poly3& vPoly, PRange pRange);
 
+        /**
+         * @brief Constructs a polynomial which uses the given arc length table
+         * instead of building one.
+         *
+         * @param startVertex       The start vertex.
+         * @param length            The length of this part of the line.
+         * @param uPoly             The polynomial for the u-coordinate.
+         * @param vPoly             The polynomial for the v-coordinate.
+         * @param pRange            The parameter range.
+         * @param arcLengthTable    The table, as returned by arcLengthTable()
+         *                          for a polynomial with the same parameters.
+         *                          It must outlive the polynomial.
+         */
+        ParamPoly3(const Vertex& startVertex, double length, const Poly3& uPoly, const Poly3& vPoly, PRange pRange,
+                   const ArcLengthTable& arcLengthTable);
+
         /**
          * @brief Parses a ParamPoly3 using the given XodrReader.
          *
@@ -775,6 +1067,13 @@ class ReferenceLine
          */
         virtual double evalCurvature(double s) const override;
 
+        /**
+         * @brief The ParamPoly3 implementation of the evalVertex() function.
+         *
+         * See Geometry::evalVertex() for more details.
+         */
+        virtual Vertex evalVertex(double s) const override;
+
         /**
          * @brief The ParamPoly3 implementation of the tessellate function.
          *
@@ -807,9 +1106,42 @@ class ReferenceLine
          */
         PRange pRange() const { return pRange_; }
 
+        /**
+         * @brief Gets the parameter of the polynomials at the point with the
+         * given s-coordinate.
+         *
+         * The parameter is found in the arc length table of this geometry,
+         * which is built on first use. The s-coordinates are proportional to
+         * the arc length along the curve, scaled so that the end of the
+         * parameter range corresponds to the end of the geometry. For well
+         * formed data, where length() is the arc length of the curve, the
+         * scale is one.
+         *
+         * @param s     The s-coordinate.
+         * @returns     The parameter.
+         */
+        double paramAt(double s) const
+        {
+            const ArcLengthTable& table = arcLengthTable();
+            double scale = length() > 0 ? table.totalLength() / length() : 0;
+            return table.paramAt((s - startVertex().sCoord_) * scale);
+        }
+
+        /**
+         * @returns The arc length table of this geometry, which is built if
+         * needed.
+         */
+        const ArcLengthTable& arcLengthTable() const { return arcLengthTable_.get(uPoly_, vPoly_, endParam()); }
+
       private:
         class AttribParsers;
 
+        /**
+         * @returns The end of the parameter range: 1 for PRange::NORMALIZED,
+         * and length() for PRange::ARC_LENGTH.
+         */
+        double endParam() const { return pRange_ == PRange::NORMALIZED ? 1 : length(); }
+
         void setAU(double au) { uPoly_.a_ = au; }
         void setBU(double bu) { uPoly_.b_ = bu; }
         void setCU(double cu) { uPoly_.c_ = cu; }
@@ -823,6 +1155,8 @@ class ReferenceLine
         Poly3 uPoly_;
         Poly3 vPoly_;
         PRange pRange_;
+
+        LazyArcLengthTable arcLengthTable_;
     };
 
     /**
@@ -830,11 +1164,10 @@ class ReferenceLine
      */
     ReferenceLine() = default;
 
-    /**
-     * @brief Copy a reference line.
-     */
-    ReferenceLine(const ReferenceLine& referenceLine);
-    ReferenceLine& operator=(const ReferenceLine& referenceLine);
+    ReferenceLine(const ReferenceLine&) = default;
+    ReferenceLine& operator=(const ReferenceLine&) = default;
+    ReferenceLine(ReferenceLine&&) = default;
+    ReferenceLine& operator=(ReferenceLine&&) = default;
 
     /**
      * @brief Parses a ReferenceLine from a <planView> xodr element
@@ -886,12 +1219,110 @@ class ReferenceLine
      */
     double evalCurvature(double s) const;
 
+    /**
+     * @brief Evaluates the points and tangent directions on the reference line
+     * at many s-coordinates at once.
+     *
+     * The results are equal to those of eval() up to rounding. The
+     * s-coordinates may be given in any order, but sorted input is fastest:
+     * runs of consecutive s-coordinates which lie in the same geometry are
+     * evaluated together, in vectorized loops where the geometry type allows.
+     *
+     * @param sCoords   The s-coordinates, which must lie in [0, endS()].
+     * @param count     The number of s-coordinates.
+     * @param out       The buffers which receive the results. Each must have
+     *                  room for @p count elements.
+     */
+    void evalMany(const double* sCoords, int count, const PointsAndTangentDirs& out) const;
+
     /**
      * Returns a piecewise linear approximation of the section of this chord
      * line with s values in the interval [startS, endS].
      */
     Tessellation tessellate(double startS, double endS) const;
 
+    /**
+     * @brief Returns a piecewise linear approximation of the section of this
+     * reference line with s values in the interval [startS, endS], which
+     * deviates at most @p tolerance from the reference line.
+     *
+     * Rather than sampling at a fixed rate, the step between two vertices is
+     * derived from the curvature of the reference line, so straight sections
+     * get very few vertices and tight curves get as many as they need.
+     *
+     * For lines, arcs and spirals the bound is strict. For (parametric) cubic
+     * polynomials, whose curvature isn't monotonic, the curvature over a step
+     * is estimated from its start, middle and end.
+     *
+     * @param startS    The start of the s-range.
+     * @param endS      The end of the s-range.
+     * @param tolerance The maximum error.
+     * @returns         The tessellation.
+     */
+    Tessellation tessellate(double startS, double endS, const TessellationTolerance& tolerance) const;
+
+    /**
+     * @brief Tessellates the section of this reference line with s values in
+     * the interval [startS, endS] at the fixed rate, into a reusable buffer.
+     *
+     * This gives the same vertices as tessellate(double, double), but
+     * overwrites @p tessellation instead of returning a new vector. Its
+     * capacity is kept, so once it has grown large enough, repeated calls don't
+     * allocate.
+     *
+     * @param tessellation  Receives the tessellation.
+     * @param startS        The start of the s-range.
+     * @param endS          The end of the s-range.
+     */
+    void tessellate(Tessellation& tessellation, double startS, double endS) const;
+
+    /**
+     * @brief Adaptively tessellates the section of this reference line with s
+     * values in the interval [startS, endS], into a reusable buffer.
+     *
+     * This gives the same vertices as
+     * tessellate(double, double, const TessellationTolerance&), but overwrites
+     * @p tessellation instead of returning a new vector, keeping its capacity.
+     *
+     * @param tessellation  Receives the tessellation.
+     * @param startS        The start of the s-range.
+     * @param endS          The end of the s-range.
+     * @param tolerance     The maximum error.
+     */
+    void tessellate(Tessellation& tessellation, double startS, double endS,
+                    const TessellationTolerance& tolerance) const;
+
+    /**
+     * @brief Tessellates the section of this reference line with s values in
+     * the interval [startS, endS] at the fixed rate, along with the Frenet
+     * frames of the vertices.
+     *
+     * The vertices are placed at the same s-coordinates as those of
+     * tessellate(double, double), and @p frames is overwritten.
+     *
+     * @param frames    Receives the tessellation.
+     * @param startS    The start of the s-range.
+     * @param endS      The end of the s-range.
+     */
+    void tessellate(FrenetFrames& frames, double startS, double endS) const;
+
+    /**
+     * @brief Adaptively tessellates the section of this reference line with s
+     * values in the interval [startS, endS], along with the Frenet frames of
+     * the vertices.
+     *
+     * The vertices are placed at the same s-coordinates as those of
+     * tessellate(double, double, const TessellationTolerance&), and
+     * @p frames is overwritten. The positions and tangents are evaluated with
+     * evalMany(), one geometry at a time.
+     *
+     * @param frames    Receives the tessellation.
+     * @param startS    The start of the s-range.
+     * @param endS      The end of the s-range.
+     * @param tolerance The maximum error.
+     */
+    void tessellate(FrenetFrames& frames, double startS, double endS, const TessellationTolerance& tolerance) const;
+
     /**
      * Returns the end s coordinate of this chord line.
      *
@@ -913,12 +1344,110 @@ class ReferenceLine
     /**
      * @brief Gets the geometry with the given index.
      */
-    const Geometry& geometry(int i) const { return *geometries_[i]; }
+    const Geometry& geometry(int i) const { return geometries_[i].geometry(); }
 
   private:
-    const Geometry& geometryContaining(double s) const;
+    /**
+     * @brief A tagged union which holds a geometry of any type by value.
+     *
+     * The geometries of a reference line are stored contiguously in this form,
+     * and the reference line dispatches on the type tag with a switch instead
+     * of calling the virtual functions of the Geometry. The Geometry interface
+     * stays available through geometry().
+     */
+    class GeometryUnion
+    {
+      public:
+        GeometryUnion(const Line& line) : type_(GeometryType::LINE), line_(line) {}
+        GeometryUnion(const Spiral& spiral) : type_(GeometryType::SPIRAL), spiral_(spiral) {}
+        GeometryUnion(Spiral&& spiral) : type_(GeometryType::SPIRAL), spiral_(std::move(spiral)) {}
+        GeometryUnion(const Arc& arc) : type_(GeometryType::ARC), arc_(arc) {}
+        GeometryUnion(const Poly3Geom& poly3) : type_(GeometryType::POLY3), poly3_(poly3) {}
+        GeometryUnion(const ParamPoly3& paramPoly3) : type_(GeometryType::PARAM_POLY3), paramPoly3_(paramPoly3) {}
+
+        GeometryUnion(const GeometryUnion& other);
+        GeometryUnion(GeometryUnion&& other) noexcept;
+        GeometryUnion& operator=(const GeometryUnion& other);
+        ~GeometryUnion() { geometry().~Geometry(); }
+
+        GeometryType type() const { return type_; }
+
+        /**
+         * @returns The geometry held by this union, as its base class.
+         */
+        const Geometry& geometry() const;
+
+        PointAndTangentDir eval(double s) const;
+        void evalMany(const double* sCoords, int count, const PointsAndTangentDirs& out) const;
+        double evalCurvature(double s) const;
+        Vertex evalVertex(double s) const;
+        void tessellate(Tessellation& tessellation, double startS, double endS, bool includeEndPt) const;
+        void tessellate(Tessellation& tessellation, double startS, double endS, bool includeEndPt,
+                        const TessellationTolerance& tolerance) const;
+        void tessellate(FrenetFrames& frames, double startS, double endS, bool includeEndPt) const;
+        void tessellate(FrenetFrames& frames, double startS, double endS, bool includeEndPt,
+                        const TessellationTolerance& tolerance) const;
+        Vertex endVertex() const;
+
+      private:
+        /**
+         * @brief Calls @p emit with the s-coordinate of each vertex of the
+         * adaptive tessellation of [startS, endS].
+         */
+        template <typename EmitFn>
+        void forEachAdaptiveTessellationS(double startS, double endS, bool includeEndPt,
+                                          const TessellationTolerance& tolerance, EmitFn&& emit) const;
+
+        /**
+         * @brief Evaluates the positions, tangents and curvatures of the
+         * vertices of @p frames from index @p begin on, from their
+         * s-coordinates.
+         */
+        void evalFrames(FrenetFrames& frames, int begin) const;
+
+        GeometryType type_;
+        union
+        {
+            Line line_;
+            Spiral spiral_;
+            Arc arc_;
+            Poly3Geom poly3_;
+            ParamPoly3 paramPoly3_;
+        };
+    };
+
+    /**
+     * @brief Calls @p fn with each geometry which overlaps [startS, endS], and
+     * the part of its s-range which lies in [startS, endS].
+     */
+    template <typename Fn>
+    void forEachGeometryInRange(double startS, double endS, Fn&& fn) const;
+
+    /**
+     * @brief Appends a geometry to this reference line.
+     *
+     * The geometries must be appended in order of increasing start s-coordinate.
+     */
+    template <class GeometryT>
+    void appendGeometry(GeometryT&& geometry)
+    {
+        geometryStartS_.push_back(geometry.startVertex().sCoord_);
+        geometries_.emplace_back(std::forward<GeometryT>(geometry));
+    }
+
+    /**
+     * @brief Gets the index of the geometry whose s-range contains @p s.
+     */
+    int geometryContaining(double s) const;
+
+    ArenaVector<GeometryUnion> geometries_;
+
+    /**
+     * @brief The start s-coordinates of geometries_, which are kept in a
+     * separate array so geometryContaining() searches through contiguous memory.
+     */
+    ArenaVector<double> geometryStartS_;
 
-    std::vector<std::unique_ptr<Geometry>> geometries_;
     Vertex endVertex_;
 };
 
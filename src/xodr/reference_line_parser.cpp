@@ -8,7 +8,7 @@ namespace aid { namespace xodr {
 namespace xml_parsers {
 
 template <>
-ReferenceLine::PRange parseXmlAttrib<ReferenceLine::PRange>(const std::string& value)
+ReferenceLine::PRange parseXmlAttrib<ReferenceLine::PRange>(std::string_view value)
 {
     if (value == "arcLength")
     {
@@ -20,7 +20,7 @@ ReferenceLine::PRange parseXmlAttrib<ReferenceLine::PRange>(const std::string& v
     }
     else
     {
-        throw std::invalid_argument(value);
+        throw std::invalid_argument(std::string(value));
     }
 }
 }  // namespace xml_parsers
@@ -55,7 +55,7 @@ XodrParseResult<ReferenceLine> ReferenceLine::parseXml(XodrReader& xml)
         [](XodrReader& xml, XodrParseResult<ReferenceLine>& refLine) {
             XodrParseResult<GeometryAttribs> geomAttribs;
 
-            static GeometryAttribs::AttribParsers geomAttribParser;
+            static const GeometryAttribs::AttribParsers geomAttribParser;
 
             geomAttribParser.parse(xml, geomAttribs);
 
@@ -80,31 +80,31 @@ XodrParseResult<ReferenceLine> ReferenceLine::parseXml(XodrReader& xml)
             if (elemName == "line")
             {
                 XodrParseResult<Line> res = Line::parseXml(geomAttribs.value(), xml);
-                refLine.value().geometries_.emplace_back(new Line(std::move(res.value())));
+                refLine.value().appendGeometry(res.value());
                 refLine.appendErrors(res);
             }
             else if (elemName == "spiral")
             {
                 XodrParseResult<Spiral> res = Spiral::parseXml(geomAttribs.value(), xml);
-                refLine.value().geometries_.emplace_back(new Spiral(std::move(res.value())));
+                refLine.value().appendGeometry(std::move(res.value()));
                 refLine.appendErrors(res);
             }
             else if (elemName == "arc")
             {
                 XodrParseResult<Arc> res = Arc::parseXml(geomAttribs.value(), xml);
-                refLine.value().geometries_.emplace_back(new Arc(std::move(res.value())));
+                refLine.value().appendGeometry(res.value());
                 refLine.appendErrors(res);
             }
             else if (elemName == "poly3")
             {
                 XodrParseResult<Poly3Geom> res = Poly3Geom::parseXml(geomAttribs.value(), xml);
-                refLine.value().geometries_.emplace_back(new Poly3Geom(std::move(res.value())));
+                refLine.value().appendGeometry(res.value());
                 refLine.appendErrors(res);
             }
             else if (elemName == "paramPoly3")
             {
                 XodrParseResult<ParamPoly3> res = ParamPoly3::parseXml(geomAttribs.value(), xml);
-                refLine.value().geometries_.emplace_back(new ParamPoly3(std::move(res.value())));
+                refLine.value().appendGeometry(res.value());
                 refLine.appendErrors(res);
             }
             else
@@ -120,7 +120,7 @@ XodrParseResult<ReferenceLine> ReferenceLine::parseXml(XodrReader& xml)
         XodrInvalidations::ALL);
     if (!ret.value().geometries_.empty())
     {
-        ret.value().endVertex_ = ret.value().geometries_.back()->endVertex();
+        ret.value().endVertex_ = ret.value().geometries_.back().endVertex();
     }
 
     return ret;
@@ -153,6 +153,7 @@ XodrParseResult<ReferenceLine::Spiral> ReferenceLine::Spiral::parseXml(const Geo
 
     static const AttribParsers attribParsers;
     attribParsers.parse(xml, ret);
+    ret.value().initClothoid();
 
     if (ret.hasValidGeometry() && ret.value().curvatureRateOfChange() == 0)
     {
@@ -170,7 +171,7 @@ class ReferenceLine::Arc::AttribParsers : public XmlAttributeParsers<XodrParseRe
     AttribParsers()
     {
         addParser("curvature",
-                  [](const std::string& value, XodrParseResult<Arc>& arc) {
+                  [](std::string_view value, XodrParseResult<Arc>& arc) {
                       double curvature = xml_parsers::parseXmlAttrib<double>(value);
                       if (curvature == 0)
                       {
@@ -1,13 +1,150 @@
 #include "road.h"
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
 namespace aid { namespace xodr {
 
 const ElevationProfile& Road::elevationProfile() const
 {
     assert(hasElevationProfile());
+    parseBody();
     return *elevationProfile_;
 }
 
+void Road::evalElevations(const double* sCoords, int numPoints, double* out) const
+{
+    if (hasElevationProfile())
+    {
+        elevationProfile_->evalElevations(sCoords, numPoints, out);
+    }
+    else
+    {
+        std::fill(out, out + numPoints, 0.0);
+    }
+}
+
+void Road::tessellateReferenceLine(ReferenceLine::FrenetFrames& frames, double startS, double endS,
+                                   const ReferenceLine::TessellationTolerance& tolerance) const
+{
+    referenceLine().tessellate(frames, startS, endS, tolerance);
+
+    frames.elevations_.resize(frames.size());
+    evalElevations(frames.sCoords_.data(), frames.size(), frames.elevations_.data());
+}
+
+int Road::laneSectionIndexAt(double s) const
+{
+    const ArenaVector<LaneSection>& sections = laneSections();
+    auto it = std::upper_bound(sections.begin(), sections.end(), s,
+                               [](double sCoord, const LaneSection& section) { return sCoord < section.startS(); });
+    return std::max(static_cast<int>(it - sections.begin()) - 1, 0);
+}
+
+/**
+ * @brief Computes the pose of the point at a lateral offset from a point on
+ * the reference line.
+ *
+ * @param point         The point on the reference line.
+ * @param tangentDir    The tangent direction of the reference line.
+ * @param curvature     The curvature of the reference line.
+ * @param elevation     The elevation of the reference line.
+ * @param t             The lateral offset.
+ * @param tDerivative   The derivative of the lateral offset with respect to s.
+ */
+static Road::Pose offsetPose(const Eigen::Vector2d& point, const Eigen::Vector2d& tangentDir, double curvature,
+                             double elevation, double t, double tDerivative)
+{
+    Eigen::Vector2d normal(-tangentDir.y(), tangentDir.x());
+    Eigen::Vector2d position = point + t * normal;
+
+    // The derivative of the normal with respect to s is -curvature times the
+    // tangent direction.
+    Eigen::Vector2d direction = (1 - curvature * t) * tangentDir + tDerivative * normal;
+
+    Road::Pose ret;
+    ret.position_ = Eigen::Vector3d(position.x(), position.y(), elevation);
+    ret.heading_ = std::atan2(direction.y(), direction.x());
+    return ret;
+}
+
+Road::Pose Road::pose(double s, double t) const
+{
+    // Unlike eval(), evalMany() accepts all s-coordinates up to and including
+    // the end of the reference line.
+    double x, y, tangentX, tangentY;
+    referenceLine().evalMany(&s, 1, {&x, &y, &tangentX, &tangentY});
+
+    double elevation;
+    evalElevations(&s, 1, &elevation);
+    return offsetPose(Eigen::Vector2d(x, y), Eigen::Vector2d(tangentX, tangentY), referenceLine().evalCurvature(s),
+                      elevation, t, 0);
+}
+
+Road::Pose Road::lanePose(double s, LaneID laneId, double offset) const
+{
+    LanePosition position;
+    position.s_ = s;
+    position.laneId_ = laneId;
+    position.offset_ = offset;
+
+    Pose ret;
+    lanePoses(&position, 1, &ret);
+    return ret;
+}
+
+void Road::lanePoses(const LanePosition* positions, int numPositions, Pose* out) const
+{
+    const ReferenceLine& refLine = referenceLine();
+    const ArenaVector<LaneSection>& sections = laneSections();
+
+    std::vector<double> sCoords(numPositions);
+    for (int i = 0; i < numPositions; i++)
+    {
+        sCoords[i] = positions[i].s_;
+    }
+
+    std::vector<double> x(numPositions), y(numPositions), tangentX(numPositions), tangentY(numPositions);
+    refLine.evalMany(sCoords.data(), numPositions, {x.data(), y.data(), tangentX.data(), tangentY.data()});
+
+    std::vector<double> elevations(numPositions);
+    evalElevations(sCoords.data(), numPositions, elevations.data());
+
+    // A cursor is used for each run of consecutive positions which lie in
+    // the same lane section.
+    std::vector<double> offsets;
+    std::vector<double> derivatives;
+    for (int begin = 0; begin < numPositions;)
+    {
+        int laneSectionIdx = laneSectionIndexAt(positions[begin].s_);
+        const LaneSection& laneSection = sections[laneSectionIdx];
+        LaneSection::BoundaryCursor cursor(laneSection);
+        offsets.resize(laneSection.lanes().size() + 1);
+        derivatives.resize(laneSection.lanes().size() + 1);
+
+        int i = begin;
+        for (; i < numPositions && (i == begin || laneSectionIndexAt(positions[i].s_) == laneSectionIdx); i++)
+        {
+            const LanePosition& position = positions[i];
+            int id = static_cast<int>(position.laneId_);
+            if (id == 0 || id > laneSection.numLeftLanes() || id < -laneSection.numRightLanes())
+            {
+                throw std::out_of_range("Lane identifier out of range of the lane section");
+            }
+            int laneIdx = laneSection.laneIdToIndex(position.laneId_);
+
+            cursor.boundaryOffsets(position.s_, offsets.data(), derivatives.data());
+            double t = (offsets[laneIdx] + offsets[laneIdx + 1]) / 2 + position.offset_;
+            double tDerivative = (derivatives[laneIdx] + derivatives[laneIdx + 1]) / 2;
+
+            out[i] = offsetPose(Eigen::Vector2d(x[i], y[i]), Eigen::Vector2d(tangentX[i], tangentY[i]),
+                                refLine.evalCurvature(position.s_), elevations[i], t, tDerivative);
+        }
+        begin = i;
+    }
+}
+
 const RoadLink& Road::roadLink(RoadLinkType roadLinkType) const
 {
     switch (roadLinkType)
@@ -25,6 +162,7 @@ const RoadLink& Road::roadLink(RoadLinkType roadLinkType) const
 
 int Road::laneSectionIndexForContactPoint(ContactPoint contactPoint) const
 {
+    parseBody();
     switch (contactPoint)
     {
         default:
@@ -40,16 +178,19 @@ int Road::laneSectionIndexForContactPoint(ContactPoint contactPoint) const
 
 LaneSection& Road::laneSectionForContactPoint(ContactPoint contactPoint)
 {
+    parseBody();
     return laneSections_[laneSectionIndexForContactPoint(contactPoint)];
 }
 
 const LaneSection& Road::laneSectionForContactPoint(ContactPoint contactPoint) const
 {
+    parseBody();
     return laneSections_[laneSectionIndexForContactPoint(contactPoint)];
 }
 
 int Road::laneSectionIndexForExternalLinkType(RoadLinkType linkType) const
 {
+    parseBody();
     switch (linkType)
     {
         default:
@@ -65,6 +206,7 @@ int Road::laneSectionIndexForExternalLinkType(RoadLinkType linkType) const
 
 LaneSection& Road::laneSectionForExternalLinkType(RoadLinkType linkType)
 {
+    parseBody();
     switch (linkType)
     {
         default:
@@ -78,8 +220,21 @@ LaneSection& Road::laneSectionForExternalLinkType(RoadLinkType linkType)
     }
 }
 
+const std::vector<XodrParseError>& Road::bodyParseErrors() const
+{
+    static const std::vector<XodrParseError> noErrors;
+    if (!lazyBody_)
+    {
+        return noErrors;
+    }
+
+    parseBody();
+    return lazyBody_->errors_;
+}
+
 void Road::validate() const
 {
+    parseBody();
     for (const LaneSection& laneSection : laneSections_)
     {
         laneSection.validate();
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include <boost/optional.hpp>
 
 #include "xodr_reader.h"
+#include "xodr_arena.h"
 #include "reference_line.h"
 #include "elevation.h"
 #include "lane_section.h"
@@ -20,7 +26,51 @@ namespace aid { namespace xodr {
  */
 class Road
 {
+    friend class XodrBinarySerializer;
+
   public:
+    /**
+     * @brief A position and heading in world coordinates, see pose() and
+     * lanePoses().
+     */
+    struct Pose
+    {
+        /**
+         * @brief The position. Its z-coordinate is the elevation of the
+         * reference line, since superelevation isn't parsed.
+         */
+        Eigen::Vector3d position_;
+
+        /**
+         * @brief The heading, in radians counterclockwise from the x-axis, of
+         * the curve of the points with the same lateral offset, or the same
+         * relative position in a lane.
+         */
+        double heading_;
+    };
+
+    /**
+     * @brief A position relative to a lane, see lanePoses().
+     */
+    struct LanePosition
+    {
+        /**
+         * @brief The s-coordinate.
+         */
+        double s_;
+
+        /**
+         * @brief The ID of the lane, in the lane section which contains s_.
+         */
+        LaneID laneId_;
+
+        /**
+         * @brief The lateral offset from the center of the lane, positive to
+         * the left.
+         */
+        double offset_ = 0;
+    };
+
     /**
      * @brief Creates an uninitialized road.
      */
@@ -50,6 +100,69 @@ class Road
      */
     static XodrParseResult<Road> parseXml(XodrReader& xml);
 
+    /**
+     * @brief Parses the header of a Road using the given XodrReader, and
+     * defers parsing its body until it's first accessed.
+     *
+     * Only the attributes and the <link> element of the road are parsed, which
+     * is all that's needed to resolve the references of the map. The other
+     * child elements are skipped, except that the <lane> elements are counted
+     * so the same global lane indices are reserved as by @ref parseXml.
+     *
+     * The road refers to the byte range of its element in the given source
+     * text, which is the text being read by @p xml. The reference line,
+     * elevation profile, lane sections and road objects are parsed from this
+     * range by @ref parseBody.
+     *
+     * This function has @ref xml_parsers::parseXmlElem semantics.
+     *
+     * @param xml       The XodrReader.
+     * @param source    The text being read by the XodrReader.
+     * @returns         The resulting Road.
+     */
+    static XodrParseResult<Road> parseXmlLazy(XodrReader& xml, const std::shared_ptr<const std::vector<char>>& source);
+
+    /**
+     * @brief Parses the body of this road, if it was created by
+     * @ref parseXmlLazy and the body hasn't been parsed yet.
+     *
+     * The accessors of the body call this function, so it doesn't need to be
+     * called explicitly, but it may be used to parse the bodies of roads
+     * which are about to be used ahead of time. It's safe to call this
+     * function (and the accessors) from multiple threads concurrently: the
+     * body is parsed only once, and the other threads wait for it.
+     *
+     * Bodies which are parsed lazily are allocated from the heap rather than
+     * from the arenas of the map, since they may be parsed on any thread.
+     */
+    void parseBody() const
+    {
+        if (lazyBody_ && !lazyBody_->parsed_.load(std::memory_order_acquire))
+        {
+            parseLazyBody();
+        }
+    }
+
+    /**
+     * @returns Whether the body of this road has been parsed. This is always
+     * the case for roads which weren't parsed lazily.
+     */
+    bool isBodyParsed() const { return !lazyBody_ || lazyBody_->parsed_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Gets the errors which were found while parsing the body of a road
+     * which was parsed lazily.
+     *
+     * These are the errors which @ref parseXml reports for the road's element,
+     * so they include any errors in the road's attributes and <link> element,
+     * which were reported when the map was loaded as well. For roads which
+     * weren't parsed lazily, all errors are reported when the map is loaded,
+     * and this list is empty.
+     *
+     * @returns         The errors.
+     */
+    const std::vector<XodrParseError>& bodyParseErrors() const;
+
     /**
      * @returns The name of this road.
      */
@@ -74,12 +187,20 @@ class Road
     /**
      * @returns The reference line of this road.
      */
-    const ReferenceLine& referenceLine() const { return referenceLine_; }
+    const ReferenceLine& referenceLine() const
+    {
+        parseBody();
+        return referenceLine_;
+    }
 
     /**
      * @returns Whether this road has an elevation profile.
      */
-    bool hasElevationProfile() const { return static_cast<bool>(elevationProfile_); }
+    bool hasElevationProfile() const
+    {
+        parseBody();
+        return static_cast<bool>(elevationProfile_);
+    }
 
     /**
      * @brief Gets the elevation profile of this road.
@@ -90,15 +211,103 @@ class Road
      */
     const ElevationProfile& elevationProfile() const;
 
+    /**
+     * @brief Evaluates the elevation of the reference line at the given
+     * s-coordinates, which is 0 if the road has no elevation profile.
+     *
+     * See ElevationProfile::evalElevations().
+     *
+     * @param sCoords       The s-coordinates.
+     * @param numPoints     The number of s-coordinates.
+     * @param out           Receives the @p numPoints elevations.
+     */
+    void evalElevations(const double* sCoords, int numPoints, double* out) const;
+
+    /**
+     * @brief Tessellates the reference line between the given s-coordinates
+     * in 3D.
+     *
+     * This is ReferenceLine::tessellate() followed by the evaluation of the
+     * elevation at each vertex, which fills frames.elevations_. The vertices
+     * are placed as in the 2D tessellation, so @p tolerance bounds the error
+     * in the x/y-plane only.
+     *
+     * @param frames        Receives the tessellation.
+     * @param startS        The s-coordinate at which to start.
+     * @param endS          The s-coordinate at which to end.
+     * @param tolerance     The tolerance, see ReferenceLine::tessellate().
+     */
+    void tessellateReferenceLine(ReferenceLine::FrenetFrames& frames, double startS, double endS,
+                                 const ReferenceLine::TessellationTolerance& tolerance) const;
+
+    /**
+     * @brief Finds the lane section which contains the given s-coordinate.
+     *
+     * @param s             The s-coordinate.
+     * @returns             The index of the last lane section which starts
+     *                      at or before @p s, or 0 if there's none.
+     */
+    int laneSectionIndexAt(double s) const;
+
+    /**
+     * @brief Converts road coordinates to a world pose.
+     *
+     * @param s             The s-coordinate, in [0, referenceLine().endS()].
+     * @param t             The lateral offset from the reference line,
+     *                      positive to the left.
+     * @returns             The pose.
+     */
+    Pose pose(double s, double t) const;
+
+    /**
+     * @brief Converts a position relative to a lane to a world pose.
+     *
+     * The lateral offset of the center of the lane is found from the width
+     * polynomials of the lane section with a LaneSection::BoundaryCursor.
+     * Lane offsets aren't parsed, so they're not applied.
+     *
+     * @param s             The s-coordinate, in [0, referenceLine().endS()].
+     * @param laneId        The ID of the lane, which must exist in the lane
+     *                      section which contains @p s.
+     * @param offset        The lateral offset from the center of the lane,
+     *                      positive to the left.
+     * @returns             The pose.
+     * @throws std::out_of_range if the lane doesn't exist.
+     */
+    Pose lanePose(double s, LaneID laneId, double offset = 0) const;
+
+    /**
+     * @brief Converts a sequence of positions relative to lanes, such as a
+     * trajectory, to world poses.
+     *
+     * The results are the same as those of lanePose(). The reference line is
+     * evaluated with ReferenceLine::evalMany(), and the lane widths with a
+     * cursor for each lane section, so positions ordered by s are fastest.
+     *
+     * @param positions     The positions.
+     * @param numPositions  The number of positions.
+     * @param out           Receives the @p numPositions poses.
+     * @throws std::out_of_range if one of the lanes doesn't exist.
+     */
+    void lanePoses(const LanePosition* positions, int numPositions, Pose* out) const;
+
     /**
      * @returns The lane sections of this road.
      */
-    const std::vector<LaneSection>& laneSections() const { return laneSections_; }
+    const ArenaVector<LaneSection>& laneSections() const
+    {
+        parseBody();
+        return laneSections_;
+    }
 
     /**
      * @returns The road objects associated with this road.
      */
-    const std::vector<RoadObject>& roadObjects() const { return roadObjects_; }
+    const ArenaVector<RoadObject>& roadObjects() const
+    {
+        parseBody();
+        return roadObjects_;
+    }
 
     /**
      * @returns The RoadLink object describing the predecessor of this road.
@@ -132,6 +341,18 @@ class Road
      */
     void resolveReferences(const IdToIndexMaps& idToIndexMaps);
 
+    /**
+     * @brief Adds the given offset to the global lane indices of all lanes in
+     * this road.
+     *
+     * This is used when roads are parsed independently of each other (see
+     * XodrMap::ParseOptions), in which case the global lane indices of each
+     * road start at 0 until the roads are merged into the map.
+     *
+     * @param offset        The offset to add.
+     */
+    void offsetGlobalLaneIndices(int offset);
+
     /**
      * @brief Gets the beginning of the range of global lane indices used by the
      * lanes in this road.
@@ -262,13 +483,48 @@ class Road
      *
      * This function should only be used from unit tests.
      */
-    LaneSection& test_laneSection(int i) { return laneSections_[i]; }
+    LaneSection& test_laneSection(int i)
+    {
+        parseBody();
+        return laneSections_[i];
+    }
 
   private:
     class AttribParsers;
     class ChildElemParsers;
     class LaneChildElemParsers;
     class ObjectsChildElemParsers;
+    class LazyChildElemParsers;
+
+    /**
+     * @brief The location of the element of a road which was parsed by
+     * @ref parseXmlLazy, and the state of its body.
+     */
+    struct LazyBody
+    {
+        std::shared_ptr<const std::vector<char>> source_;
+
+        size_t byteOffset_;
+        size_t endByteOffset_;
+        int lineNumber_;
+        int columnNumber_;
+
+        /**
+         * @brief The first global lane index of the road, and the number of
+         * global lane indices reserved for its lanes.
+         */
+        int firstGlobalLaneIndex_;
+        int numGlobalLaneIndices_;
+
+        std::once_flag parseOnce_;
+        std::atomic<bool> parsed_{false};
+
+        std::vector<XodrParseError> errors_;
+    };
+
+    static void countLanes(XodrReader& xml, XodrParseResult<Road>& road);
+
+    void parseLazyBody() const;
 
     std::string name_;
     std::string id_;
@@ -277,10 +533,16 @@ class Road
     double length_;
     ReferenceLine referenceLine_;
     boost::optional<ElevationProfile> elevationProfile_;
-    std::vector<LaneSection> laneSections_;
-    std::vector<RoadObject> roadObjects_;
+    ArenaVector<LaneSection> laneSections_;
+    ArenaVector<RoadObject> roadObjects_;
 
     RoadLinks links_;
+
+    /**
+     * @brief The state of the body of a road which was parsed lazily, or
+     * nullptr if the road was parsed completely.
+     */
+    ArenaPtr<LazyBody> lazyBody_;
 };
 
 }}  // namespace aid::xodr
@@ -83,7 +83,7 @@ ContactPoint oppositeContactPoint(ContactPoint contactPoint);
 namespace xml_parsers {
 
 template <>
-ContactPoint parseXmlAttrib(const std::string& value);
+ContactPoint parseXmlAttrib(std::string_view value);
 }
 
 /**
@@ -92,6 +92,8 @@ ContactPoint parseXmlAttrib(const std::string& value);
  */
 class RoadLink
 {
+    friend class XodrBinarySerializer;
+
   public:
     /**
      * @brief Constructs a RoadLink with its element type set to NOT_SPECIFIED.
@@ -193,7 +195,7 @@ class RoadLink
     class AttribParsers;
 
     ElementType elementType_;
-    ContactPoint contactPoint_;
+    ContactPoint contactPoint_ = ContactPoint::NOT_SPECIFIED;
     XodrObjectReference elementRef_;
 };
 
@@ -203,6 +205,8 @@ class RoadLink
  */
 class NeighborLink
 {
+    friend class XodrBinarySerializer;
+
   public:
     /**
      * @brief Constructs a NeighborLink whose 'isSpecified' flag is set to false.
@@ -292,8 +296,8 @@ class NeighborLink
     class AttribParsers;
 
     bool isSpecified_ = false;
-    Side side_;
-    Direction direction_;
+    Side side_ = Side::LEFT;
+    Direction direction_ = Direction::SAME;
     XodrObjectReference elementRef_;
 };
 
@@ -306,6 +310,8 @@ class NeighborLink
  */
 class RoadLinks
 {
+    friend class XodrBinarySerializer;
+
   public:
     /**
      * Creates a RoadLinks instance with all its members set to 'not specified'.
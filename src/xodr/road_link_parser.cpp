@@ -8,7 +8,7 @@ namespace aid { namespace xodr {
 namespace xml_parsers {
 
 template <>
-RoadLink::ElementType parseXmlAttrib(const std::string& value)
+RoadLink::ElementType parseXmlAttrib(std::string_view value)
 {
     if (value == "road")
     {
@@ -25,7 +25,7 @@ RoadLink::ElementType parseXmlAttrib(const std::string& value)
 }
 
 template <>
-ContactPoint parseXmlAttrib(const std::string& value)
+ContactPoint parseXmlAttrib(std::string_view value)
 {
     if (value == "start")
     {
@@ -94,7 +94,7 @@ void RoadLink::resolveReferences(const IdToIndexMaps& idToIndexMaps)
 namespace xml_parsers {
 
 template <>
-NeighborLink::Side parseXmlAttrib(const std::string& value)
+NeighborLink::Side parseXmlAttrib(std::string_view value)
 {
     if (value == "left")
     {
@@ -111,7 +111,7 @@ NeighborLink::Side parseXmlAttrib(const std::string& value)
 }
 
 template <>
-NeighborLink::Direction parseXmlAttrib(const std::string& value)
+NeighborLink::Direction parseXmlAttrib(std::string_view value)
 {
     if (value == "same")
     {
@@ -11,9 +11,9 @@ namespace aid { namespace xodr {
 
 namespace xml_parsers {
 template <>
-RoadObject::Type parseXmlAttrib(const std::string& value)
+RoadObject::Type parseXmlAttrib(std::string_view value)
 {
-    static const std::map<std::string, RoadObject::Type> mapping = {
+    static const std::map<std::string, RoadObject::Type, std::less<>> mapping = {
         {"none", RoadObject::Type::NONE},
         {"obstacle", RoadObject::Type::OBSTACLE},
         {"car", RoadObject::Type::CAR},
@@ -47,9 +47,9 @@ RoadObject::Type parseXmlAttrib(const std::string& value)
 }
 
 template <>
-RoadObject::Orientation parseXmlAttrib(const std::string& value)
+RoadObject::Orientation parseXmlAttrib(std::string_view value)
 {
-    static std::map<std::string, RoadObject::Orientation> mapping = {
+    static const std::map<std::string, RoadObject::Orientation, std::less<>> mapping = {
         {"+", RoadObject::Orientation::POSITIVE},
         {"-", RoadObject::Orientation::NEGATIVE},
         {"none", RoadObject::Orientation::NONE},
@@ -103,7 +103,7 @@ class RoadObject::ChildElemParsers : public XmlChildElementParsers<XodrReader, X
         });
         addParser("outline", Multiplicity::ZERO_OR_ONE, [](XodrReader& xml, XodrParseResult<RoadObject>& result) {
             auto ret = RoadObjectOutline::parseXml(xml);
-            result.value().outline_.reset(new RoadObjectOutline(ret.value()));
+            result.value().outline_ = makeArenaPtr<RoadObjectOutline>(std::move(ret.value()));
             result.appendErrors(ret);
         });
 
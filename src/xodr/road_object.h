@@ -5,6 +5,7 @@
 #include <memory>
 
 #include "xodr_reader.h"
+#include "xodr_arena.h"
 #include "road_object_outline.h"
 
 namespace aid { namespace xodr {
@@ -15,6 +16,8 @@ namespace aid { namespace xodr {
  */
 class RoadObject
 {
+    friend class XodrBinarySerializer;
+
   public:
     /**
      * The type of the RoadObject.
@@ -251,7 +254,7 @@ class RoadObject
     double width_;
     double radius_;
     double height_;
-    std::unique_ptr<RoadObjectOutline> outline_;
+    ArenaPtr<RoadObjectOutline> outline_;
 
     double heading_;
     double pitch_;
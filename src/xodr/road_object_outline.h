@@ -3,6 +3,7 @@
 #include <boost/variant.hpp>
 
 #include "xodr_reader.h"
+#include "xodr_arena.h"
 
 namespace aid { namespace xodr {
 
@@ -15,6 +16,8 @@ namespace aid { namespace xodr {
  */
 class RoadObjectOutline
 {
+    friend class XodrBinarySerializer;
+
   public:
     class CornerRoad;
     class CornerLocal;
@@ -36,6 +39,8 @@ class RoadObjectOutline
      */
     class CornerRoad
     {
+        friend class XodrBinarySerializer;
+
       public:
         /**
          * @brief Parses a CornerRoad using the given XodrReader.
@@ -84,6 +89,8 @@ class RoadObjectOutline
      */
     class CornerLocal
     {
+        friend class XodrBinarySerializer;
+
       public:
         /**
          * @brief Parses a CornerLocal using the given XodrReader.
@@ -137,12 +144,12 @@ class RoadObjectOutline
     /**
      * @return The corners of this RoadObjectOutline.
      */
-    const std::vector<Corner>& corners() const { return corners_; }
+    const ArenaVector<Corner>& corners() const { return corners_; }
 
   private:
     class ChildElemParsers;
 
-    std::vector<Corner> corners_;
+    ArenaVector<Corner> corners_;
 };
 
 }}  // namespace aid::xodr
\ No newline at end of file
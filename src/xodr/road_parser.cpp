@@ -106,6 +106,32 @@ class Road::ChildElemParsers : public XmlChildElementParsers<XodrReader, XodrPar
     }
 };
 
+/**
+ * @brief The child element parsers used by Road::parseXmlLazy.
+ *
+ * Only the <link> element is parsed. The elements which make up the body of
+ * the road are skipped (and all of them are optional, so missing elements are
+ * reported when the body is parsed), except that the lanes are counted.
+ */
+class Road::LazyChildElemParsers : public XmlChildElementParsers<XodrReader, XodrParseResult<Road>>
+{
+  public:
+    LazyChildElemParsers()
+    {
+        addParser("planView", Multiplicity::ZERO_OR_MORE,
+                  [](XodrReader& xml, XodrParseResult<Road>&) { xml.skipToEndElement(); });
+        addParser("elevationProfile", Multiplicity::ZERO_OR_MORE,
+                  [](XodrReader& xml, XodrParseResult<Road>&) { xml.skipToEndElement(); });
+        addParser("lanes", Multiplicity::ZERO_OR_MORE, &Road::countLanes);
+        addOptionalFieldParser<XodrParseResult<RoadLinks>>("link", &Road::links_, RoadLinks(),
+                                                           XodrInvalidations::CONNECTIVITY);
+        addParser("objects", Multiplicity::ZERO_OR_MORE,
+                  [](XodrReader& xml, XodrParseResult<Road>&) { xml.skipToEndElement(); });
+
+        finalize();
+    }
+};
+
 XodrParseResult<Road> Road::parseXml(XodrReader& xml)
 {
     XodrParseResult<Road> ret;
@@ -133,19 +159,124 @@ XodrParseResult<Road> Road::parseXml(XodrReader& xml)
     return ret;
 }
 
+XodrParseResult<Road> Road::parseXmlLazy(XodrReader& xml, const std::shared_ptr<const std::vector<char>>& source)
+{
+    XodrParseResult<Road> ret;
+
+    ArenaPtr<LazyBody> lazyBody = makeArenaPtr<LazyBody>();
+    lazyBody->source_ = source;
+    lazyBody->byteOffset_ = xml.getByteOffset();
+    lazyBody->lineNumber_ = xml.getLineNumber();
+    lazyBody->columnNumber_ = xml.getColumnNumber();
+    lazyBody->firstGlobalLaneIndex_ = xml.peekNextGlobalLaneIndex();
+
+    static const AttribParsers attribParsers;
+    attribParsers.parse(xml, ret);
+
+    static const LazyChildElemParsers childElemParsers;
+    childElemParsers.parse(xml, ret);
+
+    lazyBody->endByteOffset_ = xml.getEndByteOffset();
+    lazyBody->numGlobalLaneIndices_ = xml.peekNextGlobalLaneIndex() - lazyBody->firstGlobalLaneIndex_;
+
+    ret.value().lazyBody_ = std::move(lazyBody);
+    return ret;
+}
+
+void Road::countLanes(XodrReader& xml, XodrParseResult<Road>&)
+{
+    // Reserves a global lane index for each <lane> in the <left> and <right>
+    // elements of the <laneSection>s, which are the lanes that are assigned a
+    // global lane index by LaneSection::parseXml.
+    while (!xml.tryReadEndElement())
+    {
+        xml.readStartElement();
+        if (xml.getCurElementName() != "laneSection")
+        {
+            xml.skipToEndElement();
+            continue;
+        }
+
+        while (!xml.tryReadEndElement())
+        {
+            xml.readStartElement();
+            if (xml.getCurElementName() != "left" && xml.getCurElementName() != "right")
+            {
+                xml.skipToEndElement();
+                continue;
+            }
+
+            while (!xml.tryReadEndElement())
+            {
+                xml.readStartElement();
+                if (xml.getCurElementName() == "lane")
+                {
+                    xml.newGlobalLaneIndex();
+                }
+
+                xml.skipToEndElement();
+            }
+        }
+    }
+}
+
+void Road::parseLazyBody() const
+{
+    LazyBody& body = *lazyBody_;
+    std::call_once(body.parseOnce_, [this, &body]() {
+        // The body may be parsed on any thread, and arenas aren't
+        // thread-safe, so it's allocated from the heap.
+        XodrArena::Scope arenaScope(nullptr);
+
+        XodrReader xml =
+            XodrReader::fromBuffer(body.source_->data() + body.byteOffset_, body.endByteOffset_ - body.byteOffset_,
+                                   body.lineNumber_, body.columnNumber_, body.byteOffset_);
+        xml.readStartElement();
+        XodrParseResult<Road> parsed = Road::parseXml(xml);
+        assert(xml.peekNextGlobalLaneIndex() == body.numGlobalLaneIndices_);
+
+        // The accessors are const, but the body is logically part of the
+        // road's state from the moment it was created.
+        Road& road = const_cast<Road&>(*this);
+        road.referenceLine_ = std::move(parsed.value().referenceLine_);
+        road.elevationProfile_ = std::move(parsed.value().elevationProfile_);
+        road.laneSections_ = std::move(parsed.value().laneSections_);
+        road.roadObjects_ = std::move(parsed.value().roadObjects_);
+
+        for (LaneSection& laneSection : road.laneSections_)
+        {
+            laneSection.offsetGlobalLaneIndices(body.firstGlobalLaneIndex_);
+        }
+
+        body.errors_ = std::move(parsed.errors());
+        body.parsed_.store(true, std::memory_order_release);
+    });
+}
+
 void Road::resolveReferences(const IdToIndexMaps& idToIndexMaps)
 {
     junctionRef_.resolve(idToIndexMaps.junctionIdToIndex_, "-1", "junction");
     links_.resolveReferences(idToIndexMaps);
 }
 
+void Road::offsetGlobalLaneIndices(int offset)
+{
+    parseBody();
+    for (LaneSection& laneSection : laneSections_)
+    {
+        laneSection.offsetGlobalLaneIndices(offset);
+    }
+}
+
 int Road::globalLaneIndicesBegin() const
 {
+    parseBody();
     return laneSections_.front().lanes().front().globalIndex();
 }
 
 int Road::globalLaneIndicesEnd() const
 {
+    parseBody();
     return laneSections_.back().lanes().back().globalIndex() + 1;
 }
 
@@ -0,0 +1,176 @@
+#include "road_projector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "parallel_for.h"
+
+namespace aid { namespace xodr {
+
+RoadProjector::RoadProjector(const XodrMap& map, const Options& options)
+    : map_(map),
+      // The adaptive tessellation estimates its error from a few samples per
+      // segment, so leave a margin for segments where it's exceeded.
+      margin_(2 * options.maxError_)
+{
+    ReferenceLine::TessellationTolerance tolerance;
+    tolerance.maxError_ = options.maxError_;
+
+    ReferenceLine::Tessellation tessellation;
+    for (int roadIdx = 0; roadIdx < static_cast<int>(map.roads().size()); roadIdx++)
+    {
+        const ReferenceLine& refLine = map.roads()[roadIdx].referenceLine();
+        refLine.tessellate(tessellation, 0, refLine.endS(), tolerance);
+
+        // The tessellation has a vertex at the start of each geometry, so each
+        // segment lies in the geometry which contains its midpoint.
+        int geometryIdx = 0;
+        for (size_t i = 0; i + 1 < tessellation.size(); i++)
+        {
+            const ReferenceLine::Vertex& from = tessellation[i];
+            const ReferenceLine::Vertex& to = tessellation[i + 1];
+            double midS = (from.sCoord_ + to.sCoord_) / 2;
+            while (geometryIdx + 1 < refLine.numGeometries() &&
+                   refLine.geometry(geometryIdx + 1).startVertex().sCoord_ <= midS)
+            {
+                geometryIdx++;
+            }
+
+            segments_.push_back({from.position_, to.position_, from.sCoord_, to.sCoord_, roadIdx, geometryIdx});
+        }
+    }
+
+    std::vector<Eigen::AlignedBox2d> segmentBoxes(segments_.size());
+    for (size_t i = 0; i < segments_.size(); i++)
+    {
+        segmentBoxes[i].extend(segments_[i].from_);
+        segmentBoxes[i].extend(segments_[i].to_);
+    }
+
+    std::vector<int> order;
+    tree_.build(segmentBoxes, order);
+
+    std::vector<Segment> sortedSegments(segments_.size());
+    for (size_t i = 0; i < segments_.size(); i++)
+    {
+        sortedSegments[i] = segments_[order[i]];
+    }
+    segments_.swap(sortedSegments);
+}
+
+RoadPosition RoadProjector::project(const Eigen::Vector2d& point) const
+{
+    struct Candidate
+    {
+        int segmentIdx_;
+        double segmentDistance_;
+        double sHint_;
+    };
+
+    // Each point of a geometry is within margin_ of its segments, so the
+    // distance to the geometry is at least the distance to a segment minus
+    // margin_. The end points of the segments lie on the geometries, so the
+    // distance to the nearest of them bounds the distance to the reference
+    // lines from above.
+    std::vector<Candidate> candidates;
+    double bound = std::numeric_limits<double>::infinity();
+    tree_.forEachLeafNear(point, [&]() { return bound + margin_; },
+                          [&](int first, int count) {
+                              for (int i = first; i < first + count; i++)
+                              {
+                                  const Segment& segment = segments_[i];
+                                  Eigen::Vector2d dir = segment.to_ - segment.from_;
+                                  double lambda = 0;
+                                  if (dir.squaredNorm() > 0)
+                                  {
+                                      lambda = dir.dot(point - segment.from_) / dir.squaredNorm();
+                                      lambda = std::min(std::max(lambda, 0.0), 1.0);
+                                  }
+
+                                  double distance = (segment.from_ + lambda * dir - point).norm();
+                                  if (distance - margin_ > bound)
+                                  {
+                                      continue;
+                                  }
+
+                                  double sHint = segment.fromS_ + lambda * (segment.toS_ - segment.fromS_);
+                                  candidates.push_back({i, distance, sHint});
+                                  bound = std::min({bound, (segment.from_ - point).norm(),
+                                                    (segment.to_ - point).norm()});
+                              }
+                          });
+
+    // Refine the nearest candidates first, so the others can be skipped once
+    // they're farther than the nearest point which is found.
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.segmentDistance_ < b.segmentDistance_;
+    });
+
+    RoadPosition ret;
+    double bestSquaredDistance = std::numeric_limits<double>::infinity();
+    int bestSegmentIdx = -1;
+    for (const Candidate& candidate : candidates)
+    {
+        double minDistance = candidate.segmentDistance_ - margin_;
+        if (minDistance > 0 && minDistance * minDistance > bestSquaredDistance)
+        {
+            break;
+        }
+
+        const Segment& segment = segments_[candidate.segmentIdx_];
+        const ReferenceLine::Geometry& geometry =
+            map_.roads()[segment.roadIdx_].referenceLine().geometry(segment.geometryIdx_);
+        double s = geometry.nearestS(point, candidate.sHint_);
+
+        double squaredDistance = (geometry.eval(s).point_ - point).squaredNorm();
+        if (squaredDistance < bestSquaredDistance ||
+            (squaredDistance == bestSquaredDistance && segment.roadIdx_ < ret.roadIdx_))
+        {
+            bestSquaredDistance = squaredDistance;
+            bestSegmentIdx = candidate.segmentIdx_;
+            ret.roadIdx_ = segment.roadIdx_;
+            ret.s_ = s;
+        }
+    }
+
+    if (bestSegmentIdx < 0)
+    {
+        return ret;
+    }
+
+    const Segment& bestSegment = segments_[bestSegmentIdx];
+    ReferenceLine::PointAndTangentDir pt =
+        map_.roads()[bestSegment.roadIdx_].referenceLine().geometry(bestSegment.geometryIdx_).eval(ret.s_);
+    Eigen::Vector2d normal(-pt.tangentDir_.y(), pt.tangentDir_.x());
+    ret.t_ = (point - pt.point_).dot(normal);
+    ret.distance_ = std::sqrt(bestSquaredDistance);
+
+    const Road& road = map_.roads()[ret.roadIdx_];
+    ret.laneSectionIdx_ = road.laneSectionIndexAt(ret.s_);
+
+    const LaneSection& laneSection = road.laneSections()[ret.laneSectionIdx_];
+    ret.laneIdx_ = laneSection.laneIndexAt(ret.s_, ret.t_);
+    if (ret.laneIdx_ >= 0)
+    {
+        ret.laneId_ = LaneIDOpt(laneSection.laneIndexToId(ret.laneIdx_));
+    }
+
+    return ret;
+}
+
+void RoadProjector::project(const Eigen::Vector2d* points, int numPoints, RoadPosition* out, int numThreads) const
+{
+    constexpr int CHUNK_SIZE = 256;
+    int numChunks = (numPoints + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    parallelFor(numThreads, numChunks, [&](size_t chunkIdx, int) {
+        int end = std::min(static_cast<int>(chunkIdx + 1) * CHUNK_SIZE, numPoints);
+        for (int i = static_cast<int>(chunkIdx) * CHUNK_SIZE; i < end; i++)
+        {
+            out[i] = project(points[i]);
+        }
+    });
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <vector>
+#include <Eigen/Dense>
+
+#include "box_tree.h"
+#include "lane_section.h"
+#include "xodr_map.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief The position of a point relative to the road nearest to it, see
+ * RoadProjector.
+ */
+struct RoadPosition
+{
+    /**
+     * @brief The index of the road, or -1 if the map has no roads.
+     */
+    int roadIdx_ = -1;
+
+    /**
+     * @brief The s-coordinate of the point on the reference line of the road
+     * which is nearest to the projected point.
+     */
+    double s_ = 0;
+
+    /**
+     * @brief The lateral offset of the projected point from the reference
+     * line, positive to the left.
+     *
+     * Where the nearest point on the reference line is one of its end points,
+     * the projected point is generally not on its normal, and this is the
+     * offset along the normal.
+     */
+    double t_ = 0;
+
+    /**
+     * @brief The distance from the projected point to the reference line.
+     */
+    double distance_ = 0;
+
+    /**
+     * @brief The index of the lane section of the road which contains s_.
+     */
+    int laneSectionIdx_ = -1;
+
+    /**
+     * @brief The index of the lane which contains the point (see
+     * LaneSection::laneIndexAt()), or -1 if it's beyond the outermost lane.
+     */
+    int laneIdx_ = -1;
+
+    /**
+     * @brief The ID of the lane with index laneIdx_, if there is one.
+     */
+    LaneIDOpt laneId_ = LaneIDOpt::null();
+};
+
+/**
+ * @brief Projects points onto the nearest reference line of an XodrMap, which
+ * gives their road coordinates and the lanes that contain them.
+ *
+ * The reference lines are tessellated into segments, which are bulk-loaded
+ * into a BoxTree. A query first finds the segments which may be near enough
+ * to hold the nearest point, using that every segment is within
+ * Options::maxError_ of its geometry. It then refines the nearest point on the
+ * geometry of each of those candidates with Geometry::nearestS(), which is in
+ * closed form for lines and arcs, and starts Newton's method from the nearest
+ * point on the segment for the other geometry types.
+ *
+ * The lanes are found from the lateral offset and the width polynomials of the
+ * lane section, so lane offsets (which aren't parsed) are ignored.
+ */
+class RoadProjector
+{
+  public:
+    /**
+     * @brief Options which control how a RoadProjector is built.
+     */
+    struct Options
+    {
+        /**
+         * @brief The maximum distance between the segments and the reference
+         * lines.
+         *
+         * This only affects the performance, not the results: a larger value
+         * gives fewer segments, but more candidates to refine.
+         */
+        double maxError_ = .1;
+    };
+
+    /**
+     * @brief Builds a projector for the roads of a map.
+     *
+     * @param map           The map, which must outlive the projector.
+     * @param options       The options.
+     */
+    RoadProjector(const XodrMap& map, const Options& options);
+
+    /**
+     * @returns The number of segments in the index.
+     */
+    int numSegments() const { return static_cast<int>(segments_.size()); }
+
+    /**
+     * @brief Projects a point onto the nearest reference line.
+     *
+     * Where several reference lines are equally near, the one of the road with
+     * the lowest index is chosen.
+     *
+     * @param point         The point.
+     * @returns             The road coordinates of the point.
+     */
+    RoadPosition project(const Eigen::Vector2d& point) const;
+
+    /**
+     * @brief Projects each of a batch of points onto the nearest reference
+     * line.
+     *
+     * @param points        The points.
+     * @param numPoints     The number of points.
+     * @param out           Receives the @p numPoints road positions, which
+     *                      are the same as those of
+     *                      project(const Eigen::Vector2d&) const.
+     * @param numThreads    The number of threads over which the points are
+     *                      distributed, or 0 for one per hardware thread.
+     */
+    void project(const Eigen::Vector2d* points, int numPoints, RoadPosition* out, int numThreads = 0) const;
+
+  private:
+    /**
+     * @brief A segment of the tessellation of a reference line, which lies in
+     * a single geometry.
+     */
+    struct Segment
+    {
+        Eigen::Vector2d from_;
+        Eigen::Vector2d to_;
+        double fromS_;
+        double toS_;
+        int roadIdx_;
+        int geometryIdx_;
+    };
+
+    const XodrMap& map_;
+
+    /**
+     * @brief The maximum distance between a point of a geometry and the
+     * segments which approximate it.
+     */
+    double margin_;
+
+    /**
+     * @brief The segments, in the order of the leaves of tree_.
+     */
+    std::vector<Segment> segments_;
+    BoxTree tree_;
+};
+
+}}  // namespace aid::xodr
@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * @file
+ * @brief Inline math functions for vectorized loops.
+ *
+ * The functions in this file are branch-free, so loops which call them can be
+ * vectorized by the compiler. Such loops should be marked with XODR_SIMD_LOOP.
+ */
+
+/**
+ * @brief Asks the compiler to vectorize the loop which follows.
+ *
+ * This expands to an OpenMP simd pragma when the library is built with
+ * -fopenmp-simd (which doesn't link against the OpenMP runtime), and to nothing
+ * otherwise, in which case vectorization is up to the optimizer.
+ */
+#if defined(XODR_OPENMP_SIMD)
+#define XODR_SIMD_LOOP _Pragma("omp simd")
+#else
+#define XODR_SIMD_LOOP
+#endif
+
+namespace aid { namespace xodr { namespace simd {
+
+/**
+ * @brief Rounds to the nearest integer, with ties rounded to even.
+ *
+ * Adding and subtracting 1.5 * 2^52 pushes the fractional bits out of the
+ * mantissa. This only works for |x| < 2^51, but unlike std::nearbyint it
+ * vectorizes without SSE4.1.
+ */
+inline double roundToInt(double x)
+{
+    constexpr double ROUNDING_BIAS = 6755399441055744.0;
+    return (x + ROUNDING_BIAS) - ROUNDING_BIAS;
+}
+
+/**
+ * @brief Computes the sine and cosine of an angle.
+ *
+ * The angle is reduced to [-pi/4, pi/4] by subtracting a multiple of pi/2 in
+ * three parts, after which the Cephes minimax polynomials are applied. For
+ * |x| < 2^20 the results are within 2 ulp of std::sin and std::cos.
+ *
+ * @param x         The angle in radians.
+ * @param sinX      Receives the sine of @p x.
+ * @param cosX      Receives the cosine of @p x.
+ */
+inline void sinCos(double x, double& sinX, double& cosX)
+{
+    constexpr double TWO_OVER_PI = 0.63661977236758134308;
+    constexpr double PI_OVER_2_1 = 1.57079632673412561417e+00;
+    constexpr double PI_OVER_2_2 = 6.07710050630396597660e-11;
+    constexpr double PI_OVER_2_3 = 2.02226624871116645580e-21;
+
+    double quadrant = roundToInt(x * TWO_OVER_PI);
+    double r = ((x - quadrant * PI_OVER_2_1) - quadrant * PI_OVER_2_2) - quadrant * PI_OVER_2_3;
+    double z = r * r;
+
+    double sinR = r + r * z *
+                          (-1.66666666666666307295e-1 +
+                           z * (8.33333333332211858878e-3 +
+                                z * (-1.98412698295895385996e-4 +
+                                     z * (2.75573136213857245213e-6 +
+                                          z * (-2.50507477628578072866e-8 + z * 1.58962301576546568060e-10)))));
+    double cosR = 1 - .5 * z +
+                  z * z *
+                      (4.16666666666665929218e-2 +
+                       z * (-1.38888888888730564116e-3 +
+                            z * (2.48015872888517045348e-5 +
+                                 z * (-2.75573141792967388112e-7 +
+                                      z * (2.08757008419747316778e-9 + z * -1.13585365213876817300e-11)))));
+
+    // The quadrant modulo 4, as a value in {-2, -1, 0, 1, 2}, where -2 and 2
+    // both stand for quadrant 2, and -1 for quadrant 3.
+    double mod4 = quadrant - 4 * roundToInt(quadrant * .25);
+
+    bool odd = mod4 == 1 || mod4 == -1;
+    double sinAbs = odd ? cosR : sinR;
+    double cosAbs = odd ? sinR : cosR;
+    sinX = (mod4 < 0 || mod4 > 1.5) ? -sinAbs : sinAbs;
+    cosX = (mod4 > .5 || mod4 < -1.5) ? -cosAbs : cosAbs;
+}
+
+}}}  // namespace aid::xodr::simd
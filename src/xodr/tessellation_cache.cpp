@@ -0,0 +1,193 @@
+#include "tessellation_cache.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "parallel_for.h"
+
+namespace aid { namespace xodr {
+
+template <typename T>
+static size_t vectorBytes(const std::vector<T>& v)
+{
+    return v.capacity() * sizeof(T);
+}
+
+size_t TessellationCache::Entry::memoryUsage() const
+{
+    return sizeof(Entry) + vectorBytes(refLine_.sCoords_) + vectorBytes(refLine_.x_) + vectorBytes(refLine_.y_) +
+           vectorBytes(refLine_.tangentX_) + vectorBytes(refLine_.tangentY_) + vectorBytes(refLine_.curvatures_) +
+           vectorBytes(lanes_.lateralPositions_) + vectorBytes(lanes_.boundaryVertices_) +
+           vectorBytes(lanes_.boundaryOffsets_) + vectorBytes(lanes_.centerLineVertices_) +
+           vectorBytes(lanes_.variances_) + vectorBytes(lanes_.centerLineOffsets_);
+}
+
+TessellationCache::TessellationCache(const XodrMap& map, const Options& options) : map_(map), options_(options)
+{
+    assert(options.maxError_ > 0);
+    assert(options.numLods_ > 0);
+
+    const ArenaVector<Road>& roads = map.roads();
+    laneSectionsBegin_.resize(roads.size() + 1);
+    laneSectionsBegin_[0] = 0;
+    for (size_t i = 0; i < roads.size(); i++)
+    {
+        laneSectionsBegin_[i + 1] = laneSectionsBegin_[i] + static_cast<int>(roads[i].laneSections().size());
+    }
+
+    slots_.resize(static_cast<size_t>(laneSectionsBegin_.back()) * options.numLods_);
+}
+
+double TessellationCache::maxError(int lod) const
+{
+    assert(lod >= 0 && lod < options_.numLods_);
+    return std::ldexp(options_.maxError_, lod);
+}
+
+int TessellationCache::lodForMaxError(double maxError) const
+{
+    int lod = 0;
+    while (lod + 1 < options_.numLods_ && this->maxError(lod + 1) <= maxError)
+    {
+        lod++;
+    }
+    return lod;
+}
+
+std::shared_ptr<const TessellationCache::Entry> TessellationCache::get(LaneSectionKey laneSectionKey, int lod)
+{
+    int slotIdx = slotIndex(laneSectionKey, lod);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot& slot = slots_[slotIdx];
+        if (slot.entry_)
+        {
+            stats_.hits_++;
+            touch(slotIdx);
+            return slot.entry_;
+        }
+        stats_.misses_++;
+    }
+
+    std::shared_ptr<Entry> entry = computeEntry(laneSectionKey, lod);
+    size_t bytes = entry->memoryUsage();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot& slot = slots_[slotIdx];
+    if (slot.entry_)
+    {
+        // Another thread inserted the entry while this one was computing it.
+        touch(slotIdx);
+        return slot.entry_;
+    }
+
+    slot.entry_ = std::move(entry);
+    slot.bytes_ = bytes;
+    lru_.push_front(slotIdx);
+    slot.lruIt_ = lru_.begin();
+    stats_.numEntries_++;
+    stats_.bytes_ += bytes;
+
+    evict();
+    return slot.entry_;
+}
+
+std::shared_ptr<const TessellationCache::Entry> TessellationCache::find(LaneSectionKey laneSectionKey, int lod) const
+{
+    int slotIdx = slotIndex(laneSectionKey, lod);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slots_[slotIdx].entry_;
+}
+
+void TessellationCache::precompute(int firstLod, int lastLod, int numThreads)
+{
+    assert(firstLod >= 0 && firstLod <= lastLod && lastLod < options_.numLods_);
+
+    int numLaneSections = laneSectionsBegin_.back();
+    int numLods = lastLod - firstLod + 1;
+
+    // Find the road of each lane section once, rather than for every task.
+    std::vector<LaneSectionKey> keys;
+    keys.reserve(numLaneSections);
+    for (int roadIdx = 0; roadIdx + 1 < static_cast<int>(laneSectionsBegin_.size()); roadIdx++)
+    {
+        for (int i = laneSectionsBegin_[roadIdx]; i < laneSectionsBegin_[roadIdx + 1]; i++)
+        {
+            keys.emplace_back(roadIdx, i - laneSectionsBegin_[roadIdx]);
+        }
+    }
+
+    // The tasks are ordered by level of detail, from the coarsest, so the
+    // finest levels are the most recently used when the tasks are done.
+    parallelFor(numThreads, static_cast<size_t>(numLaneSections) * numLods, [&](size_t i, int) {
+        int lod = lastLod - static_cast<int>(i / numLaneSections);
+        get(keys[i % numLaneSections], lod);
+    });
+}
+
+void TessellationCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int slotIdx : lru_)
+    {
+        slots_[slotIdx].entry_.reset();
+        slots_[slotIdx].bytes_ = 0;
+    }
+    lru_.clear();
+    stats_.numEntries_ = 0;
+    stats_.bytes_ = 0;
+}
+
+TessellationCache::Stats TessellationCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+int TessellationCache::slotIndex(LaneSectionKey laneSectionKey, int lod) const
+{
+    assert(laneSectionKey.roadIdx_ >= 0 && laneSectionKey.roadIdx_ + 1 < static_cast<int>(laneSectionsBegin_.size()));
+    assert(lod >= 0 && lod < options_.numLods_);
+
+    int laneSectionIdx = laneSectionsBegin_[laneSectionKey.roadIdx_] + laneSectionKey.laneSectionIdx_;
+    assert(laneSectionIdx < laneSectionsBegin_[laneSectionKey.roadIdx_ + 1]);
+
+    return laneSectionIdx * options_.numLods_ + lod;
+}
+
+std::shared_ptr<TessellationCache::Entry> TessellationCache::computeEntry(LaneSectionKey laneSectionKey,
+                                                                          int lod) const
+{
+    const Road& road = map_.roads()[laneSectionKey.roadIdx_];
+    const LaneSection& laneSection = road.laneSections()[laneSectionKey.laneSectionIdx_];
+
+    std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+    road.referenceLine().tessellate(entry->refLine_, laneSection.startS(), laneSection.endS(),
+                                    laneSection.boundaryTessellationTolerance(maxError(lod)));
+    laneSection.tessellateLaneBoundaryCurvesAndCenterLines(entry->refLine_, entry->lanes_);
+    return entry;
+}
+
+void TessellationCache::touch(int slotIdx)
+{
+    lru_.splice(lru_.begin(), lru_, slots_[slotIdx].lruIt_);
+}
+
+void TessellationCache::evict()
+{
+    while (stats_.bytes_ > options_.maxBytes_ && lru_.size() > 1)
+    {
+        Slot& slot = slots_[lru_.back()];
+        stats_.bytes_ -= slot.bytes_;
+        stats_.numEntries_--;
+        stats_.evictions_++;
+
+        slot.entry_.reset();
+        slot.bytes_ = 0;
+        lru_.pop_back();
+    }
+}
+
+}}  // namespace aid::xodr
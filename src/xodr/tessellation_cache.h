@@ -0,0 +1,259 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "xodr_map.h"
+#include "xodr_map_keys.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief A memory-bounded cache of lane section tessellations at multiple
+ * levels of detail.
+ *
+ * Each entry holds the tessellation of a lane section's reference line (see
+ * ReferenceLine::tessellate()) along with its lane boundaries and center lines
+ * (see LaneSection::tessellateLaneBoundaryCurvesAndCenterLines()), for one
+ * level of detail (LOD). LOD 0 is the finest, with a maximum error of
+ * Options::maxError_, and every next level doubles the maximum error.
+ *
+ * When the entries take more than Options::maxBytes_ of memory, the least
+ * recently used ones are evicted. Entries are handed out as shared pointers,
+ * so an entry which is evicted stays valid for as long as it's referenced.
+ *
+ * All member functions may be called concurrently. Tessellations are computed
+ * outside of the cache's lock, so a miss doesn't block other threads. If
+ * several threads miss on the same entry at the same time, each computes it,
+ * and all get the entry which was inserted first.
+ */
+class TessellationCache
+{
+  public:
+    /**
+     * @brief Options which control the levels of detail and the size of a
+     * TessellationCache.
+     */
+    struct Options
+    {
+        /**
+         * @brief The maximum error of the lane boundaries at LOD 0.
+         */
+        double maxError_ = .01;
+
+        /**
+         * @brief The number of levels of detail.
+         */
+        int numLods_ = 8;
+
+        /**
+         * @brief The maximum amount of memory taken by the entries, in bytes.
+         *
+         * The most recently used entry is never evicted, so the cache may
+         * exceed this if a single entry is larger.
+         */
+        size_t maxBytes_ = 64 * 1024 * 1024;
+    };
+
+    /**
+     * @brief A cached tessellation of a lane section.
+     */
+    struct Entry
+    {
+        /**
+         * @brief The tessellation of the reference line between the start and
+         * end of the lane section.
+         */
+        ReferenceLine::FrenetFrames refLine_;
+
+        /**
+         * @brief The lane boundaries and center lines, derived from refLine_.
+         */
+        LaneSection::LaneTessellationBuffer lanes_;
+
+        /**
+         * @returns The amount of memory taken by the entry, in bytes.
+         */
+        size_t memoryUsage() const;
+    };
+
+    /**
+     * @brief Statistics about the use of a TessellationCache.
+     */
+    struct Stats
+    {
+        /**
+         * @brief The number of lookups which found their entry in the cache.
+         */
+        uint64_t hits_ = 0;
+
+        /**
+         * @brief The number of lookups which had to compute their entry.
+         */
+        uint64_t misses_ = 0;
+
+        /**
+         * @brief The number of entries which were evicted to stay within
+         * Options::maxBytes_.
+         */
+        uint64_t evictions_ = 0;
+
+        /**
+         * @brief The number of entries currently in the cache.
+         */
+        int numEntries_ = 0;
+
+        /**
+         * @brief The amount of memory currently taken by the entries, in
+         * bytes.
+         */
+        size_t bytes_ = 0;
+    };
+
+    /**
+     * @brief Creates a TessellationCache for the given map, which must
+     * outlive it.
+     *
+     * @param map           The map.
+     * @param options       The options.
+     */
+    TessellationCache(const XodrMap& map, const Options& options);
+
+    /**
+     * @returns The options of the cache.
+     */
+    const Options& options() const { return options_; }
+
+    /**
+     * @brief Gets the maximum error of the lane boundaries at the given level
+     * of detail.
+     *
+     * @param lod           The level of detail, in [0, Options::numLods_).
+     * @returns             The maximum error.
+     */
+    double maxError(int lod) const;
+
+    /**
+     * @brief Gets the coarsest level of detail whose maximum error doesn't
+     * exceed the given one, or 0 if there is none.
+     *
+     * @param maxError      The maximum error.
+     * @returns             The level of detail.
+     */
+    int lodForMaxError(double maxError) const;
+
+    /**
+     * @brief Gets the tessellation of a lane section, computing it if it isn't
+     * in the cache.
+     *
+     * @param laneSectionKey    The lane section.
+     * @param lod               The level of detail, in [0, Options::numLods_).
+     * @returns                 The tessellation.
+     */
+    std::shared_ptr<const Entry> get(LaneSectionKey laneSectionKey, int lod);
+
+    /**
+     * @brief Gets the tessellation of a lane section if it is in the cache.
+     *
+     * Unlike get(), this doesn't count as a hit or a miss.
+     *
+     * @param laneSectionKey    The lane section.
+     * @param lod               The level of detail, in [0, Options::numLods_).
+     * @returns                 The tessellation, or nullptr if it isn't in
+     *                          the cache.
+     */
+    std::shared_ptr<const Entry> find(LaneSectionKey laneSectionKey, int lod) const;
+
+    /**
+     * @brief Tessellates all lane sections of the map at a range of levels of
+     * detail, for example when the map is loaded.
+     *
+     * The levels are computed from the coarsest to the finest, so if they
+     * don't all fit in the cache, the finest ones are kept.
+     *
+     * @param firstLod      The finest level of detail.
+     * @param lastLod       The coarsest level of detail.
+     * @param numThreads    The number of threads to use, where 0 means one
+     *                      thread per hardware thread.
+     */
+    void precompute(int firstLod, int lastLod, int numThreads = 0);
+
+    /**
+     * @brief Removes all entries from the cache. This doesn't reset the
+     * statistics.
+     */
+    void clear();
+
+    /**
+     * @returns The statistics of the cache.
+     */
+    Stats stats() const;
+
+  private:
+    /**
+     * @brief Gets the index of a slot in slots_.
+     */
+    int slotIndex(LaneSectionKey laneSectionKey, int lod) const;
+
+    /**
+     * @brief Computes the tessellation of a lane section.
+     */
+    std::shared_ptr<Entry> computeEntry(LaneSectionKey laneSectionKey, int lod) const;
+
+    /**
+     * @brief Moves the entry in the given slot to the front of lru_. The mutex
+     * must be locked.
+     */
+    void touch(int slotIdx);
+
+    /**
+     * @brief Evicts the least recently used entries until the cache fits
+     * within Options::maxBytes_. The mutex must be locked.
+     */
+    void evict();
+
+    /**
+     * @brief The entry of a lane section at a level of detail.
+     */
+    struct Slot
+    {
+        std::shared_ptr<const Entry> entry_;
+        size_t bytes_ = 0;
+
+        /**
+         * @brief The position of the slot in lru_, if entry_ is set.
+         */
+        std::list<int>::iterator lruIt_;
+    };
+
+    const XodrMap& map_;
+    Options options_;
+
+    /**
+     * @brief The index of the first lane section of each road among the lane
+     * sections of all roads, followed by the total number of lane sections.
+     */
+    std::vector<int> laneSectionsBegin_;
+
+    mutable std::mutex mutex_;
+
+    /**
+     * @brief The slots, by lane section (in the order of laneSectionsBegin_),
+     * then by level of detail.
+     */
+    std::vector<Slot> slots_;
+
+    /**
+     * @brief The indices of the slots which have an entry, from the most to
+     * the least recently used.
+     */
+    std::list<int> lru_;
+
+    Stats stats_;
+};
+
+}}  // namespace aid::xodr
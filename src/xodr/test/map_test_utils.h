@@ -0,0 +1,96 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+
+#include "binary/xodr_map_view.h"
+#include "xodr_map.h"
+
+#include "test_config.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Loads the map with the given file name from the map data directory.
+ */
+inline XodrMap loadXodrMap(const std::string& name)
+{
+    XodrParseResult<XodrMap> result = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + name);
+    return std::move(result.value());
+}
+
+/**
+ * @brief Gets the value of a lane access restriction, of either a parsed map
+ * or a flat map.
+ */
+inline std::string_view laneAccessValue(const LaneAccess& access)
+{
+    return access.restriction();
+}
+
+inline std::string_view laneAccessValue(const LaneStringAttribView& access)
+{
+    return access.value();
+}
+
+/**
+ * @brief Expects a lane of a parsed map to be equal to a lane of another
+ * parsed map (a LaneSection::Lane) or of a flat map (a LaneView).
+ */
+template <class OtherLane>
+void expectLanesEqual(const LaneSection::Lane& a, const OtherLane& b)
+{
+    EXPECT_EQ(a.id(), b.id());
+    EXPECT_EQ(a.type(), b.type());
+    EXPECT_EQ(a.level(), b.level());
+    EXPECT_EQ(a.globalIndex(), b.globalIndex());
+
+    ASSERT_EQ(a.hasPredecessor(), b.hasPredecessor());
+    if (a.hasPredecessor())
+    {
+        EXPECT_EQ(a.predecessor(), b.predecessor());
+    }
+
+    ASSERT_EQ(a.hasSuccessor(), b.hasSuccessor());
+    if (a.hasSuccessor())
+    {
+        EXPECT_EQ(a.successor(), b.successor());
+    }
+
+    ASSERT_EQ(a.widthPoly3s().size(), b.widthPoly3s().size());
+    for (size_t i = 0; i < a.widthPoly3s().size(); i++)
+    {
+        EXPECT_EQ(a.widthPoly3s()[i].sOffset(), b.widthPoly3s()[i].sOffset());
+        EXPECT_EQ(a.widthPoly3s()[i].poly3(), b.widthPoly3s()[i].poly3());
+    }
+
+    ASSERT_EQ(a.materials().size(), b.materials().size());
+    for (size_t i = 0; i < a.materials().size(); i++)
+    {
+        EXPECT_EQ(a.materials()[i].surface(), b.materials()[i].surface());
+        EXPECT_EQ(a.materials()[i].friction(), b.materials()[i].friction());
+    }
+
+    ASSERT_EQ(a.speedLimits().size(), b.speedLimits().size());
+    for (size_t i = 0; i < a.speedLimits().size(); i++)
+    {
+        EXPECT_EQ(a.speedLimits()[i].maxSpeed(), b.speedLimits()[i].maxSpeed());
+        EXPECT_EQ(a.speedLimits()[i].unit(), b.speedLimits()[i].unit());
+    }
+
+    ASSERT_EQ(a.accesses().size(), b.accesses().size());
+    for (size_t i = 0; i < a.accesses().size(); i++)
+    {
+        EXPECT_EQ(laneAccessValue(a.accesses()[i]), laneAccessValue(b.accesses()[i]));
+    }
+
+    ASSERT_EQ(a.rules().size(), b.rules().size());
+    for (size_t i = 0; i < a.rules().size(); i++)
+    {
+        EXPECT_EQ(a.rules()[i].value(), b.rules()[i].value());
+    }
+}
+
+}}  // namespace aid::xodr
@@ -5,4 +5,5 @@
 namespace aid { namespace xodr {
 
 static const char TEST_DATA_PATH_PREFIX[] = "test/testdata/";
+static const char MAP_DATA_PATH_PREFIX[] = "../../data/opendrive/";
 }}  // namespace aid::xodr
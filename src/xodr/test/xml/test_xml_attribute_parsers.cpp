@@ -217,4 +217,77 @@ TEST(XmlAttributeParsersTest, testOptionalSetterParserAttribMissing)
     EXPECT_EQ(result.value().a_, 100);
 }
 
-}}  // namespace aid::xodr
\ No newline at end of file
+TEST(XmlAttributeParsersTest, testNumberParsing)
+{
+    using xml_parsers::parseXmlAttrib;
+
+    EXPECT_EQ(parseXmlAttrib<int>("42"), 42);
+    EXPECT_EQ(parseXmlAttrib<int>("-7"), -7);
+    EXPECT_EQ(parseXmlAttrib<int>(" +7"), 7);
+    EXPECT_EQ(parseXmlAttrib<int>("12abc"), 12);
+    EXPECT_THROW(parseXmlAttrib<int>(""), std::invalid_argument);
+    EXPECT_THROW(parseXmlAttrib<int>("abc"), std::invalid_argument);
+    EXPECT_THROW(parseXmlAttrib<int>("+-1"), std::invalid_argument);
+    EXPECT_THROW(parseXmlAttrib<int>("99999999999"), std::out_of_range);
+
+    EXPECT_EQ(parseXmlAttrib<double>("1.5"), 1.5);
+    EXPECT_EQ(parseXmlAttrib<double>("-2.5e-3"), -2.5e-3);
+    EXPECT_EQ(parseXmlAttrib<double>("+1.0000000000000000e+00"), 1.0);
+    EXPECT_EQ(parseXmlAttrib<double>("\t3"), 3.0);
+    EXPECT_EQ(parseXmlAttrib<double>("1,5"), 1.0);
+    EXPECT_THROW(parseXmlAttrib<double>("x"), std::invalid_argument);
+    EXPECT_THROW(parseXmlAttrib<double>("1e999"), std::out_of_range);
+}
+
+TEST(XmlAttributeParsersTest, testManyParsers)
+{
+    // More parsers than fit in a 32 bit or 64 bit mask.
+    const int NUM_ATTRIBS = 70;
+
+    std::string text = "<elem";
+    for (int i = 0; i < NUM_ATTRIBS; i += 2)
+    {
+        text += " a" + std::to_string(i) + " = '" + std::to_string(i) + "'";
+    }
+    text += "/>";
+    XmlReader xml = XmlReader::fromText(text);
+
+    struct Attribs
+    {
+        int a_[NUM_ATTRIBS];
+    };
+
+    // Only the attributes with an even index are specified.
+    XmlAttributeParsers<XmlParseResult<Attribs>> parsers;
+    for (int i = 0; i < NUM_ATTRIBS; i += 2)
+    {
+        parsers.addParser("a" + std::to_string(i), [](std::string_view value, XmlParseResult<Attribs>& result) {
+            int index = xml_parsers::parseXmlAttrib<int>(value);
+            result.value().a_[index] = index;
+        });
+    }
+    for (int i = 1; i < NUM_ATTRIBS; i += 2)
+    {
+        parsers.addParser("a" + std::to_string(i), [](std::string_view, XmlParseResult<Attribs>&) {});
+    }
+    parsers.finalize();
+
+    xml.readStartElement("elem");
+
+    XmlParseResult<Attribs, XmlParseError> result;
+    parsers.parse(xml, result);
+
+    for (int i = 0; i < NUM_ATTRIBS; i += 2)
+    {
+        EXPECT_EQ(result.value().a_[i], i);
+    }
+
+    // Each of the odd attributes is missing.
+    ASSERT_EQ(result.errors().size(), static_cast<size_t>(NUM_ATTRIBS / 2));
+    for (const XmlParseError& error : result.errors())
+    {
+        EXPECT_EQ(error.category_, XmlParseError::Category::MISSING_ATTRIBUTE);
+    }
+}
+
+}}  // namespace aid::xodr
@@ -110,4 +110,53 @@ TEST(XmlChildElementParsersTest, testParseOneChild_TooMany)
     EXPECT_EQ(obj.errors().at(0).value_, "a");
 }
 
+TEST(XmlChildElementParsersTest, testManyParsers)
+{
+    // More parsers than fit in a 32 bit or 64 bit mask.
+    const int NUM_CHILDREN = 70;
+
+    std::string text = "<root>";
+    for (int i = 0; i < NUM_CHILDREN; i += 2)
+    {
+        text += "<c" + std::to_string(i) + "/>";
+    }
+    text += "<c0/></root>";
+    XmlReader xml = XmlReader::fromText(text);
+
+    struct Obj
+    {
+        int numCalls_;
+    };
+
+    using Parsers = XmlChildElementParsers<XmlReader, XmlParseResult<Obj>>;
+
+    Parsers parsers;
+    for (int i = 0; i < NUM_CHILDREN; i++)
+    {
+        parsers.addParser("c" + std::to_string(i), Parsers::Multiplicity::ONE,
+                          [](XmlReader& xml, XmlParseResult<Obj>& obj) {
+                              obj.value().numCalls_++;
+
+                              xml.skipToEndElement();
+                          });
+    }
+    parsers.finalize();
+
+    XmlParseResult<Obj> obj;
+
+    xml.readStartElement("root");
+    parsers.parse(xml, obj);
+
+    EXPECT_EQ(obj.value().numCalls_, NUM_CHILDREN / 2 + 1);
+
+    // One error for the duplicated <c0>, and one for each of the odd children.
+    ASSERT_EQ(obj.errors().size(), static_cast<size_t>(NUM_CHILDREN / 2 + 1));
+    EXPECT_EQ(obj.errors().at(0).category_, XmlParseError::Category::DUPLICATE_CHILD_ELEMENT);
+    EXPECT_EQ(obj.errors().at(0).value_, "c0");
+    for (size_t i = 1; i < obj.errors().size(); i++)
+    {
+        EXPECT_EQ(obj.errors().at(i).category_, XmlParseError::Category::MISSING_CHILD_ELEMENT);
+    }
+}
+
 }}  // namespace aid::xodr
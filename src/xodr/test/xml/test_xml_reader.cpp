@@ -2,6 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <fstream>
+
 namespace aid { namespace xodr {
 
 TEST(XmlReaderTest, testReadElement)
@@ -80,4 +83,149 @@ TEST(XmlReaderTest, testTryReadNamedElement)
     xml.readEndElement();
 }
 
-}}  // namespace aid::xodr
\ No newline at end of file
+TEST(XmlReaderTest, testEmptyElementTag)
+{
+    XmlReader xml = XmlReader::fromText("<root><child a='1'/><child a='2'></child></root>");
+
+    xml.readStartElement("root");
+
+    xml.readStartElement("child");
+    EXPECT_EQ(xml.getAttribute("a"), "1");
+    EXPECT_FALSE(xml.tryReadStartElement());
+    xml.readEndElement();
+
+    xml.readStartElement("child");
+    EXPECT_EQ(xml.getAttribute("a"), "2");
+    xml.readEndElement();
+
+    xml.readEndElement();
+    EXPECT_FALSE(xml.tryReadStartElement());
+}
+
+TEST(XmlReaderTest, testAttributes)
+{
+    XmlReader xml = XmlReader::fromText("<root a = \"x &amp; y\" b='&#65;&#x42;'/>");
+
+    xml.readStartElement("root");
+    std::vector<XmlReader::Attrib> attribs = xml.getAttributes();
+    ASSERT_EQ(attribs.size(), 2u);
+    EXPECT_EQ(attribs[0].name_, "a");
+    EXPECT_EQ(attribs[0].value_, "x & y");
+    EXPECT_EQ(attribs[1].name_, "b");
+    EXPECT_EQ(attribs[1].value_, "AB");
+    EXPECT_ANY_THROW(xml.getAttribute("c"));
+}
+
+TEST(XmlReaderTest, testGetText)
+{
+    XmlReader xml = XmlReader::fromText(
+        "<?xml version=\"1.0\"?>"
+        "<!-- comment -->"
+        "<root>"
+        "  <text>  a  &lt; <!-- comment --> b  <![CDATA[ <c> ]]></text>"
+        "  <mixed>a<child/></mixed>"
+        "</root>");
+
+    xml.readStartElement("root");
+
+    xml.readStartElement("text");
+    EXPECT_EQ(xml.getText(), "a < b  <c> ");
+    xml.readEndElement();
+
+    xml.readStartElement("mixed");
+    EXPECT_ANY_THROW(xml.getText());
+    xml.skipToEndElement();
+
+    xml.readEndElement();
+}
+
+TEST(XmlReaderTest, testSkipToEndElement)
+{
+    XmlReader xml = XmlReader::fromText(
+        "<root>"
+        "  <child1><a><b/></a><c/></child1>"
+        "  <child2/>"
+        "  <child3/>"
+        "</root>");
+
+    xml.readStartElement("root");
+    xml.readStartElement("child1");
+    xml.skipToEndElement();
+
+    xml.readStartElement("child2");
+    xml.readEndElement();
+
+    // Skipping while at the end of an element skips the remaining siblings.
+    xml.skipToEndElement();
+    EXPECT_EQ(xml.getCurElementName(), "root");
+    EXPECT_FALSE(xml.tryReadStartElement());
+}
+
+TEST(XmlReaderTest, testLineNumbers)
+{
+    XmlReader xml = XmlReader::fromText(
+        "<root>\n"
+        "  <child/>\n"
+        "</root>");
+
+    xml.readStartElement("root");
+    EXPECT_EQ(xml.getLineNumber(), 1);
+    EXPECT_EQ(xml.getColumnNumber(), 1);
+
+    xml.readStartElement("child");
+    EXPECT_EQ(xml.getLineNumber(), 2);
+    EXPECT_EQ(xml.getColumnNumber(), 3);
+}
+
+TEST(XmlReaderTest, testMalformedXml)
+{
+    XmlReader mismatched = XmlReader::fromText("<root><child></root>");
+    mismatched.readStartElement("root");
+    mismatched.readStartElement("child");
+    EXPECT_ANY_THROW(mismatched.readEndElement());
+
+    XmlReader unterminated = XmlReader::fromText("<root><child/>");
+    unterminated.readStartElement("root");
+    unterminated.readStartElement("child");
+    unterminated.readEndElement();
+    EXPECT_ANY_THROW(unterminated.readEndElement());
+
+    EXPECT_ANY_THROW(XmlReader::fromFile("this/file/does/not/exist.xml"));
+
+    XmlReader duplicateAttrib = XmlReader::fromText("<root><a x='1' x='2'/></root>");
+    duplicateAttrib.readStartElement("root");
+    EXPECT_ANY_THROW(duplicateAttrib.readStartElement("a"));
+}
+
+TEST(XmlReaderTest, testReadLargeFile)
+{
+    // Use a file which is considerably larger than the buffers used to read
+    // it, so elements straddle buffer boundaries.
+    const int numChildren = 20000;
+    std::string fileName = "xml_reader_test_large_file.xml";
+    {
+        std::ofstream file(fileName);
+        file << "<root>\n";
+        for (int i = 0; i < numChildren; i++)
+        {
+            file << "  <child index=\"" << i << "\">text " << i << "</child>\n";
+        }
+        file << "</root>\n";
+    }
+
+    XmlReader xml = XmlReader::fromFile(fileName);
+    xml.readStartElement("root");
+    for (int i = 0; i < numChildren; i++)
+    {
+        xml.readStartElement("child");
+        ASSERT_EQ(xml.getAttribute("index"), std::to_string(i));
+        ASSERT_EQ(xml.getText(), "text " + std::to_string(i));
+        ASSERT_EQ(xml.getLineNumber(), i + 2);
+        xml.readEndElement();
+    }
+    xml.readEndElement();
+
+    std::remove(fileName.c_str());
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,134 @@
+#include "arc_length_table.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Computes the arc length of (uPoly(p), vPoly(p)) over [0, endParam]
+ * with Simpson's rule, in extended precision.
+ */
+static double integratedLength(const Poly3& uPoly, const Poly3& vPoly, double endParam)
+{
+    constexpr int NUM_INTERVALS = 200000;
+
+    long double step = static_cast<long double>(endParam) / NUM_INTERVALS;
+    long double sum = 0;
+    for (int i = 0; i <= NUM_INTERVALS; i++)
+    {
+        double p = static_cast<double>(i * step);
+        long double speed = std::hypot(static_cast<long double>(uPoly.evalDerivative(p)),
+                                       static_cast<long double>(vPoly.evalDerivative(p)));
+        long double weight = (i == 0 || i == NUM_INTERVALS) ? 1 : (i % 2 ? 4 : 2);
+        sum += weight * speed;
+    }
+
+    return static_cast<double>(sum * step / 3);
+}
+
+TEST(ArcLengthTableTest, testLine)
+{
+    // A line with a speed of 2, so the parameter is half the arc length.
+    ArcLengthTable table(Poly3(1, 2, 0, 0), Poly3(0, 0, 0, 0), 10);
+    EXPECT_NEAR(table.totalLength(), 20, 1e-12);
+    EXPECT_NEAR(table.paramAt(0), 0, 1e-12);
+    EXPECT_NEAR(table.paramAt(7), 3.5, 1e-12);
+    EXPECT_NEAR(table.paramAt(20), 10, 1e-12);
+    EXPECT_LE(table.numNodes(), 5);
+}
+
+TEST(ArcLengthTableTest, testMatchesNumericalIntegration)
+{
+    // A gently curving lane offset of the kind found in road networks, and a
+    // paramPoly3 with normalized parameters.
+    const Poly3 uPolys[] = {Poly3(0, 1, 0, 0), Poly3(0, 60, 0, 0)};
+    const Poly3 vPolys[] = {Poly3(0, 0, .01, -.0001), Poly3(0, 0, 3, -1)};
+    const double endParams[] = {60, 1};
+
+    for (int i = 0; i < 2; i++)
+    {
+        ArcLengthTable table(uPolys[i], vPolys[i], endParams[i]);
+        double totalLength = table.totalLength();
+        EXPECT_NEAR(totalLength, integratedLength(uPolys[i], vPolys[i], endParams[i]), 1e-9);
+
+        // Map arc lengths to parameters and back.
+        for (int j = 1; j <= 10; j++)
+        {
+            double p = endParams[i] * j / 10;
+            double s = integratedLength(uPolys[i], vPolys[i], p);
+            EXPECT_NEAR(table.paramAt(s), p, 1e-9 * endParams[i]) << "curve " << i << ", p " << p;
+        }
+    }
+}
+
+TEST(ArcLengthTableTest, testMonotonic)
+{
+    // The curve slows down to nearly zero speed around p = 1.
+    ArcLengthTable table(Poly3(0, 1, -1, 1.0 / 3), Poly3(0, 0, 0, 1e-3), 3);
+
+    double prevParam = table.paramAt(0);
+    for (int i = 1; i <= 1000; i++)
+    {
+        double param = table.paramAt(table.totalLength() * i / 1000);
+        EXPECT_GE(param, prevParam);
+        prevParam = param;
+    }
+    EXPECT_NEAR(prevParam, 3, 1e-9);
+}
+
+TEST(ArcLengthTableTest, testExtrapolation)
+{
+    ArcLengthTable table(Poly3(0, 2, 0, 0), Poly3(0, 0, 0, 0), 10);
+    EXPECT_NEAR(table.paramAt(-2), -1, 1e-12);
+    EXPECT_NEAR(table.paramAt(22), 11, 1e-12);
+}
+
+TEST(ArcLengthTableTest, testLazyTable)
+{
+    Poly3 uPoly(0, 1, 0, 0);
+    Poly3 vPoly(0, 0, .01, 0);
+
+    LazyArcLengthTable lazyTable;
+    const ArcLengthTable& table = lazyTable.get(uPoly, vPoly, 50);
+    EXPECT_EQ(&lazyTable.get(uPoly, vPoly, 50), &table);
+
+    // Copies build their own table.
+    LazyArcLengthTable copy(lazyTable);
+    EXPECT_NE(&copy.get(uPoly, vPoly, 50), &table);
+    EXPECT_EQ(copy.get(uPoly, vPoly, 50).totalLength(), table.totalLength());
+
+    // Moves take the table along.
+    LazyArcLengthTable moved(std::move(lazyTable));
+    EXPECT_EQ(&moved.get(uPoly, vPoly, 50), &table);
+}
+
+TEST(ArcLengthTableTest, testExternalNodes)
+{
+    Poly3 uPoly(0, 60, 0, 0);
+    Poly3 vPoly(0, 0, 3, -1);
+    ArcLengthTable table(uPoly, vPoly, 1);
+    std::vector<double> nodes(table.nodes(), table.nodes() + 3 * table.numNodes());
+
+    // A table which refers to a copy of the nodes gives exactly the same
+    // parameters.
+    ArcLengthTable external(nodes.data(), table.numNodes());
+    EXPECT_EQ(external.nodes(), nodes.data());
+    EXPECT_EQ(external.totalLength(), table.totalLength());
+    for (double s = -1; s <= table.totalLength() + 1; s += .1)
+    {
+        EXPECT_EQ(external.paramAt(s), table.paramAt(s));
+    }
+
+    // A lazy table which is given a table uses it, without taking ownership.
+    LazyArcLengthTable lazyTable(external);
+    EXPECT_EQ(&lazyTable.get(uPoly, vPoly, 1), &external);
+    LazyArcLengthTable moved(std::move(lazyTable));
+    EXPECT_EQ(&moved.get(uPoly, vPoly, 1), &external);
+    moved.reset();
+    EXPECT_NE(&moved.get(uPoly, vPoly, 1), &external);
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,203 @@
+#include "clothoid.h"
+#include "xodr_map.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "../test_config.h"
+
+extern "C" {
+#include "odrSpiral/odrSpiral.h"
+}
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Evaluates a point on a clothoid with odrSpiral(), the way the spiral
+ * geometry used to: as the offset between two points on the normalized spiral,
+ * rotated to the start heading.
+ */
+static Eigen::Vector2d odrSpiralPoint(const Eigen::Vector2d& startPoint, double startHeading, double startCurvature,
+                                      double curvatureRateOfChange, double u)
+{
+    double curveStartParam = startCurvature / curvatureRateOfChange;
+
+    Eigen::Vector2d curveStartPt, curveEvalPt;
+    double curveStartHeading, curveEvalHeading;
+    odrSpiral(curveStartParam, curvatureRateOfChange, &curveStartPt.x(), &curveStartPt.y(), &curveStartHeading);
+    odrSpiral(curveStartParam + u, curvatureRateOfChange, &curveEvalPt.x(), &curveEvalPt.y(), &curveEvalHeading);
+
+    return startPoint + Eigen::Rotation2Dd(startHeading - curveStartHeading) * (curveEvalPt - curveStartPt);
+}
+
+/**
+ * @brief Evaluates a point on a clothoid by integrating its tangent direction
+ * with Simpson's rule, in extended precision.
+ */
+static Eigen::Vector2d integratedPoint(const Eigen::Vector2d& startPoint, double startHeading, double startCurvature,
+                                       double curvatureRateOfChange, double u)
+{
+    constexpr int NUM_INTERVALS = 20000;
+
+    long double step = static_cast<long double>(u) / NUM_INTERVALS;
+    long double sumX = 0;
+    long double sumY = 0;
+    for (int i = 0; i <= NUM_INTERVALS; i++)
+    {
+        long double t = i * step;
+        long double heading = startHeading + t * (startCurvature + .5L * curvatureRateOfChange * t);
+        long double weight = (i == 0 || i == NUM_INTERVALS) ? 1 : (i % 2 ? 4 : 2);
+        sumX += weight * std::cos(heading);
+        sumY += weight * std::sin(heading);
+    }
+
+    return startPoint + Eigen::Vector2d(static_cast<double>(sumX * step / 3), static_cast<double>(sumY * step / 3));
+}
+
+TEST(ClothoidTest, testMatchesNumericalIntegration)
+{
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> curvatureDist(-.2, .2);
+    std::uniform_real_distribution<double> lengthDist(1, 300);
+    std::uniform_real_distribution<double> headingDist(-M_PI, M_PI);
+
+    for (int i = 0; i < 50; i++)
+    {
+        Eigen::Vector2d startPoint(-500, 300);
+        double startHeading = headingDist(random);
+        double startCurvature = curvatureDist(random);
+        double length = lengthDist(random);
+        double curvatureROC = (curvatureDist(random) - startCurvature) / length;
+
+        Clothoid clothoid(startPoint, startHeading, startCurvature, curvatureROC, length);
+
+        for (int j = 1; j <= 4; j++)
+        {
+            double u = length * j / 4;
+            Eigen::Vector2d expected = integratedPoint(startPoint, startHeading, startCurvature, curvatureROC, u);
+            EXPECT_LT((clothoid.evalPoint(u) - expected).norm(), 1e-11) << "length " << length << ", u " << u;
+        }
+    }
+}
+
+TEST(ClothoidTest, testMatchesOdrSpiral)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> curvatureDist(-.2, .2);
+    std::uniform_real_distribution<double> lengthDist(1, 300);
+    std::uniform_real_distribution<double> headingDist(-M_PI, M_PI);
+
+    for (int i = 0; i < 200; i++)
+    {
+        Eigen::Vector2d startPoint(1000, -2000);
+        double startHeading = headingDist(random);
+        double startCurvature = curvatureDist(random);
+        double endCurvature = curvatureDist(random);
+        double length = lengthDist(random);
+        double curvatureROC = (endCurvature - startCurvature) / length;
+
+        Clothoid clothoid(startPoint, startHeading, startCurvature, curvatureROC, length);
+
+        for (int j = 0; j <= 100; j++)
+        {
+            double u = length * j / 100;
+            Eigen::Vector2d expected = odrSpiralPoint(startPoint, startHeading, startCurvature, curvatureROC, u);
+
+            EXPECT_LT((clothoid.evalPoint(u) - expected).norm(), 1e-9)
+                << "curvature " << startCurvature << " to " << endCurvature << ", length " << length << ", u " << u;
+            EXPECT_NEAR(clothoid.evalHeading(u),
+                        startHeading + u * startCurvature + .5 * curvatureROC * u * u, 1e-12);
+        }
+    }
+}
+
+TEST(ClothoidTest, testMatchesOdrSpiralOnMapSpirals)
+{
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + "sample1.1.xodr").extract_value();
+
+    int numSpirals = 0;
+    for (const Road& road : map.roads())
+    {
+        const ReferenceLine& refLine = road.referenceLine();
+        for (int i = 0; i < refLine.numGeometries(); i++)
+        {
+            if (refLine.geometry(i).geometryType() != ReferenceLine::GeometryType::SPIRAL)
+            {
+                continue;
+            }
+
+            const auto& spiral = static_cast<const ReferenceLine::Spiral&>(refLine.geometry(i));
+            ReferenceLine::Vertex startVert = spiral.startVertex();
+            numSpirals++;
+
+            for (double u = 0; u <= spiral.length(); u += .25)
+            {
+                Eigen::Vector2d expected = odrSpiralPoint(startVert.position_, startVert.heading_,
+                                                          spiral.startCurvature(), spiral.curvatureRateOfChange(), u);
+
+                ReferenceLine::PointAndTangentDir pt = spiral.eval(startVert.sCoord_ + u);
+                EXPECT_LT((pt.point_ - expected).norm(), 1e-9) << "road " << road.id() << ", u " << u;
+            }
+        }
+    }
+
+    EXPECT_EQ(numSpirals, 70);
+}
+
+TEST(ClothoidTest, testPieces)
+{
+    // A tight spiral which is split into many pieces.
+    Clothoid clothoid(Eigen::Vector2d(0, 0), 0, 0, .01, 100);
+    EXPECT_GT(clothoid.numPieces(), 10);
+
+    // The heading changes by 50 radians, so the curve winds around its end
+    // point many times. It stays continuous at the piece boundaries.
+    double pieceLength = 100.0 / clothoid.numPieces();
+    for (int i = 1; i < clothoid.numPieces(); i++)
+    {
+        double u = i * pieceLength;
+        EXPECT_LT((clothoid.evalPoint(u - 1e-9) - clothoid.evalPoint(u + 1e-9)).norm(), 1e-8);
+    }
+
+    Eigen::Vector2d expectedEnd = odrSpiralPoint(Eigen::Vector2d(0, 0), 0, 1e-12, .01, 100);
+    EXPECT_LT((clothoid.evalPoint(100) - expectedEnd).norm(), 1e-9);
+}
+
+TEST(ClothoidTest, testExternalCoeffs)
+{
+    Clothoid clothoid(Eigen::Vector2d(3, 4), .5, -.02, .01, 100);
+    std::vector<double> coeffs(clothoid.coeffs(), clothoid.coeffs() + clothoid.numPieces() * Clothoid::PIECE_STRIDE);
+
+    // A clothoid which refers to a copy of the coefficients, and its copies,
+    // evaluate to exactly the same points and headings.
+    Clothoid external(.5, -.02, .01, 100, coeffs.data(), clothoid.numPieces());
+    Clothoid copy = external;
+    EXPECT_EQ(copy.coeffs(), coeffs.data());
+    EXPECT_EQ(copy.numPieces(), clothoid.numPieces());
+    for (double u = 0; u <= 100; u += .25)
+    {
+        EXPECT_EQ(copy.evalPoint(u), clothoid.evalPoint(u));
+        EXPECT_EQ(copy.evalHeading(u), clothoid.evalHeading(u));
+    }
+}
+
+TEST(ClothoidTest, testDegenerateCurvatures)
+{
+    // Without curvature, a clothoid is a line.
+    Clothoid line(Eigen::Vector2d(1, 2), M_PI / 2, 0, 0, 10);
+    EXPECT_EQ(line.numPieces(), 1);
+    EXPECT_LT((line.evalPoint(10) - Eigen::Vector2d(1, 12)).norm(), 1e-12);
+
+    // Without a change of curvature, it's an arc.
+    Clothoid arc(Eigen::Vector2d(0, 0), 0, .1, 0, 10 * M_PI);
+    for (double u = 0; u <= 10 * M_PI; u += .5)
+    {
+        Eigen::Vector2d expected(10 * std::sin(u / 10), 10 - 10 * std::cos(u / 10));
+        EXPECT_LT((arc.evalPoint(u) - expected).norm(), 1e-12);
+    }
+}
+
+}}  // namespace aid::xodr
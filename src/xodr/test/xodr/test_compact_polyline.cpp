@@ -0,0 +1,106 @@
+#include "compact_polyline.h"
+
+#include <gtest/gtest.h>
+
+#include <cfloat>
+#include <random>
+#include <stdexcept>
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Generates a random walk with steps of varying lengths, some of which
+ * are too long for a single word per coordinate.
+ */
+static std::vector<Eigen::Vector2d> randomWalk(const Eigen::Vector2d& start, int size)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> angleDist(0, 2 * M_PI);
+    std::uniform_real_distribution<double> exponentDist(-3, 3);
+
+    std::vector<Eigen::Vector2d> vertices;
+    Eigen::Vector2d vertex = start;
+    for (int i = 0; i < size; i++)
+    {
+        vertices.push_back(vertex);
+        double angle = angleDist(rng);
+        vertex += std::pow(10, exponentDist(rng)) * Eigen::Vector2d(std::cos(angle), std::sin(angle));
+    }
+
+    return vertices;
+}
+
+TEST(CompactPolylineTest, testFloatPolyline)
+{
+    Eigen::Vector2d origin(512345.25, 5401234.5);
+    std::vector<Eigen::Vector2d> vertices = randomWalk(origin + Eigen::Vector2d(10, -20), 1000);
+
+    std::vector<Eigen::Vector2f> floatVertices(vertices.size());
+    FloatPolyline::encode(vertices.data(), static_cast<int>(vertices.size()), origin, floatVertices.data());
+
+    FloatPolyline polyline = {origin, floatVertices.data(), static_cast<int>(vertices.size())};
+    for (int i = 0; i < polyline.size_; i++)
+    {
+        Eigen::Vector2d relative = vertices[i] - origin;
+        Eigen::Vector2d error = (polyline.vertex(i) - vertices[i]).cwiseAbs();
+        EXPECT_LE(error.x(), std::abs(relative.x()) * FLT_EPSILON / 2 + 1e-9);
+        EXPECT_LE(error.y(), std::abs(relative.y()) * FLT_EPSILON / 2 + 1e-9);
+    }
+}
+
+TEST(CompactPolylineTest, testQuantizedPolyline)
+{
+    Eigen::Vector2d origin(512345.25, 5401234.5);
+    std::vector<Eigen::Vector2d> vertices = randomWalk(origin + Eigen::Vector2d(-3000, 500), 1000);
+
+    for (double step : {.001, .01, .05})
+    {
+        std::vector<int16_t> words = {1, 2, 3};
+        QuantizedPolyline::encode(vertices.data(), static_cast<int>(vertices.size()), origin, step, words);
+
+        // The words are appended.
+        ASSERT_GE(words.size(), 3 + 2 * vertices.size());
+        EXPECT_EQ(words[0], 1);
+
+        QuantizedPolyline polyline = {origin, step, words.data() + 3, static_cast<int>(words.size()) - 3,
+                                      static_cast<int>(vertices.size())};
+        std::vector<Eigen::Vector2d> decoded(vertices.size());
+        polyline.decode(decoded.data());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            Eigen::Vector2d error = (decoded[i] - vertices[i]).cwiseAbs();
+            EXPECT_LE(error.maxCoeff(), step / 2 + 1e-9) << i;
+        }
+    }
+}
+
+TEST(CompactPolylineTest, testQuantizedPolylineWords)
+{
+    std::vector<Eigen::Vector2d> vertices = {{0, 0}, {32.767, -32.767}, {0, 0}, {.0004, 100}};
+
+    std::vector<int16_t> words;
+    QuantizedPolyline::encode(vertices.data(), static_cast<int>(vertices.size()), Eigen::Vector2d::Zero(), .001,
+                              words);
+
+    // Only the difference in y between the last two vertices needs an
+    // escape.
+    std::vector<int16_t> expected = {0, 0, 32767, -32767, -32767, 32767, 0, QuantizedPolyline::ESCAPE, -31072, 1};
+    EXPECT_EQ(words, expected);
+
+    QuantizedPolyline polyline = {Eigen::Vector2d::Zero(), .001, words.data(), static_cast<int>(words.size()), 4};
+    std::vector<Eigen::Vector2d> decoded(vertices.size());
+    polyline.decode(decoded.data());
+    EXPECT_EQ(decoded[3], Eigen::Vector2d(0, 100));
+}
+
+TEST(CompactPolylineTest, testQuantizedPolylineOutOfRange)
+{
+    std::vector<Eigen::Vector2d> vertices = {{0, 0}, {2e6, 0}};
+
+    std::vector<int16_t> words;
+    EXPECT_THROW(QuantizedPolyline::encode(vertices.data(), 2, Eigen::Vector2d::Zero(), .001, words),
+                 std::out_of_range);
+    EXPECT_NO_THROW(QuantizedPolyline::encode(vertices.data(), 2, Eigen::Vector2d::Zero(), .01, words));
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,192 @@
+#include "elevation.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "xodr_map.h"
+
+#include "../test_config.h"
+
+namespace aid { namespace xodr {
+
+class ElevationProfileTest : public testing::Test
+{
+  public:
+    ElevationProfileTest()
+    {
+        XodrReader xml = XodrReader::fromText(
+            "<elevationProfile>"
+            "  <elevation s='0' a='100' b='0' c='3' d='-2'/>"
+            "  <elevation s='1' a='101' b='0' c='-3' d='2'/>"
+            "  <elevation s='1.5' a='100.5' b='.5' c='0' d='0'/>"
+            "  <elevation s='4' a='101.75' b='0' c='0' d='0'/>"
+            "</elevationProfile>");
+
+        xml.readStartElement("elevationProfile");
+        profile_ = ElevationProfile::parseXml(xml).value();
+    }
+
+    /**
+     * @brief Evaluates the profile by a linear search for the segment.
+     */
+    double referenceElevation(double s) const
+    {
+        const ArenaVector<ElevationProfile::Elevation>& elevations = profile_.elevations();
+        size_t i = 0;
+        while (i + 1 < elevations.size() && s >= elevations[i + 1].sCoord())
+        {
+            i++;
+        }
+        return elevations[i].poly3().eval(s - elevations[i].sCoord());
+    }
+
+    ElevationProfile profile_;
+};
+
+TEST_F(ElevationProfileTest, testElevation)
+{
+    EXPECT_EQ(profile_.elevation(0), 100);
+    EXPECT_EQ(profile_.elevation(1), 101);
+    EXPECT_EQ(profile_.elevation(1.5), 100.5);
+    EXPECT_EQ(profile_.elevation(2), 100.75);
+    EXPECT_EQ(profile_.elevation(10), 101.75);
+
+    // The first segment also applies before its s-coordinate.
+    EXPECT_EQ(profile_.elevation(-1), 100 + 3 + 2);
+}
+
+TEST_F(ElevationProfileTest, testCursorMonotone)
+{
+    std::vector<double> sCoords;
+    for (double s = -.5; s < 5; s += .01)
+    {
+        sCoords.push_back(s);
+    }
+
+    // Includes the s-coordinates of the segments, and a repeated
+    // s-coordinate.
+    sCoords.insert(sCoords.end(), {5, 5, 6});
+
+    std::vector<double> elevations(sCoords.size());
+    profile_.evalElevations(sCoords.data(), static_cast<int>(sCoords.size()), elevations.data());
+
+    ElevationProfile::Cursor cursor(profile_);
+    for (size_t i = 0; i < sCoords.size(); i++)
+    {
+        double expected = referenceElevation(sCoords[i]);
+        EXPECT_EQ(elevations[i], expected) << sCoords[i];
+        EXPECT_EQ(cursor.elevation(sCoords[i]), expected) << sCoords[i];
+    }
+}
+
+TEST_F(ElevationProfileTest, testCursorRandomOrder)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> sDist(-1, 6);
+
+    ElevationProfile::Cursor cursor(profile_);
+    for (int i = 0; i < 1000; i++)
+    {
+        double s = sDist(rng);
+        EXPECT_EQ(cursor.elevation(s), referenceElevation(s)) << s;
+    }
+
+    for (double s : {1.0, 0.0, 4.0, 1.5, 1.5, 0.999})
+    {
+        EXPECT_EQ(cursor.elevation(s), referenceElevation(s)) << s;
+    }
+}
+
+TEST_F(ElevationProfileTest, testSlope)
+{
+    ElevationProfile::Cursor cursor(profile_);
+    EXPECT_EQ(cursor.slope(0), 0);
+    EXPECT_EQ(cursor.slope(.5), 3 - 1.5);
+    EXPECT_EQ(cursor.slope(2), .5);
+    EXPECT_EQ(cursor.slope(5), 0);
+}
+
+TEST(ElevationTest, testTessellateReferenceLine)
+{
+    for (const char* mapName : {"sample1.1.xodr", "CulDeSac.xodr"})
+    {
+        XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + mapName).extract_value();
+
+        ReferenceLine::FrenetFrames frames;
+        ReferenceLine::FrenetFrames frames2D;
+        for (const Road& road : map.roads())
+        {
+            const LaneSection& laneSection = road.laneSections().front();
+            ReferenceLine::TessellationTolerance tolerance = laneSection.boundaryTessellationTolerance(.01);
+            road.tessellateReferenceLine(frames, laneSection.startS(), laneSection.endS(), tolerance);
+            road.referenceLine().tessellate(frames2D, laneSection.startS(), laneSection.endS(), tolerance);
+
+            ASSERT_TRUE(frames.hasElevations());
+            EXPECT_EQ(frames.sCoords_, frames2D.sCoords_);
+            EXPECT_EQ(frames.x_, frames2D.x_);
+            EXPECT_EQ(frames.y_, frames2D.y_);
+            EXPECT_TRUE(frames2D.elevations_.empty());
+
+            for (int i = 0; i < frames.size(); i++)
+            {
+                double expected = 0;
+                if (road.hasElevationProfile())
+                {
+                    expected = road.elevationProfile().elevation(frames.sCoords_[i]);
+                }
+                EXPECT_EQ(frames.elevations_[i], expected);
+            }
+        }
+    }
+}
+
+TEST(ElevationTest, testTessellateLaneBoundaryCurves3D)
+{
+    XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + "Roundabout8Course.xodr").extract_value();
+
+    ReferenceLine::FrenetFrames frames;
+    LaneSection::LaneTessellationBuffer buffer;
+    std::vector<double> inner;
+    std::vector<double> outer;
+    int numRaisedLanes = 0;
+    for (const Road& road : map.roads())
+    {
+        for (const LaneSection& laneSection : road.laneSections())
+        {
+            road.tessellateReferenceLine(frames, laneSection.startS(), laneSection.endS(),
+                                         laneSection.boundaryTessellationTolerance(.01));
+            laneSection.tessellateLaneBoundaryCurves3D(frames, buffer);
+
+            int numPoints = frames.size();
+            ASSERT_EQ(buffer.laneEdgeVertices_.size(), 2 * laneSection.lanes().size() * numPoints);
+
+            inner.resize(numPoints);
+            outer.resize(numPoints);
+            for (int i = 0; i < static_cast<int>(laneSection.lanes().size()); i++)
+            {
+                laneSection.evalLaneHeights(i, frames.sCoords_.data(), numPoints, inner.data(), outer.data());
+                if (!laneSection.lanes()[i].heights().empty() && outer[0] != 0)
+                {
+                    numRaisedLanes++;
+                }
+
+                bool isLeftLane = i < laneSection.numLeftLanes();
+                const Eigen::Vector3d* leftEdge = buffer.leftEdgeVertices(i);
+                const Eigen::Vector3d* rightEdge = buffer.rightEdgeVertices(i);
+                for (int j = 0; j < numPoints; j++)
+                {
+                    EXPECT_EQ(leftEdge[j].head<2>(), buffer.boundaryVertices(i)[j]);
+                    EXPECT_EQ(rightEdge[j].head<2>(), buffer.boundaryVertices(i + 1)[j]);
+                    EXPECT_EQ(leftEdge[j].z(), frames.elevations_[j] + (isLeftLane ? outer[j] : inner[j]));
+                    EXPECT_EQ(rightEdge[j].z(), frames.elevations_[j] + (isLeftLane ? inner[j] : outer[j]));
+                }
+            }
+        }
+    }
+
+    // The sidewalks of the map are raised.
+    EXPECT_GT(numRaisedLanes, 0);
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,296 @@
+#include "lane_graph.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+#include "../test_config.h"
+
+namespace aid { namespace xodr {
+
+class LaneGraphTest : public testing::TestWithParam<const char*>
+{
+  public:
+    LaneGraphTest()
+    {
+        map_ = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + GetParam()).extract_value();
+        graph_ = LaneGraph(map_, LaneGraph::Options());
+    }
+
+    /**
+     * @brief Gets the global index of the lane with the given id, or -1 if
+     * there's no such lane.
+     */
+    static int globalIndex(const LaneSection& laneSection, LaneID id)
+    {
+        int intId = static_cast<int>(id);
+        if (intId == 0 || intId > laneSection.numLeftLanes() || intId < -laneSection.numRightLanes())
+        {
+            return -1;
+        }
+        return laneSection.laneById(id).globalIndex();
+    }
+
+    XodrMap map_;
+    LaneGraph graph_;
+};
+
+TEST_P(LaneGraphTest, testCompressedSparseRows)
+{
+    ASSERT_EQ(graph_.numLanes(), map_.totalNumLanes());
+
+    const std::vector<int>& offsets = graph_.offsets();
+    ASSERT_EQ(offsets.size(), static_cast<size_t>(graph_.numLanes()) + 1);
+    EXPECT_EQ(offsets.front(), 0);
+    EXPECT_EQ(offsets.back(), graph_.numEdges());
+    EXPECT_GT(graph_.numEdges(), 0);
+    ASSERT_EQ(graph_.edgeLengths().size(), graph_.targets().size());
+
+    for (int lane = 0; lane < graph_.numLanes(); lane++)
+    {
+        ASSERT_LE(offsets[lane], offsets[lane + 1]);
+        EXPECT_EQ(graph_.numSuccessors(lane), offsets[lane + 1] - offsets[lane]);
+        EXPECT_EQ(graph_.successors(lane), graph_.targets().data() + offsets[lane]);
+        for (int i = offsets[lane]; i < offsets[lane + 1]; i++)
+        {
+            EXPECT_GE(graph_.targets()[i], 0);
+            EXPECT_LT(graph_.targets()[i], graph_.numLanes());
+            EXPECT_NE(graph_.targets()[i], lane);
+            if (i > offsets[lane])
+            {
+                EXPECT_LT(graph_.targets()[i - 1], graph_.targets()[i]);
+            }
+            EXPECT_EQ(graph_.edgeLengths()[i], graph_.laneLength(lane));
+        }
+    }
+}
+
+TEST_P(LaneGraphTest, testLaneLinks)
+{
+    // Every lane link within a road or between linked roads is an edge, in the
+    // direction in which the lane is traversed.
+    int numLinks = 0;
+    for (const Road& road : map_.roads())
+    {
+        const ArenaVector<LaneSection>& laneSections = road.laneSections();
+        for (int i = 0; i < static_cast<int>(laneSections.size()); i++)
+        {
+            const ArenaVector<LaneSection::Lane>& lanes = laneSections[i].lanes();
+            for (int j = 0; j < static_cast<int>(lanes.size()); j++)
+            {
+                bool isRightLane = static_cast<int>(laneSections[i].laneIndexToId(j)) < 0;
+                for (RoadLinkType linkType : {RoadLinkType::PREDECESSOR, RoadLinkType::SUCCESSOR})
+                {
+                    if (!lanes[j].hasLink(linkType))
+                    {
+                        continue;
+                    }
+
+                    const LaneSection* linkedLaneSection;
+                    int linkedIdx = linkType == RoadLinkType::SUCCESSOR ? i + 1 : i - 1;
+                    if (linkedIdx >= 0 && linkedIdx < static_cast<int>(laneSections.size()))
+                    {
+                        linkedLaneSection = &laneSections[linkedIdx];
+                    }
+                    else if (road.roadLink(linkType).elementType() == RoadLink::ElementType::ROAD)
+                    {
+                        const RoadLink& roadLink = road.roadLink(linkType);
+                        linkedLaneSection = &map_.roads()[roadLink.elementRef().index()].laneSectionForContactPoint(
+                            roadLink.contactPoint());
+                    }
+                    else
+                    {
+                        continue;
+                    }
+
+                    int lane = lanes[j].globalIndex();
+                    int linkedLane = globalIndex(*linkedLaneSection, lanes[j].link(linkType));
+                    ASSERT_GE(linkedLane, 0);
+
+                    numLinks++;
+                    if ((linkType == RoadLinkType::SUCCESSOR) == isRightLane)
+                    {
+                        EXPECT_TRUE(graph_.hasEdge(lane, linkedLane));
+                    }
+                    else
+                    {
+                        EXPECT_TRUE(graph_.hasEdge(linkedLane, lane));
+                    }
+                }
+            }
+        }
+    }
+
+    EXPECT_GT(numLinks, 0);
+}
+
+TEST_P(LaneGraphTest, testEdgesAreLinks)
+{
+    // The lanes of every edge are linked, by a lane link of one of them or of a
+    // junction connection.
+    std::set<std::pair<int, int>> linkedLanes;
+    auto addLink = [&](int a, int b) {
+        if (a >= 0 && b >= 0)
+        {
+            linkedLanes.insert(std::minmax(a, b));
+        }
+    };
+
+    for (const Road& road : map_.roads())
+    {
+        const ArenaVector<LaneSection>& laneSections = road.laneSections();
+        for (int i = 0; i < static_cast<int>(laneSections.size()); i++)
+        {
+            for (const LaneSection::Lane& lane : laneSections[i].lanes())
+            {
+                if (lane.hasLink(RoadLinkType::SUCCESSOR))
+                {
+                    const LaneSection* next = i + 1 < static_cast<int>(laneSections.size()) ? &laneSections[i + 1]
+                                                                                          : nullptr;
+                    const RoadLink& roadLink = road.roadLink(RoadLinkType::SUCCESSOR);
+                    if (!next && roadLink.elementType() == RoadLink::ElementType::ROAD)
+                    {
+                        next = &map_.roads()[roadLink.elementRef().index()].laneSectionForContactPoint(
+                            roadLink.contactPoint());
+                    }
+                    if (next)
+                    {
+                        addLink(lane.globalIndex(), globalIndex(*next, lane.link(RoadLinkType::SUCCESSOR)));
+                    }
+                }
+
+                if (lane.hasLink(RoadLinkType::PREDECESSOR))
+                {
+                    const LaneSection* prev = i > 0 ? &laneSections[i - 1] : nullptr;
+                    const RoadLink& roadLink = road.roadLink(RoadLinkType::PREDECESSOR);
+                    if (!prev && roadLink.elementType() == RoadLink::ElementType::ROAD)
+                    {
+                        prev = &map_.roads()[roadLink.elementRef().index()].laneSectionForContactPoint(
+                            roadLink.contactPoint());
+                    }
+                    if (prev)
+                    {
+                        addLink(lane.globalIndex(), globalIndex(*prev, lane.link(RoadLinkType::PREDECESSOR)));
+                    }
+                }
+            }
+        }
+    }
+
+    for (const Junction& junction : map_.junctions())
+    {
+        for (const Junction::Connection& connection : junction.connections())
+        {
+            const Road& incomingRoad = map_.roads()[connection.incomingRoad().index()];
+            const LaneSection& connectingLaneSection =
+                map_.roads()[connection.connectingRoad().index()].laneSectionForContactPoint(
+                    connection.contactPoint());
+            for (const Junction::LaneLink& laneLink : connection.laneLinks())
+            {
+                int to = globalIndex(connectingLaneSection, laneLink.to());
+                for (ContactPoint contactPoint : {ContactPoint::START, ContactPoint::END})
+                {
+                    addLink(globalIndex(incomingRoad.laneSectionForContactPoint(contactPoint), laneLink.from()), to);
+                }
+            }
+        }
+    }
+
+    for (int lane = 0; lane < graph_.numLanes(); lane++)
+    {
+        for (int i = 0; i < graph_.numSuccessors(lane); i++)
+        {
+            EXPECT_EQ(linkedLanes.count(std::minmax(lane, graph_.successors(lane)[i])), 1u);
+        }
+    }
+}
+
+TEST_P(LaneGraphTest, testLaneLengths)
+{
+    // The lane lengths match the lengths of densely sampled lane centers. Some
+    // lanes have discontinuous widths, where the sampled centers jump, and the
+    // tessellated center lines cross the jump diagonally instead.
+    for (const Road& road : map_.roads())
+    {
+        double endS = road.referenceLine().endS();
+        for (const LaneSection& laneSection : road.laneSections())
+        {
+            double sectionEndS = std::min(laneSection.endS(), endS);
+            for (int j = 0; j < static_cast<int>(laneSection.lanes().size()); j++)
+            {
+                LaneID laneId = laneSection.laneIndexToId(j);
+                constexpr int NUM_SAMPLES = 2000;
+
+                double length = 0;
+                double jumps = 0;
+                Eigen::Vector2d prev = road.lanePose(laneSection.startS(), laneId).position_.head<2>();
+                for (int k = 1; k <= NUM_SAMPLES; k++)
+                {
+                    // The lane section at its end s-coordinate is the next one.
+                    double s = laneSection.startS() + (sectionEndS - laneSection.startS()) * k / NUM_SAMPLES;
+                    s = std::min(s, sectionEndS - 1e-9);
+                    Eigen::Vector2d cur = road.lanePose(s, laneId).position_.head<2>();
+                    double step = (cur - prev).norm();
+                    if (step > 2 * (sectionEndS - laneSection.startS()) / NUM_SAMPLES + .05)
+                    {
+                        jumps += step;
+                    }
+                    length += step;
+                    prev = cur;
+                }
+
+                double graphLength = graph_.laneLength(laneSection.lanes()[j].globalIndex());
+                EXPECT_GT(graphLength, 0);
+                EXPECT_NEAR(graphLength, length, 1e-3 * length + .02 + jumps);
+            }
+        }
+    }
+}
+
+TEST_P(LaneGraphTest, testNumThreads)
+{
+    LaneGraph::Options options;
+    options.numThreads_ = 1;
+    LaneGraph singleThreaded(map_, options);
+    options.numThreads_ = 3;
+    LaneGraph multiThreaded(map_, options);
+
+    EXPECT_TRUE(singleThreaded == graph_);
+    EXPECT_TRUE(multiThreaded == graph_);
+}
+
+TEST_P(LaneGraphTest, testSerialize)
+{
+    std::vector<char> data = graph_.serialize();
+    LaneGraph deserialized = LaneGraph::deserialize(data.data(), data.size());
+    EXPECT_TRUE(deserialized == graph_);
+
+    std::vector<char> corrupt = data;
+    corrupt.back() ^= 1;
+    EXPECT_THROW(LaneGraph::deserialize(corrupt.data(), corrupt.size()), std::runtime_error);
+
+    EXPECT_THROW(LaneGraph::deserialize(data.data(), data.size() - 1), std::runtime_error);
+
+    corrupt = data;
+    corrupt[0] = 'Y';
+    EXPECT_THROW(LaneGraph::deserialize(corrupt.data(), corrupt.size()), std::runtime_error);
+}
+
+INSTANTIATE_TEST_CASE_P(Maps, LaneGraphTest,
+                        testing::Values("Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                        "sample1.1.xodr"));
+
+TEST(LaneGraphEmptyTest, testSerialize)
+{
+    LaneGraph graph;
+    EXPECT_EQ(graph.numLanes(), 0);
+    EXPECT_EQ(graph.numEdges(), 0);
+
+    std::vector<char> data = graph.serialize();
+    EXPECT_TRUE(LaneGraph::deserialize(data.data(), data.size()) == graph);
+}
+
+}}  // namespace aid::xodr
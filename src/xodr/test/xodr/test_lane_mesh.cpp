@@ -0,0 +1,181 @@
+#include "lane_mesh.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "../test_config.h"
+
+namespace aid { namespace xodr {
+
+class LaneMeshTest : public testing::TestWithParam<const char*>
+{
+  public:
+    LaneMeshTest() { map_ = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + GetParam()).extract_value(); }
+
+    XodrMap map_;
+};
+
+/**
+ * @brief Computes the signed area of the projection of a triangle onto the
+ * x/y-plane, which is positive if it's wound counter-clockwise.
+ */
+static double signedArea(const Eigen::Vector3d& a, const Eigen::Vector3d& b, const Eigen::Vector3d& c)
+{
+    Eigen::Vector3d ab = b - a;
+    Eigen::Vector3d ac = c - a;
+    return .5 * (ab.x() * ac.y() - ab.y() * ac.x());
+}
+
+TEST_P(LaneMeshTest, testStructure)
+{
+    LaneMeshBuilder builder(map_);
+    LaneMesh mesh;
+    builder.build(LaneMeshBuilder::Options(), mesh);
+
+    ASSERT_EQ(mesh.batches_.size(), static_cast<size_t>(NUM_LANE_TYPES));
+    ASSERT_EQ(mesh.laneRanges_.size(), static_cast<size_t>(map_.totalNumLanes()));
+
+    int numLanes = 0;
+    for (int typeIdx = 0; typeIdx < NUM_LANE_TYPES; typeIdx++)
+    {
+        const LaneMesh::Batch& batch = mesh.batches_[typeIdx];
+        ASSERT_EQ(batch.indices_.size() % 3, 0u);
+
+        for (uint32_t index : batch.indices_)
+        {
+            ASSERT_LT(index, batch.vertices_.size());
+        }
+
+        // The lanes of the batch cover its indices in order.
+        int nextIndex = 0;
+        for (int globalLaneIdx : batch.lanes_)
+        {
+            const LaneMesh::LaneRange& range = mesh.laneRanges_[globalLaneIdx];
+            EXPECT_EQ(static_cast<int>(range.laneType_), typeIdx);
+            EXPECT_EQ(range.firstIndex_, nextIndex);
+            nextIndex += range.numIndices_;
+        }
+        EXPECT_EQ(nextIndex, static_cast<int>(batch.indices_.size()));
+        numLanes += static_cast<int>(batch.lanes_.size());
+
+        // The triangles are wound counter-clockwise, apart from a few where
+        // the boundaries of a lane cross, for example on the inside of
+        // curves which are tighter than the lane is wide.
+        int numClockwise = 0;
+        for (size_t i = 0; i < batch.indices_.size(); i += 3)
+        {
+            double area = signedArea(batch.vertices_[batch.indices_[i]], batch.vertices_[batch.indices_[i + 1]],
+                                     batch.vertices_[batch.indices_[i + 2]]);
+            if (area < -1e-9)
+            {
+                numClockwise++;
+            }
+        }
+        EXPECT_LE(numClockwise, static_cast<int>(batch.indices_.size() / 3) / 100);
+    }
+    EXPECT_EQ(numLanes, map_.totalNumLanes());
+}
+
+TEST_P(LaneMeshTest, testWeldsEdgeEndPoints)
+{
+    LaneMeshBuilder builder(map_);
+    LaneMeshBuilder::Options options;
+    options.maxError_ = .02;
+
+    MapTessellator tessellator(map_);
+    MapTessellator::Options tessellatorOptions;
+    tessellatorOptions.maxError_ = options.maxError_;
+    tessellator.tessellate(tessellatorOptions);
+
+    std::vector<Eigen::Vector3d> endPoints;
+    LaneSection::LaneTessellationBuffer buffer;
+    for (int roadIdx = 0; roadIdx < static_cast<int>(map_.roads().size()); roadIdx++)
+    {
+        for (int i = 0; i < static_cast<int>(map_.roads()[roadIdx].laneSections().size()); i++)
+        {
+            LaneSectionKey key(roadIdx, i);
+            laneSectionByKey(map_, key).tessellateLaneBoundaryCurves3D(tessellator.refLineFrames(key), buffer);
+            for (int j = 0; j < buffer.numBoundaries() - 1; j++)
+            {
+                int size = buffer.boundarySize(j);
+                for (const Eigen::Vector3d* edge : {buffer.leftEdgeVertices(j), buffer.rightEdgeVertices(j)})
+                {
+                    endPoints.push_back(edge[0]);
+                    endPoints.push_back(edge[size - 1]);
+                }
+            }
+        }
+    }
+
+    LaneMesh mesh;
+    LaneMesh unweldedMesh;
+    builder.build(options, mesh);
+    options.weldTolerance_ = 0;
+    builder.build(options, unweldedMesh);
+
+    // Wherever the boundaries meet, the vertices of each batch coincide, so
+    // there are no cracks between lane sections or linked roads. There may be
+    // more than one such vertex, up to a rounding error, where a boundary has
+    // duplicate vertices, for example at the end of a geometry of length 0.
+    double tolerance = LaneMeshBuilder::Options().weldTolerance_;
+    for (int typeIdx = 0; typeIdx < NUM_LANE_TYPES; typeIdx++)
+    {
+        const LaneMesh::Batch& batch = mesh.batches_[typeIdx];
+        const LaneMesh::Batch& unweldedBatch = unweldedMesh.batches_[typeIdx];
+        EXPECT_LE(batch.vertices_.size(), unweldedBatch.vertices_.size());
+        EXPECT_LE(batch.indices_.size(), unweldedBatch.indices_.size());
+
+        std::vector<Eigen::Vector3d> vertices = batch.vertices_;
+        std::sort(vertices.begin(), vertices.end(),
+                  [](const Eigen::Vector3d& a, const Eigen::Vector3d& b) { return a.x() < b.x(); });
+        for (const Eigen::Vector3d& endPoint : endPoints)
+        {
+            auto it = std::lower_bound(vertices.begin(), vertices.end(), endPoint.x() - tolerance,
+                                       [](const Eigen::Vector3d& v, double x) { return v.x() < x; });
+            const Eigen::Vector3d* nearby = nullptr;
+            for (; it != vertices.end() && it->x() <= endPoint.x() + tolerance; ++it)
+            {
+                if ((*it - endPoint).norm() <= tolerance)
+                {
+                    if (nearby)
+                    {
+                        EXPECT_LE((*it - *nearby).norm(), 1e-9) << "at " << endPoint.transpose();
+                    }
+                    nearby = &*it;
+                }
+            }
+        }
+    }
+}
+
+TEST_P(LaneMeshTest, testDeterministic)
+{
+    LaneMeshBuilder builder(map_);
+    LaneMeshBuilder::Options options;
+
+    LaneMesh expected;
+    options.numThreads_ = 1;
+    builder.build(options, expected);
+
+    // Rebuild into the same mesh, to check that its buffers are reset.
+    LaneMesh mesh;
+    for (int numThreads : {3, 2})
+    {
+        options.numThreads_ = numThreads;
+        builder.build(options, mesh);
+
+        for (int typeIdx = 0; typeIdx < NUM_LANE_TYPES; typeIdx++)
+        {
+            EXPECT_EQ(mesh.batches_[typeIdx].vertices_, expected.batches_[typeIdx].vertices_);
+            EXPECT_EQ(mesh.batches_[typeIdx].indices_, expected.batches_[typeIdx].indices_);
+            EXPECT_EQ(mesh.batches_[typeIdx].lanes_, expected.batches_[typeIdx].lanes_);
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(Maps, LaneMeshTest,
+                        testing::Values("Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                        "sample1.1.xodr"));
+
+}}  // namespace aid::xodr
@@ -0,0 +1,299 @@
+#include "lane_router.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#include "../test_config.h"
+
+namespace aid { namespace xodr {
+
+class LaneRouterTest : public testing::TestWithParam<const char*>
+{
+  public:
+    LaneRouterTest()
+    {
+        map_ = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + GetParam()).extract_value();
+        graph_ = LaneGraph(map_, LaneGraph::Options());
+
+        for (int roadIdx = 0; roadIdx < static_cast<int>(map_.roads().size()); roadIdx++)
+        {
+            const ArenaVector<LaneSection>& laneSections = map_.roads()[roadIdx].laneSections();
+            for (int i = 0; i < static_cast<int>(laneSections.size()); i++)
+            {
+                for (int j = 0; j < static_cast<int>(laneSections[i].lanes().size()); j++)
+                {
+                    laneKeys_.emplace_back(roadIdx, i, j);
+                }
+            }
+        }
+    }
+
+    int globalIndex(const LaneKey& key) const
+    {
+        return map_.roads()[key.roadIdx_].laneSections()[key.laneSectionIdx_].lanes()[key.laneIdx_].globalIndex();
+    }
+
+    /**
+     * @brief Generates random queries between lanes which can be used.
+     */
+    std::vector<LaneRouter::Query> randomQueries(const LaneRouter& router, int numQueries) const
+    {
+        std::vector<LaneKey> usableKeys;
+        for (const LaneKey& key : laneKeys_)
+        {
+            if (!std::isinf(router.laneCost(globalIndex(key))))
+            {
+                usableKeys.push_back(key);
+            }
+        }
+
+        std::mt19937 rng(5);
+        std::uniform_int_distribution<size_t> keyDist(0, usableKeys.size() - 1);
+        std::vector<LaneRouter::Query> queries;
+        for (int i = 0; i < numQueries; i++)
+        {
+            queries.push_back({usableKeys[keyDist(rng)], usableKeys[keyDist(rng)]});
+        }
+        return queries;
+    }
+
+    /**
+     * @brief Finds the costs of the routes from a lane to all lanes, by
+     * relaxing all edges until none of the costs decreases.
+     */
+    std::vector<double> bellmanFord(const LaneRouter& router, int source) const
+    {
+        std::vector<double> costs(graph_.numLanes(), std::numeric_limits<double>::infinity());
+        costs[source] = 0;
+
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (int from = 0; from < graph_.numLanes(); from++)
+            {
+                for (int i = 0; i < graph_.numSuccessors(from); i++)
+                {
+                    int to = graph_.successors(from)[i];
+                    if (std::isinf(router.laneCost(to)))
+                    {
+                        continue;
+                    }
+
+                    double cost = costs[from] + router.laneCost(from);
+                    if (cost < costs[to] * (1 - 1e-12))
+                    {
+                        costs[to] = cost;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        return costs;
+    }
+
+    /**
+     * @brief Checks that a route consists of linked, usable lanes, and that
+     * its cost is the sum of the costs of its lanes.
+     */
+    void checkRoute(const LaneRouter& router, const LaneRouter::Query& query, const LaneRouter::Route& route)
+    {
+        ASSERT_FALSE(route.lanes_.empty());
+        EXPECT_EQ(route.lanes_.front(), query.from_);
+        EXPECT_EQ(route.lanes_.back(), query.to_);
+
+        double cost = 0;
+        for (size_t i = 0; i + 1 < route.lanes_.size(); i++)
+        {
+            int lane = globalIndex(route.lanes_[i]);
+            EXPECT_TRUE(graph_.hasEdge(lane, globalIndex(route.lanes_[i + 1])));
+            EXPECT_FALSE(std::isinf(router.laneCost(lane)));
+            cost += router.laneCost(lane);
+        }
+        EXPECT_NEAR(route.cost_, cost, 1e-9 * cost);
+    }
+
+    XodrMap map_;
+    LaneGraph graph_;
+    std::vector<LaneKey> laneKeys_;
+};
+
+TEST_P(LaneRouterTest, testMatchesBellmanFord)
+{
+    LaneRouter router(map_, graph_, LaneRouter::Options());
+    LaneRouter::SearchState state;
+
+    std::vector<LaneRouter::Query> queries = randomQueries(router, 10);
+    for (const LaneRouter::Query& query : queries)
+    {
+        std::vector<double> costs = bellmanFord(router, globalIndex(query.from_));
+        for (const LaneKey& to : laneKeys_)
+        {
+            double expectedCost = costs[globalIndex(to)];
+            if (std::isinf(router.laneCost(globalIndex(to))))
+            {
+                expectedCost = std::numeric_limits<double>::infinity();
+            }
+
+            for (LaneRouter::Algorithm algorithm : {LaneRouter::Algorithm::DIJKSTRA, LaneRouter::Algorithm::A_STAR})
+            {
+                LaneRouter::Route route = router.findRoute(query.from_, to, state, algorithm);
+                if (std::isinf(expectedCost))
+                {
+                    EXPECT_TRUE(std::isinf(route.cost_));
+                    EXPECT_TRUE(route.lanes_.empty());
+                }
+                else
+                {
+                    EXPECT_NEAR(route.cost_, expectedCost, 1e-9 * expectedCost);
+                    checkRoute(router, {query.from_, to}, route);
+                }
+            }
+        }
+    }
+}
+
+TEST_P(LaneRouterTest, testAStarSettlesFewerLanes)
+{
+    LaneRouter router(map_, graph_, LaneRouter::Options());
+    LaneRouter::SearchState state;
+
+    long numSettledDijkstra = 0;
+    long numSettledAStar = 0;
+    for (const LaneRouter::Query& query : randomQueries(router, 100))
+    {
+        LaneRouter::Route dijkstraRoute =
+            router.findRoute(query.from_, query.to_, state, LaneRouter::Algorithm::DIJKSTRA);
+        numSettledDijkstra += state.numSettled();
+
+        LaneRouter::Route aStarRoute = router.findRoute(query.from_, query.to_, state, LaneRouter::Algorithm::A_STAR);
+        numSettledAStar += state.numSettled();
+
+        if (std::isinf(dijkstraRoute.cost_))
+        {
+            EXPECT_TRUE(std::isinf(aStarRoute.cost_));
+        }
+        else
+        {
+            EXPECT_NEAR(aStarRoute.cost_, dijkstraRoute.cost_, 1e-9 * dijkstraRoute.cost_);
+        }
+    }
+
+    EXPECT_LE(numSettledAStar, numSettledDijkstra);
+}
+
+TEST_P(LaneRouterTest, testLaneTypes)
+{
+    LaneRouter router(map_, graph_, LaneRouter::Options());
+
+    LaneRouter::Options allTypesOptions;
+    allTypesOptions.laneTypeCostFactors_.fill(2);
+    LaneRouter allTypesRouter(map_, graph_, allTypesOptions);
+
+    for (const LaneKey& key : laneKeys_)
+    {
+        int lane = globalIndex(key);
+        const LaneSection::Lane& laneData =
+            map_.roads()[key.roadIdx_].laneSections()[key.laneSectionIdx_].lanes()[key.laneIdx_];
+
+        double expectedCost = graph_.laneLength(lane) / LaneRouter::Options().defaultSpeed_;
+        EXPECT_NEAR(allTypesRouter.laneCost(lane), 2 * expectedCost, 1e-9);
+        if (laneData.type() == LaneType::DRIVING)
+        {
+            EXPECT_NEAR(router.laneCost(lane), expectedCost, 1e-9);
+        }
+        else if (laneData.type() == LaneType::SIDEWALK || laneData.type() == LaneType::NONE)
+        {
+            EXPECT_TRUE(std::isinf(router.laneCost(lane)));
+        }
+    }
+}
+
+TEST_P(LaneRouterTest, testSameLane)
+{
+    LaneRouter router(map_, graph_, LaneRouter::Options());
+    LaneRouter::SearchState state;
+
+    for (const LaneRouter::Query& query : randomQueries(router, 10))
+    {
+        LaneRouter::Route route = router.findRoute(query.from_, query.from_, state);
+        EXPECT_EQ(route.cost_, 0);
+        ASSERT_EQ(route.lanes_.size(), 1u);
+        EXPECT_EQ(route.lanes_[0], query.from_);
+    }
+
+    EXPECT_THROW(router.findRoute(LaneKey(-1, 0, 0), laneKeys_[0], state), std::out_of_range);
+}
+
+TEST_P(LaneRouterTest, testBatch)
+{
+    LaneRouter router(map_, graph_, LaneRouter::Options());
+    LaneRouter::SearchState state;
+    std::vector<LaneRouter::Query> queries = randomQueries(router, 50);
+
+    for (int numThreads : {1, 3})
+    {
+        std::vector<LaneRouter::Route> routes(queries.size());
+        router.findRoutes(queries.data(), static_cast<int>(queries.size()), routes.data(), numThreads);
+
+        for (size_t i = 0; i < queries.size(); i++)
+        {
+            LaneRouter::Route expected = router.findRoute(queries[i].from_, queries[i].to_, state);
+            EXPECT_EQ(routes[i].cost_, expected.cost_);
+            EXPECT_EQ(routes[i].lanes_, expected.lanes_);
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(Maps, LaneRouterTest,
+                        testing::Values("Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                        "sample1.1.xodr"));
+
+TEST(LaneRouterSpeedLimitTest, testSpeedLimits)
+{
+    std::ifstream file(std::string(MAP_DATA_PATH_PREFIX) + "CulDeSac.xodr");
+    std::stringstream text;
+    text << file.rdbuf();
+
+    // Limit the speed of all lanes to 36 km/h.
+    std::string mapText = text.str();
+    for (size_t pos = mapText.find("</lane>"); pos != std::string::npos; pos = mapText.find("</lane>", pos + 1))
+    {
+        std::string speed = "<speed sOffset=\"0\" max=\"36\" unit=\"km/h\"/>";
+        mapText.insert(pos, speed);
+        pos += speed.size();
+    }
+
+    XodrMap map = XodrMap::fromText(mapText).extract_value();
+    LaneGraph graph(map, LaneGraph::Options());
+    LaneRouter router(map, graph, LaneRouter::Options());
+
+    int numDrivingLanes = 0;
+    for (const Road& road : map.roads())
+    {
+        for (const LaneSection& laneSection : road.laneSections())
+        {
+            for (const LaneSection::Lane& lane : laneSection.lanes())
+            {
+                ASSERT_EQ(lane.speedLimits().size(), 1u);
+                if (lane.type() == LaneType::DRIVING)
+                {
+                    numDrivingLanes++;
+                    EXPECT_NEAR(router.laneCost(lane.globalIndex()), graph.laneLength(lane.globalIndex()) / 10,
+                                1e-9);
+                }
+            }
+        }
+    }
+
+    EXPECT_GT(numDrivingLanes, 0);
+}
+
+}}  // namespace aid::xodr
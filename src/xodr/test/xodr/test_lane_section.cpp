@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 #include "reference_line.h"
 #include "validation/lane_link_validation.h"
 
@@ -82,6 +84,51 @@ TEST_F(LaneSectionTest, testTessellate)
     }
 }
 
+TEST_F(LaneSectionTest, testTessellateIntoBuffer)
+{
+    xodr::ReferenceLine::Tessellation refLineTessellation;
+    refLine_.tessellate(refLineTessellation, 0, 9);
+    int numPoints = static_cast<int>(refLineTessellation.size());
+
+    LaneSection::LaneTessellationBuffer buffer;
+    laneSection_.tessellateLaneBoundaryCurvesAndCenterLines(refLineTessellation, buffer);
+    ASSERT_EQ(buffer.numBoundaries(), 7);
+    ASSERT_EQ(buffer.numCenterLines(), 6);
+
+    const double expectedLateral[] = {
+        5.5, 4, 3.65, 0, -3.65, -4, -5.5,
+    };
+
+    for (int i = 0; i < buffer.numBoundaries(); i++)
+    {
+        EXPECT_EQ(buffer.boundaryOffsets_[i], i * numPoints);
+        ASSERT_EQ(buffer.boundarySize(i), numPoints);
+
+        for (int j = 0; j < numPoints; j++)
+        {
+            EXPECT_EQ(buffer.lateralPositions_[buffer.boundaryOffsets_[i] + j], expectedLateral[i]);
+            EXPECT_EQ(buffer.boundaryVertices(i)[j],
+                      Eigen::Vector2d(refLineTessellation[j].position_.x(), expectedLateral[i]));
+        }
+    }
+
+    for (int i = 0; i < buffer.numCenterLines(); i++)
+    {
+        for (int j = buffer.centerLineOffsets_[i]; j < buffer.centerLineOffsets_[i + 1]; j++)
+        {
+            EXPECT_DOUBLE_EQ(buffer.centerLineVertices_[j].y(), .5 * (expectedLateral[i] + expectedLateral[i + 1]));
+            EXPECT_DOUBLE_EQ(buffer.variances_[j], .5 * (expectedLateral[i + 1] - expectedLateral[i]));
+        }
+    }
+
+    // Parts which aren't computed are cleared.
+    laneSection_.tessellateLaneBoundaries(refLineTessellation, buffer);
+    EXPECT_EQ(buffer.numBoundaries(), 7);
+    EXPECT_TRUE(buffer.boundaryVertices_.empty());
+    EXPECT_EQ(buffer.numCenterLines(), 0);
+    EXPECT_TRUE(buffer.centerLineVertices_.empty());
+}
+
 TEST_F(LaneSectionTest, testLaneIdToIndex)
 {
     int lane3Idx = laneSection_.laneIdToIndex(LaneID(3));
@@ -127,6 +174,110 @@ TEST_F(LaneSectionTest, testLaneById)
     EXPECT_EQ(laneMinus3.id(), LaneID(-3));
 }
 
+TEST_F(LaneSectionTest, testLaneIndexAt)
+{
+    // The boundaries are at 5.5, 4, 3.65, 0, -3.65, -4 and -5.5.
+    EXPECT_EQ(laneSection_.laneIndexAt(5, 5), 0);
+    EXPECT_EQ(laneSection_.laneIndexAt(5, 3.8), 1);
+    EXPECT_EQ(laneSection_.laneIndexAt(5, 1), 2);
+    EXPECT_EQ(laneSection_.laneIndexAt(5, -1), 3);
+    EXPECT_EQ(laneSection_.laneIndexAt(5, -3.8), 4);
+    EXPECT_EQ(laneSection_.laneIndexAt(5, -5), 5);
+
+    // Points on a boundary are in the inner lane.
+    EXPECT_EQ(laneSection_.laneIndexAt(5, 0), 2);
+    EXPECT_EQ(laneSection_.laneIndexAt(5, 3.65), 2);
+    EXPECT_EQ(laneSection_.laneIndexAt(5, -3.65), 3);
+    EXPECT_EQ(laneSection_.laneIndexAt(5, 5.5), 0);
+
+    EXPECT_EQ(laneSection_.laneIndexAt(5, 5.6), -1);
+    EXPECT_EQ(laneSection_.laneIndexAt(5, -5.6), -1);
+}
+
+TEST(LaneSectionBoundaryCursorTest, testBoundaryOffsets)
+{
+    XodrReader xml = XodrReader::fromText(
+        "<laneSection s='10'>"
+        "  <left>"
+        "    <lane id='2' type='sidewalk' level='false'>"
+        "      <width sOffset='2' a='1.5' b='0.1' c='0' d='0'/>"
+        "      <width sOffset='8' a='2.1' b='0' c='-0.01' d='0.001'/>"
+        "    </lane>"
+        "    <lane id='1' type='driving' level='false'>"
+        "      <width sOffset='0' a='3' b='0' c='0.02' d='0'/>"
+        "      <width sOffset='5' a='3.5' b='0.2' c='0' d='0'/>"
+        "      <width sOffset='6' a='3.7' b='0' c='0' d='0'/>"
+        "    </lane>"
+        "  </left>"
+        "  <center>"
+        "    <lane id='0' type='driving' level='false'/>"
+        "  </center>"
+        "  <right>"
+        "    <lane id='-1' type='driving' level='false'>"
+        "      <width sOffset='0' a='3.5' b='-0.05' c='0' d='0.0001'/>"
+        "    </lane>"
+        "  </right>"
+        "</laneSection>");
+    xml.readStartElement("laneSection");
+    LaneSection laneSection = LaneSection::parseXml(xml).value();
+
+    // The offsets at evenly spaced s-coordinates, in order, in reverse order
+    // and alternating between the two ends of the lane section.
+    std::vector<double> sorted;
+    for (int i = 0; i <= 120; i++)
+    {
+        sorted.push_back(10 + i * .1);
+    }
+    std::vector<double> reversed(sorted.rbegin(), sorted.rend());
+    std::vector<double> alternating;
+    for (size_t i = 0; i < sorted.size(); i++)
+    {
+        alternating.push_back(i % 2 == 0 ? sorted[i / 2] : sorted[sorted.size() - 1 - i / 2]);
+    }
+
+    const LaneSection::Lane& lane2 = laneSection.laneById(LaneID(2));
+    const LaneSection::Lane& lane1 = laneSection.laneById(LaneID(1));
+    const LaneSection::Lane& laneMinus1 = laneSection.laneById(LaneID(-1));
+    for (const std::vector<double>& sCoords : {sorted, reversed, alternating})
+    {
+        LaneSection::BoundaryCursor cursor(laneSection);
+        for (double s : sCoords)
+        {
+            double localS = s - 10;
+            double expected[4];
+            expected[1] = lane1.widthAtSCoord(localS);
+            expected[0] = expected[1] + lane2.widthAtSCoord(localS);
+            expected[2] = 0;
+            expected[3] = -laneMinus1.widthAtSCoord(localS);
+
+            double offsets[4];
+            double derivatives[4];
+            cursor.boundaryOffsets(s, offsets, derivatives);
+            for (int i = 0; i < 4; i++)
+            {
+                EXPECT_DOUBLE_EQ(offsets[i], expected[i]) << "s = " << s << ", boundary " << i;
+            }
+
+            // Compare the derivatives to finite differences, away from the
+            // starts of the polynomials, where the widths have kinks.
+            double h = 1e-6;
+            double offsetsBefore[4];
+            double offsetsAfter[4];
+            laneSection.evalBoundaryOffsets(s - h, offsetsBefore);
+            laneSection.evalBoundaryOffsets(s + h, offsetsAfter);
+            bool nearKink = false;
+            for (double kink : {12.0, 15.0, 16.0, 18.0})
+            {
+                nearKink |= std::abs(s - kink) < 2 * h;
+            }
+            for (int i = 0; i < 4 && !nearKink; i++)
+            {
+                EXPECT_NEAR(derivatives[i], (offsetsAfter[i] - offsetsBefore[i]) / (2 * h), 1e-6);
+            }
+        }
+    }
+}
+
 TEST_F(LaneSectionTest, testValidateLaneLinks)
 {
     LaneSection fromSection = laneSection_;
@@ -0,0 +1,221 @@
+#include "lane_spatial_index.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "map_tessellator.h"
+
+#include "../test_config.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief A quad of a lane, see LaneSpatialIndex.
+ */
+struct TestQuad
+{
+    Eigen::Vector2d corners_[4];
+    LaneKey lane_;
+    int globalLaneIdx_;
+};
+
+/**
+ * @brief Tests whether a point is in a polygon, by its winding number.
+ */
+static bool windingContains(const Eigen::Vector2d* corners, int numCorners, const Eigen::Vector2d& point)
+{
+    int winding = 0;
+    for (int i = 0; i < numCorners; i++)
+    {
+        const Eigen::Vector2d& a = corners[i];
+        const Eigen::Vector2d& b = corners[(i + 1) % numCorners];
+        double side = (b.x() - a.x()) * (point.y() - a.y()) - (point.x() - a.x()) * (b.y() - a.y());
+        if (a.y() <= point.y() && b.y() > point.y() && side > 0)
+        {
+            winding++;
+        }
+        else if (a.y() > point.y() && b.y() <= point.y() && side < 0)
+        {
+            winding--;
+        }
+    }
+
+    return winding != 0;
+}
+
+class LaneSpatialIndexTest : public testing::TestWithParam<const char*>
+{
+  public:
+    LaneSpatialIndexTest()
+    {
+        map_ = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + GetParam()).extract_value();
+
+        // A coarse tolerance keeps the brute force search manageable.
+        options_.maxError_ = .05;
+
+        MapTessellator tessellator(map_);
+        MapTessellator::Options options;
+        options.maxError_ = options_.maxError_;
+        tessellator.tessellate(options);
+
+        for (int roadIdx = 0; roadIdx < static_cast<int>(map_.roads().size()); roadIdx++)
+        {
+            for (int i = 0; i < static_cast<int>(map_.roads()[roadIdx].laneSections().size()); i++)
+            {
+                LaneSectionKey laneSectionKey(roadIdx, i);
+                const ArenaVector<LaneSection::Lane>& lanes = laneSectionByKey(map_, laneSectionKey).lanes();
+                for (int j = 0; j < static_cast<int>(lanes.size()); j++)
+                {
+                    MapTessellator::Polyline left = tessellator.boundary(tessellator.boundaryIndex(laneSectionKey, j));
+                    MapTessellator::Polyline right =
+                        tessellator.boundary(tessellator.boundaryIndex(laneSectionKey, j + 1));
+                    for (int k = 0; k + 1 < left.size_; k++)
+                    {
+                        quads_.push_back({{left.vertices_[k], left.vertices_[k + 1], right.vertices_[k + 1],
+                                           right.vertices_[k]},
+                                          LaneKey(laneSectionKey, j), lanes[j].globalIndex()});
+                        for (const Eigen::Vector2d& corner : quads_.back().corners_)
+                        {
+                            bounds_.extend(corner);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Finds the lanes which contain a point by testing all quads.
+     */
+    std::vector<LaneKey> bruteForceLanes(const Eigen::Vector2d& point) const
+    {
+        std::vector<const TestQuad*> containing;
+        for (const TestQuad& quad : quads_)
+        {
+            if (windingContains(quad.corners_, 4, point))
+            {
+                containing.push_back(&quad);
+            }
+        }
+        std::sort(containing.begin(), containing.end(),
+                  [](const TestQuad* a, const TestQuad* b) { return a->globalLaneIdx_ < b->globalLaneIdx_; });
+
+        std::vector<LaneKey> lanes;
+        for (size_t i = 0; i < containing.size(); i++)
+        {
+            if (i == 0 || containing[i]->globalLaneIdx_ != containing[i - 1]->globalLaneIdx_)
+            {
+                lanes.push_back(containing[i]->lane_);
+            }
+        }
+        return lanes;
+    }
+
+    XodrMap map_;
+    LaneSpatialIndex::Options options_;
+    std::vector<TestQuad> quads_;
+    Eigen::AlignedBox2d bounds_;
+};
+
+TEST_P(LaneSpatialIndexTest, testMatchesBruteForce)
+{
+    LaneSpatialIndex index(map_, options_);
+    ASSERT_EQ(index.numQuads(), static_cast<int>(quads_.size()));
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> xDist(bounds_.min().x(), bounds_.max().x());
+    std::uniform_real_distribution<double> yDist(bounds_.min().y(), bounds_.max().y());
+    std::uniform_int_distribution<size_t> quadDist(0, quads_.size() - 1);
+    std::uniform_real_distribution<double> jitterDist(-1, 1);
+
+    // Half of the points are uniformly distributed over the map, the other
+    // half are near the corners of quads, and thus often near boundaries.
+    std::vector<LaneKey> lanes;
+    int numInLane = 0;
+    for (int i = 0; i < 200; i++)
+    {
+        Eigen::Vector2d point(xDist(rng), yDist(rng));
+        if (i % 2 == 1)
+        {
+            point = quads_[quadDist(rng)].corners_[(i / 2) % 4] + Eigen::Vector2d(jitterDist(rng), jitterDist(rng));
+        }
+
+        index.findLanes(point, lanes);
+        EXPECT_EQ(lanes, bruteForceLanes(point)) << point.transpose();
+        numInLane += !lanes.empty();
+    }
+    EXPECT_GT(numInLane, 0);
+}
+
+TEST_P(LaneSpatialIndexTest, testFindsQuadCenters)
+{
+    LaneSpatialIndex index(map_, options_);
+
+    // The center of a convex quad is inside it.
+    std::vector<LaneKey> lanes;
+    for (const TestQuad& quad : quads_)
+    {
+        bool convex = true;
+        double firstTurn = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            Eigen::Vector2d e0 = quad.corners_[(i + 1) % 4] - quad.corners_[i];
+            Eigen::Vector2d e1 = quad.corners_[(i + 2) % 4] - quad.corners_[(i + 1) % 4];
+            double turn = e0.x() * e1.y() - e0.y() * e1.x();
+            convex = convex && std::abs(turn) > 1e-6 && (i == 0 || (turn > 0) == (firstTurn > 0));
+            firstTurn = i == 0 ? turn : firstTurn;
+        }
+        if (!convex)
+        {
+            continue;
+        }
+
+        Eigen::Vector2d center = (quad.corners_[0] + quad.corners_[1] + quad.corners_[2] + quad.corners_[3]) / 4;
+        index.findLanes(center, lanes);
+        EXPECT_NE(std::find(lanes.begin(), lanes.end(), quad.lane_), lanes.end()) << center.transpose();
+    }
+}
+
+TEST_P(LaneSpatialIndexTest, testBatch)
+{
+    LaneSpatialIndex index(map_, options_);
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> xDist(bounds_.min().x(), bounds_.max().x());
+    std::uniform_real_distribution<double> yDist(bounds_.min().y(), bounds_.max().y());
+
+    // Enough points for several chunks, the last of which is partial.
+    std::vector<Eigen::Vector2d> points(1000);
+    for (Eigen::Vector2d& point : points)
+    {
+        point = Eigen::Vector2d(xDist(rng), yDist(rng));
+    }
+
+    LaneSpatialIndex::BatchResult result;
+    std::vector<LaneKey> lanes;
+    for (int numThreads : {1, 3})
+    {
+        index.findLanes(points.data(), static_cast<int>(points.size()), result, numThreads);
+        ASSERT_EQ(result.offsets_.size(), points.size() + 1);
+        ASSERT_EQ(result.lanes_.size(), static_cast<size_t>(result.offsets_.back()));
+
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            index.findLanes(points[i], lanes);
+            std::vector<LaneKey> batchLanes(result.lanes_.begin() + result.offsets_[i],
+                                            result.lanes_.begin() + result.offsets_[i + 1]);
+            EXPECT_EQ(batchLanes, lanes);
+        }
+    }
+
+    index.findLanes(points.data(), 0, result);
+    EXPECT_EQ(result.offsets_, std::vector<int>{0});
+    EXPECT_TRUE(result.lanes_.empty());
+}
+
+INSTANTIATE_TEST_CASE_P(Maps, LaneSpatialIndexTest,
+                        testing::Values("Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                        "sample1.1.xodr"));
+
+}}  // namespace aid::xodr
@@ -0,0 +1,201 @@
+#include "map_tessellator.h"
+
+#include <gtest/gtest.h>
+
+#include <cfloat>
+
+#include "../test_config.h"
+
+namespace aid { namespace xodr {
+
+class MapTessellatorTest : public testing::TestWithParam<const char*>
+{
+  public:
+    MapTessellatorTest()
+    {
+        map_ = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + GetParam()).extract_value();
+    }
+
+    XodrMap map_;
+};
+
+TEST_P(MapTessellatorTest, testMatchesLaneSectionTessellation)
+{
+    MapTessellator::Options options;
+    options.maxError_ = .02;
+    options.numThreads_ = 3;
+
+    MapTessellator tessellator(map_);
+    tessellator.tessellate(options);
+
+    ReferenceLine::FrenetFrames frames;
+    LaneSection::LaneTessellationBuffer expected;
+
+    int numBoundaries = 0;
+    int numCenterLines = 0;
+    for (int roadIdx = 0; roadIdx < static_cast<int>(map_.roads().size()); roadIdx++)
+    {
+        const Road& road = map_.roads()[roadIdx];
+        for (int i = 0; i < static_cast<int>(road.laneSections().size()); i++)
+        {
+            const LaneSection& laneSection = road.laneSections()[i];
+            road.referenceLine().tessellate(frames, laneSection.startS(), laneSection.endS(),
+                                            laneSection.boundaryTessellationTolerance(options.maxError_));
+            laneSection.tessellateLaneBoundaryCurvesAndCenterLines(frames, expected);
+
+            for (int j = 0; j < expected.numBoundaries(); j++)
+            {
+                MapTessellator::Polyline boundary =
+                    tessellator.boundary(tessellator.boundaryIndex(LaneSectionKey(roadIdx, i), j));
+                ASSERT_EQ(boundary.size_, expected.boundarySize(j));
+                for (int k = 0; k < boundary.size_; k++)
+                {
+                    EXPECT_EQ(boundary.vertices_[k], expected.boundaryVertices(j)[k]);
+                }
+                numBoundaries++;
+            }
+
+            for (int j = 0; j < expected.numCenterLines(); j++)
+            {
+                int globalIndex = laneSection.lanes()[j].globalIndex();
+                MapTessellator::Polyline centerLine = tessellator.centerLine(globalIndex);
+                const double* variances = tessellator.centerLineVariances(globalIndex);
+
+                int offset = expected.centerLineOffsets_[j];
+                ASSERT_EQ(centerLine.size_, expected.centerLineOffsets_[j + 1] - offset);
+                for (int k = 0; k < centerLine.size_; k++)
+                {
+                    EXPECT_EQ(centerLine.vertices_[k], expected.centerLineVertices_[offset + k]);
+                    EXPECT_EQ(variances[k], expected.variances_[offset + k]);
+                }
+                numCenterLines++;
+            }
+        }
+    }
+
+    EXPECT_EQ(tessellator.numBoundaries(), numBoundaries);
+    EXPECT_EQ(numCenterLines, map_.totalNumLanes());
+}
+
+TEST_P(MapTessellatorTest, testDeterministic)
+{
+    MapTessellator::Options options;
+    options.numThreads_ = 1;
+
+    MapTessellator reference(map_);
+    reference.tessellate(options);
+
+    // The output doesn't depend on the number of threads, and a tessellator
+    // which is reused (here, after a coarser tessellation) gives the same
+    // output as a fresh one.
+    MapTessellator tessellator(map_);
+    MapTessellator::Options coarseOptions;
+    coarseOptions.maxError_ = 1;
+    tessellator.tessellate(coarseOptions);
+
+    for (int numThreads : {2, 4, 7})
+    {
+        options.numThreads_ = numThreads;
+        tessellator.tessellate(options);
+
+        ASSERT_EQ(tessellator.numBoundaries(), reference.numBoundaries());
+        for (int i = 0; i < reference.numBoundaries(); i++)
+        {
+            MapTessellator::Polyline expected = reference.boundary(i);
+            MapTessellator::Polyline actual = tessellator.boundary(i);
+            ASSERT_EQ(actual.size_, expected.size_);
+            EXPECT_TRUE(std::equal(expected.vertices_, expected.vertices_ + expected.size_, actual.vertices_))
+                << numThreads << " threads, boundary " << i;
+        }
+
+        for (int i = 0; i < map_.totalNumLanes(); i++)
+        {
+            MapTessellator::Polyline expected = reference.centerLine(i);
+            MapTessellator::Polyline actual = tessellator.centerLine(i);
+            ASSERT_EQ(actual.size_, expected.size_);
+            EXPECT_TRUE(std::equal(expected.vertices_, expected.vertices_ + expected.size_, actual.vertices_))
+                << numThreads << " threads, center line " << i;
+        }
+    }
+}
+
+TEST_P(MapTessellatorTest, testCompactVertexFormats)
+{
+    MapTessellator::Options options;
+    options.numThreads_ = 3;
+
+    MapTessellator reference(map_);
+    reference.tessellate(options);
+
+    MapTessellator tessellator(map_);
+
+    options.vertexFormat_ = VertexFormat::FLOAT;
+    tessellator.tessellate(options);
+    ASSERT_EQ(tessellator.numBoundaries(), reference.numBoundaries());
+
+    // The float coordinates are rounded relative to the origin of the road.
+    auto expectFloatError = [&](MapTessellator::Polyline expected, FloatPolyline actual) {
+        ASSERT_EQ(actual.size_, expected.size_);
+        for (int i = 0; i < actual.size_; i++)
+        {
+            Eigen::Vector2d bound = (expected.vertices_[i] - actual.origin_).cwiseAbs() * FLT_EPSILON / 2;
+            Eigen::Vector2d error = (actual.vertex(i) - expected.vertices_[i]).cwiseAbs();
+            EXPECT_LE(error.x(), bound.x() + 1e-9);
+            EXPECT_LE(error.y(), bound.y() + 1e-9);
+        }
+    };
+    for (int i = 0; i < reference.numBoundaries(); i++)
+    {
+        expectFloatError(reference.boundary(i), tessellator.floatBoundary(i));
+    }
+    for (int i = 0; i < map_.totalNumLanes(); i++)
+    {
+        expectFloatError(reference.centerLine(i), tessellator.floatCenterLine(i));
+    }
+    EXPECT_EQ(2 * tessellator.vertexMemoryUsage(), reference.vertexMemoryUsage());
+
+    options.vertexFormat_ = VertexFormat::QUANTIZED;
+    options.quantizationStep_ = .002;
+    tessellator.tessellate(options);
+
+    std::vector<Eigen::Vector2d> decoded;
+    auto expectQuantizedError = [&](MapTessellator::Polyline expected, QuantizedPolyline actual) {
+        ASSERT_EQ(actual.size_, expected.size_);
+        decoded.resize(actual.size_);
+        actual.decode(decoded.data());
+        for (int i = 0; i < actual.size_; i++)
+        {
+            Eigen::Vector2d error = (decoded[i] - expected.vertices_[i]).cwiseAbs();
+            EXPECT_LE(error.maxCoeff(), options.quantizationStep_ / 2 + 1e-9);
+        }
+    };
+    for (int i = 0; i < reference.numBoundaries(); i++)
+    {
+        expectQuantizedError(reference.boundary(i), tessellator.quantizedBoundary(i));
+    }
+    for (int i = 0; i < map_.totalNumLanes(); i++)
+    {
+        expectQuantizedError(reference.centerLine(i), tessellator.quantizedCenterLine(i));
+    }
+
+    // Most vertices take a single word per coordinate.
+    EXPECT_LT(tessellator.vertexMemoryUsage(), reference.vertexMemoryUsage() / 3);
+
+    // The quantized output doesn't depend on the number of threads either.
+    MapTessellator singleThreaded(map_);
+    options.numThreads_ = 1;
+    singleThreaded.tessellate(options);
+    for (int i = 0; i < reference.numBoundaries(); i++)
+    {
+        QuantizedPolyline expected = singleThreaded.quantizedBoundary(i);
+        QuantizedPolyline actual = tessellator.quantizedBoundary(i);
+        ASSERT_EQ(actual.numWords_, expected.numWords_);
+        EXPECT_TRUE(std::equal(expected.words_, expected.words_ + expected.numWords_, actual.words_));
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(Maps, MapTessellatorTest,
+                        testing::Values("Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                        "sample1.1.xodr"));
+
+}}  // namespace aid::xodr
@@ -2,6 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include <limits>
+#include <random>
+
 namespace aid { namespace xodr {
 
 class TestFactory
@@ -19,17 +22,17 @@ class TestFactory
 
             Eigen::Vector2d dir = endPt - startPt;
 
-            ReferenceLine::Line* line = new ReferenceLine::Line();
-            line->startVertex_.position_ = startPt;
-            line->startVertex_.heading_ = std::atan2(dir.y(), dir.x());
-            line->startVertex_.sCoord_ = sCoord;
-            line->length_ = (endPt - startPt).norm();
-            refLine.geometries_.emplace_back(line);
+            ReferenceLine::Line line;
+            line.startVertex_.position_ = startPt;
+            line.startVertex_.heading_ = std::atan2(dir.y(), dir.x());
+            line.startVertex_.sCoord_ = sCoord;
+            line.length_ = (endPt - startPt).norm();
+            refLine.appendGeometry(line);
 
-            sCoord += line->length_;
+            sCoord += line.length_;
         }
 
-        refLine.endVertex_ = refLine.geometries_.back()->endVertex();
+        refLine.endVertex_ = refLine.geometries_.back().endVertex();
 
         return refLine;
     }
@@ -304,7 +307,8 @@ TEST(ReferenceLineTest, testEvalPoly3)
     ReferenceLine::PointAndTangentDir res = poly3.eval(20);
 
     ReferenceLine::PointAndTangentDir expectedRes;
-    expectedRes.point_ = Eigen::Vector2d(-4403.046055, 2874.975397);
+    // The point at an arc length of 18 from the start, at u = 2.813470.
+    expectedRes.point_ = Eigen::Vector2d(-3.368021, 31.927022);
     expectedRes.tangentDir_ = (poly3.eval(20.001).point_ - res.point_).normalized();
 
     EXPECT_NEAR(res.point_.x(), expectedRes.point_.x(), .0001);
@@ -326,7 +330,9 @@ TEST(ReferenceLineTest, testEvalParamPoly3ArcLength)
     ReferenceLine::PointAndTangentDir res = paramPoly3.eval(20);
 
     ReferenceLine::PointAndTangentDir expectedRes;
-    expectedRes.point_ = Eigen::Vector2d(2929.707235, 4327.308884);
+    // The curve is much longer than the geometry, so s is scaled to the arc
+    // length of the curve: this is the point at 18% of its arc length.
+    expectedRes.point_ = Eigen::Vector2d(75668.096829, 161857.944694);
     expectedRes.tangentDir_ = (paramPoly3.eval(20.001).point_ - res.point_).normalized();
 
     EXPECT_NEAR(res.point_.x(), expectedRes.point_.x(), .0001);
@@ -348,7 +354,8 @@ TEST(ReferenceLineTest, testEvalParamPoly3Normalized)
     ReferenceLine::PointAndTangentDir res = paramPoly3.eval(20);
 
     ReferenceLine::PointAndTangentDir expectedRes;
-    expectedRes.point_ = Eigen::Vector2d(10.173467, 20.032452);
+    // The point at 18% of the arc length of the curve.
+    expectedRes.point_ = Eigen::Vector2d(10.608915, 19.779961);
     expectedRes.tangentDir_ = (paramPoly3.eval(20.001).point_ - res.point_).normalized();
 
     EXPECT_NEAR(res.point_.x(), expectedRes.point_.x(), .0001);
@@ -397,6 +404,191 @@ TEST(ReferenceLineTest, testEvalManyGeoms)
     EXPECT_NEAR(res.tangentDir_.y(), expectedRes.tangentDir_.y(), .0001);
 }
 
+/**
+ * @brief Creates a reference line with one geometry of each type, each 10
+ * meters long.
+ */
+static ReferenceLine mixedGeometriesReferenceLine()
+{
+    return ReferenceLine::fromText(
+        "<planView>"
+        "  <geometry s='0' x='0' y='0' hdg='0' length='10'><line/></geometry>"
+        "  <geometry s='10' x='10' y='0' hdg='0' length='10'><spiral curvStart='0' curvEnd='0.05'/></geometry>"
+        "  <geometry s='20' x='19.9' y='0.8' hdg='0.25' length='10'><arc curvature='0.05'/></geometry>"
+        "  <geometry s='30' x='29.4' y='4' hdg='0.75' length='10'><poly3 a='0' b='0' c='0.01' d='0'/></geometry>"
+        "  <geometry s='40' x='35' y='12' hdg='1' length='10'>"
+        "    <paramPoly3 aU='0' bU='10' cU='0' dU='0' aV='0' bV='0' cV='1' dV='0' pRange='normalized'/>"
+        "  </geometry>"
+        "</planView>")
+        .extract_value();
+}
+
+TEST(ReferenceLineTest, testGeometryAccessors)
+{
+    const ReferenceLine refLine = mixedGeometriesReferenceLine();
+
+    const ReferenceLine::GeometryType expectedTypes[] = {
+        ReferenceLine::GeometryType::LINE, ReferenceLine::GeometryType::SPIRAL, ReferenceLine::GeometryType::ARC,
+        ReferenceLine::GeometryType::POLY3, ReferenceLine::GeometryType::PARAM_POLY3};
+
+    ASSERT_EQ(refLine.numGeometries(), 5);
+
+    ReferenceLine copy = refLine;
+    for (int i = 0; i < refLine.numGeometries(); i++)
+    {
+        const ReferenceLine::Geometry& geometry = refLine.geometry(i);
+        EXPECT_EQ(geometry.geometryType(), expectedTypes[i]);
+        EXPECT_EQ(geometry.startVertex().sCoord_, 10 * i);
+        EXPECT_EQ(geometry.length(), 10);
+
+        // Evaluating the reference line must pick the geometry whose range
+        // contains s, including at the start of that range.
+        for (double s : {10.0 * i, 10.0 * i + 5})
+        {
+            ReferenceLine::PointAndTangentDir expected = geometry.eval(s);
+            ReferenceLine::PointAndTangentDir res = refLine.eval(s);
+            EXPECT_EQ(res.point_, expected.point_);
+            EXPECT_EQ(res.tangentDir_, expected.tangentDir_);
+            EXPECT_EQ(refLine.evalCurvature(s), geometry.evalCurvature(s));
+
+            EXPECT_EQ(copy.eval(s).point_, expected.point_);
+        }
+
+        EXPECT_NE(&copy.geometry(i), &geometry);
+        EXPECT_EQ(copy.geometry(i).geometryType(), expectedTypes[i]);
+    }
+
+    EXPECT_EQ(refLine.endVertex().sCoord_, 50);
+}
+
+TEST(ReferenceLineTest, testEvalMany)
+{
+    const ReferenceLine refLine = mixedGeometriesReferenceLine();
+
+    // Sorted s-coordinates, including the geometry boundaries and the end.
+    std::vector<double> sCoords;
+    for (int i = 0; i <= 500; i++)
+    {
+        sCoords.push_back(i * .1);
+    }
+
+    // The same s-coordinates in an order which jumps between geometries.
+    std::vector<double> shuffled;
+    for (int i = 0; i < 5; i++)
+    {
+        for (int j = i; j < static_cast<int>(sCoords.size()); j += 5)
+        {
+            shuffled.push_back(sCoords[j]);
+        }
+    }
+
+    for (const std::vector<double>& input : {sCoords, shuffled})
+    {
+        int count = static_cast<int>(input.size());
+        std::vector<double> x(count), y(count), tangentX(count), tangentY(count);
+        refLine.evalMany(input.data(), count, {x.data(), y.data(), tangentX.data(), tangentY.data()});
+
+        for (int i = 0; i < count; i++)
+        {
+            ReferenceLine::PointAndTangentDir expected = refLine.eval(input[i]);
+            EXPECT_NEAR(x[i], expected.point_.x(), 1e-9) << "s = " << input[i];
+            EXPECT_NEAR(y[i], expected.point_.y(), 1e-9) << "s = " << input[i];
+            EXPECT_NEAR(tangentX[i], expected.tangentDir_.x(), 1e-12) << "s = " << input[i];
+            EXPECT_NEAR(tangentY[i], expected.tangentDir_.y(), 1e-12) << "s = " << input[i];
+        }
+    }
+}
+
+/**
+ * @brief Finds the s-coordinate of the point on a geometry nearest to a point,
+ * among points sampled at a fixed step.
+ */
+static double sampledNearestS(const ReferenceLine::Geometry& geometry, const Eigen::Vector2d& point, double step)
+{
+    double startS = geometry.startVertex().sCoord_;
+    int numSteps = static_cast<int>(std::ceil(geometry.length() / step));
+
+    double bestS = startS;
+    double bestDistance = std::numeric_limits<double>::infinity();
+    for (int i = 0; i <= numSteps; i++)
+    {
+        double s = startS + std::min(i * step, geometry.length());
+        double distance = (geometry.eval(s).point_ - point).squaredNorm();
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            bestS = s;
+        }
+    }
+
+    return bestS;
+}
+
+TEST(ReferenceLineTest, testNearestS)
+{
+    const ReferenceLine mixed = mixedGeometriesReferenceLine();
+
+    // Arcs with both signs of curvature, one of which covers most of its
+    // circle, so the end points are the nearest points to some points.
+    const ReferenceLine arcs =
+        ReferenceLine::fromText(
+            "<planView>"
+            "  <geometry s='0' x='0' y='0' hdg='2' length='50'><arc curvature='-0.1'/></geometry>"
+            "  <geometry s='50' x='0' y='0' hdg='-1' length='5'><arc curvature='0.2'/></geometry>"
+            "</planView>")
+            .extract_value();
+
+    std::vector<const ReferenceLine::Geometry*> geometries;
+    for (const ReferenceLine* refLine : {&mixed, &arcs})
+    {
+        for (int i = 0; i < refLine->numGeometries(); i++)
+        {
+            geometries.push_back(&refLine->geometry(i));
+        }
+    }
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> unitDist(0, 1);
+    for (const ReferenceLine::Geometry* geometry : geometries)
+    {
+        double startS = geometry->startVertex().sCoord_;
+        double endS = startS + geometry->length();
+        bool closedForm = geometry->geometryType() == ReferenceLine::GeometryType::LINE ||
+                          geometry->geometryType() == ReferenceLine::GeometryType::ARC;
+
+        for (int i = 0; i < 100; i++)
+        {
+            // Points on the normals of the geometry, nearer to it than its
+            // radius of curvature, project back to the foot of the normal.
+            double s = startS + unitDist(rng) * geometry->length();
+            double t = unitDist(rng) * 6 - 3;
+            ReferenceLine::PointAndTangentDir pt = geometry->eval(s);
+            Eigen::Vector2d normal(-pt.tangentDir_.y(), pt.tangentDir_.x());
+            Eigen::Vector2d point = pt.point_ + t * normal;
+
+            // The hint is the nearest point of a coarse tessellation, like in
+            // RoadProjector. The closed form implementations ignore it.
+            double sHint = closedForm ? startS : sampledNearestS(*geometry, point, 1);
+            EXPECT_NEAR(geometry->nearestS(point, sHint), s, 1e-6)
+                << "type " << static_cast<int>(geometry->geometryType()) << ", s = " << s << ", t = " << t;
+
+            // Points anywhere around the geometry are no nearer to any of its
+            // sampled points than to the one which is found.
+            if (closedForm)
+            {
+                Eigen::Vector2d farPoint = pt.point_ + Eigen::Vector2d(unitDist(rng) - .5, unitDist(rng) - .5) * 40;
+                double nearestS = geometry->nearestS(farPoint, startS);
+                ASSERT_TRUE(nearestS >= startS && nearestS <= endS);
+
+                double distance = (geometry->eval(nearestS).point_ - farPoint).norm();
+                double sampledS = sampledNearestS(*geometry, farPoint, .01);
+                double sampledDistance = (geometry->eval(sampledS).point_ - farPoint).norm();
+                EXPECT_LE(distance, sampledDistance + 1e-9);
+            }
+        }
+    }
+}
+
 // Test the evalCurvature functions
 
 TEST(ReferenceLineTest, testEvalLineCurvature)
@@ -439,7 +631,11 @@ TEST(ReferenceLineTest, testEvalPoly3Curvature)
     ReferenceLine::GeometryAttribs geomAttribs{};
     geomAttribs.length_ = 100;
     EXPECT_NEAR(ReferenceLine::Poly3Geom(geomAttribs, Poly3(0, -4, 0, 1)).evalCurvature(0), 0, .0001);
-    EXPECT_NEAR(ReferenceLine::Poly3Geom(geomAttribs, Poly3(0, 2, -1, .02)).evalCurvature(3), -0.0351, .0001);
+
+    // The curvature at an arc length of 3, where u = 2.062532.
+    ReferenceLine::Poly3Geom poly3(geomAttribs, Poly3(0, 2, -1, .02));
+    EXPECT_NEAR(poly3.uCoordAt(3), 2.062532237, 1e-8);
+    EXPECT_NEAR(poly3.evalCurvature(3), -0.1838161222, 1e-8);
 }
 
 TEST(ReferenceLineTest, testEvalParamPoly3ArcLengthCurvature)
@@ -450,7 +646,11 @@ TEST(ReferenceLineTest, testEvalParamPoly3ArcLengthCurvature)
                                          ReferenceLine::PRange::ARC_LENGTH);
 
     EXPECT_NEAR(paramPoly3.evalCurvature(0), -8, 0.0001);
-    EXPECT_NEAR(paramPoly3.evalCurvature(0.25), -0.82875, 0.0001);
+
+    // The curve is much longer than the geometry, so s is scaled to the arc
+    // length of the curve.
+    EXPECT_NEAR(paramPoly3.paramAt(0.25), 14.12558283, 1e-7);
+    EXPECT_NEAR(paramPoly3.evalCurvature(0.25), 2.695523123e-05, 1e-12);
 }
 
 TEST(ReferenceLineTest, testEvalParamPoly3NormalizedCurvature)
@@ -461,7 +661,9 @@ TEST(ReferenceLineTest, testEvalParamPoly3NormalizedCurvature)
                                          ReferenceLine::PRange::NORMALIZED);
 
     EXPECT_NEAR(paramPoly3.evalCurvature(0), -8, 0.0001);
-    EXPECT_NEAR(paramPoly3.evalCurvature(25), -0.82875, 0.0001);
+
+    EXPECT_NEAR(paramPoly3.paramAt(25), 0.480608476691, 1e-9);
+    EXPECT_NEAR(paramPoly3.evalCurvature(25), -0.04753517162, 1e-8);
 }
 
 }}  // namespace aid::xodr
\ No newline at end of file
@@ -2,9 +2,133 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <stdexcept>
+
 #include "../test_config.h"
 #include "xodr_map.h"
 
 namespace aid { namespace xodr {
 
+class RoadPoseTest : public testing::TestWithParam<const char*>
+{
+  public:
+    RoadPoseTest()
+    {
+        map_ = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + GetParam()).extract_value();
+    }
+
+    XodrMap map_;
+};
+
+TEST_P(RoadPoseTest, testLanePose)
+{
+    for (const Road& road : map_.roads())
+    {
+        const ReferenceLine& refLine = road.referenceLine();
+        for (int i = 0; i <= 10; i++)
+        {
+            double s = road.referenceLine().endS() * i / 10;
+            const LaneSection& laneSection = road.laneSections()[road.laneSectionIndexAt(s)];
+
+            std::vector<double> offsets(laneSection.lanes().size() + 1);
+            laneSection.evalBoundaryOffsets(s, offsets.data());
+
+            double x, y, tangentX, tangentY;
+            refLine.evalMany(&s, 1, {&x, &y, &tangentX, &tangentY});
+            Eigen::Vector2d point(x, y);
+            Eigen::Vector2d normal(-tangentY, tangentX);
+            double elevation;
+            road.evalElevations(&s, 1, &elevation);
+
+            for (int j = 0; j < static_cast<int>(laneSection.lanes().size()); j++)
+            {
+                LaneID laneId = laneSection.laneIndexToId(j);
+                double t = (offsets[j] + offsets[j + 1]) / 2 + .5;
+                Eigen::Vector2d expected = point + t * normal;
+
+                Road::Pose pose = road.lanePose(s, laneId, .5);
+                EXPECT_NEAR(pose.position_.x(), expected.x(), 1e-9);
+                EXPECT_NEAR(pose.position_.y(), expected.y(), 1e-9);
+                EXPECT_EQ(pose.position_.z(), elevation);
+
+                Road::Pose refPose = road.pose(s, t);
+                EXPECT_NEAR((refPose.position_ - pose.position_).norm(), 0, 1e-9);
+            }
+        }
+    }
+}
+
+TEST_P(RoadPoseTest, testHeading)
+{
+    // The heading is the direction in which the pose moves as s increases.
+    const double h = 1e-5;
+    for (const Road& road : map_.roads())
+    {
+        for (int i = 1; i < 10; i++)
+        {
+            double s = road.referenceLine().endS() * i / 10;
+            int laneSectionIdx = road.laneSectionIndexAt(s);
+            if (road.laneSectionIndexAt(s - h) != laneSectionIdx || road.laneSectionIndexAt(s + h) != laneSectionIdx)
+            {
+                continue;
+            }
+
+            const LaneSection& laneSection = road.laneSections()[laneSectionIdx];
+            for (int j = 0; j < static_cast<int>(laneSection.lanes().size()); j++)
+            {
+                LaneID laneId = laneSection.laneIndexToId(j);
+                Eigen::Vector3d before = road.lanePose(s - h, laneId).position_;
+                Eigen::Vector3d after = road.lanePose(s + h, laneId).position_;
+                double expected = std::atan2(after.y() - before.y(), after.x() - before.x());
+
+                double heading = road.lanePose(s, laneId).heading_;
+                EXPECT_NEAR(std::remainder(heading - expected, 2 * M_PI), 0, 1e-4)
+                    << "road " << road.id() << ", s = " << s << ", lane " << static_cast<int>(laneId);
+            }
+        }
+    }
+}
+
+TEST_P(RoadPoseTest, testLanePoses)
+{
+    for (const Road& road : map_.roads())
+    {
+        // A trajectory along the outermost right lane of each lane section,
+        // or the outermost left one if there are no right lanes.
+        std::vector<Road::LanePosition> positions;
+        for (int i = 0; i <= 100; i++)
+        {
+            Road::LanePosition position;
+            position.s_ = road.referenceLine().endS() * i / 100;
+            const LaneSection& laneSection = road.laneSections()[road.laneSectionIndexAt(position.s_)];
+            position.laneId_ = laneSection.numRightLanes() > 0 ? LaneID(-laneSection.numRightLanes())
+                                                                : LaneID(laneSection.numLeftLanes());
+            position.offset_ = .1 * (i % 3);
+            positions.push_back(position);
+        }
+
+        std::vector<Road::Pose> poses(positions.size());
+        road.lanePoses(positions.data(), static_cast<int>(positions.size()), poses.data());
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            Road::Pose expected = road.lanePose(positions[i].s_, positions[i].laneId_, positions[i].offset_);
+            EXPECT_NEAR((poses[i].position_ - expected.position_).norm(), 0, 1e-9);
+            EXPECT_NEAR(poses[i].heading_, expected.heading_, 1e-9);
+        }
+    }
+}
+
+TEST_P(RoadPoseTest, testMissingLane)
+{
+    const Road& road = map_.roads()[0];
+    const LaneSection& laneSection = road.laneSections()[0];
+    EXPECT_THROW(road.lanePose(0, LaneID(laneSection.numLeftLanes() + 1)), std::out_of_range);
+    EXPECT_THROW(road.lanePose(0, LaneID(-laneSection.numRightLanes() - 1)), std::out_of_range);
+}
+
+INSTANTIATE_TEST_CASE_P(Maps, RoadPoseTest,
+                        testing::Values("Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                        "sample1.1.xodr"));
+
 }}  // namespace aid::xodr
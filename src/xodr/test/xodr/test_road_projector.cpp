@@ -0,0 +1,148 @@
+#include "road_projector.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "map_tessellator.h"
+
+#include "../test_config.h"
+
+namespace aid { namespace xodr {
+
+class RoadProjectorTest : public testing::TestWithParam<const char*>
+{
+  public:
+    RoadProjectorTest()
+    {
+        map_ = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + GetParam()).extract_value();
+
+        // Points up to 15 meters to either side of the reference lines.
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<size_t> roadDist(0, map_.roads().size() - 1);
+        std::uniform_real_distribution<double> unitDist(0, 1);
+        for (int i = 0; i < 100; i++)
+        {
+            const ReferenceLine& refLine = map_.roads()[roadDist(rng)].referenceLine();
+            ReferenceLine::PointAndTangentDir pt = refLine.eval(unitDist(rng) * refLine.endS() * .999);
+            Eigen::Vector2d normal(-pt.tangentDir_.y(), pt.tangentDir_.x());
+            points_.push_back(pt.point_ + (unitDist(rng) * 30 - 15) * normal);
+        }
+    }
+
+    XodrMap map_;
+    std::vector<Eigen::Vector2d> points_;
+};
+
+TEST_P(RoadProjectorTest, testMatchesBruteForce)
+{
+    RoadProjector projector(map_, RoadProjector::Options());
+
+    for (const Eigen::Vector2d& point : points_)
+    {
+        RoadPosition pos = projector.project(point);
+        ASSERT_GE(pos.roadIdx_, 0);
+
+        // No point sampled along any of the reference lines is nearer.
+        double sampledDistance = std::numeric_limits<double>::infinity();
+        for (const Road& road : map_.roads())
+        {
+            const ReferenceLine& refLine = road.referenceLine();
+            for (double s = 0; s < refLine.endS(); s += .1)
+            {
+                sampledDistance = std::min(sampledDistance, (refLine.eval(s).point_ - point).norm());
+            }
+        }
+        EXPECT_LE(pos.distance_, sampledDistance + 1e-9);
+
+        // The road coordinates give back the point, unless its nearest point
+        // is the end of the road, where it may be off the normal.
+        const Road& road = map_.roads()[pos.roadIdx_];
+        const ReferenceLine& refLine = road.referenceLine();
+        ASSERT_TRUE(pos.s_ >= 0 && pos.s_ <= refLine.endS());
+        if (pos.s_ > 1e-6 && pos.s_ < refLine.endS() - 1e-6)
+        {
+            ReferenceLine::PointAndTangentDir pt = refLine.eval(pos.s_);
+            Eigen::Vector2d normal(-pt.tangentDir_.y(), pt.tangentDir_.x());
+            EXPECT_NEAR((pt.point_ + pos.t_ * normal - point).norm(), 0, 1e-6);
+            EXPECT_NEAR(std::abs(pos.t_), pos.distance_, 1e-6);
+        }
+
+        const LaneSection& laneSection = road.laneSections()[pos.laneSectionIdx_];
+        EXPECT_GE(pos.s_, laneSection.startS());
+        EXPECT_EQ(pos.laneIdx_, laneSection.laneIndexAt(pos.s_, pos.t_));
+        EXPECT_EQ(static_cast<bool>(pos.laneId_), pos.laneIdx_ >= 0);
+    }
+}
+
+TEST_P(RoadProjectorTest, testLaneCenters)
+{
+    RoadProjector projector(map_, RoadProjector::Options());
+
+    MapTessellator tessellator(map_);
+    tessellator.tessellate(MapTessellator::Options());
+
+    // The middle vertex of the center line of each lane is in that lane, if
+    // the road of the lane is the nearest one. It may not be where roads
+    // overlap, for example in junctions.
+    int numMatched = 0;
+    for (int roadIdx = 0; roadIdx < static_cast<int>(map_.roads().size()); roadIdx++)
+    {
+        const ArenaVector<LaneSection>& laneSections = map_.roads()[roadIdx].laneSections();
+        for (int i = 0; i < static_cast<int>(laneSections.size()); i++)
+        {
+            const ArenaVector<LaneSection::Lane>& lanes = laneSections[i].lanes();
+            for (int j = 0; j < static_cast<int>(lanes.size()); j++)
+            {
+                int globalLaneIdx = lanes[j].globalIndex();
+                MapTessellator::Polyline centerLine = tessellator.centerLine(globalLaneIdx);
+                int vertexIdx = centerLine.size_ / 2;
+                if (std::abs(tessellator.centerLineVariances(globalLaneIdx)[vertexIdx]) < 1e-3)
+                {
+                    continue;
+                }
+
+                RoadPosition pos = projector.project(centerLine.vertices_[vertexIdx]);
+                if (pos.roadIdx_ != roadIdx || pos.laneSectionIdx_ != i)
+                {
+                    continue;
+                }
+
+                numMatched++;
+                EXPECT_EQ(pos.laneIdx_, j);
+                ASSERT_TRUE(pos.laneId_);
+                EXPECT_EQ(*pos.laneId_, lanes[j].id());
+            }
+        }
+    }
+
+    EXPECT_GT(numMatched, 0);
+}
+
+TEST_P(RoadProjectorTest, testBatch)
+{
+    RoadProjector projector(map_, RoadProjector::Options());
+
+    for (int numThreads : {1, 3})
+    {
+        std::vector<RoadPosition> positions(points_.size());
+        projector.project(points_.data(), static_cast<int>(points_.size()), positions.data(), numThreads);
+
+        for (size_t i = 0; i < points_.size(); i++)
+        {
+            RoadPosition expected = projector.project(points_[i]);
+            EXPECT_EQ(positions[i].roadIdx_, expected.roadIdx_);
+            EXPECT_EQ(positions[i].s_, expected.s_);
+            EXPECT_EQ(positions[i].t_, expected.t_);
+            EXPECT_EQ(positions[i].laneIdx_, expected.laneIdx_);
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(Maps, RoadProjectorTest,
+                        testing::Values("Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                        "sample1.1.xodr"));
+
+}}  // namespace aid::xodr
@@ -0,0 +1,326 @@
+#include "xodr_map.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "../test_config.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Gets the distance from a point to a line segment.
+ */
+static double distanceToSegment(const Eigen::Vector2d& pt, const Eigen::Vector2d& a, const Eigen::Vector2d& b)
+{
+    Eigen::Vector2d ab = b - a;
+    double t = ab.squaredNorm() > 0 ? std::clamp((pt - a).dot(ab) / ab.squaredNorm(), 0.0, 1.0) : 0;
+    return (a + t * ab - pt).norm();
+}
+
+/**
+ * @brief Measures the maximum distance between the exact lane boundaries of a
+ * lane section (including the reference line itself) and the boundaries
+ * derived from the given tessellation of the reference line.
+ *
+ * The exact boundaries are sampled at a number of points in between each pair
+ * of consecutive tessellation vertices, and compared against the segment
+ * between those vertices.
+ */
+static double maxBoundaryError(const ReferenceLine& refLine, const LaneSection& laneSection,
+                               const ReferenceLine::Tessellation& tessellation)
+{
+    constexpr int NUM_SAMPLES_PER_SEGMENT = 16;
+
+    auto boundaries = laneSection.tessellateLaneBoundaryCurves(tessellation);
+
+    double maxError = 0;
+    for (int i = 0; i + 1 < static_cast<int>(tessellation.size()); i++)
+    {
+        ReferenceLine::Tessellation exact;
+        for (int j = 0; j <= NUM_SAMPLES_PER_SEGMENT; j++)
+        {
+            double s = tessellation[i].sCoord_ +
+                       (tessellation[i + 1].sCoord_ - tessellation[i].sCoord_) * j / NUM_SAMPLES_PER_SEGMENT;
+
+            ReferenceLine::PointAndTangentDir pt = refLine.eval(s);
+
+            ReferenceLine::Vertex vertex;
+            vertex.sCoord_ = s;
+            vertex.position_ = pt.point_;
+            vertex.heading_ = std::atan2(pt.tangentDir_.y(), pt.tangentDir_.x());
+            exact.push_back(vertex);
+        }
+
+        auto exactBoundaries = laneSection.tessellateLaneBoundaryCurves(exact);
+        for (int b = 0; b < static_cast<int>(boundaries.size()); b++)
+        {
+            for (const Eigen::Vector2d& pt : exactBoundaries[b].vertices_)
+            {
+                double error = distanceToSegment(pt, boundaries[b].vertices_[i], boundaries[b].vertices_[i + 1]);
+                maxError = std::max(maxError, error);
+            }
+        }
+    }
+
+    return maxError;
+}
+
+class TessellationTest : public testing::Test
+{
+  public:
+    TessellationTest()
+    {
+        map_ = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + "Roundabout8Course.xodr").extract_value();
+    }
+
+    XodrMap map_;
+};
+
+TEST_F(TessellationTest, testAdaptiveTessellationErrorBound)
+{
+    for (double maxError : {.1, .01, .001})
+    {
+        for (const Road& road : map_.roads())
+        {
+            const ReferenceLine& refLine = road.referenceLine();
+            for (const LaneSection& laneSection : road.laneSections())
+            {
+                ReferenceLine::TessellationTolerance tolerance =
+                    laneSection.boundaryTessellationTolerance(maxError);
+                auto tessellation = refLine.tessellate(laneSection.startS(), laneSection.endS(), tolerance);
+
+                ASSERT_GE(tessellation.size(), 2);
+                EXPECT_EQ(tessellation.front().sCoord_, laneSection.startS());
+                EXPECT_EQ(tessellation.back().sCoord_, laneSection.endS());
+
+                EXPECT_LE(maxBoundaryError(refLine, laneSection, tessellation), maxError)
+                    << "road " << road.id() << ", max error " << maxError;
+            }
+        }
+    }
+}
+
+TEST_F(TessellationTest, testAdaptiveTessellationVertexCount)
+{
+    // Find the error of the fixed rate tessellation, then tessellate
+    // adaptively with that error as the tolerance.
+    int numFixedVertices = 0;
+    double fixedMaxError = 0;
+    for (const Road& road : map_.roads())
+    {
+        for (const LaneSection& laneSection : road.laneSections())
+        {
+            auto tessellation = road.referenceLine().tessellate(laneSection.startS(), laneSection.endS());
+            numFixedVertices += static_cast<int>(tessellation.size());
+            fixedMaxError =
+                std::max(fixedMaxError, maxBoundaryError(road.referenceLine(), laneSection, tessellation));
+        }
+    }
+
+    int numAdaptiveVertices = 0;
+    for (const Road& road : map_.roads())
+    {
+        for (const LaneSection& laneSection : road.laneSections())
+        {
+            auto tessellation = road.referenceLine().tessellate(
+                laneSection.startS(), laneSection.endS(), laneSection.boundaryTessellationTolerance(fixedMaxError));
+            numAdaptiveVertices += static_cast<int>(tessellation.size());
+        }
+    }
+
+    // Most roads in this map are curved and wide, which limits the savings.
+    EXPECT_LT(numAdaptiveVertices * 3, numFixedVertices * 2)
+        << numAdaptiveVertices << " adaptive vs " << numFixedVertices << " fixed rate vertices for a max error of "
+        << fixedMaxError;
+}
+
+TEST(ReferenceLineTessellationTest, testAdaptiveTessellationOfEachGeometryType)
+{
+    // A continuous reference line with one geometry of each type.
+    const ReferenceLine refLine =
+        ReferenceLine::fromText(
+            "<planView>"
+            "  <geometry s='0' x='0' y='0' hdg='0' length='10'><line/></geometry>"
+            "  <geometry s='10' x='10' y='0' hdg='0' length='10'><spiral curvStart='0' curvEnd='0.05'/></geometry>"
+            "  <geometry s='20' x='19.937681' y='0.829620' hdg='0.25' length='10'><arc curvature='0.05'/></geometry>"
+            "  <geometry s='30' x='28.622377' y='5.574092' hdg='0.75' length='10'>"
+            "    <poly3 a='0' b='0' c='0.01' d='0'/>"
+            "  </geometry>"
+            "  <geometry s='40' x='35.218904' y='13.068386' hdg='0.946145' length='10'>"
+            "    <paramPoly3 aU='0' bU='10' cU='0' dU='0' aV='0' bV='0' cV='1' dV='0' pRange='normalized'/>"
+            "  </geometry>"
+            "</planView>")
+            .extract_value();
+
+    XodrReader laneSectionReader = XodrReader::fromText(
+        "<laneSection s='0'>"
+        "  <left>"
+        "    <lane id='1' type='driving' level='false'>"
+        "      <width sOffset='0' a='3' b='0.05' c='-0.002' d='0.00002'/>"
+        "    </lane>"
+        "  </left>"
+        "  <center>"
+        "    <lane id='0' type='driving' level='false'/>"
+        "  </center>"
+        "</laneSection>");
+    laneSectionReader.readStartElement("laneSection");
+    LaneSection laneSection = LaneSection::parseXml(laneSectionReader).extract_value();
+    laneSection.test_setEndS(refLine.endS());
+
+    // Without lateral offsets, the line needs no vertices besides its end points.
+    ReferenceLine::TessellationTolerance tolerance;
+    tolerance.maxError_ = .001;
+    auto tessellation = refLine.tessellate(0, refLine.endS(), tolerance);
+
+    EXPECT_EQ(tessellation[0].sCoord_, 0);
+    EXPECT_EQ(tessellation[1].sCoord_, 10);
+
+    // The varying lane width needs more vertices to bound the error of the
+    // lane boundary.
+    auto boundaryTessellation =
+        refLine.tessellate(0, refLine.endS(), laneSection.boundaryTessellationTolerance(.001));
+    EXPECT_GT(boundaryTessellation.size(), tessellation.size());
+    EXPECT_LE(maxBoundaryError(refLine, laneSection, boundaryTessellation), .001);
+
+    for (const ReferenceLine::Vertex& vertex : boundaryTessellation)
+    {
+        ReferenceLine::PointAndTangentDir expected = refLine.eval(vertex.sCoord_);
+        EXPECT_NEAR((vertex.position_ - expected.point_).norm(), 0, 1e-9);
+        EXPECT_NEAR(std::cos(vertex.heading_), expected.tangentDir_.x(), 1e-9);
+        EXPECT_NEAR(std::sin(vertex.heading_), expected.tangentDir_.y(), 1e-9);
+    }
+}
+
+TEST_F(TessellationTest, testTessellateIntoBuffers)
+{
+    ReferenceLine::Tessellation refLineTessellation;
+    LaneSection::LaneTessellationBuffer buffer;
+
+    // Tessellate twice: the second pass reuses the buffers, which are large
+    // enough by then, so it may not reallocate them.
+    for (int pass = 0; pass < 2; pass++)
+    {
+        const ReferenceLine::Vertex* refLineData = refLineTessellation.data();
+        const Eigen::Vector2d* boundaryData = buffer.boundaryVertices_.data();
+        const Eigen::Vector2d* centerLineData = buffer.centerLineVertices_.data();
+
+        for (const Road& road : map_.roads())
+        {
+            for (const LaneSection& laneSection : road.laneSections())
+            {
+                ReferenceLine::TessellationTolerance tolerance = laneSection.boundaryTessellationTolerance(.01);
+                ReferenceLine::Tessellation expectedRefLine =
+                    road.referenceLine().tessellate(laneSection.startS(), laneSection.endS(), tolerance);
+                road.referenceLine().tessellate(refLineTessellation, laneSection.startS(), laneSection.endS(),
+                                                tolerance);
+                ASSERT_EQ(refLineTessellation.size(), expectedRefLine.size());
+                for (int i = 0; i < static_cast<int>(expectedRefLine.size()); i++)
+                {
+                    EXPECT_EQ(refLineTessellation[i].position_, expectedRefLine[i].position_);
+                }
+
+                auto expected = laneSection.tessellateLaneBoundaryCurvesAndCenterLines(expectedRefLine);
+                laneSection.tessellateLaneBoundaryCurvesAndCenterLines(refLineTessellation, buffer);
+
+                ASSERT_EQ(buffer.numBoundaries(), static_cast<int>(expected.boundaryCurveTessellations_.size()));
+                for (int i = 0; i < buffer.numBoundaries(); i++)
+                {
+                    const auto& vertices = expected.boundaryCurveTessellations_[i].vertices_;
+                    ASSERT_EQ(buffer.boundarySize(i), static_cast<int>(vertices.size()));
+                    for (int j = 0; j < buffer.boundarySize(i); j++)
+                    {
+                        EXPECT_EQ(buffer.boundaryVertices(i)[j], vertices[j]);
+                    }
+                }
+
+                ASSERT_EQ(buffer.numCenterLines(), static_cast<int>(expected.centerLineTessellations_.size()));
+                for (int i = 0; i < buffer.numCenterLines(); i++)
+                {
+                    const auto& centerLine = expected.centerLineTessellations_[i];
+                    int offset = buffer.centerLineOffsets_[i];
+                    for (int j = 0; j < static_cast<int>(centerLine.vertices_.size()); j++)
+                    {
+                        EXPECT_EQ(buffer.centerLineVertices_[offset + j], centerLine.vertices_[j]);
+                        EXPECT_EQ(buffer.variances_[offset + j], centerLine.variances_[j]);
+                    }
+                }
+            }
+        }
+
+        if (pass == 1)
+        {
+            EXPECT_EQ(refLineTessellation.data(), refLineData);
+            EXPECT_EQ(buffer.boundaryVertices_.data(), boundaryData);
+            EXPECT_EQ(buffer.centerLineVertices_.data(), centerLineData);
+        }
+    }
+}
+
+TEST(FrenetFramesTest, testMatchesVertexTessellation)
+{
+    const char* const mapNames[] = {"Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                    "sample1.1.xodr"};
+
+    ReferenceLine::FrenetFrames frames;
+    LaneSection::LaneTessellationBuffer expected;
+    LaneSection::LaneTessellationBuffer actual;
+
+    for (const char* mapName : mapNames)
+    {
+        XodrMap map = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + mapName).extract_value();
+        for (const Road& road : map.roads())
+        {
+            const ReferenceLine& refLine = road.referenceLine();
+
+            // The fixed rate tessellation of the whole reference line.
+            ReferenceLine::Tessellation tessellation = refLine.tessellate(0, refLine.endS());
+            refLine.tessellate(frames, 0, refLine.endS());
+            ASSERT_EQ(frames.size(), static_cast<int>(tessellation.size()));
+            for (int i = 0; i < frames.size(); i++)
+            {
+                EXPECT_EQ(frames.sCoords_[i], tessellation[i].sCoord_);
+            }
+
+            for (const LaneSection& laneSection : road.laneSections())
+            {
+                ReferenceLine::TessellationTolerance tolerance = laneSection.boundaryTessellationTolerance(.01);
+                refLine.tessellate(tessellation, laneSection.startS(), laneSection.endS(), tolerance);
+                refLine.tessellate(frames, laneSection.startS(), laneSection.endS(), tolerance);
+
+                ASSERT_EQ(frames.size(), static_cast<int>(tessellation.size())) << mapName << ", road " << road.id();
+                for (int i = 0; i < frames.size(); i++)
+                {
+                    const ReferenceLine::Vertex& vertex = tessellation[i];
+                    EXPECT_EQ(frames.sCoords_[i], vertex.sCoord_);
+                    EXPECT_NEAR(frames.x_[i], vertex.position_.x(), 1e-9);
+                    EXPECT_NEAR(frames.y_[i], vertex.position_.y(), 1e-9);
+                    EXPECT_NEAR(frames.tangentX_[i], std::cos(vertex.heading_), 1e-9);
+                    EXPECT_NEAR(frames.tangentY_[i], std::sin(vertex.heading_), 1e-9);
+                    EXPECT_NEAR(frames.curvatures_[i], refLine.evalCurvature(vertex.sCoord_), 1e-9);
+                }
+
+                laneSection.tessellateLaneBoundaryCurvesAndCenterLines(tessellation, expected);
+                laneSection.tessellateLaneBoundaryCurvesAndCenterLines(frames, actual);
+
+                EXPECT_EQ(actual.boundaryOffsets_, expected.boundaryOffsets_);
+                EXPECT_EQ(actual.lateralPositions_, expected.lateralPositions_);
+                ASSERT_EQ(actual.boundaryVertices_.size(), expected.boundaryVertices_.size());
+                for (int i = 0; i < static_cast<int>(actual.boundaryVertices_.size()); i++)
+                {
+                    EXPECT_LT((actual.boundaryVertices_[i] - expected.boundaryVertices_[i]).norm(), 1e-8);
+                }
+
+                EXPECT_EQ(actual.centerLineOffsets_, expected.centerLineOffsets_);
+                ASSERT_EQ(actual.centerLineVertices_.size(), expected.centerLineVertices_.size());
+                for (int i = 0; i < static_cast<int>(actual.centerLineVertices_.size()); i++)
+                {
+                    EXPECT_LT((actual.centerLineVertices_[i] - expected.centerLineVertices_[i]).norm(), 1e-8);
+                    EXPECT_DOUBLE_EQ(actual.variances_[i], expected.variances_[i]);
+                }
+            }
+        }
+    }
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,217 @@
+#include "tessellation_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "../test_config.h"
+
+namespace aid { namespace xodr {
+
+class TessellationCacheTest : public testing::Test
+{
+  public:
+    TessellationCacheTest()
+    {
+        map_ = XodrMap::fromFile(std::string(MAP_DATA_PATH_PREFIX) + "sample1.1.xodr").extract_value();
+    }
+
+    std::vector<LaneSectionKey> allLaneSectionKeys() const
+    {
+        std::vector<LaneSectionKey> keys;
+        for (int roadIdx = 0; roadIdx < static_cast<int>(map_.roads().size()); roadIdx++)
+        {
+            for (int i = 0; i < static_cast<int>(map_.roads()[roadIdx].laneSections().size()); i++)
+            {
+                keys.emplace_back(roadIdx, i);
+            }
+        }
+        return keys;
+    }
+
+    XodrMap map_;
+};
+
+TEST_F(TessellationCacheTest, testMatchesLaneSectionTessellation)
+{
+    TessellationCache cache(map_, TessellationCache::Options());
+
+    ReferenceLine::FrenetFrames frames;
+    LaneSection::LaneTessellationBuffer expected;
+    for (LaneSectionKey key : allLaneSectionKeys())
+    {
+        for (int lod : {0, 3})
+        {
+            const Road& road = map_.roads()[key.roadIdx_];
+            const LaneSection& laneSection = road.laneSections()[key.laneSectionIdx_];
+            road.referenceLine().tessellate(frames, laneSection.startS(), laneSection.endS(),
+                                            laneSection.boundaryTessellationTolerance(cache.maxError(lod)));
+            laneSection.tessellateLaneBoundaryCurvesAndCenterLines(frames, expected);
+
+            std::shared_ptr<const TessellationCache::Entry> entry = cache.get(key, lod);
+            EXPECT_EQ(entry->refLine_.sCoords_, frames.sCoords_);
+            EXPECT_EQ(entry->lanes_.boundaryOffsets_, expected.boundaryOffsets_);
+            EXPECT_EQ(entry->lanes_.boundaryVertices_, expected.boundaryVertices_);
+            EXPECT_EQ(entry->lanes_.centerLineVertices_, expected.centerLineVertices_);
+        }
+    }
+}
+
+TEST_F(TessellationCacheTest, testHitsAndMisses)
+{
+    TessellationCache cache(map_, TessellationCache::Options());
+
+    std::shared_ptr<const TessellationCache::Entry> a = cache.get(LaneSectionKey(0, 0), 0);
+    std::shared_ptr<const TessellationCache::Entry> b = cache.get(LaneSectionKey(0, 0), 1);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(cache.get(LaneSectionKey(0, 0), 0), a);
+    EXPECT_EQ(cache.get(LaneSectionKey(0, 0), 1), b);
+    EXPECT_EQ(cache.find(LaneSectionKey(0, 0), 1), b);
+    EXPECT_EQ(cache.find(LaneSectionKey(0, 0), 2), nullptr);
+
+    // Coarser levels of detail have fewer vertices.
+    EXPECT_LE(b->refLine_.size(), a->refLine_.size());
+
+    TessellationCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.hits_, 2u);
+    EXPECT_EQ(stats.misses_, 2u);
+    EXPECT_EQ(stats.evictions_, 0u);
+    EXPECT_EQ(stats.numEntries_, 2);
+    EXPECT_EQ(stats.bytes_, a->memoryUsage() + b->memoryUsage());
+
+    cache.clear();
+    EXPECT_EQ(cache.find(LaneSectionKey(0, 0), 0), nullptr);
+    EXPECT_EQ(cache.stats().numEntries_, 0);
+    EXPECT_EQ(cache.stats().bytes_, 0u);
+
+    // Cleared entries stay valid while they're referenced.
+    EXPECT_GT(a->refLine_.size(), 0);
+}
+
+TEST_F(TessellationCacheTest, testLodForMaxError)
+{
+    TessellationCache::Options options;
+    options.maxError_ = .01;
+    options.numLods_ = 4;
+    TessellationCache cache(map_, options);
+
+    EXPECT_EQ(cache.maxError(0), .01);
+    EXPECT_EQ(cache.maxError(3), .08);
+
+    EXPECT_EQ(cache.lodForMaxError(.001), 0);
+    EXPECT_EQ(cache.lodForMaxError(.01), 0);
+    EXPECT_EQ(cache.lodForMaxError(.03), 1);
+    EXPECT_EQ(cache.lodForMaxError(.04), 2);
+    EXPECT_EQ(cache.lodForMaxError(1), 3);
+}
+
+TEST_F(TessellationCacheTest, testEvictsLeastRecentlyUsed)
+{
+    LaneSectionKey keyA(0, 0);
+    LaneSectionKey keyB(1, 0);
+    LaneSectionKey keyC(2, 0);
+
+    size_t bytesA, bytesB, bytesC;
+    {
+        TessellationCache cache(map_, TessellationCache::Options());
+        bytesA = cache.get(keyA, 0)->memoryUsage();
+        bytesB = cache.get(keyB, 0)->memoryUsage();
+        bytesC = cache.get(keyC, 0)->memoryUsage();
+    }
+
+    TessellationCache::Options options;
+    options.maxBytes_ = bytesA + bytesB + bytesC - 1;
+    TessellationCache cache(map_, options);
+
+    cache.get(keyA, 0);
+    cache.get(keyB, 0);
+    cache.get(keyA, 0);
+    cache.get(keyC, 0);
+
+    EXPECT_NE(cache.find(keyA, 0), nullptr);
+    EXPECT_EQ(cache.find(keyB, 0), nullptr);
+    EXPECT_NE(cache.find(keyC, 0), nullptr);
+
+    TessellationCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.evictions_, 1u);
+    EXPECT_EQ(stats.numEntries_, 2);
+    EXPECT_EQ(stats.bytes_, bytesA + bytesC);
+    EXPECT_LE(stats.bytes_, options.maxBytes_);
+}
+
+TEST_F(TessellationCacheTest, testPrecompute)
+{
+    TessellationCache::Options options;
+    options.numLods_ = 4;
+    TessellationCache cache(map_, options);
+    cache.precompute(1, 3, 3);
+
+    std::vector<LaneSectionKey> keys = allLaneSectionKeys();
+    for (LaneSectionKey key : keys)
+    {
+        EXPECT_EQ(cache.find(key, 0), nullptr);
+        for (int lod = 1; lod <= 3; lod++)
+        {
+            EXPECT_NE(cache.find(key, lod), nullptr);
+        }
+    }
+
+    TessellationCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.numEntries_, static_cast<int>(keys.size()) * 3);
+    EXPECT_EQ(stats.misses_, keys.size() * 3);
+    EXPECT_EQ(stats.hits_, 0u);
+}
+
+TEST_F(TessellationCacheTest, testConcurrentReaders)
+{
+    std::vector<LaneSectionKey> keys = allLaneSectionKeys();
+
+    // Small enough that entries are evicted while other threads use them.
+    TessellationCache::Options options;
+    options.numLods_ = 2;
+    options.maxBytes_ = 64 * 1024;
+    TessellationCache cache(map_, options);
+
+    const int numThreads = 4;
+    const int numIterations = 3;
+    std::vector<std::thread> threads;
+    std::vector<int> numMismatches(numThreads, 0);
+    for (int t = 0; t < numThreads; t++)
+    {
+        threads.emplace_back([&, t]() {
+            for (int it = 0; it < numIterations; it++)
+            {
+                for (size_t i = 0; i < keys.size(); i++)
+                {
+                    LaneSectionKey key = keys[(i + t) % keys.size()];
+                    int lod = (i + it) % 2;
+                    std::shared_ptr<const TessellationCache::Entry> entry = cache.get(key, lod);
+                    const LaneSection& laneSection = laneSectionByKey(map_, key);
+                    if (entry->lanes_.numBoundaries() != static_cast<int>(laneSection.lanes().size()) + 1)
+                    {
+                        numMismatches[t]++;
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (int t = 0; t < numThreads; t++)
+    {
+        EXPECT_EQ(numMismatches[t], 0);
+    }
+
+    TessellationCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.hits_ + stats.misses_, static_cast<uint64_t>(numThreads * numIterations * keys.size()));
+
+    // Threads which miss on the same entry at the same time both count a
+    // miss, but only one of them inserts it.
+    EXPECT_GE(stats.misses_ - stats.evictions_, static_cast<uint64_t>(stats.numEntries_));
+    EXPECT_GT(stats.evictions_, 0u);
+}
+
+}}  // namespace aid::xodr
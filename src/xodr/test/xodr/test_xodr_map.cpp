@@ -1,7 +1,12 @@
 #include "xodr_map.h"
+#include "binary/xodr_binary_serializer.h"
 
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
 #include "../test_config.h"
 
 namespace aid { namespace xodr {
@@ -151,4 +156,182 @@ TEST(XodrMapTest, testGlobalLaneIndex)
     EXPECT_EQ(xodrMap.totalNumLanes(), expectedGlobalIndex);
 }
 
+TEST(XodrMapTest, testParallelParse)
+{
+    const char* const fileNames[] = {"Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                     "sample1.1.xodr"};
+    for (const char* fileName : fileNames)
+    {
+        std::string path = std::string(MAP_DATA_PATH_PREFIX) + fileName;
+        XodrParseResult<XodrMap> sequential = XodrMap::fromFile(path);
+
+        for (int numThreads : {2, 3, 8})
+        {
+            XodrMap::ParseOptions options;
+            options.numThreads_ = numThreads;
+            XodrParseResult<XodrMap> parallel = XodrMap::fromFile(path, options);
+
+            // The serialized maps contain everything stored in an XodrMap,
+            // including the global lane indices.
+            EXPECT_EQ(XodrBinarySerializer::serialize(sequential.value()),
+                      XodrBinarySerializer::serialize(parallel.value()))
+                << fileName << ", " << numThreads << " threads";
+            EXPECT_EQ(sequential.errorMessages(), parallel.errorMessages());
+        }
+    }
+}
+
+TEST(XodrMapTest, testParallelParseErrors)
+{
+    const char* const fileNames[] = {"xodr/resolve_invalid_road_ref.xodr", "xodr/resolve_invalid_junction_ref.xodr"};
+    for (const char* fileName : fileNames)
+    {
+        std::string path = std::string(TEST_DATA_PATH_PREFIX) + fileName;
+        XodrParseResult<XodrMap> sequential = XodrMap::fromFile(path);
+
+        XodrMap::ParseOptions options;
+        options.numThreads_ = 4;
+        XodrParseResult<XodrMap> parallel = XodrMap::fromFile(path, options);
+
+        EXPECT_FALSE(parallel.hasValidConnectivity());
+        EXPECT_EQ(sequential.errorMessages(), parallel.errorMessages());
+    }
+}
+
+TEST(XodrMapTest, testLazyParse)
+{
+    const char* const fileNames[] = {"Crossing8Course.xodr", "CulDeSac.xodr", "Roundabout8Course.xodr",
+                                     "sample1.1.xodr"};
+    for (const char* fileName : fileNames)
+    {
+        std::string path = std::string(MAP_DATA_PATH_PREFIX) + fileName;
+        XodrParseResult<XodrMap> eager = XodrMap::fromFile(path);
+
+        XodrMap::ParseOptions options;
+        options.lazy_ = true;
+        XodrParseResult<XodrMap> lazy = XodrMap::fromFile(path, options);
+        EXPECT_TRUE(lazy.hasValidConnectivity()) << fileName;
+
+        const XodrMap& map = lazy.value();
+        ASSERT_EQ(map.roads().size(), eager.value().roads().size());
+        EXPECT_EQ(map.totalNumLanes(), eager.value().totalNumLanes());
+        for (const Road& road : map.roads())
+        {
+            EXPECT_FALSE(road.isBodyParsed());
+        }
+
+        // Accessing the body of a road only parses that road.
+        const Road& lastRoad = map.roads().back();
+        const Road& eagerLastRoad = eager.value().roads().back();
+        EXPECT_EQ(lastRoad.id(), eagerLastRoad.id());
+        EXPECT_EQ(lastRoad.laneSections().size(), eagerLastRoad.laneSections().size());
+        EXPECT_EQ(lastRoad.globalLaneIndicesBegin(), eagerLastRoad.globalLaneIndicesBegin());
+        EXPECT_TRUE(lastRoad.isBodyParsed());
+        EXPECT_FALSE(map.roads().front().isBodyParsed());
+
+        // The bodies can be parsed concurrently, and the result is identical
+        // to the eagerly parsed map.
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; i++)
+        {
+            threads.emplace_back([&map]() {
+                for (const Road& road : map.roads())
+                {
+                    road.parseBody();
+                }
+            });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        EXPECT_EQ(XodrBinarySerializer::serialize(eager.value()), XodrBinarySerializer::serialize(map)) << fileName;
+    }
+}
+
+TEST(XodrMapTest, testLazyParseBodyErrors)
+{
+    const char* text = R"(
+        <OpenDRIVE>
+            <header/>
+            <road name="" id="1" length="10" junction="-1">
+                <lanes>
+                    <laneSection s="0">
+                        <center><lane id="0" type="none"/></center>
+                        <right>
+                            <lane id="-1" type="driving"><width sOffset="0" a="3" b="0" c="0" d="0"/></lane>
+                        </right>
+                    </laneSection>
+                </lanes>
+            </road>
+        </OpenDRIVE>)";
+
+    std::string path = "lazy_parse_body_errors.xodr";
+    {
+        std::ofstream file(path);
+        file << text;
+    }
+
+    XodrMap::ParseOptions options;
+    options.lazy_ = true;
+    XodrParseResult<XodrMap> lazy = XodrMap::fromFile(path, options);
+    std::remove(path.c_str());
+
+    // The missing <planView> is only found when the body is parsed.
+    EXPECT_TRUE(lazy.errors().empty());
+    EXPECT_EQ(lazy.value().totalNumLanes(), 1);
+
+    const Road& road = lazy.value().roads().front();
+    ASSERT_EQ(road.bodyParseErrors().size(), 1u);
+    EXPECT_TRUE(road.bodyParseErrors().front().invalidatesRoadGeometry());
+    EXPECT_EQ(road.laneSections().front().lanes().back().globalIndex(), 0);
+}
+
+TEST(XodrMapTest, testArenaAllocation)
+{
+    std::string path = std::string(MAP_DATA_PATH_PREFIX) + "sample1.1.xodr";
+    XodrParseResult<XodrMap> parsed = XodrMap::fromFile(path);
+
+    // The map is moved out of the parse result, its objects keep referring to
+    // the arena, which moves along with it.
+    XodrMap map = std::move(parsed.value());
+
+    XodrMap::MemoryStats stats = map.memoryStats();
+    EXPECT_GT(stats.bytesAllocated_, 0u);
+    EXPECT_LE(stats.bytesAllocated_, stats.bytesReserved_);
+    EXPECT_LT(stats.numChunks_, 16u);
+
+    const Road& road = map.roads().front();
+    XodrArena* arena = map.roads().get_allocator().arena();
+    ASSERT_NE(arena, nullptr);
+    EXPECT_EQ(road.laneSections().get_allocator().arena(), arena);
+    EXPECT_EQ(road.laneSections().front().lanes().get_allocator().arena(), arena);
+
+    // Copies made outside of a parser are allocated from the heap, so they
+    // may outlive the map.
+    LaneSection copy = road.laneSections().front();
+    size_t numLanes = copy.lanes().size();
+    EXPECT_EQ(copy.lanes().get_allocator().arena(), nullptr);
+    map = XodrMap();
+    EXPECT_EQ(copy.lanes().size(), numLanes);
+    EXPECT_EQ(copy.lanes().back().widthPoly3s().get_allocator().arena(), nullptr);
+
+    // Maps loaded from binary files and parsed on multiple threads are
+    // allocated from arenas as well.
+    XodrMap::ParseOptions options;
+    options.numThreads_ = 2;
+    XodrParseResult<XodrMap> parallel = XodrMap::fromFile(path, options);
+    EXPECT_GT(parallel.value().memoryStats().bytesAllocated_, 0u);
+    EXPECT_NE(parallel.value().roads().get_allocator().arena(), nullptr);
+
+    std::vector<char> data = XodrBinarySerializer::serialize(parallel.value());
+    XodrMap loaded = XodrBinarySerializer::deserialize(
+        *reinterpret_cast<const XodrBinarySerializer::Header*>(data.data()),
+        data.data() + sizeof(XodrBinarySerializer::Header));
+    EXPECT_GT(loaded.memoryStats().bytesAllocated_, 0u);
+    EXPECT_NE(loaded.roads().front().laneSections().get_allocator().arena(), nullptr);
+}
+
 }}  // namespace aid::xodr
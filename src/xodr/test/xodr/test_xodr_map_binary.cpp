@@ -0,0 +1,175 @@
+#include "xodr_map.h"
+#include "binary/xodr_binary_serializer.h"
+#include "binary/binary_stream.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "../map_test_utils.h"
+#include "../test_config.h"
+
+namespace aid { namespace xodr {
+
+namespace {
+
+std::vector<char> readFile(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& fileName, const std::vector<char>& data)
+{
+    std::ofstream file(fileName, std::ios::binary);
+    file.write(data.data(), data.size());
+}
+
+void expectRoadsEqual(const Road& a, const Road& b)
+{
+    EXPECT_EQ(a.id(), b.id());
+    EXPECT_EQ(a.name(), b.name());
+    EXPECT_EQ(a.length(), b.length());
+
+    const ReferenceLine& aRefLine = a.referenceLine();
+    const ReferenceLine& bRefLine = b.referenceLine();
+    ASSERT_EQ(aRefLine.numGeometries(), bRefLine.numGeometries());
+    for (int i = 0; i < aRefLine.numGeometries(); i++)
+    {
+        EXPECT_EQ(aRefLine.geometry(i).geometryType(), bRefLine.geometry(i).geometryType());
+        EXPECT_EQ(aRefLine.geometry(i).length(), bRefLine.geometry(i).length());
+    }
+
+    for (double s = 0; s < aRefLine.endS(); s += aRefLine.endS() / 8)
+    {
+        EXPECT_EQ(aRefLine.eval(s).point_, bRefLine.eval(s).point_);
+        EXPECT_EQ(aRefLine.eval(s).tangentDir_, bRefLine.eval(s).tangentDir_);
+    }
+
+    ASSERT_EQ(a.laneSections().size(), b.laneSections().size());
+    for (size_t i = 0; i < a.laneSections().size(); i++)
+    {
+        const LaneSection& aSection = a.laneSections()[i];
+        const LaneSection& bSection = b.laneSections()[i];
+        EXPECT_EQ(aSection.startS(), bSection.startS());
+        EXPECT_EQ(aSection.endS(), bSection.endS());
+        ASSERT_EQ(aSection.lanes().size(), bSection.lanes().size());
+        for (size_t j = 0; j < aSection.lanes().size(); j++)
+        {
+            expectLanesEqual(aSection.lanes()[j], bSection.lanes()[j]);
+        }
+    }
+
+    ASSERT_EQ(a.roadObjects().size(), b.roadObjects().size());
+    for (size_t i = 0; i < a.roadObjects().size(); i++)
+    {
+        EXPECT_EQ(a.roadObjects()[i].id(), b.roadObjects()[i].id());
+        EXPECT_EQ(a.roadObjects()[i].type(), b.roadObjects()[i].type());
+        EXPECT_EQ(a.roadObjects()[i].hasOutlineGeometry(), b.roadObjects()[i].hasOutlineGeometry());
+    }
+
+    EXPECT_EQ(a.predecessor().elementType(), b.predecessor().elementType());
+    EXPECT_EQ(a.successor().elementType(), b.successor().elementType());
+}
+
+}  // namespace
+
+class XodrMapBinaryTest : public ::testing::Test, public ::testing::WithParamInterface<const char*>
+{
+};
+
+TEST_P(XodrMapBinaryTest, testRoundTrip)
+{
+    XodrMap map = loadXodrMap(GetParam());
+
+    std::string fileName = std::string(GetParam()) + ".bin";
+    map.saveBinary(fileName);
+    XodrMap loadedMap = XodrMap::fromBinary(fileName);
+    std::remove(fileName.c_str());
+
+    // Serializing the loaded map should result in exactly the same data, since
+    // the binary format contains everything which is stored in an XodrMap.
+    EXPECT_EQ(XodrBinarySerializer::serialize(map), XodrBinarySerializer::serialize(loadedMap));
+
+    EXPECT_EQ(map.totalNumLanes(), loadedMap.totalNumLanes());
+    EXPECT_EQ(map.hasGeoReference(), loadedMap.hasGeoReference());
+
+    ASSERT_EQ(map.roads().size(), loadedMap.roads().size());
+    for (size_t i = 0; i < map.roads().size(); i++)
+    {
+        expectRoadsEqual(map.roads()[i], loadedMap.roads()[i]);
+        EXPECT_EQ(loadedMap.roadIndexById(map.roads()[i].id()), static_cast<int>(i));
+    }
+
+    ASSERT_EQ(map.junctions().size(), loadedMap.junctions().size());
+    for (size_t i = 0; i < map.junctions().size(); i++)
+    {
+        const Junction& a = map.junctions()[i];
+        const Junction& b = loadedMap.junctions()[i];
+        EXPECT_EQ(a.id(), b.id());
+        EXPECT_EQ(loadedMap.junctionIndexById(a.id()), static_cast<int>(i));
+
+        ASSERT_EQ(a.connections().size(), b.connections().size());
+        for (size_t j = 0; j < a.connections().size(); j++)
+        {
+            EXPECT_EQ(a.connections()[j].incomingRoad().index(), b.connections()[j].incomingRoad().index());
+            EXPECT_EQ(a.connections()[j].connectingRoad().index(), b.connections()[j].connectingRoad().index());
+            EXPECT_EQ(a.connections()[j].laneLinks().size(), b.connections()[j].laneLinks().size());
+        }
+    }
+}
+
+TEST_P(XodrMapBinaryTest, testCorruptData)
+{
+    XodrMap map = loadXodrMap(GetParam());
+
+    std::string fileName = std::string(GetParam()) + ".corrupt.bin";
+    map.saveBinary(fileName);
+    std::vector<char> data = readFile(fileName);
+
+    // A flipped bit in the payload is caught by the checksum.
+    std::vector<char> flipped = data;
+    flipped[sizeof(XodrBinarySerializer::Header) + flipped.size() / 2] ^= 0x10;
+    writeFile(fileName, flipped);
+    EXPECT_ANY_THROW(XodrMap::fromBinary(fileName));
+
+    // Truncated files are rejected.
+    std::vector<char> truncated(data.begin(), data.end() - 1);
+    writeFile(fileName, truncated);
+    EXPECT_ANY_THROW(XodrMap::fromBinary(fileName));
+
+    // Other format versions are rejected.
+    std::vector<char> otherVersion = data;
+    XodrBinarySerializer::Header header;
+    std::memcpy(&header, otherVersion.data(), sizeof(header));
+    header.formatVersion_++;
+    std::memcpy(otherVersion.data(), &header, sizeof(header));
+    writeFile(fileName, otherVersion);
+    EXPECT_ANY_THROW(XodrMap::fromBinary(fileName));
+
+    std::remove(fileName.c_str());
+}
+
+TEST(BinaryReaderTest, testReadEnum)
+{
+    // Enums are written as their underlying type.
+    std::vector<int> values = {0, 3, static_cast<int>(LaneType::HOV), NUM_LANE_TYPES, -1};
+
+    // Enum values which are out of range would otherwise be used as out of
+    // bounds indices, e.g. by LaneRouter.
+    BinaryReader in(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(int));
+    EXPECT_EQ(in.readEnum(LaneType::HOV, "lane type"), LaneType::NONE);
+    EXPECT_EQ(in.readEnum(LaneType::HOV, "lane type"), LaneType::SHOULDER);
+    EXPECT_EQ(in.readEnum(LaneType::HOV, "lane type"), LaneType::HOV);
+    EXPECT_THROW(in.readEnum(LaneType::HOV, "lane type"), std::runtime_error);
+    EXPECT_THROW(in.readEnum(LaneType::HOV, "lane type"), std::runtime_error);
+    EXPECT_TRUE(in.atEnd());
+}
+
+INSTANTIATE_TEST_CASE_P(OpenDriveMaps, XodrMapBinaryTest,
+                        ::testing::Values<const char*>("Crossing8Course.xodr", "CulDeSac.xodr",
+                                                       "Roundabout8Course.xodr", "sample1.1.xodr"));
+
+}}  // namespace aid::xodr
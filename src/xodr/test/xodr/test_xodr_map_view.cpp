@@ -0,0 +1,228 @@
+#include "binary/xodr_map_view.h"
+#include "binary/xodr_binary_serializer.h"
+#include "xodr_map.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "../map_test_utils.h"
+#include "../test_config.h"
+
+namespace aid { namespace xodr {
+
+namespace {
+
+void expectRoadsEqual(const Road& a, const RoadView& b)
+{
+    EXPECT_EQ(a.id(), b.id());
+    EXPECT_EQ(a.name(), b.name());
+    EXPECT_EQ(a.length(), b.length());
+    EXPECT_EQ(a.junctionRef().id(), b.junctionRef().id());
+
+    const ReferenceLine& aRefLine = a.referenceLine();
+    ReferenceLineView bRefLine = b.referenceLine();
+    ASSERT_EQ(aRefLine.numGeometries(), bRefLine.numGeometries());
+    for (int i = 0; i < aRefLine.numGeometries(); i++)
+    {
+        EXPECT_EQ(aRefLine.geometry(i).geometryType(), bRefLine.geometry(i).geometryType());
+        EXPECT_EQ(aRefLine.geometry(i).length(), bRefLine.geometry(i).length());
+        EXPECT_EQ(aRefLine.geometry(i).startVertex().position_, bRefLine.geometry(i).startVertex().position_);
+    }
+    EXPECT_EQ(aRefLine.endS(), bRefLine.endS());
+
+    for (double s = 0; s < aRefLine.endS(); s += aRefLine.endS() / 16)
+    {
+        EXPECT_EQ(aRefLine.eval(s).point_, bRefLine.eval(s).point_);
+        EXPECT_EQ(aRefLine.eval(s).tangentDir_, bRefLine.eval(s).tangentDir_);
+        EXPECT_EQ(aRefLine.evalCurvature(s), bRefLine.evalCurvature(s));
+    }
+
+    ASSERT_EQ(a.hasElevationProfile(), b.hasElevationProfile());
+    if (a.hasElevationProfile())
+    {
+        ASSERT_EQ(a.elevationProfile().elevations().size(), b.elevationProfile().elevations().size());
+    }
+
+    ASSERT_EQ(a.laneSections().size(), b.laneSections().size());
+    for (size_t i = 0; i < a.laneSections().size(); i++)
+    {
+        const LaneSection& aSection = a.laneSections()[i];
+        LaneSectionView bSection = b.laneSections()[i];
+        EXPECT_EQ(aSection.startS(), bSection.startS());
+        EXPECT_EQ(aSection.endS(), bSection.endS());
+        EXPECT_EQ(aSection.singleSided(), bSection.singleSided());
+        EXPECT_EQ(aSection.numLeftLanes(), bSection.numLeftLanes());
+        EXPECT_EQ(aSection.numRightLanes(), bSection.numRightLanes());
+
+        ASSERT_EQ(aSection.lanes().size(), bSection.lanes().size());
+        for (size_t j = 0; j < aSection.lanes().size(); j++)
+        {
+            const LaneSection::Lane& aLane = aSection.lanes()[j];
+            expectLanesEqual(aLane, bSection.lanes()[j]);
+            EXPECT_EQ(bSection.laneIndexToId(static_cast<int>(j)), aLane.id());
+            EXPECT_EQ(bSection.laneById(aLane.id()).globalIndex(), aLane.globalIndex());
+
+            double midS = (aSection.endS() - aSection.startS()) / 2;
+            EXPECT_EQ(aLane.widthAtSCoord(midS), bSection.lanes()[j].widthAtSCoord(midS));
+        }
+    }
+
+    ASSERT_EQ(a.roadObjects().size(), b.roadObjects().size());
+    for (size_t i = 0; i < a.roadObjects().size(); i++)
+    {
+        EXPECT_EQ(a.roadObjects()[i].id(), b.roadObjects()[i].id());
+        EXPECT_EQ(a.roadObjects()[i].type(), b.roadObjects()[i].type());
+        EXPECT_EQ(a.roadObjects()[i].s(), b.roadObjects()[i].s());
+        EXPECT_EQ(a.roadObjects()[i].hasOutlineGeometry(), b.roadObjects()[i].hasOutlineGeometry());
+        if (a.roadObjects()[i].hasOutlineGeometry())
+        {
+            EXPECT_EQ(a.roadObjects()[i].outline().corners().size(),
+                      b.roadObjects()[i].outlineCorners().size());
+        }
+    }
+
+    EXPECT_EQ(a.predecessor().elementType(), b.predecessor().elementType());
+    EXPECT_EQ(a.successor().elementType(), b.successor().elementType());
+    if (a.predecessor().elementType() == RoadLink::ElementType::ROAD)
+    {
+        EXPECT_EQ(a.predecessor().contactPoint(), b.predecessor().contactPoint());
+        EXPECT_EQ(a.predecessor().elementRef().index(), b.predecessor().elementRef().index());
+    }
+}
+
+}  // namespace
+
+class XodrMapViewTest : public ::testing::Test, public ::testing::WithParamInterface<const char*>
+{
+};
+
+TEST_P(XodrMapViewTest, testMatchesXodrMap)
+{
+    XodrMap map = loadXodrMap(GetParam());
+
+    std::string fileName = std::string(GetParam()) + ".flat";
+    map.saveFlat(fileName);
+    XodrMapView view = XodrMapView::fromFile(fileName);
+    std::remove(fileName.c_str());
+
+    EXPECT_TRUE(view.verifyChecksum());
+    EXPECT_EQ(map.totalNumLanes(), view.totalNumLanes());
+    ASSERT_EQ(map.hasGeoReference(), view.hasGeoReference());
+    if (map.hasGeoReference())
+    {
+        EXPECT_EQ(map.geoReference(), view.geoReference());
+    }
+
+    ASSERT_EQ(map.roads().size(), view.roads().size());
+    for (size_t i = 0; i < map.roads().size(); i++)
+    {
+        const Road& road = map.roads()[i];
+        expectRoadsEqual(road, view.roads()[i]);
+
+        EXPECT_EQ(view.roadIndexById(road.id()), static_cast<int>(i));
+        ASSERT_TRUE(view.roadById(road.id()));
+        EXPECT_EQ(view.roadById(road.id())->id(), road.id());
+    }
+    EXPECT_EQ(view.roadIndexById("no such road"), -1);
+    EXPECT_FALSE(view.roadById("no such road"));
+
+    ASSERT_EQ(map.junctions().size(), view.junctions().size());
+    for (size_t i = 0; i < map.junctions().size(); i++)
+    {
+        const Junction& a = map.junctions()[i];
+        JunctionView b = view.junctions()[i];
+        EXPECT_EQ(a.id(), b.id());
+        EXPECT_EQ(a.name(), b.name());
+        EXPECT_EQ(view.junctionIndexById(a.id()), static_cast<int>(i));
+
+        ASSERT_EQ(a.connections().size(), b.connections().size());
+        for (size_t j = 0; j < a.connections().size(); j++)
+        {
+            const Junction::Connection& aConn = a.connections()[j];
+            ConnectionView bConn = b.connections()[j];
+            EXPECT_EQ(aConn.id(), bConn.id());
+            EXPECT_EQ(aConn.incomingRoad().index(), bConn.incomingRoad().index());
+            EXPECT_EQ(aConn.connectingRoad().index(), bConn.connectingRoad().index());
+            EXPECT_EQ(aConn.contactPoint(), bConn.contactPoint());
+
+            ASSERT_EQ(aConn.laneLinks().size(), bConn.laneLinks().size());
+            for (size_t k = 0; k < aConn.laneLinks().size(); k++)
+            {
+                EXPECT_EQ(aConn.laneLinks()[k].from(), bConn.laneLinks()[k].from());
+                EXPECT_EQ(aConn.laneLinks()[k].to(), bConn.laneLinks()[k].to());
+            }
+        }
+    }
+    EXPECT_EQ(view.junctionIndexById("no such junction"), -1);
+}
+
+TEST_P(XodrMapViewTest, testInvalidData)
+{
+    XodrMap map = loadXodrMap(GetParam());
+    std::vector<char> data = XodrBinarySerializer::serializeFlat(map);
+
+    // Copy the data into a buffer of 64 bit integers, to ensure it's aligned.
+    std::vector<uint64_t> buffer((data.size() + 7) / 8);
+    auto* bytes = reinterpret_cast<char*>(buffer.data());
+    std::memcpy(bytes, data.data(), data.size());
+
+    EXPECT_TRUE(XodrMapView::fromBuffer(bytes, data.size()).verifyChecksum());
+
+    // A flipped bit is caught by the checksum.
+    bytes[data.size() / 2 + sizeof(flat::Header) / 2] ^= 0x10;
+    EXPECT_FALSE(XodrMapView::fromBuffer(bytes, data.size()).verifyChecksum());
+    std::memcpy(bytes, data.data(), data.size());
+
+    // Truncated data is rejected.
+    EXPECT_ANY_THROW(XodrMapView::fromBuffer(bytes, data.size() - 8));
+    EXPECT_ANY_THROW(XodrMapView::fromBuffer(bytes, 4));
+
+    // Other format versions are rejected.
+    reinterpret_cast<flat::Header*>(bytes)->formatVersion_++;
+    EXPECT_ANY_THROW(XodrMapView::fromBuffer(bytes, data.size()));
+    std::memcpy(bytes, data.data(), data.size());
+
+    // Binary map data isn't a flat map.
+    std::vector<char> binary = XodrBinarySerializer::serialize(map);
+    std::vector<uint64_t> binaryBuffer((binary.size() + 7) / 8);
+    std::memcpy(binaryBuffer.data(), binary.data(), binary.size());
+    EXPECT_ANY_THROW(XodrMapView::fromBuffer(reinterpret_cast<char*>(binaryBuffer.data()), binary.size()));
+
+    EXPECT_ANY_THROW(XodrMapView::fromFile("no_such_file.flat"));
+}
+
+TEST(XodrMapViewCubicTest, testCubicGeometries)
+{
+    // The example maps have no (param)poly3 geometries, so use test maps which
+    // do.
+    for (const char* name : {"validate_poly3s.xodr", "validate_parampoly3s.xodr"})
+    {
+        XodrMap map =
+            XodrMap::fromFile(std::string(TEST_DATA_PATH_PREFIX) + "xodr/test_road_width_validation/" + name)
+                .extract_value();
+        std::vector<char> data = XodrBinarySerializer::serializeFlat(map);
+
+        std::vector<uint64_t> buffer((data.size() + 7) / 8);
+        std::memcpy(buffer.data(), data.data(), data.size());
+        XodrMapView view = XodrMapView::fromBuffer(reinterpret_cast<char*>(buffer.data()), data.size());
+
+        ASSERT_EQ(map.roads().size(), view.roads().size());
+        for (size_t i = 0; i < map.roads().size(); i++)
+        {
+            // The arc length tables are stored in the flat map.
+            GeometryView geometry = view.roads()[i].referenceLine().geometry(0);
+            ASSERT_NE(geometry.geometryType(), ReferenceLine::GeometryType::LINE);
+            EXPECT_FALSE(geometry.record().precomputed_.size_ == 0);
+
+            expectRoadsEqual(map.roads()[i], view.roads()[i]);
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(OpenDriveMaps, XodrMapViewTest,
+                        ::testing::Values<const char*>("Crossing8Course.xodr", "CulDeSac.xodr",
+                                                       "Roundabout8Course.xodr", "sample1.1.xodr"));
+
+}}  // namespace aid::xodr
@@ -3,7 +3,7 @@
 namespace aid { namespace xodr { namespace xml_parsers {
 
 template <>
-DistanceUnit parseXmlAttrib(const std::string& value)
+DistanceUnit parseXmlAttrib(std::string_view value)
 {
     if (value == "m")
     {
@@ -30,7 +30,7 @@ DistanceUnit parseXmlAttrib(const std::string& value)
 }
 
 template <>
-SpeedUnit parseXmlAttrib(const std::string& value)
+SpeedUnit parseXmlAttrib(std::string_view value)
 {
     if (value == "m/s")
     {
@@ -53,7 +53,7 @@ SpeedUnit parseXmlAttrib(const std::string& value)
 }
 
 template <>
-MassUnit parseXmlAttrib(const std::string& value)
+MassUnit parseXmlAttrib(std::string_view value)
 {
     if (value == "kg")
     {
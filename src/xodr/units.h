@@ -32,13 +32,13 @@ enum class MassUnit
 namespace xml_parsers {
 
 template <>
-DistanceUnit parseXmlAttrib(const std::string& value);
+DistanceUnit parseXmlAttrib(std::string_view value);
 
 template <>
-SpeedUnit parseXmlAttrib(const std::string& value);
+SpeedUnit parseXmlAttrib(std::string_view value);
 
 template <>
-MassUnit parseXmlAttrib(const std::string& value);
+MassUnit parseXmlAttrib(std::string_view value);
 
 }  // namespace xml_parsers
 
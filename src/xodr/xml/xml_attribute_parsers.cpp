@@ -1,26 +1,81 @@
 #include "xml/xml_attribute_parsers.h"
 
+#include <charconv>
+#include <stdexcept>
+
 namespace aid { namespace xodr { namespace xml_parsers {
+
+namespace {
+
+/**
+ * @brief Parses a number from the start of the given string.
+ *
+ * Like std::stoi and std::stod, leading white space and a leading '+' are
+ * skipped, and any characters following the number are ignored. Unlike those
+ * functions, the parsing is independent of the current locale.
+ *
+ * An std::invalid_argument exception is thrown if the string doesn't start
+ * with a number, and an std::out_of_range exception is thrown if the number
+ * can't be represented by T.
+ */
+template <class T>
+T parseNumber(std::string_view value)
+{
+    const char* first = value.data();
+    const char* last = value.data() + value.size();
+    while (first != last && (*first == ' ' || *first == '\t' || *first == '\n' || *first == '\r'))
+    {
+        first++;
+    }
+
+    // std::from_chars doesn't accept an explicit '+' sign, so it's skipped
+    // here. A '-' following it would be accepted though, so that case is
+    // rejected explicitly.
+    if (first != last && *first == '+')
+    {
+        first++;
+        if (first != last && *first == '-')
+        {
+            throw std::invalid_argument(std::string(value));
+        }
+    }
+
+    T ret;
+    std::from_chars_result res = std::from_chars(first, last, ret);
+    if (res.ec == std::errc::invalid_argument)
+    {
+        throw std::invalid_argument(std::string(value));
+    }
+    else if (res.ec == std::errc::result_out_of_range)
+    {
+        throw std::out_of_range(std::string(value));
+    }
+
+    return ret;
+}
+
+}  // namespace
+
 template <>
-int parseXmlAttrib<int>(const std::string& value)
+int parseXmlAttrib<int>(std::string_view value)
 {
-    return std::stoi(value);
+    return parseNumber<int>(value);
 }
 
 template <>
-double parseXmlAttrib<double>(const std::string& value)
+double parseXmlAttrib<double>(std::string_view value)
 {
-    return std::stod(value);
+    return parseNumber<double>(value);
 }
 
 template <>
-std::string parseXmlAttrib<std::string>(const std::string& value)
+std::string parseXmlAttrib<std::string>(std::string_view value)
 {
-    return value;
+    return std::string(value);
 }
 
 template <>
-bool parseXmlAttrib<bool>(const std::string& value)
+bool parseXmlAttrib<bool>(std::string_view value)
 {
     if (value == "true")
     {
@@ -40,7 +95,7 @@ bool parseXmlAttrib<bool>(const std::string& value)
     }
     else
     {
-        throw std::invalid_argument(value);
+        throw std::invalid_argument(std::string(value));
     }
 }
-}}}  // namespace aid::xodr::xml_parsers
\ No newline at end of file
+}}}  // namespace aid::xodr::xml_parsers
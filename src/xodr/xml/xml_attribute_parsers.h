@@ -1,8 +1,12 @@
 #pragma once
 
+#include <memory>
 #include <string>
-#include <functional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 
+#include "xml_name_table.h"
 #include "xml_parse_result.h"
 #include "xml_reader.h"
 
@@ -14,21 +18,25 @@ namespace xml_parsers {
  *
  * To add parsing support for your own types, simply create a new template
  * specialization.
+ *
+ * The value is passed as a view of the attribute value stored in the
+ * XmlReader, so parsers of non-string types don't need to copy it. Numbers are
+ * parsed independently of the current locale.
  */
 template <class T>
-T parseXmlAttrib(const std::string& value);
+T parseXmlAttrib(std::string_view value);
 
 template <>
-int parseXmlAttrib<int>(const std::string& value);
+int parseXmlAttrib<int>(std::string_view value);
 
 template <>
-double parseXmlAttrib<double>(const std::string& value);
+double parseXmlAttrib<double>(std::string_view value);
 
 template <>
-std::string parseXmlAttrib<std::string>(const std::string& value);
+std::string parseXmlAttrib<std::string>(std::string_view value);
 
 template <>
-bool parseXmlAttrib<bool>(const std::string& value);
+bool parseXmlAttrib<bool>(std::string_view value);
 
 }  // namespace xml_parsers
 
@@ -74,7 +82,8 @@ class XmlAttributeParsers
      *
      * @param name          The attribute name.
      * @param               A parser functor. This functor must have the
-     *                      signature void(const std::string& value, T& obj);
+     *                      signature void(std::string_view value, T& obj),
+     *                      and must not have any captures.
      * @param parseFailArgs Any arguments that should be passed to the
      *                      constructor of T::Error() on parser failure.
      *                      The first argument will always be the XmlParseError
@@ -178,9 +187,24 @@ class XmlAttributeParsers
     static void parseField(XmlReader& xml, T& result, const std::string& attribName, FieldT T::Value::*fieldPtr);
 
   private:
-    using ParseFunc = std::function<void(const std::string& value, T&)>;
-    using SetDefaultFunc = std::function<void(typename T::Value&)>;
-    using SetErrorFunc = std::function<void(XmlParseError error, T&)>;
+    struct Parser;
+
+    /**
+     * @brief The parse functions of a parser.
+     *
+     * These are plain function pointers to instantiations of the templated
+     * static functions below, which know the type of the parser's target and
+     * data. This way, no closures have to be stored and invoking a parser
+     * doesn't involve more than a direct call.
+     */
+    using ParseFunc = void (*)(const Parser& parser, std::string_view value, T& result);
+    using SetDefaultFunc = void (*)(const Parser& parser, typename T::Value& obj);
+    using SetErrorFunc = void (*)(const Parser& parser, XmlParseError error, T& result);
+
+    /**
+     * @brief The signature of the functors passed to @ref addParser.
+     */
+    using CustomParseFunc = void (*)(std::string_view value, T&);
 
     /**
      * Information for a single attribute parser.
@@ -201,9 +225,9 @@ class XmlAttributeParsers
          * The parser function.
          *
          * This function is called when an attribute with this parser's name
-         * is encountered. It's passed the attribute value and the target object
-         * and is in turn responsible for parsing the value and storing the
-         * result in the target object.
+         * is encountered. It's passed the parser itself, the attribute value
+         * and the target object and is in turn responsible for parsing the
+         * value and storing the result in the target object.
          */
         ParseFunc parseFunc_;
 
@@ -214,30 +238,103 @@ class XmlAttributeParsers
          * This function is only relevant for optional attribute parsers, since
          * setErrorFunc_ will be called if the attribute was not optional.
          */
-        SetDefaultFunc setDefaultFunc_;
+        SetDefaultFunc setDefaultFunc_ = nullptr;
 
         /**
          * A function which should be applied to the object if the attribute
          * was missing or an exception was thrown while parsing.
          */
         SetErrorFunc setErrorFunc_;
+
+        /**
+         * The member pointer (to a field or setter) or function pointer the
+         * parse functions operate on.
+         *
+         * Member pointers of different types can't be converted into each
+         * other, so the pointer is stored as raw bytes, and converted back by
+         * the parse functions, which know its type.
+         */
+        std::aligned_storage_t<2 * sizeof(void*), alignof(void*)> target_;
+
+        /**
+         * The default value and the parse fail arguments, stored in a
+         * ParserData object.
+         */
+        std::shared_ptr<const void> data_;
+
+        template <class TargetT>
+        void setTarget(TargetT target);
+
+        template <class TargetT>
+        TargetT target() const;
+
+        template <class DataT>
+        const DataT& data() const
+        {
+            return *static_cast<const DataT*>(data_.get());
+        }
     };
 
     /**
-     * A bit-mask which specifies whether a parser is optional. The bit at
-     * index i corresponds to the parser with index i in the parsers_ list.
-     *
-     * This value is computed by the finalize() function.
+     * @brief The data of a parser which is only needed when an attribute is
+     * missing or invalid.
+     */
+    template <class DefaultT, class... ParseFailArgs>
+    struct ParserData
+    {
+        DefaultT defaultValue_;
+        std::tuple<ParseFailArgs...> parseFailArgs_;
+    };
+
+    /**
+     * @brief The DefaultT of the ParserData of required parsers.
      */
-    uint32_t optionalMask_;
+    struct NoDefault
+    {
+    };
+
+    template <class... ParseFailArgs>
+    static Parser makeParser(const std::string& name, bool required, ParseFailArgs... parseFailArgs);
+
+    template <class DefaultT, class... ParseFailArgs>
+    static Parser makeOptionalParser(const std::string& name, DefaultT defaultValue, ParseFailArgs... parseFailArgs);
+
+    static void parseCustom(const Parser& parser, std::string_view value, T& result);
+
+    template <class FieldT>
+    static void parseIntoField(const Parser& parser, std::string_view value, T& result);
+
+    template <class SetterParamT>
+    static void parseIntoSetter(const Parser& parser, std::string_view value, T& result);
+
+    template <class FieldT, class DataT>
+    static void setFieldDefault(const Parser& parser, typename T::Value& obj);
+
+    template <class SetterParamT, class DataT>
+    static void setSetterDefault(const Parser& parser, typename T::Value& obj);
+
+    template <class DataT>
+    static void setError(const Parser& parser, XmlParseError error, T& result);
+
+    /**
+     * Whether finalize() has been called.
+     */
+    bool finalized_ = false;
 
     /**
      * A list of all parsers.
      *
-     * This list is sorted by name in the finalize function, to allow for binary
-     * searches on element names.
+     * This list is sorted by name in the finalize function, so missing
+     * attributes are reported in a deterministic order.
      */
     std::vector<Parser> parsers_;
+
+    /**
+     * Maps attribute names to indices in the parsers_ list.
+     *
+     * This table is built by the finalize() function.
+     */
+    XmlNameTable nameTable_;
 };
 
 }}  // namespace aid::xodr
@@ -1,16 +1,17 @@
 #include <sstream>
 #include <algorithm>
+#include <cstring>
 
 namespace aid { namespace xodr {
 
 namespace xml_parsers {
 template <class T>
-T parseXmlAttrib(const std::string& value)
+T parseXmlAttrib(std::string_view value)
 {
     auto parseResult = T::parse(value);
     if (!parseResult.errors().empty())
     {
-        throw std::invalid_argument(value);
+        throw std::invalid_argument(std::string(value));
     }
     return parseResult.value();
 }
@@ -20,80 +21,48 @@ template <class T>
 void XmlAttributeParsers<T>::parse(XmlReader& xml, T& result) const
 {
     // If this assert triggers then you probably forgot to call finalize.
-    assert(optionalMask_ != (uint32_t)-1);
+    assert(finalized_);
 
-    uint32_t visitedMask = 0;
+    XmlIndexSet visited(parsers_.size());
+    size_t numVisited = 0;
 
-    std::vector<XmlReader::Attrib> attribs = xml.getAttributes();
-
-    for (const XmlReader::Attrib& attrib : attribs)
+    for (const XmlReader::Attrib& attrib : xml.attributes())
     {
-        // Perform a binary search to find the parser for the attribute.
-
-        // The current search range consists of the parsers with index i
-        // satisfying min <= i < max.
-        int min = 0;
-        int max = static_cast<int>(parsers_.size());
-
-        while (true)
+        int index = nameTable_.find(attrib.name_);
+        if (index < 0)
         {
-            // If the current search range is empty, then no parser exists for
-            // the current attribute.
-            if (min == max)
-            {
-                // Skip attributes which don't have a parser in this XmlAttributeParsers.
-                result.errors().emplace_back(XmlParseError(XmlParseError::Category::UNEXPECTED_ATTRIBUTE,
-                                                           xml.getCurElementName(), attrib.value_));
-                break;
-            }
-
-            // Compute the index of the mid parser of the current search range.
-            int mid = (min + max) / 2;
-            int cmpRes = parsers_[mid].name_.compare(attrib.name_);
-            if (cmpRes < 0)
-            {
-                // The mid parser's name compares lower than the attribute's
-                // name, so we can narrow the search range to the part after the
-                // mid element.
-                min = mid + 1;
-            }
-            else if (cmpRes > 0)
-            {
-                // The mid parser's name compares higher than the attribute's
-                // name, so we can narrow the search range to the part before
-                // the mid element.
-                max = mid;
-            }
-            else
-            {
-                // The mid parser's name matches the attribute's name, so this
-                // is the parser we should use.
-
-                uint32_t mask = 1 << mid;
+            // Skip attributes which don't have a parser in this XmlAttributeParsers.
+            result.errors().emplace_back(XmlParseError(XmlParseError::Category::UNEXPECTED_ATTRIBUTE,
+                                                       xml.getCurElementName(), attrib.value_));
+            continue;
+        }
 
-                // Duplicated attributes aren't allowed in xml, so it would be
-                // a code error (of the xml parser) if it successfully parsed
-                // xml with duplicated attributes.
-                assert(!(visitedMask & mask));
+        // Duplicated attributes aren't allowed in xml, so it would be a code
+        // error (of the xml parser) if it successfully parsed xml with
+        // duplicated attributes. A duplicate mustn't be counted, or it would
+        // make up for a missing required attribute.
+        bool inserted = visited.insert(index);
+        assert(inserted);
+        if (!inserted)
+        {
+            continue;
+        }
+        numVisited++;
 
-                visitedMask |= mask;
-                try
-                {
-                    parsers_[mid].parseFunc_(attrib.value_.c_str(), result);
-                }
-                catch (const std::exception&)
-                {
-                    parsers_[mid].setErrorFunc_(XmlParseError(XmlParseError::Category::INVALID_ATTRIBUTE_VALUE,
-                                                              parsers_[mid].name_, attrib.value_),
-                                                result);
-                }
-                break;
-            }
+        const Parser& parser = parsers_[index];
+        try
+        {
+            parser.parseFunc_(parser, attrib.value_, result);
+        }
+        catch (const std::exception&)
+        {
+            parser.setErrorFunc_(
+                parser, XmlParseError(XmlParseError::Category::INVALID_ATTRIBUTE_VALUE, parser.name_, attrib.value_),
+                result);
         }
     }
 
-    uint32_t fullMask = (1 << static_cast<int>(parsers_.size())) - 1;
-    if (visitedMask != fullMask)
+    if (numVisited != parsers_.size())
     {
         // There are parsers which weren't invoked, so we either have to report
         // an error, or set the default value, depending on whether the parser
@@ -101,18 +70,20 @@ void XmlAttributeParsers<T>::parse(XmlReader& xml, T& result) const
 
         for (int i = 0; i < static_cast<int>(parsers_.size()); i++)
         {
-            if (!(visitedMask & (1 << i)))
+            if (!visited.contains(i))
             {
-                if (parsers_[i].required_)
+                const Parser& parser = parsers_[i];
+                if (parser.required_)
                 {
-                    parsers_[i].setErrorFunc_(XmlParseError(XmlParseError::Category::MISSING_ATTRIBUTE,
-                                                            xml.getCurElementName(), parsers_[i].name_),
-                                              result);
+                    parser.setErrorFunc_(parser,
+                                         XmlParseError(XmlParseError::Category::MISSING_ATTRIBUTE,
+                                                       xml.getCurElementName(), parser.name_),
+                                         result);
                 }
                 else
                 {
-                    assert(parsers_[i].setDefaultFunc_);
-                    parsers_[i].setDefaultFunc_(result.value());
+                    assert(parser.setDefaultFunc_);
+                    parser.setDefaultFunc_(parser, result.value());
                 }
             }
         }
@@ -123,16 +94,13 @@ template <class T>
 template <class ParseF, class... ParseFailArgs>
 void XmlAttributeParsers<T>::addParser(const std::string& name, ParseF&& parseF, ParseFailArgs... parseFailArgs)
 {
-    assert(parsers_.size() <= 31);
+    static_assert(std::is_convertible<ParseF, CustomParseFunc>::value,
+                  "The parser functor must have the signature void(std::string_view value, T& obj) and no captures.");
 
-    Parser parser;
-    parser.name_ = name;
-    parser.required_ = true;
-    parser.parseFunc_ = parseF;
-    parser.setErrorFunc_ = [parseFailArgs...](XmlParseError parseError, T& result) {
-        result.errors().emplace_back(std::move(parseError), parseFailArgs...);
-    };
-    parsers_.push_back(parser);
+    Parser parser = makeParser(name, true, parseFailArgs...);
+    parser.parseFunc_ = &parseCustom;
+    parser.setTarget(static_cast<CustomParseFunc>(parseF));
+    parsers_.push_back(std::move(parser));
 }
 
 template <class T>
@@ -140,44 +108,24 @@ template <class FieldT, class... ParseFailArgs>
 void XmlAttributeParsers<T>::addFieldParser(const std::string& name, FieldT T::Value::*fieldPtr,
                                             ParseFailArgs... parseFailArgs)
 {
-    assert(parsers_.size() <= 31);
-
-    Parser parser;
-    parser.name_ = name;
-    parser.required_ = true;
-
-    parser.parseFunc_ = [fieldPtr](const std::string& value, T& result) {
-        result.value().*fieldPtr = xml_parsers::parseXmlAttrib<FieldT>(value);
-    };
-
-    parser.setErrorFunc_ = [parseFailArgs...](XmlParseError parseError, T& result) {
-        result.errors().emplace_back(std::move(parseError), parseFailArgs...);
-    };
-    parsers_.push_back(parser);
-}  // namespace xodr
+    Parser parser = makeParser(name, true, parseFailArgs...);
+    parser.parseFunc_ = &parseIntoField<FieldT>;
+    parser.setTarget(fieldPtr);
+    parsers_.push_back(std::move(parser));
+}
 
 template <class T>
 template <class FieldT, class... ParseFailArgs>
 void XmlAttributeParsers<T>::addOptionalFieldParser(const std::string& name, FieldT T::Value::*fieldPtr,
                                                     FieldT defaultValue, ParseFailArgs... parseFailArgs)
 {
-    assert(parsers_.size() <= 31);
+    using DataT = ParserData<FieldT, ParseFailArgs...>;
 
-    Parser parser;
-    parser.name_ = name;
-    parser.required_ = false;
-
-    parser.parseFunc_ = [fieldPtr](const std::string& value, T& result) {
-        result.value().*fieldPtr = xml_parsers::parseXmlAttrib<FieldT>(value);
-    };
-
-    parser.setErrorFunc_ = [parseFailArgs...](XmlParseError parseError, T& result) {
-        result.errors().emplace_back(std::move(parseError), parseFailArgs...);
-    };
-
-    parser.setDefaultFunc_ = [fieldPtr, defaultValue](typename T::Value& res) { res.*fieldPtr = defaultValue; };
-
-    parsers_.push_back(parser);
+    Parser parser = makeOptionalParser(name, std::move(defaultValue), parseFailArgs...);
+    parser.parseFunc_ = &parseIntoField<FieldT>;
+    parser.setDefaultFunc_ = &setFieldDefault<FieldT, DataT>;
+    parser.setTarget(fieldPtr);
+    parsers_.push_back(std::move(parser));
 }
 
 template <class T>
@@ -185,72 +133,146 @@ template <class SetterParamT, class... ParseFailArgs>
 void XmlAttributeParsers<T>::addSetterParser(const std::string& name, void (T::Value::*setter)(SetterParamT),
                                              ParseFailArgs... parseFailArgs)
 {
-    assert(parsers_.size() <= 31);
+    Parser parser = makeParser(name, true, parseFailArgs...);
+    parser.parseFunc_ = &parseIntoSetter<SetterParamT>;
+    parser.setTarget(setter);
+    parsers_.push_back(std::move(parser));
+}
 
+template <class T>
+template <class SetterParamT, class... ParseFailArgs>
+void XmlAttributeParsers<T>::addOptionalSetterParser(const std::string& name, void (T::Value::*setter)(SetterParamT),
+                                                     SetterParamT defaultValue, ParseFailArgs... parseFailArgs)
+{
     using ValueT = typename std::decay<SetterParamT>::type;
+    using DataT = ParserData<ValueT, ParseFailArgs...>;
 
-    Parser parser;
-    parser.name_ = name;
-    parser.required_ = true;
+    Parser parser = makeOptionalParser(name, ValueT(defaultValue), parseFailArgs...);
+    parser.parseFunc_ = &parseIntoSetter<SetterParamT>;
+    parser.setDefaultFunc_ = &setSetterDefault<SetterParamT, DataT>;
+    parser.setTarget(setter);
+    parsers_.push_back(std::move(parser));
+}
 
-    parser.parseFunc_ = [setter, name, parseFailArgs...](const std::string& value, T& result) {
-        (result.value().*setter)(xml_parsers::parseXmlAttrib<ValueT>(value));
-    };
+template <class T>
+template <class FieldT>
+void XmlAttributeParsers<T>::parseField(XmlReader& xml, T& result, const std::string& attribName,
+                                        FieldT T::Value::*fieldPtr)
+{
+    result.value().*fieldPtr = xml_parsers::parseXmlAttrib<FieldT>(xml.getAttribute(attribName));
+}
 
-    parser.setErrorFunc_ = [parseFailArgs...](XmlParseError parseError, T& result) {
-        result.errors().emplace_back(std::move(parseError), parseFailArgs...);
-    };
+template <class T>
+void XmlAttributeParsers<T>::finalize()
+{
+    std::sort(parsers_.begin(), parsers_.end(), [](const Parser& a, const Parser& b) { return a.name_ < b.name_; });
 
-    parsers_.push_back(parser);
+    std::vector<std::string> names;
+    for (const Parser& parser : parsers_)
+    {
+        names.push_back(parser.name_);
+    }
+    nameTable_.build(names);
+
+    finalized_ = true;
 }
 
 template <class T>
-template <class SetterParamT, class... ParseFailArgs>
-void XmlAttributeParsers<T>::addOptionalSetterParser(const std::string& name, void (T::Value::*setter)(SetterParamT),
-                                                     SetterParamT defaultValue, ParseFailArgs... parseFailArgs)
+template <class TargetT>
+void XmlAttributeParsers<T>::Parser::setTarget(TargetT target)
+{
+    static_assert(sizeof(TargetT) <= sizeof(target_), "The parser target doesn't fit in the target storage.");
+    static_assert(std::is_trivially_copyable<TargetT>::value, "The parser target must be trivially copyable.");
+    std::memcpy(&target_, &target, sizeof(TargetT));
+}
+
+template <class T>
+template <class TargetT>
+TargetT XmlAttributeParsers<T>::Parser::target() const
 {
-    assert(parsers_.size() <= 31);
+    TargetT target;
+    std::memcpy(&target, &target_, sizeof(TargetT));
+    return target;
+}
 
-    using ValueT = typename std::decay<SetterParamT>::type;
+template <class T>
+template <class... ParseFailArgs>
+typename XmlAttributeParsers<T>::Parser XmlAttributeParsers<T>::makeParser(const std::string& name, bool required,
+                                                                           ParseFailArgs... parseFailArgs)
+{
+    using DataT = ParserData<NoDefault, ParseFailArgs...>;
+
+    Parser parser;
+    parser.name_ = name;
+    parser.required_ = required;
+    parser.setErrorFunc_ = &setError<DataT>;
+    parser.data_ = std::make_shared<const DataT>(DataT{NoDefault(), std::make_tuple(parseFailArgs...)});
+    return parser;
+}
+
+template <class T>
+template <class DefaultT, class... ParseFailArgs>
+typename XmlAttributeParsers<T>::Parser XmlAttributeParsers<T>::makeOptionalParser(const std::string& name,
+                                                                                   DefaultT defaultValue,
+                                                                                   ParseFailArgs... parseFailArgs)
+{
+    using DataT = ParserData<DefaultT, ParseFailArgs...>;
 
     Parser parser;
     parser.name_ = name;
     parser.required_ = false;
+    parser.setErrorFunc_ = &setError<DataT>;
+    parser.data_ = std::make_shared<const DataT>(DataT{std::move(defaultValue), std::make_tuple(parseFailArgs...)});
+    return parser;
+}
 
-    parser.parseFunc_ = [setter, name, parseFailArgs...](const std::string& value, T& result) {
-        (result.value().*setter)(xml_parsers::parseXmlAttrib<ValueT>(value));
-    };
+template <class T>
+void XmlAttributeParsers<T>::parseCustom(const Parser& parser, std::string_view value, T& result)
+{
+    parser.template target<CustomParseFunc>()(value, result);
+}
 
-    parser.setErrorFunc_ = [parseFailArgs...](XmlParseError parseError, T& result) {
-        result.errors().emplace_back(std::move(parseError), parseFailArgs...);
-    };
+template <class T>
+template <class FieldT>
+void XmlAttributeParsers<T>::parseIntoField(const Parser& parser, std::string_view value, T& result)
+{
+    auto fieldPtr = parser.template target<FieldT T::Value::*>();
+    result.value().*fieldPtr = xml_parsers::parseXmlAttrib<FieldT>(value);
+}
 
-    parser.setDefaultFunc_ = [setter, defaultValue](typename T::Value& obj) { (obj.*setter)(defaultValue); };
+template <class T>
+template <class SetterParamT>
+void XmlAttributeParsers<T>::parseIntoSetter(const Parser& parser, std::string_view value, T& result)
+{
+    using ValueT = typename std::decay<SetterParamT>::type;
 
-    parsers_.push_back(parser);
+    auto setter = parser.template target<void (T::Value::*)(SetterParamT)>();
+    (result.value().*setter)(xml_parsers::parseXmlAttrib<ValueT>(value));
 }
 
 template <class T>
-template <class FieldT>
-void XmlAttributeParsers<T>::parseField(XmlReader& xml, T& result, const std::string& attribName,
-                                        FieldT T::Value::*fieldPtr)
+template <class FieldT, class DataT>
+void XmlAttributeParsers<T>::setFieldDefault(const Parser& parser, typename T::Value& obj)
 {
-    result.value().*fieldPtr = xml_parsers::parseXmlAttrib<FieldT>(xml.getAttribute(attribName));
+    auto fieldPtr = parser.template target<FieldT T::Value::*>();
+    obj.*fieldPtr = parser.template data<DataT>().defaultValue_;
 }
 
 template <class T>
-void XmlAttributeParsers<T>::finalize()
+template <class SetterParamT, class DataT>
+void XmlAttributeParsers<T>::setSetterDefault(const Parser& parser, typename T::Value& obj)
 {
-    std::sort(parsers_.begin(), parsers_.end(), [](const Parser& a, const Parser& b) { return a.name_ < b.name_; });
+    auto setter = parser.template target<void (T::Value::*)(SetterParamT)>();
+    (obj.*setter)(parser.template data<DataT>().defaultValue_);
+}
 
-    optionalMask_ = 0;
-    for (int i = 0; i < static_cast<int>(parsers_.size()); i++)
-    {
-        if (!parsers_[i].required_)
-        {
-            optionalMask_ |= 1 << i;
-        }
-    }
+template <class T>
+template <class DataT>
+void XmlAttributeParsers<T>::setError(const Parser& parser, XmlParseError error, T& result)
+{
+    std::apply(
+        [&](const auto&... parseFailArgs) { result.errors().emplace_back(std::move(error), parseFailArgs...); },
+        parser.template data<DataT>().parseFailArgs_);
 }
 
 }}  // namespace aid::xodr
@@ -1,9 +1,12 @@
 #pragma once
 
-#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 #include <boost/optional.hpp>
 
+#include "xml_name_table.h"
 #include "xml_parse_result.h"
 #include "xml_reader.h"
 
@@ -113,6 +116,9 @@ class XmlChildElementParsers
      * @param parseF        The parse function. This function will be invoked
      *                      by the XmlReader::parse function each time it
      *                      encounters a child element with the given name.
+     *                      It must have the signature
+     *                      void(XmlReaderT& xml, T& result), and must not have
+     *                      any captures.
      * @param parseFailArgs Any arguments that should be passed to the
      *                      constructor of T::Error() on parser failure.
      *                      The first argument will always be the XmlParseError
@@ -249,8 +255,9 @@ class XmlChildElementParsers
      *                      The first argument will always be the XmlParseError
      *                      object that triggered the error.
      */
-    template <class ElemT, class... ParseFailArgs>
-    void addVectorElementParser(const std::string& name, std::vector<typename ElemT::Value> T::Value::*vectorPtr,
+    template <class ElemT, class Alloc, class... ParseFailArgs>
+    void addVectorElementParser(const std::string& name,
+                                std::vector<typename ElemT::Value, Alloc> T::Value::*vectorPtr,
                                 Multiplicity multiplicity, ParseFailArgs... parseFailArgs);
 
     /**
@@ -278,6 +285,8 @@ class XmlChildElementParsers
                                ParseFailArgs... parseFailArgs);
 
   private:
+    struct Parser;
+
     /**
      * @brief A parse function for a child element.
      *
@@ -287,10 +296,16 @@ class XmlChildElementParsers
      * child (so a valid parse function would be one which simply calls
      * skipToEndElement()).
      *
-     * The second parameter is the target object. This is the object where the
-     * result should be stored in.
+     * The first parameter is the parser itself, which holds the target member
+     * pointer. The last parameter is the target object. This is the object
+     * where the result should be stored in.
+     *
+     * This is a plain function pointer to an instantiation of one of the
+     * templated static functions below, which know the type of the parser's
+     * target and data, so invoking a parser doesn't involve more than a direct
+     * call.
      */
-    using ParseFunc = std::function<void(XmlReaderT&, T&)>;
+    using ParseFunc = void (*)(const Parser& parser, XmlReaderT&, T&);
 
     /**
      * @brief A function which sets a default value in a target object.
@@ -300,12 +315,17 @@ class XmlChildElementParsers
      * specified for a certain parser, then it will be invoked by the parse
      * function if no child element with the parser's name is found.
      */
-    using SetDefaultFunc = std::function<void(typename T::Value&)>;
+    using SetDefaultFunc = void (*)(const Parser& parser, typename T::Value&);
 
     /**
      * @brief A function which marks a parse result as failure.
      */
-    using SetErrorFunc = std::function<void(XmlParseError error, T& result)>;
+    using SetErrorFunc = void (*)(const Parser& parser, XmlParseError error, T& result);
+
+    /**
+     * @brief The signature of the functors passed to @ref addParser.
+     */
+    using CustomParseFunc = void (*)(XmlReaderT&, T&);
 
     struct Parser
     {
@@ -314,25 +334,101 @@ class XmlChildElementParsers
         bool allowMany_;
 
         ParseFunc parseFunc_;
-        SetDefaultFunc setDefaultFunc_;
+        SetDefaultFunc setDefaultFunc_ = nullptr;
         SetErrorFunc setErrorFunc_;
+
+        /**
+         * The member pointer (to a field or setter) or function pointer the
+         * parse functions operate on, stored as raw bytes. See
+         * XmlAttributeParsers::Parser::target_.
+         */
+        std::aligned_storage_t<2 * sizeof(void*), alignof(void*)> target_;
+
+        /**
+         * The default value and the parse fail arguments, stored in a
+         * ParserData object.
+         */
+        std::shared_ptr<const void> data_;
+
+        template <class TargetT>
+        void setTarget(TargetT target);
+
+        template <class TargetT>
+        TargetT target() const;
+
+        template <class DataT>
+        const DataT& data() const
+        {
+            return *static_cast<const DataT*>(data_.get());
+        }
     };
 
     /**
-     * A bit-mask which specifies whether a parser is optional. The bit at
-     * index i corresponds to the parser with index i in the parsers_ list.
-     *
-     * This value is computed by the finalize() function.
+     * @brief The data of a parser which is only needed when a child element is
+     * missing or invalid.
      */
-    uint32_t optionalMask_ = (uint32_t)-1;
+    template <class DefaultT, class... ParseFailArgs>
+    struct ParserData
+    {
+        DefaultT defaultValue_;
+        std::tuple<ParseFailArgs...> parseFailArgs_;
+    };
+
+    /**
+     * @brief The DefaultT of the ParserData of parsers without a default value.
+     */
+    struct NoDefault
+    {
+    };
+
+    template <class DefaultT, class... ParseFailArgs>
+    static Parser makeParser(const std::string& name, Multiplicity multiplicity, DefaultT defaultValue,
+                             ParseFailArgs... parseFailArgs);
+
+    static void parseCustom(const Parser& parser, XmlReaderT& xml, T& result);
+
+    template <class FieldT, class TargetT>
+    static void parseIntoField(const Parser& parser, XmlReaderT& xml, T& result);
+
+    template <class ValueT>
+    static void parseIntoSetter(const Parser& parser, XmlReaderT& xml, T& result);
+
+    template <class ElemT, class VectorT>
+    static void parseIntoVector(const Parser& parser, XmlReaderT& xml, T& result);
+
+    template <class FieldT, class DataT>
+    static void setFieldDefault(const Parser& parser, typename T::Value& obj);
+
+    template <class FieldT>
+    static void setOptionalFieldDefault(const Parser& parser, typename T::Value& obj);
+
+    template <class ValueT, class DataT>
+    static void setSetterDefault(const Parser& parser, typename T::Value& obj);
+
+    static void setNoDefault(const Parser& parser, typename T::Value& obj);
+
+    template <class DataT>
+    static void setError(const Parser& parser, XmlParseError error, T& result);
+
+    /**
+     * Whether finalize() has been called.
+     */
+    bool finalized_ = false;
 
     /**
      * A list of all parsers.
      *
-     * This list is sorted by name in the finalize function, to allow for binary
-     * searches on element names.
+     * This list is sorted by name in the finalize function, so missing child
+     * elements are reported in a deterministic order.
      */
     std::vector<Parser> parsers_;
+
+    /**
+     * Maps element names to indices in the parsers_ list.
+     *
+     * This table is built by the finalize() function.
+     */
+    XmlNameTable nameTable_;
 };
 
 }}  // namespace aid::xodr
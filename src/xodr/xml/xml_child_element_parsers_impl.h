@@ -1,5 +1,6 @@
 #include <sstream>
 #include <algorithm>
+#include <cstring>
 
 namespace aid { namespace xodr {
 
@@ -7,82 +8,45 @@ template <class XmlReaderT, class T>
 void XmlChildElementParsers<XmlReaderT, T>::parse(XmlReaderT& xml, T& result) const
 {
     // If this assert triggers then you probably forgot to call finalize.
-    assert(optionalMask_ != (uint32_t)-1);
+    assert(finalized_);
 
-    uint32_t visitedMask = 0;
+    XmlIndexSet visited(parsers_.size());
+    size_t numVisited = 0;
 
     std::string parentName = xml.getCurElementName();
     while (!xml.tryReadEndElement())
     {
         xml.readStartElement();
 
-        // Perform a binary search to find the parser for the element with name xml.getCurElementName().
-
-        // The current search range consists of the parsers with index i
-        // satisfying min <= i < max.
-        int min = 0;
-        int max = static_cast<int>(parsers_.size());
-
-        while (true)
+        int index = nameTable_.find(xml.getCurElementName());
+        if (index < 0)
         {
-            // If the current search range is empty, then no parser exists for
-            // the current element.
-            if (min == max)
-            {
-                // Skip elements which don't have a parser.
-                result.errors().emplace_back(XmlParseError(XmlParseError::Category::UNEXPECTED_CHILD_ELEMENT,
-                                                           parentName, xml.getCurElementName()));
-
-                xml.skipToEndElement();
-                break;
-            }
-
-            // Compute the index of the mid parser of the current search range.
-            int mid = (min + max) / 2;
-            int cmpRes = parsers_[mid].name_.compare(xml.getCurElementName());
-            if (cmpRes < 0)
-            {
-                // The mid parser's name compares lower than the element's name,
-                // so we can narrow the search range to the part after the mid element.
-                min = mid + 1;
-            }
-            else if (cmpRes > 0)
-            {
-                // The mid parser's name compares higher than the element's
-                // name, so we can narrow the search range to the part before
-                // the mid element.
-                max = mid;
-            }
-            else
-            {
-                // The mid parser's name matches the element's name, so this is
-                // the parser we should use.
+            // Skip elements which don't have a parser.
+            result.errors().emplace_back(XmlParseError(XmlParseError::Category::UNEXPECTED_CHILD_ELEMENT, parentName,
+                                                       xml.getCurElementName()));
 
-                uint32_t mask = 1 << mid;
-                if (visitedMask & mask)
-                {
-                    // We already parsed a similar element, so it depends on
-                    // allowMany_ whether we allow this, or whether it's an error.
-
-                    if (!parsers_[mid].allowMany_)
-                    {
-                        parsers_[mid].setErrorFunc_(XmlParseError(XmlParseError::Category::DUPLICATE_CHILD_ELEMENT,
-                                                                  parentName, parsers_[mid].name_),
-                                                    result);
-                    }
-                }
-                else
-                {
-                    visitedMask |= mask;
-                }
+            xml.skipToEndElement();
+            continue;
+        }
 
-                parsers_[mid].parseFunc_(xml, result);
-                break;
-            }
+        const Parser& parser = parsers_[index];
+        if (visited.insert(index))
+        {
+            numVisited++;
         }
+        else if (!parser.allowMany_)
+        {
+            // We already parsed a similar element, and this type of element
+            // isn't allowed to be repeated.
+            parser.setErrorFunc_(
+                parser, XmlParseError(XmlParseError::Category::DUPLICATE_CHILD_ELEMENT, parentName, parser.name_),
+                result);
+        }
+
+        parser.parseFunc_(parser, xml, result);
     }
-    uint32_t fullMask = (1 << static_cast<int>(parsers_.size())) - 1;
-    if (visitedMask != fullMask)
+
+    if (numVisited != parsers_.size())
     {
         // There are parsers which weren't invoked, so we either have to report
         // an error, or set the default value, depending on whether the parser
@@ -90,18 +54,20 @@ void XmlChildElementParsers<XmlReaderT, T>::parse(XmlReaderT& xml, T& result) co
 
         for (int i = 0; i < static_cast<int>(parsers_.size()); i++)
         {
-            if (!(visitedMask & (1 << i)))
+            if (!visited.contains(i))
             {
-                if (parsers_[i].required_)
+                const Parser& parser = parsers_[i];
+                if (parser.required_)
                 {
-                    parsers_[i].setErrorFunc_(
-                        XmlParseError(XmlParseError::Category::MISSING_CHILD_ELEMENT, parentName, parsers_[i].name_),
+                    parser.setErrorFunc_(
+                        parser,
+                        XmlParseError(XmlParseError::Category::MISSING_CHILD_ELEMENT, parentName, parser.name_),
                         result);
                 }
                 else
                 {
-                    assert(parsers_[i].setDefaultFunc_);
-                    parsers_[i].setDefaultFunc_(result.value());
+                    assert(parser.setDefaultFunc_);
+                    parser.setDefaultFunc_(parser, result.value());
                 }
             }
         }
@@ -113,17 +79,13 @@ template <class ParseF, class... ParseFailArgs>
 void XmlChildElementParsers<XmlReaderT, T>::addParser(const std::string& name, Multiplicity multiplicity,
                                                       ParseF&& parse, ParseFailArgs... parseFailArgs)
 {
-    assert(parsers_.size() <= 31);
+    static_assert(std::is_convertible<ParseF, CustomParseFunc>::value,
+                  "The parser functor must have the signature void(XmlReaderT& xml, T& result) and no captures.");
 
-    Parser parser;
-    parser.name_ = name;
-    parser.required_ = multiplicity == Multiplicity::ONE || multiplicity == Multiplicity::ONE_OR_MORE;
-    parser.allowMany_ = multiplicity == Multiplicity::ZERO_OR_MORE || multiplicity == Multiplicity::ONE_OR_MORE;
-    parser.parseFunc_ = std::move(parse);
-    parser.setDefaultFunc_ = [](typename T::Value&) {};
-    parser.setErrorFunc_ = [parseFailArgs...](XmlParseError parseError, T& result) {
-        result.errors().emplace_back(std::move(parseError), parseFailArgs...);
-    };
+    Parser parser = makeParser(name, multiplicity, NoDefault(), parseFailArgs...);
+    parser.parseFunc_ = &parseCustom;
+    parser.setDefaultFunc_ = &setNoDefault;
+    parser.setTarget(static_cast<CustomParseFunc>(parse));
     parsers_.push_back(std::move(parser));
 }
 
@@ -133,24 +95,10 @@ void XmlChildElementParsers<XmlReaderT, T>::addFieldParser(const std::string& na
                                                            typename FieldT::Value T::Value::*fieldPtr,
                                                            ParseFailArgs... parseFailArgs)
 {
-    assert(parsers_.size() <= 31);
-
-    Parser parser;
-    parser.name_ = name;
-    parser.required_ = true;
-    parser.allowMany_ = false;
-
-    parser.parseFunc_ = [fieldPtr](XmlReaderT& xml, T& result) {
-        auto childParseRes = xml_parsers::parseXmlElem<XmlReaderT, FieldT>(xml);
-        result.value().*fieldPtr = std::move(childParseRes.value());
-        result.appendErrors(childParseRes);
-    };
-
-    parser.setErrorFunc_ = [parseFailArgs...](XmlParseError parseError, T& result) {
-        result.errors().emplace_back(std::move(parseError), parseFailArgs...);
-    };
-
-    parsers_.push_back(parser);
+    Parser parser = makeParser(name, Multiplicity::ONE, NoDefault(), parseFailArgs...);
+    parser.parseFunc_ = &parseIntoField<FieldT, typename FieldT::Value>;
+    parser.setTarget(fieldPtr);
+    parsers_.push_back(std::move(parser));
 }
 
 template <class XmlReaderT, class T>
@@ -160,26 +108,13 @@ void XmlChildElementParsers<XmlReaderT, T>::addOptionalFieldParser(const std::st
                                                                    typename FieldT::Value defaultValue,
                                                                    ParseFailArgs... parseFailArgs)
 {
-    assert(parsers_.size() <= 31);
-
-    Parser parser;
-    parser.name_ = name;
-    parser.required_ = false;
-    parser.allowMany_ = false;
-
-    parser.parseFunc_ = [fieldPtr](XmlReaderT& xml, T& result) {
-        auto childParseRes = xml_parsers::parseXmlElem<XmlReaderT, FieldT>(xml);
-        result.value().*fieldPtr = std::move(childParseRes.value());
-        result.appendErrors(childParseRes);
-    };
+    using DataT = ParserData<typename FieldT::Value, ParseFailArgs...>;
 
-    parser.setDefaultFunc_ = [fieldPtr, defaultValue](typename T::Value& obj) { obj.*fieldPtr = defaultValue; };
-
-    parser.setErrorFunc_ = [parseFailArgs...](XmlParseError parseError, T& result) {
-        result.errors().emplace_back(std::move(parseError), parseFailArgs...);
-    };
-
-    parsers_.push_back(parser);
+    Parser parser = makeParser(name, Multiplicity::ZERO_OR_ONE, std::move(defaultValue), parseFailArgs...);
+    parser.parseFunc_ = &parseIntoField<FieldT, typename FieldT::Value>;
+    parser.setDefaultFunc_ = &setFieldDefault<typename FieldT::Value, DataT>;
+    parser.setTarget(fieldPtr);
+    parsers_.push_back(std::move(parser));
 }
 
 template <class XmlReaderT, class T>
@@ -188,54 +123,24 @@ void XmlChildElementParsers<XmlReaderT, T>::addOptionalFieldParser(
     const std::string& name, boost::optional<typename FieldT::Value> T::Value::*fieldPtr,
     ParseFailArgs... parseFailArgs)
 {
-    assert(parsers_.size() <= 31);
-
-    Parser parser;
-    parser.name_ = name;
-    parser.required_ = false;
-    parser.allowMany_ = false;
-
-    parser.parseFunc_ = [fieldPtr](XmlReaderT& xml, T& result) {
-        auto childParseRes = xml_parsers::parseXmlElem<XmlReaderT, FieldT>(xml);
-        result.value().*fieldPtr = std::move(childParseRes.value());
-        result.appendErrors(childParseRes);
-    };
-
-    parser.setDefaultFunc_ = [fieldPtr](typename T::Value& obj) { obj.*fieldPtr = boost::none; };
-
-    parser.setErrorFunc_ = [parseFailArgs...](XmlParseError parseError, T& result) {
-        result.errors().emplace_back(std::move(parseError), parseFailArgs...);
-    };
-
-    parsers_.push_back(parser);
+    Parser parser = makeParser(name, Multiplicity::ZERO_OR_ONE, NoDefault(), parseFailArgs...);
+    parser.parseFunc_ = &parseIntoField<FieldT, boost::optional<typename FieldT::Value>>;
+    parser.setDefaultFunc_ = &setOptionalFieldDefault<typename FieldT::Value>;
+    parser.setTarget(fieldPtr);
+    parsers_.push_back(std::move(parser));
 }
 
 template <class XmlReaderT, class T>
-template <class ElemT, class... ParseFailArgs>
+template <class ElemT, class Alloc, class... ParseFailArgs>
 void XmlChildElementParsers<XmlReaderT, T>::addVectorElementParser(
-    const std::string& name, std::vector<typename ElemT::Value> T::Value::*vectorPtr, Multiplicity multiplicity,
-    ParseFailArgs... parseFailArgs)
+    const std::string& name, std::vector<typename ElemT::Value, Alloc> T::Value::*vectorPtr,
+    Multiplicity multiplicity, ParseFailArgs... parseFailArgs)
 {
-    assert(parsers_.size() <= 31);
-
-    Parser parser;
-    parser.name_ = name;
-    parser.required_ = multiplicity == Multiplicity::ONE || multiplicity == Multiplicity::ONE_OR_MORE;
-    parser.allowMany_ = multiplicity == Multiplicity::ZERO_OR_MORE || multiplicity == Multiplicity::ONE_OR_MORE;
-
-    parser.parseFunc_ = [vectorPtr](XmlReaderT& xml, T& result) {
-        auto childParseRes = xml_parsers::parseXmlElem<XmlReaderT, ElemT>(xml);
-        (result.value().*vectorPtr).push_back(std::move(childParseRes.value()));
-        result.appendErrors(childParseRes);
-    };
-
-    parser.setDefaultFunc_ = [](typename T::Value&) {};
-
-    parser.setErrorFunc_ = [parseFailArgs...](XmlParseError parseError, T& result) {
-        result.errors().emplace_back(std::move(parseError), parseFailArgs...);
-    };
-
-    parsers_.push_back(parser);
+    Parser parser = makeParser(name, multiplicity, NoDefault(), parseFailArgs...);
+    parser.parseFunc_ = &parseIntoVector<ElemT, std::vector<typename ElemT::Value, Alloc>>;
+    parser.setDefaultFunc_ = &setNoDefault;
+    parser.setTarget(vectorPtr);
+    parsers_.push_back(std::move(parser));
 }
 
 template <class XmlReaderT, class T>
@@ -244,23 +149,10 @@ void XmlChildElementParsers<XmlReaderT, T>::addSetterParser(const std::string& n
                                                             void (T::Value::*setter)(typename ValueT::Value),
                                                             ParseFailArgs... parseFailArgs)
 {
-    assert(parsers_.size() <= 31);
-
-    Parser parser;
-    parser.name_ = name;
-    parser.required_ = true;
-    parser.allowMany_ = false;
-    parser.parseFunc_ = [setter](XmlReaderT& xml, T& result) {
-        auto childParseRes = xml_parsers::parseXmlElem<XmlReaderT, ValueT>(xml);
-        (result.value().*setter)(std::move(childParseRes.value()));
-        result.appendErrors(childParseRes);
-    };
-
-    parser.setErrorFunc_ = [parseFailArgs...](XmlParseError parseError, T& result) {
-        result.errors().emplace_back(std::move(parseError), parseFailArgs...);
-    };
-
-    parsers_.push_back(parser);
+    Parser parser = makeParser(name, Multiplicity::ONE, NoDefault(), parseFailArgs...);
+    parser.parseFunc_ = &parseIntoSetter<ValueT>;
+    parser.setTarget(setter);
+    parsers_.push_back(std::move(parser));
 }
 
 template <class XmlReaderT, class T>
@@ -270,24 +162,13 @@ void XmlChildElementParsers<XmlReaderT, T>::addOptionalSetterParser(const std::s
                                                                     typename ValueT::Value defaultValue,
                                                                     ParseFailArgs... parseFailArgs)
 {
-    assert(parsers_.size() <= 31);
+    using DataT = ParserData<typename ValueT::Value, ParseFailArgs...>;
 
-    Parser parser;
-    parser.name_ = name;
-    parser.required_ = false;
-    parser.allowMany_ = false;
-    parser.parseFunc_ = [setter](XmlReaderT& xml, T& result) {
-        auto childParseRes = xml_parsers::parseXmlElem<XmlReaderT, ValueT>(xml);
-        (result.value().*setter)(std::move(childParseRes.value()));
-        result.appendErrors(childParseRes);
-    };
-    parser.setDefaultFunc_ = [setter, defaultValue](typename T::Value& obj) { (obj.*setter)(defaultValue); };
-
-    parser.setErrorFunc_ = [parseFailArgs...](XmlParseError parseError, T& result) {
-        result.errors().emplace_back(std::move(parseError), parseFailArgs...);
-    };
-
-    parsers_.push_back(parser);
+    Parser parser = makeParser(name, Multiplicity::ZERO_OR_ONE, std::move(defaultValue), parseFailArgs...);
+    parser.parseFunc_ = &parseIntoSetter<ValueT>;
+    parser.setDefaultFunc_ = &setSetterDefault<ValueT, DataT>;
+    parser.setTarget(setter);
+    parsers_.push_back(std::move(parser));
 }
 
 template <class XmlReaderT, class T>
@@ -295,14 +176,14 @@ void XmlChildElementParsers<XmlReaderT, T>::finalize()
 {
     std::sort(parsers_.begin(), parsers_.end(), [](const Parser& a, const Parser& b) { return a.name_ < b.name_; });
 
-    optionalMask_ = 0;
-    for (int i = 0; i < static_cast<int>(parsers_.size()); i++)
+    std::vector<std::string> names;
+    for (const Parser& parser : parsers_)
     {
-        if (!parsers_[i].required_)
-        {
-            optionalMask_ |= 1 << i;
-        }
+        names.push_back(parser.name_);
     }
+    nameTable_.build(names);
+
+    finalized_ = true;
 }
 
 template <class XmlReaderT, class T>
@@ -334,4 +215,112 @@ void XmlChildElementParsers<XmlReaderT, T>::parseOneOrMore(XmlReaderT& xml, T& r
     }
 }
 
+template <class XmlReaderT, class T>
+template <class TargetT>
+void XmlChildElementParsers<XmlReaderT, T>::Parser::setTarget(TargetT target)
+{
+    static_assert(sizeof(TargetT) <= sizeof(target_), "The parser target doesn't fit in the target storage.");
+    static_assert(std::is_trivially_copyable<TargetT>::value, "The parser target must be trivially copyable.");
+    std::memcpy(&target_, &target, sizeof(TargetT));
+}
+
+template <class XmlReaderT, class T>
+template <class TargetT>
+TargetT XmlChildElementParsers<XmlReaderT, T>::Parser::target() const
+{
+    TargetT target;
+    std::memcpy(&target, &target_, sizeof(TargetT));
+    return target;
+}
+
+template <class XmlReaderT, class T>
+template <class DefaultT, class... ParseFailArgs>
+typename XmlChildElementParsers<XmlReaderT, T>::Parser XmlChildElementParsers<XmlReaderT, T>::makeParser(
+    const std::string& name, Multiplicity multiplicity, DefaultT defaultValue, ParseFailArgs... parseFailArgs)
+{
+    using DataT = ParserData<DefaultT, ParseFailArgs...>;
+
+    Parser parser;
+    parser.name_ = name;
+    parser.required_ = multiplicity == Multiplicity::ONE || multiplicity == Multiplicity::ONE_OR_MORE;
+    parser.allowMany_ = multiplicity == Multiplicity::ZERO_OR_MORE || multiplicity == Multiplicity::ONE_OR_MORE;
+    parser.setErrorFunc_ = &setError<DataT>;
+    parser.data_ = std::make_shared<const DataT>(DataT{std::move(defaultValue), std::make_tuple(parseFailArgs...)});
+    return parser;
+}
+
+template <class XmlReaderT, class T>
+void XmlChildElementParsers<XmlReaderT, T>::parseCustom(const Parser& parser, XmlReaderT& xml, T& result)
+{
+    parser.template target<CustomParseFunc>()(xml, result);
+}
+
+template <class XmlReaderT, class T>
+template <class FieldT, class TargetT>
+void XmlChildElementParsers<XmlReaderT, T>::parseIntoField(const Parser& parser, XmlReaderT& xml, T& result)
+{
+    auto fieldPtr = parser.template target<TargetT T::Value::*>();
+    auto childParseRes = xml_parsers::parseXmlElem<XmlReaderT, FieldT>(xml);
+    result.value().*fieldPtr = std::move(childParseRes.value());
+    result.appendErrors(childParseRes);
+}
+
+template <class XmlReaderT, class T>
+template <class ValueT>
+void XmlChildElementParsers<XmlReaderT, T>::parseIntoSetter(const Parser& parser, XmlReaderT& xml, T& result)
+{
+    auto setter = parser.template target<void (T::Value::*)(typename ValueT::Value)>();
+    auto childParseRes = xml_parsers::parseXmlElem<XmlReaderT, ValueT>(xml);
+    (result.value().*setter)(std::move(childParseRes.value()));
+    result.appendErrors(childParseRes);
+}
+
+template <class XmlReaderT, class T>
+template <class ElemT, class VectorT>
+void XmlChildElementParsers<XmlReaderT, T>::parseIntoVector(const Parser& parser, XmlReaderT& xml, T& result)
+{
+    auto vectorPtr = parser.template target<VectorT T::Value::*>();
+    auto childParseRes = xml_parsers::parseXmlElem<XmlReaderT, ElemT>(xml);
+    (result.value().*vectorPtr).push_back(std::move(childParseRes.value()));
+    result.appendErrors(childParseRes);
+}
+
+template <class XmlReaderT, class T>
+template <class FieldT, class DataT>
+void XmlChildElementParsers<XmlReaderT, T>::setFieldDefault(const Parser& parser, typename T::Value& obj)
+{
+    auto fieldPtr = parser.template target<FieldT T::Value::*>();
+    obj.*fieldPtr = parser.template data<DataT>().defaultValue_;
+}
+
+template <class XmlReaderT, class T>
+template <class FieldT>
+void XmlChildElementParsers<XmlReaderT, T>::setOptionalFieldDefault(const Parser& parser, typename T::Value& obj)
+{
+    auto fieldPtr = parser.template target<boost::optional<FieldT> T::Value::*>();
+    obj.*fieldPtr = boost::none;
+}
+
+template <class XmlReaderT, class T>
+template <class ValueT, class DataT>
+void XmlChildElementParsers<XmlReaderT, T>::setSetterDefault(const Parser& parser, typename T::Value& obj)
+{
+    auto setter = parser.template target<void (T::Value::*)(typename ValueT::Value)>();
+    (obj.*setter)(parser.template data<DataT>().defaultValue_);
+}
+
+template <class XmlReaderT, class T>
+void XmlChildElementParsers<XmlReaderT, T>::setNoDefault(const Parser&, typename T::Value&)
+{
+}
+
+template <class XmlReaderT, class T>
+template <class DataT>
+void XmlChildElementParsers<XmlReaderT, T>::setError(const Parser& parser, XmlParseError error, T& result)
+{
+    std::apply(
+        [&](const auto&... parseFailArgs) { result.errors().emplace_back(std::move(error), parseFailArgs...); },
+        parser.template data<DataT>().parseFailArgs_);
+}
+
 }}  // namespace aid::xodr
@@ -0,0 +1,84 @@
+#include "xml/xml_name_table.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace aid { namespace xodr {
+
+void XmlNameTable::build(const std::vector<std::string>& names)
+{
+    std::vector<std::string> sortedNames = names;
+    std::sort(sortedNames.begin(), sortedNames.end());
+    if (std::adjacent_find(sortedNames.begin(), sortedNames.end()) != sortedNames.end())
+    {
+        throw std::runtime_error("Duplicate name in XmlNameTable.");
+    }
+
+    chars_.clear();
+    for (const std::string& name : names)
+    {
+        chars_ += name;
+    }
+
+    // Start with a table with at least twice as many slots as there are names,
+    // and double its size whenever a number of seeds failed to produce a
+    // perfect hash. With a load factor of at most 1/2, a perfect hash is
+    // found after a few dozen seeds at most for the parser sizes we use.
+    // It's not guaranteed to exist though: names whose full hashes collide
+    // for every seed which is tried can't be separated by any table size, so
+    // the search gives up after a few sizes.
+    uint32_t numSlots = 1;
+    while (numSlots < 2 * names.size())
+    {
+        numSlots *= 2;
+    }
+
+    const uint32_t SEEDS_PER_SIZE = 256;
+    const int NUM_SIZES = 5;
+    for (int i = 0; i < NUM_SIZES; i++)
+    {
+        for (uint32_t seed = 0; seed < SEEDS_PER_SIZE; seed++)
+        {
+            if (tryBuild(names, seed, numSlots))
+            {
+                return;
+            }
+        }
+
+        numSlots *= 2;
+    }
+
+    throw std::runtime_error("Failed to find a perfect hash for the names of an XmlNameTable.");
+}
+
+bool XmlNameTable::tryBuild(const std::vector<std::string>& names, uint32_t seed, uint32_t numSlots)
+{
+    assert((numSlots & (numSlots - 1)) == 0);
+
+    slots_.assign(numSlots, Slot());
+    mask_ = numSlots - 1;
+    seed_ = seed;
+
+    uint32_t nameOffset = 0;
+    for (int i = 0; i < static_cast<int>(names.size()); i++)
+    {
+        uint32_t hash = computeHash(names[i], seed);
+        Slot& slot = slots_[hash & mask_];
+        if (slot.index_ >= 0)
+        {
+            return false;
+        }
+
+        slot.hash_ = hash;
+        slot.nameOffset_ = nameOffset;
+        slot.nameSize_ = static_cast<uint32_t>(names[i].size());
+        slot.index_ = i;
+
+        nameOffset += slot.nameSize_;
+    }
+
+    return true;
+}
+
+}}  // namespace aid::xodr
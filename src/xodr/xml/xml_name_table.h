@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief A perfect hash table which maps element or attribute names to
+ * indices.
+ *
+ * An XmlNameTable is built once from a fixed set of names (the names of the
+ * parsers in an XmlAttributeParsers or XmlChildElementParsers), after which
+ * looking up a name takes a single hash computation and at most one string
+ * comparison.
+ *
+ * When the table is built, a hash seed and a (power of two) table size are
+ * searched for such that no two names map to the same slot. Each slot stores
+ * the full hash and the length of its name, so names which aren't in the
+ * table are usually rejected without comparing any characters.
+ */
+class XmlNameTable
+{
+  public:
+    /**
+     * @brief Builds the table for the given names.
+     *
+     * The index of a name is its index in the given list. The names must be
+     * unique.
+     *
+     * @param names         The names.
+     * @throws std::runtime_error if the names aren't unique, or if no seed and
+     *                      table size which separate them are found.
+     */
+    void build(const std::vector<std::string>& names);
+
+    /**
+     * @brief Looks up the given name.
+     *
+     * @param name          The name to look up.
+     * @returns             The index of the name, or -1 if the name isn't in
+     *                      the table.
+     */
+    int find(std::string_view name) const
+    {
+        uint32_t hash = computeHash(name, seed_);
+        const Slot& slot = slots_[hash & mask_];
+        if (slot.hash_ != hash || slot.nameSize_ != name.size() || slot.index_ < 0)
+        {
+            return -1;
+        }
+
+        if (name.compare(0, name.size(), chars_.data() + slot.nameOffset_, slot.nameSize_) != 0)
+        {
+            return -1;
+        }
+
+        return slot.index_;
+    }
+
+  private:
+    struct Slot
+    {
+        uint32_t hash_ = 0;
+        uint32_t nameOffset_ = 0;
+        uint32_t nameSize_ = 0;
+        int index_ = -1;
+    };
+
+    /**
+     * @brief Computes the seeded FNV-1a hash of the given name.
+     */
+    static uint32_t computeHash(std::string_view name, uint32_t seed)
+    {
+        uint32_t hash = 2166136261u ^ seed;
+        for (char c : name)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+
+    bool tryBuild(const std::vector<std::string>& names, uint32_t seed, uint32_t numSlots);
+
+    uint32_t seed_ = 0;
+
+    /**
+     * @brief The number of slots minus one, used to map a hash to a slot.
+     */
+    uint32_t mask_ = 0;
+
+    std::vector<Slot> slots_ = std::vector<Slot>(1);
+
+    /**
+     * @brief The characters of all names, referred to by the slots.
+     */
+    std::string chars_;
+};
+
+/**
+ * @brief A set of indices, used to keep track of which parsers were used while
+ * parsing an element.
+ *
+ * Sets of up to 128 indices are stored inline, so no memory is allocated for
+ * any of the parsers in this module.
+ */
+class XmlIndexSet
+{
+  public:
+    /**
+     * @brief Constructs an empty set for indices in the range [0, size).
+     */
+    explicit XmlIndexSet(size_t size) : words_((size + 63) / 64, 0) {}
+
+    /**
+     * @brief Inserts the given index into this set.
+     *
+     * @returns             True if the index was inserted, false if it was
+     *                      already in the set.
+     */
+    bool insert(int index)
+    {
+        uint64_t mask = uint64_t(1) << (index % 64);
+        uint64_t& word = words_[index / 64];
+        if (word & mask)
+        {
+            return false;
+        }
+
+        word |= mask;
+        return true;
+    }
+
+    /**
+     * @brief Returns whether the given index is in this set.
+     */
+    bool contains(int index) const { return (words_[index / 64] >> (index % 64)) & 1; }
+
+  private:
+    boost::container::small_vector<uint64_t, 2> words_;
+};
+
+}}  // namespace aid::xodr
@@ -1,5 +1,6 @@
 #include "xml/xml_reader.h"
 
+#include <cassert>
 #include <stdexcept>
 #include <sstream>
 #include <vector>
@@ -15,12 +16,7 @@ XmlReader XmlReader::fromFile(const std::string& fileName)
 
 void XmlReader::initFromFile(const std::string& fileName)
 {
-    if (!doc_.LoadFile(fileName.c_str()))
-    {
-        throw std::runtime_error(doc_.ErrorDesc());
-    }
-
-    curElement_ = nullptr;
+    tokenizer_ = XmlTokenizer::fromFile(fileName);
 }
 
 XmlReader XmlReader::fromText(const std::string& text)
@@ -32,13 +28,46 @@ XmlReader XmlReader::fromText(const std::string& text)
 
 void XmlReader::initFromText(const std::string& text)
 {
-    doc_.Parse(text.c_str());
-    if (doc_.Error())
+    tokenizer_ = XmlTokenizer::fromText(text);
+}
+
+void XmlReader::initFromBuffer(const char* data, size_t size, int lineNumber, int columnNumber, size_t byteOffset)
+{
+    tokenizer_ = XmlTokenizer::fromBuffer(data, size, lineNumber, columnNumber, byteOffset);
+}
+
+const XmlToken& XmlReader::peek(int index) const
+{
+    assert(index < 2);
+
+    while (numLookahead_ <= index)
     {
-        throw std::runtime_error(doc_.ErrorDesc());
+        tokenizer_->next(lookahead_[numLookahead_]);
+        numLookahead_++;
     }
 
-    curElement_ = nullptr;
+    return lookahead_[index];
+}
+
+const XmlToken& XmlReader::peekNonText() const
+{
+    const XmlToken& token = peek(0);
+    return token.type_ == XmlToken::Type::TEXT ? peek(1) : token;
+}
+
+void XmlReader::consumeNonText()
+{
+    int index = peek(0).type_ == XmlToken::Type::TEXT ? 1 : 0;
+    assert(index < numLookahead_);
+
+    // Swapping rather than copying allows the token buffers to be reused.
+    std::swap(cur_, lookahead_[index]);
+
+    numLookahead_ -= index + 1;
+    if (numLookahead_ > 0)
+    {
+        std::swap(lookahead_[0], lookahead_[1]);
+    }
 }
 
 void XmlReader::readStartElement()
@@ -61,212 +90,172 @@ void XmlReader::readStartElement(const std::string& expectedName)
 
 void XmlReader::readEndElement()
 {
-    assert(curElement_);
-
-    if (endOfElement_)
-    {
-        if (curElement_->NextSiblingElement())
-        {
-            throw std::runtime_error("End element expected");
-        }
-
-        curElement_ = static_cast<TiXmlElement*>(curElement_->Parent());
-        assert(!curElement_ || curElement_->Type() == TiXmlNode::TINYXML_ELEMENT);
-    }
-    else
+    if (!tryReadEndElement())
     {
-        if (curElement_->FirstChildElement())
-        {
-            throw std::runtime_error("End element expected");
-        }
-
-        endOfElement_ = true;
+        throw std::runtime_error("End element expected");
     }
 }
 
 void XmlReader::skipToEndElement()
 {
-    assert(curElement_);
-
-    if (endOfElement_)
-    {
-        curElement_ = static_cast<TiXmlElement*>(curElement_->Parent());
-        assert(!curElement_ || curElement_->Type() == TiXmlNode::TINYXML_ELEMENT);
-    }
-    else
-    {
-        endOfElement_ = true;
-    }
-}
+    assert(started_);
 
-bool XmlReader::tryReadStartElement()
-{
-    if (!curElement_)
-    {
-        curElement_ = doc_.RootElement();
-        endOfElement_ = false;
-        return true;
-    }
-    else if (!endOfElement_)
+    // Skip all tokens up to, and including, the end tag which closes the
+    // current element (or the parent element if we're already at the end of
+    // the current element). Attributes of skipped elements aren't stored.
+    int level = 0;
+    while (true)
     {
-        TiXmlElement* nextElem = curElement_->FirstChildElement();
-        if (nextElem)
+        if (numLookahead_ > 0)
         {
-            curElement_ = nextElem;
-            return true;
+            std::swap(cur_, lookahead_[0]);
+            numLookahead_--;
+            std::swap(lookahead_[0], lookahead_[1]);
         }
         else
         {
-            return false;
+            tokenizer_->next(cur_, false);
         }
-    }
-    else
-    {
-        TiXmlElement* nextElem = curElement_->NextSiblingElement();
-        if (nextElem)
+
+        if (cur_.type_ == XmlToken::Type::START_ELEMENT)
         {
-            curElement_ = nextElem;
-            endOfElement_ = false;
-            return true;
+            level++;
         }
-        else
+        else if (cur_.type_ == XmlToken::Type::END_ELEMENT)
         {
-            return false;
-        }
-    }
-}
+            if (level == 0)
+            {
+                endOfElement_ = true;
+                return;
+            }
 
-bool XmlReader::tryReadStartElement(const std::string& expectedName)
-{
-    if (!curElement_)
-    {
-        TiXmlElement* nextElem = doc_.RootElement();
-        if (nextElem && nextElem->Value() == expectedName)
-        {
-            curElement_ = nextElem;
-            endOfElement_ = false;
-            return true;
+            level--;
         }
-        else
+        else if (cur_.type_ == XmlToken::Type::END_OF_DOCUMENT)
         {
-            return false;
+            throw std::runtime_error("Unexpected end of document.");
         }
     }
-    else if (!endOfElement_)
+}
+
+bool XmlReader::tryReadStartElement()
+{
+    if (peekNonText().type_ != XmlToken::Type::START_ELEMENT)
     {
-        TiXmlElement* nextElem = curElement_->FirstChildElement();
-        if (nextElem && nextElem->Value() == expectedName)
-        {
-            curElement_ = nextElem;
-            return true;
-        }
-        else
-        {
-            return false;
-        }
+        return false;
     }
-    else
+
+    consumeNonText();
+    started_ = true;
+    endOfElement_ = false;
+    return true;
+}
+
+bool XmlReader::tryReadStartElement(const std::string& expectedName)
+{
+    const XmlToken& next = peekNonText();
+    if (next.type_ != XmlToken::Type::START_ELEMENT || next.value_ != expectedName)
     {
-        TiXmlElement* nextElem = curElement_->NextSiblingElement();
-        if (nextElem && nextElem->Value() == expectedName)
-        {
-            curElement_ = nextElem;
-            endOfElement_ = false;
-            return true;
-        }
-        else
-        {
-            return false;
-        }
+        return false;
     }
+
+    consumeNonText();
+    started_ = true;
+    endOfElement_ = false;
+    return true;
 }
 
 bool XmlReader::tryReadEndElement()
 {
-    assert(curElement_);
+    assert(started_);
 
-    if (endOfElement_)
+    if (peekNonText().type_ != XmlToken::Type::END_ELEMENT)
     {
-        if (curElement_->NextSiblingElement())
-        {
-            return false;
-        }
-
-        curElement_ = static_cast<TiXmlElement*>(curElement_->Parent());
-        return true;
+        return false;
     }
-    else
-    {
-        if (curElement_->FirstChildElement())
-        {
-            return false;
-        }
 
-        endOfElement_ = true;
-        return true;
-    }
+    consumeNonText();
+    endOfElement_ = true;
+    return true;
 }
 
-std::string XmlReader::getCurElementName() const
+const std::string& XmlReader::getCurElementName() const
 {
-    assert(curElement_);
-    return curElement_->Value();
+    assert(started_);
+    return cur_.value_;
 }
 
 std::vector<XmlReader::Attrib> XmlReader::getAttributes() const
 {
-    assert(curElement_);
+    assert(started_);
     assert(!endOfElement_);
 
-    std::vector<Attrib> ret;
-    for (const TiXmlAttribute* attrib = curElement_->FirstAttribute(); attrib; attrib = attrib->Next())
-    {
-        ret.push_back({attrib->Name(), attrib->Value()});
-    }
-    return ret;
+    return std::vector<Attrib>(cur_.attribs_.begin(), cur_.attribs_.begin() + cur_.numAttribs_);
+}
+
+XmlReader::AttribRange XmlReader::attributes() const
+{
+    assert(started_);
+    assert(!endOfElement_);
+
+    const Attrib* attribs = cur_.attribs_.data();
+    return AttribRange(attribs, attribs + cur_.numAttribs_);
 }
 
 std::string XmlReader::getAttribute(const std::string& name) const
 {
-    assert(curElement_);
+    assert(started_);
     assert(!endOfElement_);
 
-    const char* ret = curElement_->Attribute(name.c_str());
-    if (!ret)
+    for (int i = 0; i < cur_.numAttribs_; i++)
     {
-        std::stringstream err;
-        err << "Attribute '" << name << ". expected.";
-        throw std::runtime_error(err.str());
+        if (cur_.attribs_[i].name_ == name)
+        {
+            return cur_.attribs_[i].value_;
+        }
     }
 
-    return ret;
+    std::stringstream err;
+    err << "Attribute '" << name << ". expected.";
+    throw std::runtime_error(err.str());
 }
 
 std::string XmlReader::getText() const
 {
-    assert(curElement_);
+    assert(started_);
     assert(!endOfElement_);
 
-    const TiXmlNode* firstChild = curElement_->FirstChild();
-    if (firstChild != curElement_->LastChild() || firstChild->Type() != TiXmlNode::TINYXML_TEXT)
+    const XmlToken& text = peek(0);
+    if (text.type_ != XmlToken::Type::TEXT || peek(1).type_ != XmlToken::Type::END_ELEMENT)
     {
         throw std::runtime_error("Text expected.");
     }
 
-    const TiXmlText* text = firstChild->ToText();
-    return text->Value();
+    return text.value_;
 }
 
 int XmlReader::getLineNumber() const
 {
     assert(!endOfElement_);  // Not implemented yet for end elements.
-    return curElement_->Row();
+    return cur_.lineNumber_;
 }
 
 int XmlReader::getColumnNumber() const
 {
     assert(!endOfElement_);  // Not implemented yet for end elements.
-    return curElement_->Column();
+    return cur_.columnNumber_;
+}
+
+size_t XmlReader::getByteOffset() const
+{
+    assert(started_);
+    return cur_.byteOffset_;
+}
+
+size_t XmlReader::getEndByteOffset() const
+{
+    assert(started_);
+    return cur_.endByteOffset_;
 }
 
 }}  // namespace aid::xodr
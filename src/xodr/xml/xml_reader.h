@@ -1,9 +1,10 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
-#include "tinyxml.h"
+#include "xml/xml_tokenizer.h"
 
 namespace aid { namespace xodr {
 
@@ -12,12 +13,19 @@ namespace aid { namespace xodr {
  *
  * An xml file is treated as a sequence of nodes. The various functions in the
  * in the XmlReader allow you to go through these nodes in a sequential manner.
+ *
+ * The document is never loaded into memory as a whole: the XmlReader pulls
+ * tokens from an @ref XmlTokenizer as it goes, and only looks ahead by at most
+ * two tokens.
  */
 class XmlReader
 {
   public:
     ~XmlReader() = default;
 
+    XmlReader(XmlReader&&) = default;
+    XmlReader& operator=(XmlReader&&) = default;
+
     /**
      * @brief Creates an XmlReader which parses the given xml file.
      *
@@ -118,23 +126,12 @@ class XmlReader
      *
      * @returns             The name of the current element.
      */
-    std::string getCurElementName() const;
+    const std::string& getCurElementName() const;
 
     /**
      * @brief A attribute's name/value pair.
      */
-    struct Attrib
-    {
-        /**
-         * @brief The attribute name.
-         */
-        std::string name_;
-
-        /**
-         * @brief The attribute value.
-         */
-        std::string value_;
-    };
+    using Attrib = XmlAttrib;
 
     /**
      * @brief Gets all attributes associated with the current element.
@@ -147,6 +144,40 @@ class XmlReader
      */
     std::vector<Attrib> getAttributes() const;
 
+    /**
+     * @brief A range of attributes, which refers to the attributes stored in
+     * the XmlReader.
+     */
+    class AttribRange
+    {
+      public:
+        AttribRange(const Attrib* begin, const Attrib* end) : begin_(begin), end_(end) {}
+
+        const Attrib* begin() const { return begin_; }
+        const Attrib* end() const { return end_; }
+        size_t size() const { return end_ - begin_; }
+
+      private:
+        const Attrib* begin_;
+        const Attrib* end_;
+    };
+
+    /**
+     * @brief Gets all attributes associated with the current element, without
+     * copying them.
+     *
+     * Unlike @ref getAttributes, this function doesn't allocate any memory. The
+     * returned range is only valid until the XmlReader advances to another
+     * node.
+     *
+     * This function should only be called when the current node is the start
+     * tag of an element. It's the responsibility of the caller to make sure
+     * this is the case.
+     *
+     * @returns             The range of attributes.
+     */
+    AttribRange attributes() const;
+
     /**
      * @brief Gets the value of the attribute with the given name.
      *
@@ -185,6 +216,18 @@ class XmlReader
      */
     int getColumnNumber() const;
 
+    /**
+     * @returns The byte offset (from the start of the xml document) of the
+     * first character of the current node.
+     */
+    size_t getByteOffset() const;
+
+    /**
+     * @returns The byte offset (from the start of the xml document) just past
+     * the last character of the current node.
+     */
+    size_t getEndByteOffset() const;
+
   protected:
     XmlReader() = default;
 
@@ -209,10 +252,38 @@ class XmlReader
      */
     void initFromText(const std::string& text);
 
+    /**
+     * @brief Initializes this XmlReader to parse the xml in the given buffer,
+     * without copying it.
+     *
+     * See @ref XmlTokenizer::fromBuffer for the meaning of the parameters.
+     */
+    void initFromBuffer(const char* data, size_t size, int lineNumber, int columnNumber, size_t byteOffset);
+
   private:
-    TiXmlDocument doc_;
-    TiXmlElement* curElement_;
-    bool endOfElement_;
+    const XmlToken& peek(int index) const;
+    const XmlToken& peekNonText() const;
+    void consumeNonText();
+
+    std::unique_ptr<XmlTokenizer> tokenizer_;
+
+    /**
+     * @brief The start tag of the current element, or its end tag if
+     * endOfElement_ is true.
+     */
+    XmlToken cur_;
+    bool started_ = false;
+    bool endOfElement_ = false;
+
+    /**
+     * @brief The tokens which have been read from the tokenizer, but which
+     * haven't been consumed yet.
+     *
+     * Since the tokenizer reports consecutive character data as a single TEXT
+     * token, we never need to look ahead more than two tokens.
+     */
+    mutable XmlToken lookahead_[2];
+    mutable int numLookahead_ = 0;
 };
 
 }}  // namespace aid::xodr
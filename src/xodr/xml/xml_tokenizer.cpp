@@ -0,0 +1,855 @@
+#include "xml/xml_tokenizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace aid { namespace xodr {
+
+namespace {
+
+/**
+ * @brief The size of the window through which the tokenizer looks at the
+ * document, and the size of each of the buffers used to read files.
+ */
+constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+/**
+ * @brief The number of file buffers which can be filled ahead of the
+ * tokenizer.
+ */
+constexpr int NUM_FILE_BUFFERS = 3;
+
+bool isWhiteSpace(int c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+bool isNameTerminator(int c) { return c < 0 || isWhiteSpace(c) || c == '/' || c == '>' || c == '=' || c == '<'; }
+
+void appendUtf8(std::string& out, unsigned long codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        out += static_cast<char>(codePoint);
+    }
+    else if (codePoint < 0x800)
+    {
+        out += static_cast<char>(0xc0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+    else if (codePoint < 0x10000)
+    {
+        out += static_cast<char>(0xe0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+    else
+    {
+        out += static_cast<char>(0xf0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief A source of consecutive chunks of the document.
+ */
+class XmlTokenizer::ChunkSource
+{
+  public:
+    virtual ~ChunkSource() = default;
+
+    /**
+     * @brief Copies the next bytes of the document into dst.
+     *
+     * @param dst           The destination buffer.
+     * @param maxSize       The maximum number of bytes to copy.
+     * @returns             The number of bytes copied, 0 at the end of the
+     *                      document.
+     */
+    virtual size_t read(char* dst, size_t maxSize) = 0;
+};
+
+/**
+ * @brief A ChunkSource which reads from a string.
+ */
+class XmlTokenizer::TextChunkSource : public XmlTokenizer::ChunkSource
+{
+  public:
+    explicit TextChunkSource(std::string text) : text_(std::move(text)) {}
+
+    size_t read(char* dst, size_t maxSize) override
+    {
+        size_t size = std::min(maxSize, text_.size() - pos_);
+        std::memcpy(dst, text_.data() + pos_, size);
+        pos_ += size;
+        return size;
+    }
+
+  private:
+    std::string text_;
+    size_t pos_ = 0;
+};
+
+/**
+ * @brief A ChunkSource which reads from a buffer owned by the caller.
+ */
+class XmlTokenizer::BufferChunkSource : public XmlTokenizer::ChunkSource
+{
+  public:
+    BufferChunkSource(const char* data, size_t size) : data_(data), size_(size) {}
+
+    size_t read(char* dst, size_t maxSize) override
+    {
+        size_t size = std::min(maxSize, size_ - pos_);
+        std::memcpy(dst, data_ + pos_, size);
+        pos_ += size;
+        return size;
+    }
+
+  private:
+    const char* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+/**
+ * @brief A ChunkSource which reads from a file.
+ *
+ * A background thread reads the file into a small ring of buffers, so the
+ * disk I/O overlaps with the tokenization of the previously read chunks.
+ */
+class XmlTokenizer::FileChunkSource : public XmlTokenizer::ChunkSource
+{
+  public:
+    explicit FileChunkSource(FILE* file) : file_(file)
+    {
+        for (Buffer& buffer : buffers_)
+        {
+            buffer.data_.resize(CHUNK_SIZE);
+        }
+
+        thread_ = std::thread([this] { readLoop(); });
+    }
+
+    ~FileChunkSource() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        thread_.join();
+
+        fclose(file_);
+    }
+
+    size_t read(char* dst, size_t maxSize) override
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return numFull_ > 0 || endOfFile_; });
+
+        if (numFull_ == 0)
+        {
+            if (error_)
+            {
+                throw std::runtime_error("Error while reading xml file.");
+            }
+
+            return 0;
+        }
+
+        Buffer& buffer = buffers_[readIndex_];
+        size_t size = std::min(maxSize, buffer.size_ - readOffset_);
+        std::memcpy(dst, buffer.data_.data() + readOffset_, size);
+        readOffset_ += size;
+
+        if (readOffset_ == buffer.size_)
+        {
+            readOffset_ = 0;
+            readIndex_ = (readIndex_ + 1) % NUM_FILE_BUFFERS;
+            numFull_--;
+            lock.unlock();
+            cond_.notify_all();
+        }
+
+        return size;
+    }
+
+  private:
+    void readLoop()
+    {
+        int writeIndex = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this] { return numFull_ < NUM_FILE_BUFFERS || stop_; });
+                if (stop_)
+                {
+                    return;
+                }
+            }
+
+            // The buffer at writeIndex isn't accessed by the consumer until
+            // it's marked as full, so it can be filled without holding the lock.
+            Buffer& buffer = buffers_[writeIndex];
+            buffer.size_ = fread(buffer.data_.data(), 1, buffer.data_.size(), file_);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (buffer.size_ > 0)
+            {
+                writeIndex = (writeIndex + 1) % NUM_FILE_BUFFERS;
+                numFull_++;
+            }
+
+            if (buffer.size_ < buffer.data_.size())
+            {
+                error_ = ferror(file_) != 0;
+                endOfFile_ = true;
+                cond_.notify_all();
+                return;
+            }
+
+            cond_.notify_all();
+        }
+    }
+
+    struct Buffer
+    {
+        std::vector<char> data_;
+        size_t size_ = 0;
+    };
+
+    FILE* file_;
+    std::thread thread_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    Buffer buffers_[NUM_FILE_BUFFERS];
+    int readIndex_ = 0;
+    size_t readOffset_ = 0;
+    int numFull_ = 0;
+    bool endOfFile_ = false;
+    bool error_ = false;
+    bool stop_ = false;
+};
+
+XmlTokenizer::XmlTokenizer(std::unique_ptr<ChunkSource> source, size_t windowSize)
+    : source_(std::move(source)), window_(windowSize)
+{
+    // Skip the UTF-8 byte order mark, if there is one.
+    if (peekChar(0) == 0xef && peekChar(1) == 0xbb && peekChar(2) == 0xbf)
+    {
+        pos_ += 3;
+    }
+}
+
+XmlTokenizer::~XmlTokenizer() = default;
+
+std::unique_ptr<XmlTokenizer> XmlTokenizer::fromFile(const std::string& fileName)
+{
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open file \"" + fileName + "\".");
+    }
+
+    return std::unique_ptr<XmlTokenizer>(new XmlTokenizer(std::make_unique<FileChunkSource>(file), CHUNK_SIZE));
+}
+
+std::unique_ptr<XmlTokenizer> XmlTokenizer::fromText(const std::string& text)
+{
+    return std::unique_ptr<XmlTokenizer>(
+        new XmlTokenizer(std::make_unique<TextChunkSource>(text), std::min(text.size() + 1, CHUNK_SIZE)));
+}
+
+std::unique_ptr<XmlTokenizer> XmlTokenizer::fromBuffer(const char* data, size_t size, int lineNumber,
+                                                       int columnNumber, size_t byteOffset)
+{
+    std::unique_ptr<XmlTokenizer> ret(
+        new XmlTokenizer(std::make_unique<BufferChunkSource>(data, size), std::min(size + 1, CHUNK_SIZE)));
+    ret->lineNumber_ = lineNumber;
+    ret->columnNumber_ = columnNumber;
+    ret->windowOffset_ += byteOffset;
+    return ret;
+}
+
+bool XmlTokenizer::refill(size_t numBytes)
+{
+    if (sourceExhausted_)
+    {
+        return false;
+    }
+
+    // Move the unconsumed part of the window to the front.
+    size_t numUnconsumed = end_ - pos_;
+    windowOffset_ += pos_;
+    std::memmove(window_.data(), window_.data() + pos_, numUnconsumed);
+    pos_ = 0;
+    end_ = numUnconsumed;
+
+    if (window_.size() < numBytes)
+    {
+        window_.resize(numBytes);
+    }
+
+    while (end_ < numBytes)
+    {
+        size_t size = source_->read(window_.data() + end_, window_.size() - end_);
+        if (size == 0)
+        {
+            sourceExhausted_ = true;
+            return false;
+        }
+
+        end_ += size;
+    }
+
+    return true;
+}
+
+void XmlTokenizer::advanceMany(size_t numBytes)
+{
+    assert(pos_ + numBytes <= end_);
+
+    // The column number is the distance to the last new line, so only the new
+    // lines have to be located.
+    const char* begin = window_.data() + pos_;
+    const char* end = begin + numBytes;
+    const char* lastNewLine = nullptr;
+    for (const char* p = begin; (p = static_cast<const char*>(std::memchr(p, '\n', end - p))); p++)
+    {
+        lineNumber_++;
+        lastNewLine = p;
+    }
+
+    if (lastNewLine)
+    {
+        columnNumber_ = static_cast<int>(end - lastNewLine);
+    }
+    else
+    {
+        columnNumber_ += static_cast<int>(numBytes);
+    }
+
+    pos_ += numBytes;
+}
+
+bool XmlTokenizer::lookingAt(const char* str)
+{
+    for (size_t i = 0; str[i]; i++)
+    {
+        if (peekChar(i) != static_cast<unsigned char>(str[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void XmlTokenizer::skipPast(const char* terminator)
+{
+    while (!lookingAt(terminator))
+    {
+        if (peekChar(0) < 0)
+        {
+            std::stringstream msg;
+            msg << "\"" << terminator << "\" expected.";
+            throwError(msg.str());
+        }
+
+        advance(1);
+    }
+
+    advance(std::strlen(terminator));
+}
+
+void XmlTokenizer::skipWhiteSpace()
+{
+    while (isWhiteSpace(peekChar(0)))
+    {
+        advance(1);
+    }
+}
+
+void XmlTokenizer::next(XmlToken& token, bool storeAttribs)
+{
+    token.numAttribs_ = 0;
+
+    if (pendingEndElement_)
+    {
+        // The END_ELEMENT token of an empty-element tag.
+        pendingEndElement_ = false;
+        depth_--;
+        token.type_ = XmlToken::Type::END_ELEMENT;
+        token.value_ = openElements_[depth_];
+        token.byteOffset_ = windowOffset_ + pos_;
+        token.endByteOffset_ = token.byteOffset_;
+        return;
+    }
+
+    readToken(token, storeAttribs);
+    token.endByteOffset_ = windowOffset_ + pos_;
+}
+
+void XmlTokenizer::readToken(XmlToken& token, bool storeAttribs)
+{
+    while (true)
+    {
+        token.lineNumber_ = lineNumber_;
+        token.columnNumber_ = columnNumber_;
+        token.byteOffset_ = windowOffset_ + pos_;
+
+        int c = peekChar(0);
+        if (c < 0)
+        {
+            if (depth_ > 0)
+            {
+                throwError("Unexpected end of document, \"</" + openElements_[depth_ - 1] + ">\" expected.");
+            }
+
+            token.type_ = XmlToken::Type::END_OF_DOCUMENT;
+            token.value_.clear();
+            return;
+        }
+
+        if (c == '<')
+        {
+            if (lookingAt("<![CDATA["))
+            {
+                readText(token);
+                return;
+            }
+            else if (lookingAt("<!--"))
+            {
+                skipPast("-->");
+            }
+            else if (lookingAt("<!"))
+            {
+                skipDocType();
+            }
+            else if (lookingAt("<?"))
+            {
+                skipPast("?>");
+            }
+            else if (lookingAt("</"))
+            {
+                readEndTag(token);
+                return;
+            }
+            else
+            {
+                readStartTag(token, storeAttribs);
+                return;
+            }
+        }
+        else if (!storeAttribs && skipText())
+        {
+            continue;
+        }
+        else if (readText(token))
+        {
+            return;
+        }
+    }
+}
+
+void XmlTokenizer::readName(std::string& name)
+{
+    // Names don't contain new lines, so the name is located first (which may
+    // refill the window) and then copied at once.
+    size_t size = 0;
+    while (!isNameTerminator(peekChar(size)))
+    {
+        size++;
+    }
+
+    name.assign(window_.data() + pos_, size);
+    pos_ += size;
+    columnNumber_ += static_cast<int>(size);
+
+    if (name.empty())
+    {
+        throwError("Name expected.");
+    }
+}
+
+void XmlTokenizer::readStartTag(XmlToken& token, bool storeAttribs)
+{
+    advance(1);
+
+    if (depth_ == static_cast<int>(openElements_.size()))
+    {
+        openElements_.emplace_back();
+    }
+    readName(openElements_[depth_]);
+    token.type_ = XmlToken::Type::START_ELEMENT;
+    token.value_ = openElements_[depth_];
+    depth_++;
+
+    while (true)
+    {
+        skipWhiteSpace();
+
+        int c = peekChar(0);
+        if (c == '>')
+        {
+            advance(1);
+            return;
+        }
+        else if (c == '/')
+        {
+            advance(1);
+            if (peekChar(0) != '>')
+            {
+                throwError("'>' expected.");
+            }
+
+            advance(1);
+            pendingEndElement_ = true;
+            return;
+        }
+        else if (c < 0)
+        {
+            throwError("Unexpected end of document inside a start tag.");
+        }
+
+        XmlAttrib* attrib = &scratchAttrib_;
+        if (storeAttribs)
+        {
+            if (token.numAttribs_ == static_cast<int>(token.attribs_.size()))
+            {
+                token.attribs_.emplace_back();
+            }
+            attrib = &token.attribs_[token.numAttribs_++];
+        }
+
+        readName(attrib->name_);
+
+        // The attributes of skipped elements aren't stored, so only those of
+        // elements which are read can be checked for duplicates.
+        if (storeAttribs)
+        {
+            for (int i = 0; i + 1 < token.numAttribs_; i++)
+            {
+                if (token.attribs_[i].name_ == attrib->name_)
+                {
+                    throwError("Duplicate attribute \"" + attrib->name_ + "\".");
+                }
+            }
+        }
+
+        skipWhiteSpace();
+        if (peekChar(0) != '=')
+        {
+            throwError("'=' expected after attribute \"" + attrib->name_ + "\".");
+        }
+        advance(1);
+        skipWhiteSpace();
+
+        int quote = peekChar(0);
+        if (quote != '"' && quote != '\'')
+        {
+            throwError("Quoted value expected for attribute \"" + attrib->name_ + "\".");
+        }
+        advance(1);
+
+        if (!storeAttribs && skipAttribValue(static_cast<char>(quote)))
+        {
+            continue;
+        }
+
+        attrib->value_.clear();
+        while (true)
+        {
+            c = peekChar(0);
+            if (c == quote)
+            {
+                advance(1);
+                break;
+            }
+            else if (c == '&')
+            {
+                appendEntity(attrib->value_);
+            }
+            else if (c < 0)
+            {
+                throwError("Unterminated value of attribute \"" + attrib->name_ + "\".");
+            }
+            else
+            {
+                attrib->value_ += static_cast<char>(c);
+                advance(1);
+            }
+        }
+    }
+}
+
+bool XmlTokenizer::skipAttribValue(char quote)
+{
+    // Look for the closing quote in the window. Values which contain entities
+    // are read by the caller instead, so invalid entities are still reported.
+    const char* begin = window_.data() + pos_;
+    const char* end = static_cast<const char*>(std::memchr(begin, quote, end_ - pos_));
+    if (!end || std::memchr(begin, '&', end - begin))
+    {
+        return false;
+    }
+
+    advance(end - begin + 1);
+    return true;
+}
+
+void XmlTokenizer::readEndTag(XmlToken& token)
+{
+    advance(2);
+
+    token.type_ = XmlToken::Type::END_ELEMENT;
+    readName(token.value_);
+    skipWhiteSpace();
+    if (peekChar(0) != '>')
+    {
+        throwError("'>' expected.");
+    }
+
+    if (depth_ == 0)
+    {
+        throwError("Unexpected end tag \"</" + token.value_ + ">\".");
+    }
+    else if (token.value_ != openElements_[depth_ - 1])
+    {
+        throwError("End tag \"</" + token.value_ + ">\" doesn't match start tag \"<" + openElements_[depth_ - 1] +
+                   ">\".");
+    }
+
+    advance(1);
+    depth_--;
+}
+
+bool XmlTokenizer::skipText()
+{
+    // Tokens which are read with storeAttribs == false are skipped, so their
+    // character data doesn't have to be condensed into a TEXT token. Text
+    // which contains entities is read by readText instead, so invalid entities
+    // are still reported.
+    const char* begin = window_.data() + pos_;
+    const char* end = static_cast<const char*>(std::memchr(begin, '<', end_ - pos_));
+    if (!end || std::memchr(begin, '&', end - begin))
+    {
+        return false;
+    }
+
+    advance(end - begin);
+    return true;
+}
+
+bool XmlTokenizer::readText(XmlToken& token)
+{
+    // Like TinyXML, leading and trailing white space is removed, and runs of
+    // white space inside the text are condensed into a single space. The
+    // content of CDATA sections is kept as is. Comments and processing
+    // instructions inside the text are skipped, so consecutive character data
+    // is always reported as a single TEXT token.
+
+    std::string& text = token.value_;
+    text.clear();
+
+    bool pendingSpace = false;
+    bool sawCData = false;
+    while (true)
+    {
+        int c = peekChar(0);
+        if (c < 0)
+        {
+            break;
+        }
+        else if (c == '<')
+        {
+            if (lookingAt("<![CDATA["))
+            {
+                if (pendingSpace)
+                {
+                    text += ' ';
+                    pendingSpace = false;
+                }
+
+                advance(9);
+                while (!lookingAt("]]>"))
+                {
+                    c = peekChar(0);
+                    if (c < 0)
+                    {
+                        throwError("\"]]>\" expected.");
+                    }
+
+                    text += static_cast<char>(c);
+                    advance(1);
+                }
+                advance(3);
+                sawCData = true;
+            }
+            else if (lookingAt("<!--"))
+            {
+                skipPast("-->");
+            }
+            else if (lookingAt("<?"))
+            {
+                skipPast("?>");
+            }
+            else
+            {
+                break;
+            }
+        }
+        else if (isWhiteSpace(c))
+        {
+            pendingSpace = !text.empty();
+            advance(1);
+        }
+        else
+        {
+            if (pendingSpace)
+            {
+                text += ' ';
+                pendingSpace = false;
+            }
+
+            if (c == '&')
+            {
+                appendEntity(text);
+            }
+            else
+            {
+                text += static_cast<char>(c);
+                advance(1);
+            }
+        }
+    }
+
+    if (text.empty() && !sawCData)
+    {
+        // White space only, which isn't reported.
+        return false;
+    }
+
+    token.type_ = XmlToken::Type::TEXT;
+    return true;
+}
+
+void XmlTokenizer::skipDocType()
+{
+    // Skips "<!DOCTYPE ...>", including an internal subset in square brackets.
+    int bracketDepth = 0;
+    while (true)
+    {
+        int c = peekChar(0);
+        if (c < 0)
+        {
+            throwError("'>' expected.");
+        }
+
+        advance(1);
+        if (c == '[')
+        {
+            bracketDepth++;
+        }
+        else if (c == ']')
+        {
+            bracketDepth--;
+        }
+        else if (c == '>' && bracketDepth == 0)
+        {
+            return;
+        }
+    }
+}
+
+void XmlTokenizer::appendEntity(std::string& out)
+{
+    assert(peekChar(0) == '&');
+
+    static const struct
+    {
+        const char* name_;
+        char value_;
+    } namedEntities[] = {{"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}};
+
+    for (const auto& entity : namedEntities)
+    {
+        if (lookingAt(entity.name_))
+        {
+            out += entity.value_;
+            advance(std::strlen(entity.name_));
+            return;
+        }
+    }
+
+    if (peekChar(1) == '#')
+    {
+        bool hex = peekChar(2) == 'x';
+        size_t i = hex ? 3 : 2;
+        unsigned long codePoint = 0;
+        bool anyDigits = false;
+        while (true)
+        {
+            int c = peekChar(i);
+            int digit;
+            if (c >= '0' && c <= '9')
+            {
+                digit = c - '0';
+            }
+            else if (hex && c >= 'a' && c <= 'f')
+            {
+                digit = c - 'a' + 10;
+            }
+            else if (hex && c >= 'A' && c <= 'F')
+            {
+                digit = c - 'A' + 10;
+            }
+            else
+            {
+                break;
+            }
+
+            codePoint = codePoint * (hex ? 16 : 10) + digit;
+            anyDigits = true;
+            i++;
+
+            if (codePoint > 0x10ffff)
+            {
+                throwError("Invalid character reference.");
+            }
+        }
+
+        if (!anyDigits || peekChar(i) != ';')
+        {
+            throwError("Invalid character reference.");
+        }
+
+        appendUtf8(out, codePoint);
+        advance(i + 1);
+        return;
+    }
+
+    // Like TinyXML, unknown entities are passed through unchanged.
+    out += '&';
+    advance(1);
+}
+
+void XmlTokenizer::throwError(const std::string& msg) const
+{
+    std::stringstream err;
+    err << "Xml error at line " << lineNumber_ << ", column " << columnNumber_ << ": " << msg;
+    throw std::runtime_error(err.str());
+}
+
+}}  // namespace aid::xodr
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief An attribute's name/value pair.
+ */
+struct XmlAttrib
+{
+    /**
+     * @brief The attribute name.
+     */
+    std::string name_;
+
+    /**
+     * @brief The attribute value.
+     */
+    std::string value_;
+};
+
+/**
+ * @brief A single token produced by the @ref XmlTokenizer.
+ *
+ * Tokens are designed to be reused: the tokenizer overwrites the strings in an
+ * existing token in place, so once a token has been used for a while, reading
+ * new tokens into it no longer allocates any memory.
+ */
+struct XmlToken
+{
+    enum class Type
+    {
+        /**
+         * @brief The start tag of an element.
+         *
+         * An empty-element tag is reported as a START_ELEMENT token followed
+         * by an END_ELEMENT token.
+         */
+        START_ELEMENT,
+
+        /**
+         * @brief The end tag of an element.
+         */
+        END_ELEMENT,
+
+        /**
+         * @brief Character data (including CDATA sections).
+         *
+         * Text which only consists of white space is never reported.
+         */
+        TEXT,
+
+        /**
+         * @brief The end of the document was reached.
+         */
+        END_OF_DOCUMENT,
+    };
+
+    /**
+     * @brief The token type.
+     */
+    Type type_ = Type::END_OF_DOCUMENT;
+
+    /**
+     * @brief The element name for START_ELEMENT and END_ELEMENT tokens, the
+     * (entity decoded) character data for TEXT tokens.
+     */
+    std::string value_;
+
+    /**
+     * @brief The attributes of a START_ELEMENT token.
+     *
+     * Only the first numAttribs_ entries are valid. The remaining entries are
+     * kept around so their memory can be reused by subsequent tokens.
+     */
+    std::vector<XmlAttrib> attribs_;
+
+    /**
+     * @brief The number of valid entries in attribs_.
+     */
+    int numAttribs_ = 0;
+
+    /**
+     * @brief The line number (1-based) at which this token starts.
+     */
+    int lineNumber_ = 0;
+
+    /**
+     * @brief The column number (1-based) at which this token starts.
+     */
+    int columnNumber_ = 0;
+
+    /**
+     * @brief The offset (in bytes, from the start of the document) of the
+     * first character of this token.
+     */
+    size_t byteOffset_ = 0;
+
+    /**
+     * @brief The offset (in bytes, from the start of the document) just past
+     * the last character of this token.
+     */
+    size_t endByteOffset_ = 0;
+};
+
+/**
+ * @brief A pull tokenizer for xml documents.
+ *
+ * The XmlTokenizer never holds more than a small, fixed-size window of the
+ * document in memory. When reading from a file, the next part of the file is
+ * read on a background thread while the current part is being tokenized.
+ *
+ * The tokenizer verifies that the document is well-formed as far as element
+ * nesting is concerned, and throws a std::runtime_error which includes the
+ * location of the error otherwise.
+ */
+class XmlTokenizer
+{
+  public:
+    ~XmlTokenizer();
+
+    XmlTokenizer(const XmlTokenizer&) = delete;
+    XmlTokenizer& operator=(const XmlTokenizer&) = delete;
+
+    /**
+     * @brief Creates an XmlTokenizer which tokenizes the given xml file.
+     *
+     * An exception is thrown if the file can't be opened.
+     *
+     * @param fileName      The file name of the xml file.
+     * @returns             The XmlTokenizer.
+     */
+    static std::unique_ptr<XmlTokenizer> fromFile(const std::string& fileName);
+
+    /**
+     * @brief Creates an XmlTokenizer which tokenizes the xml contained in the
+     * given string.
+     *
+     * @param text          A string containing the xml to tokenize.
+     * @returns             The XmlTokenizer.
+     */
+    static std::unique_ptr<XmlTokenizer> fromText(const std::string& text);
+
+    /**
+     * @brief Creates an XmlTokenizer which tokenizes the xml in the given
+     * buffer, without copying it.
+     *
+     * The buffer typically contains a fragment of a larger document, in which
+     * case the position of the fragment within that document can be passed, so
+     * the line numbers, column numbers and byte offsets of the tokens (and of
+     * errors) are relative to the start of the document.
+     *
+     * @param data          A pointer to the xml to tokenize. The buffer should
+     *                      outlive the tokenizer.
+     * @param size          The size of the buffer in bytes.
+     * @param lineNumber    The line number of the first byte of the buffer.
+     * @param columnNumber  The column number of the first byte of the buffer.
+     * @param byteOffset    The byte offset of the first byte of the buffer.
+     * @returns             The XmlTokenizer.
+     */
+    static std::unique_ptr<XmlTokenizer> fromBuffer(const char* data, size_t size, int lineNumber = 1,
+                                                    int columnNumber = 1, size_t byteOffset = 0);
+
+    /**
+     * @brief Reads the next token.
+     *
+     * @param token         The token to read into.
+     * @param storeAttribs  Whether the attributes of START_ELEMENT tokens
+     *                      should be stored. Pass false when the token is going
+     *                      to be skipped anyway.
+     */
+    void next(XmlToken& token, bool storeAttribs = true);
+
+    /**
+     * @returns The number of currently open elements.
+     */
+    int depth() const { return depth_; }
+
+  private:
+    class ChunkSource;
+    class FileChunkSource;
+    class TextChunkSource;
+    class BufferChunkSource;
+
+    /**
+     * @param source        The source of the document.
+     * @param windowSize    The initial size of the window. Documents which
+     *                      are smaller than a chunk use a smaller window, so
+     *                      tokenizers for small fragments are cheap to create.
+     */
+    XmlTokenizer(std::unique_ptr<ChunkSource> source, size_t windowSize);
+
+    bool refill(size_t numBytes);
+    int peekChar(size_t offset)
+    {
+        if (end_ - pos_ <= offset && !refill(offset + 1))
+        {
+            return -1;
+        }
+
+        return static_cast<unsigned char>(window_[pos_ + offset]);
+    }
+    void advance(size_t numBytes)
+    {
+        // Most calls advance past a single character.
+        if (numBytes == 1)
+        {
+            assert(pos_ < end_);
+            if (window_[pos_++] == '\n')
+            {
+                lineNumber_++;
+                columnNumber_ = 1;
+            }
+            else
+            {
+                columnNumber_++;
+            }
+
+            return;
+        }
+
+        advanceMany(numBytes);
+    }
+    void advanceMany(size_t numBytes);
+    bool lookingAt(const char* str);
+    void skipPast(const char* terminator);
+    void skipWhiteSpace();
+
+    void readToken(XmlToken& token, bool storeAttribs);
+    void readName(std::string& name);
+    void readStartTag(XmlToken& token, bool storeAttribs);
+
+    /**
+     * @brief Skips the value of an attribute which isn't stored, up to and
+     * including the closing quote, if the rest of the value is in the window
+     * and doesn't contain entities.
+     *
+     * @returns             True if the value was skipped, false if it has to
+     *                      be read character by character.
+     */
+    bool skipAttribValue(char quote);
+    void readEndTag(XmlToken& token);
+    bool readText(XmlToken& token);
+
+    /**
+     * @brief Skips the character data up to the next markup, without storing
+     * it, if the markup is in the window and the data doesn't contain
+     * entities.
+     *
+     * @returns             True if the data was skipped, false if it has to
+     *                      be read by readText.
+     */
+    bool skipText();
+    void skipDocType();
+    void appendEntity(std::string& out);
+
+    [[noreturn]] void throwError(const std::string& msg) const;
+
+    std::unique_ptr<ChunkSource> source_;
+    bool sourceExhausted_ = false;
+
+    std::vector<char> window_;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+
+    /**
+     * @brief The byte offset of window_[0] within the document.
+     */
+    size_t windowOffset_ = 0;
+
+    int lineNumber_ = 1;
+    int columnNumber_ = 1;
+
+    XmlAttrib scratchAttrib_;
+
+    std::vector<std::string> openElements_;
+    int depth_ = 0;
+    bool pendingEndElement_ = false;
+};
+
+}}  // namespace aid::xodr
@@ -0,0 +1,44 @@
+#include "xodr_arena.h"
+
+#include <algorithm>
+
+namespace aid { namespace xodr {
+
+namespace {
+
+thread_local XodrArena* currentArena = nullptr;
+
+}  // namespace
+
+XodrArena* XodrArena::current()
+{
+    return currentArena;
+}
+
+XodrArena::Scope::Scope(XodrArena* arena) : prevArena_(currentArena)
+{
+    currentArena = arena;
+}
+
+XodrArena::Scope::~Scope()
+{
+    currentArena = prevArena_;
+}
+
+void* XodrArena::allocateSlow(size_t size)
+{
+    // Chunks are allocated with new[], so they're aligned to at least
+    // alignof(std::max_align_t).
+    size_t chunkSize = std::max(nextChunkSize_, size);
+    nextChunkSize_ = std::min(nextChunkSize_ * 2, MAX_CHUNK_SIZE);
+
+    chunks_.emplace_back(new char[chunkSize]);
+    capacity_ = chunkSize;
+    used_ = size;
+
+    bytesAllocated_ += size;
+    bytesReserved_ += chunkSize;
+    return chunks_.back().get();
+}
+
+}}  // namespace aid::xodr
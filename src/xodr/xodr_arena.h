@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief A monotonic memory arena, from which the objects of an XodrMap are
+ * allocated.
+ *
+ * Memory is handed out from large chunks by bumping a pointer, and is only
+ * released when the arena is destroyed. Deallocating memory which was
+ * allocated from an arena is a no-op.
+ *
+ * An XodrArena isn't thread-safe. Each thread which parses part of a map uses
+ * its own arena.
+ *
+ * Objects don't refer to an arena explicitly when they're created. Instead,
+ * an arena is made the current arena of a thread using a @ref Scope, and the
+ * containers of the map objects (see @ref ArenaAllocator) allocate from the
+ * current arena of the thread on which they were created. When there's no
+ * current arena, they allocate from the heap, so objects which are parsed or
+ * copied outside of an XodrMap are unaffected.
+ */
+class XodrArena
+{
+  public:
+    XodrArena() = default;
+    XodrArena(const XodrArena&) = delete;
+    XodrArena& operator=(const XodrArena&) = delete;
+
+    /**
+     * @brief Allocates a block of memory.
+     *
+     * @param size          The size of the block in bytes.
+     * @param alignment     The alignment of the block. This must be a power of
+     *                      two, no larger than alignof(std::max_align_t).
+     * @returns             The block.
+     */
+    void* allocate(size_t size, size_t alignment)
+    {
+        assert(alignment <= alignof(std::max_align_t) && (alignment & (alignment - 1)) == 0);
+
+        size_t offset = (used_ + alignment - 1) & ~(alignment - 1);
+        if (offset + size > capacity_)
+        {
+            return allocateSlow(size);
+        }
+
+        used_ = offset + size;
+        bytesAllocated_ += size;
+        return chunks_.back().get() + offset;
+    }
+
+    /**
+     * @returns The number of chunks allocated by this arena.
+     */
+    size_t numChunks() const { return chunks_.size(); }
+
+    /**
+     * @returns The number of bytes handed out by this arena.
+     */
+    size_t bytesAllocated() const { return bytesAllocated_; }
+
+    /**
+     * @returns The total size of the chunks allocated by this arena.
+     */
+    size_t bytesReserved() const { return bytesReserved_; }
+
+    /**
+     * @brief Gets the current arena of the calling thread.
+     *
+     * @returns             The current arena, or nullptr if the thread has no
+     *                      current arena.
+     */
+    static XodrArena* current();
+
+    /**
+     * @brief Makes an arena the current arena of the calling thread for the
+     * lifetime of the Scope.
+     *
+     * Scopes may be nested. When a Scope is destroyed, the previous current
+     * arena is restored.
+     */
+    class Scope
+    {
+      public:
+        /**
+         * @param arena         The arena, or nullptr to allocate from the heap
+         *                      within this scope.
+         */
+        explicit Scope(XodrArena* arena);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        XodrArena* prevArena_;
+    };
+
+  private:
+    void* allocateSlow(size_t size);
+
+    /**
+     * @brief The size of the first chunk. Subsequent chunks double in size, up
+     * to MAX_CHUNK_SIZE.
+     */
+    static constexpr size_t INITIAL_CHUNK_SIZE = 64 * 1024;
+    static constexpr size_t MAX_CHUNK_SIZE = 4 * 1024 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> chunks_;
+
+    /**
+     * @brief The capacity of the last chunk, and the number of bytes used in it.
+     */
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+
+    size_t nextChunkSize_ = INITIAL_CHUNK_SIZE;
+
+    size_t bytesAllocated_ = 0;
+    size_t bytesReserved_ = 0;
+};
+
+/**
+ * @brief A standard library allocator which allocates from an XodrArena, or
+ * from the heap if it doesn't have an arena.
+ *
+ * A default constructed ArenaAllocator uses the current arena of the calling
+ * thread (see @ref XodrArena::Scope). The allocator is propagated when a
+ * container is moved, so objects keep referring to the arena they were
+ * allocated from. A copy of a container uses the current arena of the thread
+ * which makes the copy.
+ */
+template <class T>
+class ArenaAllocator
+{
+  public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    ArenaAllocator() : arena_(XodrArena::current()) {}
+    explicit ArenaAllocator(XodrArena* arena) : arena_(arena) {}
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena())
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        if (arena_)
+        {
+            return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n)
+    {
+        if (!arena_)
+        {
+            std::allocator<T>().deallocate(ptr, n);
+        }
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+    /**
+     * @returns The arena, or nullptr if this allocator allocates from the heap.
+     */
+    XodrArena* arena() const { return arena_; }
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& b) const
+    {
+        return arena_ == b.arena();
+    }
+
+    template <class U>
+    bool operator!=(const ArenaAllocator<U>& b) const
+    {
+        return arena_ != b.arena();
+    }
+
+  private:
+    XodrArena* arena_;
+};
+
+/**
+ * @brief A vector which allocates its elements from an XodrArena.
+ */
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+/**
+ * @brief The deleter of an @ref ArenaPtr.
+ *
+ * Objects allocated from an arena are only destroyed, since their memory is
+ * released together with the arena. Objects allocated from the heap are
+ * deleted.
+ */
+template <class T>
+class ArenaDeleter
+{
+  public:
+    ArenaDeleter() = default;
+    explicit ArenaDeleter(XodrArena* arena) : arena_(arena) {}
+
+    template <class U, class = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    ArenaDeleter(const ArenaDeleter<U>& other) : arena_(other.arena())
+    {
+    }
+
+    void operator()(T* ptr) const
+    {
+        if (arena_)
+        {
+            ptr->~T();
+        }
+        else
+        {
+            delete ptr;
+        }
+    }
+
+    XodrArena* arena() const { return arena_; }
+
+  private:
+    XodrArena* arena_ = nullptr;
+};
+
+/**
+ * @brief A unique pointer to an object which may be allocated from an
+ * XodrArena.
+ *
+ * A pointer to an object created with new may be stored in an ArenaPtr as
+ * well, in which case the object is deleted as usual.
+ */
+template <class T>
+using ArenaPtr = std::unique_ptr<T, ArenaDeleter<T>>;
+
+/**
+ * @brief Creates an object in the current arena of the calling thread, or on
+ * the heap if there's no current arena.
+ */
+template <class T, class... Args>
+ArenaPtr<T> makeArenaPtr(Args&&... args)
+{
+    XodrArena* arena = XodrArena::current();
+    if (!arena)
+    {
+        return ArenaPtr<T>(new T(std::forward<Args>(args)...));
+    }
+
+    void* mem = arena->allocate(sizeof(T), alignof(T));
+    return ArenaPtr<T>(new (mem) T(std::forward<Args>(args)...), ArenaDeleter<T>(arena));
+}
+
+}}  // namespace aid::xodr
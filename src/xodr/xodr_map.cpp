@@ -1,8 +1,11 @@
 #include "xodr_map.h"
+#include "binary/xodr_binary_serializer.h"
 #include "validation/road_link_validation.h"
 #include "validation/junction_validation.h"
 #include "xml/xml_child_element_parsers.h"
 
+#include <fstream>
+
 namespace aid { namespace xodr {
 
 XodrParseResult<XodrMap> XodrMap::fromFile(const std::string& fileName)
@@ -19,6 +22,74 @@ XodrParseResult<XodrMap> XodrMap::fromText(const std::string& text)
     return XodrMap::parseXml(reader);
 }
 
+XodrMap XodrMap::fromBinary(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open binary map file \"" + fileName + "\".");
+    }
+
+    uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    XodrBinarySerializer::Header header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        throw std::runtime_error("Failed to read the header of binary map file \"" + fileName + "\".");
+    }
+    XodrBinarySerializer::validateHeader(header);
+
+    if (header.payloadSize_ != fileSize - sizeof(header))
+    {
+        throw std::runtime_error("Size mismatch in binary map file \"" + fileName + "\".");
+    }
+
+    std::vector<char> payload(header.payloadSize_);
+    if (!file.read(payload.data(), payload.size()))
+    {
+        throw std::runtime_error("Unexpected end of binary map file \"" + fileName + "\".");
+    }
+
+    return XodrBinarySerializer::deserialize(header, payload.data());
+}
+
+XodrMap& XodrMap::operator=(XodrMap&& map)
+{
+    // The objects of this map have to be destroyed before the arenas they
+    // were allocated from, so the arenas are moved last.
+    geoReference_ = std::move(map.geoReference_);
+    roads_ = std::move(map.roads_);
+    junctions_ = std::move(map.junctions_);
+    idToIndexMaps_ = std::move(map.idToIndexMaps_);
+    totalNumLanes_ = map.totalNumLanes_;
+    lazySource_ = std::move(map.lazySource_);
+    arenas_ = std::move(map.arenas_);
+    return *this;
+}
+
+void XodrMap::saveBinary(const std::string& fileName) const
+{
+    std::vector<char> data = XodrBinarySerializer::serialize(*this);
+
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file.write(data.data(), data.size()))
+    {
+        throw std::runtime_error("Failed to write binary map file \"" + fileName + "\".");
+    }
+}
+
+void XodrMap::saveFlat(const std::string& fileName) const
+{
+    std::vector<char> data = XodrBinarySerializer::serializeFlat(*this);
+
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file.write(data.data(), data.size()))
+    {
+        throw std::runtime_error("Failed to write flat map file \"" + fileName + "\".");
+    }
+}
+
 class XodrMap::HeaderChildElemParsers : public XmlChildElementParsers<XodrReader, XodrParseResult<XodrMap>>
 {
   public:
@@ -47,13 +118,40 @@ class XodrMap::ChildElemParsers : public XmlChildElementParsers<XodrReader, Xodr
   private:
 };
 
-XodrParseResult<XodrMap> XodrMap::parseXml(XodrReader& xml)
+class XodrMap::LazyChildElemParsers : public XmlChildElementParsers<XodrReader, XodrParseResult<XodrMap>>
 {
-    XodrParseResult<XodrMap> ret;
+  public:
+    LazyChildElemParsers()
+    {
+        addParser("road", Multiplicity::ONE_OR_MORE,
+                  [](XodrReader& xml, XodrParseResult<XodrMap>& map) {
+                      XodrParseResult<Road> road = Road::parseXmlLazy(xml, map.value().lazySource_);
+                      map.value().roads_.push_back(std::move(road.value()));
+                      map.appendErrors(road);
+                  },
+                  XodrInvalidations::ALL);
+        addVectorElementParser<XodrParseResult<Junction>>("junction", &XodrMap::junctions_, Multiplicity::ZERO_OR_MORE,
+                                                          XodrInvalidations::ALL);
+        finalize();
+    }
+};
 
+void XodrMap::parseHeader(XodrReader& xml, XodrParseResult<XodrMap>& map)
+{
     xml.readStartElement("header");
     static HeaderChildElemParsers headerChildElemParsers;
-    headerChildElemParsers.parse(xml, ret);
+    headerChildElemParsers.parse(xml, map);
+}
+
+XodrParseResult<XodrMap> XodrMap::parseXml(XodrReader& xml)
+{
+    std::unique_ptr<XodrArena> arena = std::make_unique<XodrArena>();
+    XodrArena::Scope arenaScope(arena.get());
+
+    XodrParseResult<XodrMap> ret;
+    ret.value().arenas_.push_back(std::move(arena));
+
+    parseHeader(xml, ret);
     static const ChildElemParsers childElementParsers;
     childElementParsers.parse(xml, ret);
     ret.value().resolveReferences(ret.errors());
@@ -61,6 +159,26 @@ XodrParseResult<XodrMap> XodrMap::parseXml(XodrReader& xml)
     return ret;
 }
 
+XodrParseResult<XodrMap> XodrMap::parseLazy(std::shared_ptr<const std::vector<char>> source)
+{
+    std::unique_ptr<XodrArena> arena = std::make_unique<XodrArena>();
+    XodrArena::Scope arenaScope(arena.get());
+
+    XodrParseResult<XodrMap> ret;
+    ret.value().arenas_.push_back(std::move(arena));
+    ret.value().lazySource_ = std::move(source);
+
+    const std::vector<char>& text = *ret.value().lazySource_;
+    XodrReader xml = XodrReader::fromBuffer(text.data(), text.size());
+    xml.readStartElement("OpenDRIVE");
+    parseHeader(xml, ret);
+    static const LazyChildElemParsers childElementParsers;
+    childElementParsers.parse(xml, ret);
+    ret.value().resolveReferences(ret.errors());
+    ret.value().totalNumLanes_ = xml.peekNextGlobalLaneIndex();
+    return ret;
+}
+
 void XodrMap::resolveReferences(std::vector<XodrParseError>& errors)
 {
     assert(idToIndexMaps_.roadIdToIndex_.empty());
@@ -211,6 +329,19 @@ bool XodrMap::hasRoadObjects() const
     return false;
 }
 
+XodrMap::MemoryStats XodrMap::memoryStats() const
+{
+    MemoryStats ret;
+    for (const std::unique_ptr<XodrArena>& arena : arenas_)
+    {
+        ret.numChunks_ += arena->numChunks();
+        ret.bytesAllocated_ += arena->bytesAllocated();
+        ret.bytesReserved_ += arena->bytesReserved();
+    }
+
+    return ret;
+}
+
 void XodrMap::validate() const
 {
     for (const Road& road : roads_)
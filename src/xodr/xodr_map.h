@@ -3,6 +3,7 @@
 #include <boost/optional.hpp>
 
 #include "xodr_reader.h"
+#include "xodr_arena.h"
 #include "road.h"
 #include "junction.h"
 
@@ -15,13 +16,50 @@ class LaneSection;
  */
 class XodrMap
 {
+    friend class XodrBinarySerializer;
+
   public:
     XodrMap() = default;
     XodrMap(const XodrMap&) = delete;
     XodrMap& operator=(const XodrMap&) = delete;
 
     XodrMap(XodrMap&&) = default;
-    XodrMap& operator=(XodrMap&&) = default;
+    XodrMap& operator=(XodrMap&& map);
+
+    /**
+     * @brief Options which control how an xodr file is loaded.
+     */
+    struct ParseOptions
+    {
+        /**
+         * @brief The number of threads used to parse the <road> and <junction>
+         * elements.
+         *
+         * If this is 1, the file is parsed sequentially. If it's 0, one thread
+         * per hardware thread is used.
+         *
+         * The resulting XodrMap (including the global lane indices) and the
+         * parse errors are the same regardless of the number of threads.
+         */
+        int numThreads_ = 1;
+
+        /**
+         * @brief Whether the bodies of the roads are parsed lazily.
+         *
+         * If this is true, the file is read into memory and scanned
+         * sequentially, parsing only the <header>, the <junction> elements and
+         * the attributes and <link> elements of the roads. The reference line,
+         * elevation profile, lane sections and road objects of a road are
+         * parsed when they're first accessed (see @ref Road::parseBody), so
+         * the map can be used much sooner when only a few roads are needed.
+         *
+         * The errors in the bodies of the roads aren't reported by
+         * @ref fromFile in this case, see @ref Road::bodyParseErrors instead.
+         * The numThreads_ option is ignored when parsing lazily.
+         */
+        bool lazy_ = false;
+    };
+
     /**
      * @brief Loads an XodrMap from the given xodr file.
      *
@@ -30,6 +68,23 @@ class XodrMap
      */
     static XodrParseResult<XodrMap> fromFile(const std::string& fileName);
 
+    /**
+     * @brief Loads an XodrMap from the given xodr file, using the given
+     * options.
+     *
+     * When multiple threads are used, the whole file is read into memory, its
+     * top-level elements are located by a sequential pass over the document,
+     * and the <road> and <junction> elements are then parsed concurrently.
+     *
+     * When lazy parsing is enabled, the file is kept in memory by the map
+     * until it's destroyed.
+     *
+     * @param fileName      The name of the xodr file.
+     * @param options       The options.
+     * @returns             The XodrMap.
+     */
+    static XodrParseResult<XodrMap> fromFile(const std::string& fileName, const ParseOptions& options);
+
     /**
      * @brief Loads an XodrMap from the given xodr text.
      *
@@ -48,6 +103,44 @@ class XodrMap
      */
     static XodrParseResult<XodrMap> parseXml(XodrReader& xml);
 
+    /**
+     * @brief Loads an XodrMap from a binary map file written by @ref saveBinary.
+     *
+     * The binary file contains a fully parsed and resolved map, so loading it
+     * is much faster than parsing the original xodr file.
+     *
+     * An exception is thrown if the file can't be read, if it was written with
+     * a different version of the binary format, or if it's corrupt.
+     *
+     * @param fileName      The name of the binary map file.
+     * @returns             The XodrMap.
+     */
+    static XodrMap fromBinary(const std::string& fileName);
+
+    /**
+     * @brief Saves this XodrMap to a binary map file, which can be loaded
+     * using @ref fromBinary.
+     *
+     * See @ref XodrBinarySerializer for a description of the binary format.
+     *
+     * An exception is thrown if the file can't be written.
+     *
+     * @param fileName      The name of the binary map file.
+     */
+    void saveBinary(const std::string& fileName) const;
+
+    /**
+     * @brief Saves this XodrMap to a flat map file, which can be memory mapped
+     * and used without deserialization through an @ref XodrMapView.
+     *
+     * See @ref flat_map_format.h for a description of the file format.
+     *
+     * An exception is thrown if the file can't be written.
+     *
+     * @param fileName      The name of the flat map file.
+     */
+    void saveFlat(const std::string& fileName) const;
+
     /**
      * @brief Gets whether this XodrMap has a geo-reference.
      *
@@ -75,7 +168,7 @@ class XodrMap
      *
      * @returns             A const reference to the vector containing the roads.
      */
-    const std::vector<Road>& roads() const { return roads_; }
+    const ArenaVector<Road>& roads() const { return roads_; }
 
     /**
      * @brief Gets the road with the given road id, or nullptr if no road with
@@ -103,7 +196,7 @@ class XodrMap
      *
      * @returns             A const reference to the vector containing the junctions.
      */
-    const std::vector<Junction>& junctions() const { return junctions_; }
+    const ArenaVector<Junction>& junctions() const { return junctions_; }
 
     /**
      * @brief Gets the junction with the given junction id, or nullptr if no
@@ -144,11 +237,48 @@ class XodrMap
      * all roads, and returns true if there's at least one road with at least
      * one road objects.
      *
+     * If the map was parsed lazily, this parses the bodies of all roads.
+     *
      * @return True if there's at least one road with at least one road object,
      * false otherwise.
      */
     bool hasRoadObjects() const;
 
+    /**
+     * @brief Statistics about the memory used by an XodrMap.
+     */
+    struct MemoryStats
+    {
+        /**
+         * @brief The number of arena chunks, which is the number of large
+         * allocations the map's objects were allocated from.
+         */
+        size_t numChunks_ = 0;
+
+        /**
+         * @brief The number of bytes allocated from the arenas.
+         */
+        size_t bytesAllocated_ = 0;
+
+        /**
+         * @brief The total size of the arena chunks.
+         */
+        size_t bytesReserved_ = 0;
+    };
+
+    /**
+     * @brief Gets statistics about the memory used by this XodrMap.
+     *
+     * All objects of a map which is parsed or loaded from a binary file are
+     * allocated from arenas owned by the map (see @ref XodrArena), so loading
+     * a map only takes a few large allocations, and destroying it releases
+     * them at once. Objects must not be moved out of a map which is destroyed
+     * before them, but they can be copied.
+     *
+     * @returns             The memory statistics.
+     */
+    MemoryStats memoryStats() const;
+
     /**
      * @brief Validates this XodrMap.
      *
@@ -192,17 +322,43 @@ class XodrMap
   private:
     void resolveReferences(std::vector<XodrParseError>& errors);
 
+    static void parseHeader(XodrReader& xml, XodrParseResult<XodrMap>& map);
+
+    static XodrParseResult<XodrMap> parseLazy(std::shared_ptr<const std::vector<char>> source);
+
     class HeaderChildElemParsers;
     class ChildElemParsers;
+    class LazyChildElemParsers;
+    class ParallelParser;
+
+    /**
+     * @brief The arenas which own the memory of this map's objects.
+     *
+     * The objects are allocated from the current arena of the thread which
+     * creates them (see @ref XodrArena::Scope), so an arena is made current
+     * before the map is created, and then added to this list.
+     *
+     * This is the first member, so the arenas are destroyed after the objects
+     * allocated from them.
+     */
+    std::vector<std::unique_ptr<XodrArena>> arenas_;
 
     boost::optional<std::string> geoReference_;
 
-    std::vector<Road> roads_;
-    std::vector<Junction> junctions_;
+    ArenaVector<Road> roads_;
+    ArenaVector<Junction> junctions_;
 
     IdToIndexMaps idToIndexMaps_;
 
     int totalNumLanes_;
+
+    /**
+     * @brief The text of the xodr file, if the map was parsed lazily.
+     *
+     * The roads share ownership of the text, which they parse their bodies
+     * from.
+     */
+    std::shared_ptr<const std::vector<char>> lazySource_;
 };
 
 }}  // namespace aid::xodr
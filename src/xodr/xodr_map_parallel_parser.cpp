@@ -0,0 +1,264 @@
+#include "xodr_map.h"
+
+#include <exception>
+#include <fstream>
+#include <memory>
+
+#include "parallel_for.h"
+
+namespace aid { namespace xodr {
+
+/**
+ * @brief Parses the <road> and <junction> elements of an xodr document
+ * concurrently.
+ *
+ * The document is first scanned sequentially, which locates the byte range of
+ * each top-level element (skipping over their contents without storing any
+ * attributes). Each <road> and <junction> element is then parsed on one of the
+ * worker threads, using a reader which only sees that element. Finally, the
+ * results are merged into the map in document order.
+ *
+ * The global lane indices of each road are assigned starting at 0 by the
+ * worker which parses it, and are offset during the merge by the number of
+ * lanes in all preceding roads. This results in the same global lane indices
+ * as the sequential parser, regardless of the order in which the elements are
+ * parsed.
+ */
+class XodrMap::ParallelParser
+{
+  public:
+    ParallelParser(const char* data, size_t size) : data_(data), size_(size) {}
+
+    XodrParseResult<XodrMap> parse(int numThreads)
+    {
+        std::unique_ptr<XodrArena> arena = std::make_unique<XodrArena>();
+        XodrArena::Scope arenaScope(arena.get());
+
+        XodrParseResult<XodrMap> ret;
+        ret.value().arenas_.push_back(std::move(arena));
+
+        XodrReader xml = XodrReader::fromBuffer(data_, size_);
+        xml.readStartElement("OpenDRIVE");
+        parseHeader(xml, ret);
+        scanElements(xml);
+
+        parseElements(numThreads);
+        merge(ret);
+
+        for (std::unique_ptr<XodrArena>& workerArena : workerArenas_)
+        {
+            ret.value().arenas_.push_back(std::move(workerArena));
+        }
+
+        ret.value().resolveReferences(ret.errors());
+        return ret;
+    }
+
+  private:
+    /**
+     * @brief A top-level element of the document.
+     *
+     * Elements other than <road> and <junction> only hold the error which the
+     * sequential parser reports for them, so errors are merged in the same
+     * order as well.
+     */
+    struct Element
+    {
+        enum class Type
+        {
+            ROAD,
+            JUNCTION,
+            UNEXPECTED,
+        };
+
+        Type type_;
+
+        size_t byteOffset_;
+        size_t endByteOffset_;
+        int lineNumber_;
+        int columnNumber_;
+
+        std::unique_ptr<XodrParseResult<Road>> road_;
+        std::unique_ptr<XodrParseResult<Junction>> junction_;
+        boost::optional<XmlParseError> error_;
+
+        /**
+         * @brief The number of global lane indices used by this element.
+         */
+        int numGlobalLaneIndices_ = 0;
+
+        std::exception_ptr exception_;
+    };
+
+    void scanElements(XodrReader& xml)
+    {
+        std::string parentName = xml.getCurElementName();
+        while (!xml.tryReadEndElement())
+        {
+            xml.readStartElement();
+
+            Element element;
+            element.byteOffset_ = xml.getByteOffset();
+            element.lineNumber_ = xml.getLineNumber();
+            element.columnNumber_ = xml.getColumnNumber();
+
+            const std::string& name = xml.getCurElementName();
+            if (name == "road")
+            {
+                element.type_ = Element::Type::ROAD;
+            }
+            else if (name == "junction")
+            {
+                element.type_ = Element::Type::JUNCTION;
+            }
+            else
+            {
+                element.type_ = Element::Type::UNEXPECTED;
+                element.error_ = XmlParseError(XmlParseError::Category::UNEXPECTED_CHILD_ELEMENT, parentName, name);
+            }
+
+            xml.skipToEndElement();
+            element.endByteOffset_ = xml.getEndByteOffset();
+            elements_.push_back(std::move(element));
+        }
+    }
+
+    void parseElements(int numThreads)
+    {
+        // Arenas aren't thread-safe, so each worker thread allocates the
+        // objects it parses from its own arena, which is handed over to the
+        // map afterwards. The calling thread (thread index 0) uses the arena
+        // of the map.
+        workerArenas_.resize(numThreads - 1);
+        for (std::unique_ptr<XodrArena>& workerArena : workerArenas_)
+        {
+            workerArena = std::make_unique<XodrArena>();
+        }
+
+        // Parse errors and exceptions are stored in the elements, so they're
+        // merged in document order regardless of the thread which parsed them.
+        parallelFor(numThreads, elements_.size(), [this](size_t i, int threadIdx) {
+            XodrArena* arena = threadIdx == 0 ? XodrArena::current() : workerArenas_[threadIdx - 1].get();
+            XodrArena::Scope arenaScope(arena);
+            parseElement(elements_[i]);
+        });
+    }
+
+    void parseElement(Element& element)
+    {
+        if (element.type_ == Element::Type::UNEXPECTED)
+        {
+            return;
+        }
+
+        try
+        {
+            XodrReader xml =
+                XodrReader::fromBuffer(data_ + element.byteOffset_, element.endByteOffset_ - element.byteOffset_,
+                                       element.lineNumber_, element.columnNumber_, element.byteOffset_);
+            xml.readStartElement();
+
+            if (element.type_ == Element::Type::ROAD)
+            {
+                element.road_ = std::make_unique<XodrParseResult<Road>>(Road::parseXml(xml));
+            }
+            else
+            {
+                element.junction_ = std::make_unique<XodrParseResult<Junction>>(Junction::parseXml(xml));
+            }
+
+            element.numGlobalLaneIndices_ = xml.peekNextGlobalLaneIndex();
+        }
+        catch (...)
+        {
+            element.exception_ = std::current_exception();
+        }
+    }
+
+    void merge(XodrParseResult<XodrMap>& map)
+    {
+        int nextGlobalLaneIndex = 0;
+        for (Element& element : elements_)
+        {
+            if (element.exception_)
+            {
+                std::rethrow_exception(element.exception_);
+            }
+
+            switch (element.type_)
+            {
+                case Element::Type::ROAD:
+                    element.road_->value().offsetGlobalLaneIndices(nextGlobalLaneIndex);
+                    map.value().roads_.push_back(std::move(element.road_->value()));
+                    map.appendErrors(*element.road_);
+                    break;
+                case Element::Type::JUNCTION:
+                    map.value().junctions_.push_back(std::move(element.junction_->value()));
+                    map.appendErrors(*element.junction_);
+                    break;
+                case Element::Type::UNEXPECTED:
+                    map.errors().emplace_back(std::move(*element.error_));
+                    break;
+            }
+
+            nextGlobalLaneIndex += element.numGlobalLaneIndices_;
+        }
+
+        if (map.value().roads_.empty())
+        {
+            map.errors().emplace_back(
+                XmlParseError(XmlParseError::Category::MISSING_CHILD_ELEMENT, "OpenDRIVE", "road"),
+                XodrInvalidations::ALL);
+        }
+
+        map.value().totalNumLanes_ = nextGlobalLaneIndex;
+    }
+
+    const char* data_;
+    size_t size_;
+
+    std::vector<Element> elements_;
+
+    std::vector<std::unique_ptr<XodrArena>> workerArenas_;
+};
+
+/**
+ * @brief Reads the whole file with the given name into memory.
+ */
+static std::vector<char> readFile(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open file \"" + fileName + "\".");
+    }
+
+    std::vector<char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(data.data(), data.size()))
+    {
+        throw std::runtime_error("Error while reading xml file.");
+    }
+
+    return data;
+}
+
+XodrParseResult<XodrMap> XodrMap::fromFile(const std::string& fileName, const ParseOptions& options)
+{
+    if (options.lazy_)
+    {
+        return parseLazy(std::make_shared<const std::vector<char>>(readFile(fileName)));
+    }
+
+    int numThreads = resolveNumThreads(options.numThreads_);
+
+    if (numThreads == 1)
+    {
+        return fromFile(fileName);
+    }
+
+    std::vector<char> data = readFile(fileName);
+    return ParallelParser(data.data(), data.size()).parse(numThreads);
+}
+
+}}  // namespace aid::xodr
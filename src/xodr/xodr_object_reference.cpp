@@ -5,7 +5,7 @@
 
 namespace aid { namespace xodr {
 
-XodrParseResult<XodrObjectReference> XodrObjectReference::parse(const std::string& txt)
+XodrParseResult<XodrObjectReference> XodrObjectReference::parse(std::string_view txt)
 {
     XodrObjectReference ret;
     ret.id_ = txt;
@@ -21,6 +21,8 @@ namespace aid { namespace xodr {
  */
 class XodrObjectReference
 {
+    friend class XodrBinarySerializer;
+
   public:
     XodrObjectReference() = default;
 
@@ -39,7 +41,7 @@ class XodrObjectReference
      *
      * @returns             The XodrObjectReference.
      */
-    static XodrParseResult<XodrObjectReference> parse(const std::string& txt);
+    static XodrParseResult<XodrObjectReference> parse(std::string_view txt);
 
     /**
      * @brief Returns whether the ID of this reference is equal to the given value.
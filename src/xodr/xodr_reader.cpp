@@ -42,4 +42,12 @@ XodrReader XodrReader::fromText(const std::string& text)
     ret.initFromText(text);
     return ret;
 }
+
+XodrReader XodrReader::fromBuffer(const char* data, size_t size, int lineNumber, int columnNumber,
+                                  size_t byteOffset)
+{
+    XodrReader ret;
+    ret.initFromBuffer(data, size, lineNumber, columnNumber, byteOffset);
+    return ret;
+}
 }}  // namespace aid::xodr
\ No newline at end of file
@@ -197,6 +197,19 @@ class XodrReader : public XmlReader
      */
     static XodrReader fromText(const std::string& text);
 
+    /**
+     * @brief Creates an XodrReader which parses the xodr in the given buffer,
+     * without copying it.
+     *
+     * This is used to parse fragments of a larger document, see
+     * @ref XmlTokenizer::fromBuffer for the meaning of the parameters. The
+     * global lane indices of the returned reader start at 0.
+     *
+     * @returns             The XodrReader.
+     */
+    static XodrReader fromBuffer(const char* data, size_t size, int lineNumber = 1, int columnNumber = 1,
+                                 size_t byteOffset = 0);
+
     /**
      * @brief Gets a new global lane index.
      *
@@ -7,7 +7,10 @@
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QScrollArea>
 
+#include <vector>
+
 #include "bounding_rect.h"
+#include "xodr/map_tessellator.h"
 #include "xodr/xodr_map.h"
 
 namespace aid { namespace xodr {
@@ -15,6 +18,12 @@ namespace aid { namespace xodr {
 static constexpr float DRAW_SCALE = 8;
 static constexpr float DRAW_MARGIN = 200;
 
+/**
+ * @brief The maximum error of the rendered lane boundaries, in meters. A
+ * quarter of a pixel is indistinguishable from the exact curves.
+ */
+static constexpr double TESSELLATION_MAX_ERROR = .25 / DRAW_SCALE;
+
 struct XodrFileInfo
 {
     const char* name;
@@ -58,6 +67,18 @@ class XodrViewerWindow::XodrView : public QWidget
 
     std::unique_ptr<XodrMap> xodrMap_;
 
+    /**
+     * @brief The tessellation of xodrMap_, which is computed once by setMap()
+     * and drawn by paintEvent().
+     */
+    std::unique_ptr<MapTessellator> mapTessellator_;
+
+    /**
+     * @brief A buffer for the points drawn by paintEvent(), which is kept
+     * from one repaint to the next so it's only allocated once.
+     */
+    std::vector<QPointF> qtPoints_;
+
     /**
      * @brief The offset used in the pointMapToView function.
      *
@@ -119,8 +140,15 @@ void XodrViewerWindow::onXodrFileSelected(int index)
 
 void XodrViewerWindow::XodrView::setMap(std::unique_ptr<XodrMap>&& xodrMap)
 {
+    // The tessellator refers to the map, so it's destroyed first.
+    mapTessellator_.reset();
     xodrMap_ = std::move(xodrMap);
 
+    MapTessellator::Options tessellationOptions;
+    tessellationOptions.maxError_ = TESSELLATION_MAX_ERROR;
+    mapTessellator_.reset(new MapTessellator(*xodrMap_));
+    mapTessellator_->tessellate(tessellationOptions);
+
     BoundingRect boundingRect = xodrMapApproxBoundingRect(*xodrMap_);
 
     Eigen::Vector2d diag = boundingRect.max_ - boundingRect.min_;
@@ -146,21 +174,24 @@ void XodrViewerWindow::XodrView::paintEvent(QPaintEvent*)
 {
     QPainter painter(this);
 
-    for (const Road& road : xodrMap_->roads())
+    if (!xodrMap_)
+    {
+        return;
+    }
+
+    const auto& roads = xodrMap_->roads();
+    for (int roadIdx = 0; roadIdx < (int)roads.size(); roadIdx++)
     {
-        const auto& laneSections = road.laneSections();
+        const auto& laneSections = roads[roadIdx].laneSections();
         for (int laneSectionIdx = 0; laneSectionIdx < (int)laneSections.size(); laneSectionIdx++)
         {
             const LaneSection& laneSection = laneSections[laneSectionIdx];
-
-            auto refLineTessellation = road.referenceLine().tessellate(laneSection.startS(), laneSection.endS());
-            auto boundaries = laneSection.tessellateLaneBoundaryCurves(refLineTessellation);
             const auto& lanes = laneSection.lanes();
 
-            for (size_t i = 0; i < boundaries.size(); i++)
+            int firstBoundary = mapTessellator_->boundaryIndex(LaneSectionKey(roadIdx, laneSectionIdx), 0);
+            int numBoundaries = (int)lanes.size() + 1;
+            for (int i = 0; i < numBoundaries; i++)
             {
-                const LaneSection::BoundaryCurveTessellation& boundary = boundaries[i];
-
                 if(i == 0)
                 {
                     // The left-most boundary. Only render it if the left-most 
@@ -171,7 +202,7 @@ void XodrViewerWindow::XodrView::paintEvent(QPaintEvent*)
                         continue;
                     }
                 }
-                else if(i == boundaries.size() - 1)
+                else if(i == numBoundaries - 1)
                 {
                     // A boundary between two lanes. Render it if at least one
                     // of the two adjacent lanes is visible.
@@ -192,12 +223,16 @@ void XodrViewerWindow::XodrView::paintEvent(QPaintEvent*)
                     }
                 }
 
-                QVector<QPointF> qtPoints;
-                for (Eigen::Vector2d pt : boundary.vertices_)
+                MapTessellator::Polyline boundary = mapTessellator_->boundary(firstBoundary + i);
+                const Eigen::Vector2d* vertices = boundary.vertices_;
+                int numVertices = boundary.size_;
+
+                qtPoints_.resize(numVertices);
+                for (int j = 0; j < numVertices; j++)
                 {
-                    qtPoints.append(pointMapToView(pt));
+                    qtPoints_[j] = pointMapToView(vertices[j]);
                 }
-                painter.drawPolyline(qtPoints);
+                painter.drawPolyline(qtPoints_.data(), numVertices);
             }
         }
     }